@@ -131,6 +131,13 @@ TypeId DsrRouting::GetTypeId ()
                    MakePointerAccessor (&DsrRouting::SetPassiveBuffer,
                                         &DsrRouting::GetPassiveBuffer),
                    MakePointerChecker<DsrPassiveBuffer> ())
+    .AddAttribute ("Adversary",
+                   "The attacker nodes and what they do, "
+                   "built from the DsrAdversary defaults when not set.",
+                   PointerValue (0),
+                   MakePointerAccessor (&DsrRouting::SetAdversary,
+                                        &DsrRouting::GetAdversary),
+                   MakePointerChecker<DsrAdversary> ())
     .AddAttribute ("MaxSendBuffLen",
                    "Maximum number of packets that can be stored "
                    "in send buffer.",
@@ -449,24 +456,14 @@ void DsrRouting::Start ()
   SetPassiveBuffer (passiveBuffer);
 
 
-  uint16_t count = 2; // 1 = 1 blackhole, 2 = 2 blackholes 3 = no blackhole
-   switch (count) {
-      case 1:
-
-    	  if(m_node->GetId() == 5)
-    		  blackHole = true;
-    	  
-          break;
-      case 2:
-    	  if(m_node->GetId() == 5 || m_node->GetId() == 7)
-    	       blackHole = true;
-        break;
-      case 3:
-    	  blackHole = false;
-        break;
-      default:
-        NS_FATAL_ERROR ("not find the blackhole option!");
-        break;
+  // Attacker nodes and their behaviour come from the adversary model
+  if (m_adversary == 0)
+    {
+      m_adversary = CreateObject<DsrAdversary> ();
+    }
+  if (m_adversary->IsAttacker (m_node->GetId ()))
+    {
+      NS_LOG_INFO ("Node " << m_node->GetId () << " is an attacker");
     }
 
   // Set the send buffer parameters
@@ -597,6 +594,18 @@ DsrRouting::SetNode (Ptr<Node> node)
   m_node = node;
 }
 
+void
+DsrRouting::SetAdversary (Ptr<dsr::DsrAdversary> adversary)
+{
+  m_adversary = adversary;
+}
+
+Ptr<dsr::DsrAdversary>
+DsrRouting::GetAdversary () const
+{
+  return m_adversary;
+}
+
 Ptr<Node>
 DsrRouting::GetNode () const
 {
@@ -2643,7 +2652,12 @@ DsrRouting::AssignStreams (int64_t stream)
 {
   NS_LOG_FUNCTION (this << stream);
   m_uniformRandomVariable->SetStream (stream);
-  return 1;
+  if (m_adversary == 0)
+    {
+      m_adversary = CreateObject<DsrAdversary> ();
+    }
+  // A shared adversary takes the stream of the first node only
+  return 1 + m_adversary->AssignStreams (stream + 1);
 }
 
 void
@@ -3666,7 +3680,7 @@ uint8_t DsrRouting::processSr(Ptr<Packet> packet, Ptr<Packet> dsrP, Ipv4Address
 		  	  //Ptr<Packet> ackp = packet->Copy ();
 		  	 // m_ipv4Route = SetRoute (ackAddress, ipv4Address);
 
-		  	    if(blackHole == true){ // when blackhole receives the datapacket->discard it!
+		  	    if(m_adversary->DropsData (m_node->GetId (), GetIDfromIP (nodeList.front ()), GetIDfromIP (nodeList.back ()))){ // when blackhole receives the datapacket->discard it!
 		  	    	 /*if(ApacketId != p->GetUid()){
 		  	    	  	++attackCount;
 		  	    	  	ApacketId = p->GetUid();
@@ -3952,7 +3966,7 @@ uint8_t DsrRouting::processRreq(Ptr<Packet> packet, Ptr<Packet> dsrP, Ipv4Addres
                                               saveRoute);
 
 
-      if(blackHole == true){  // blackhole test let 32 and 25 be blackhole attack
+      if(m_adversary->ForgesReplies (m_node->GetId ())){  // blackhole / grayhole answer with a forged reply
           	  Ipv4Address nextHop; // Declare the next hop address to use
           	               std::vector<Ipv4Address> changeRoute (nodeList);
 
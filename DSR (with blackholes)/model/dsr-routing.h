@@ -71,6 +71,7 @@
 #include "dsr-option-header.h"
 #include "dsr-fs-header.h"
 #include "dsr-rsendbuff.h"
+#include "dsr-adversary.h"
 #include "dsr-errorbuff.h"
 #include "dsr-gratuitous-reply-table.h"
 
@@ -152,6 +153,16 @@ public:
     * \return the passive buffer
     */
   Ptr<dsr::DsrPassiveBuffer> GetPassiveBuffer () const;
+  /**
+   * \brief Set the adversary model
+   * \param adversary the attacker set and behaviour, may be shared by all the nodes
+   */
+  void SetAdversary (Ptr<dsr::DsrAdversary> adversary);
+  /**
+   * \brief Get the adversary model
+   * \return the attacker set and behaviour
+   */
+  Ptr<dsr::DsrAdversary> GetAdversary () const;
 
   /// functions used to direct to route cache
   //\{
@@ -612,7 +623,6 @@ bool ContainAddressAfter (Ipv4Address ipv4Address, Ipv4Address destAddress, std:
    * \brief List of DSR Options supported.
    */
 
-  bool blackHole = false;
   uint16_t dsrRreq = 0;
   uint16_t dsrRrep = 0;
   uint16_t dsrAck = 0;
@@ -757,6 +767,8 @@ bool ContainAddressAfter (Ipv4Address ipv4Address, Ipv4Address destAddress, std:
 
   Ptr<dsr::DsrPassiveBuffer> m_passiveBuffer;           ///< A "drop-front" queue used by the routing layer to cache route request sent.
 
+  Ptr<dsr::DsrAdversary> m_adversary;                   ///< The attacker set and behaviour
+
   uint32_t m_numPriorityQueues;                         ///< The number of priority queues used
 
   bool m_linkAck;                                       ///< define if we use link acknowledgement or not
@@ -39,6 +39,7 @@
 #include "ns3/double.h"
 #include "ns3/uinteger.h"
 #include "ns3/string.h"
+#include "ns3/enum.h"
 #include "ns3/ipv4-address-helper.h"
 
 #include "ns3/dsr-fs-header.h"
@@ -46,6 +47,7 @@
 #include "ns3/dsr-rreq-table.h"
 #include "ns3/dsr-rcache.h"
 #include "ns3/dsr-rsendbuff.h"
+#include "ns3/dsr-adversary.h"
 #include "ns3/dsr-main-helper.h"
 #include "ns3/dsr-helper.h"
 
@@ -503,6 +505,75 @@ DsrRreqTableTest::DoRun ()
   NS_TEST_EXPECT_MSG_EQ (rt.m_reqNo, 2, "trivial");
 }
 // -----------------------------------------------------------------------------
+// / Unit test for the adversary model
+class DsrAdversaryTest : public TestCase
+{
+public:
+  DsrAdversaryTest ();
+  ~DsrAdversaryTest ();
+  virtual void
+  DoRun (void);
+  void CheckWindow (bool active);
+
+  Ptr<dsr::DsrAdversary> adversary;
+};
+DsrAdversaryTest::DsrAdversaryTest ()
+  : TestCase ("DSR Adversary")
+{
+}
+DsrAdversaryTest::~DsrAdversaryTest ()
+{
+}
+void
+DsrAdversaryTest::CheckWindow (bool active)
+{
+  NS_TEST_EXPECT_MSG_EQ (adversary->IsActive (12), active, "Attack window at " << Simulator::Now ().GetSeconds ());
+  NS_TEST_EXPECT_MSG_EQ (adversary->ForgesReplies (12), active, "trivial");
+  NS_TEST_EXPECT_MSG_EQ (adversary->DropsData (12, 1, 2), active, "trivial");
+}
+void
+DsrAdversaryTest::DoRun ()
+{
+  adversary = CreateObject<dsr::DsrAdversary> ();
+  NS_TEST_EXPECT_MSG_EQ (adversary->GetAttackerNodes (), "5,7", "The old DSR blackholes by default");
+  adversary->SetAttribute ("AttackerNodes", StringValue (""));
+  NS_TEST_EXPECT_MSG_EQ (adversary->IsConfigured (), false, "No attackers");
+  NS_TEST_EXPECT_MSG_EQ (adversary->DropsData (12, 1, 2), false, "trivial");
+  NS_TEST_EXPECT_MSG_EQ (adversary->AssignStreams (7), 1, "The first node sharing the adversary assigns its stream");
+  NS_TEST_EXPECT_MSG_EQ (adversary->AssignStreams (9), 0, "The others do not");
+
+  adversary->SetAttribute ("AttackerNodes", StringValue ("18, 12,30-32"));
+  NS_TEST_EXPECT_MSG_EQ (adversary->GetAttackerNodes (), "12,18,30,31,32", "Ids and ranges");
+  NS_TEST_EXPECT_MSG_EQ (adversary->IsConfigured (), true, "trivial");
+  NS_TEST_EXPECT_MSG_EQ (adversary->IsAttacker (31), true, "trivial");
+  NS_TEST_EXPECT_MSG_EQ (adversary->IsAttacker (13), false, "trivial");
+
+  adversary->SetAttribute ("AttackType", EnumValue (dsr::DsrAdversary::GRAYHOLE));
+  adversary->SetAttribute ("DropProbability", DoubleValue (0.0));
+  NS_TEST_EXPECT_MSG_EQ (adversary->ForgesReplies (12), true, "A grayhole forges replies");
+  NS_TEST_EXPECT_MSG_EQ (adversary->DropsData (12, 1, 2), false, "trivial");
+  adversary->SetAttribute ("DropProbability", DoubleValue (1.0));
+  NS_TEST_EXPECT_MSG_EQ (adversary->DropsData (12, 1, 2), true, "trivial");
+  NS_TEST_EXPECT_MSG_EQ (adversary->DropsData (13, 1, 2), false, "Only attackers drop");
+
+  adversary->SetAttribute ("AttackType", EnumValue (dsr::DsrAdversary::SELECTIVE_FORWARDING));
+  adversary->SetAttribute ("SelectiveTargets", StringValue ("2"));
+  NS_TEST_EXPECT_MSG_EQ (adversary->ForgesReplies (12), false, "A selective forwarder routes honestly");
+  NS_TEST_EXPECT_MSG_EQ (adversary->DropsData (12, 1, 2), true, "Flows to a target are dropped");
+  NS_TEST_EXPECT_MSG_EQ (adversary->DropsData (12, 2, 3), true, "Flows from a target are dropped");
+  NS_TEST_EXPECT_MSG_EQ (adversary->DropsData (12, 1, 3), false, "Other flows are forwarded");
+
+  adversary->SetAttribute ("AttackType", EnumValue (dsr::DsrAdversary::BLACKHOLE));
+  adversary->SetAttribute ("StartTime", TimeValue (Seconds (10)));
+  adversary->SetAttribute ("StopTime", TimeValue (Seconds (20)));
+  Simulator::Schedule (Seconds (5), &DsrAdversaryTest::CheckWindow, this, false);
+  Simulator::Schedule (Seconds (10), &DsrAdversaryTest::CheckWindow, this, true);
+  Simulator::Schedule (Seconds (19), &DsrAdversaryTest::CheckWindow, this, true);
+  Simulator::Schedule (Seconds (20), &DsrAdversaryTest::CheckWindow, this, false);
+  Simulator::Run ();
+  Simulator::Destroy ();
+}
+// -----------------------------------------------------------------------------
 class DsrTestSuite : public TestSuite
 {
 public:
@@ -517,5 +588,6 @@ public:
     AddTestCase (new DsrAckHeaderTest, TestCase::QUICK);
     AddTestCase (new DsrCacheEntryTest, TestCase::QUICK);
     AddTestCase (new DsrSendBuffTest, TestCase::QUICK);
+    AddTestCase (new DsrAdversaryTest, TestCase::QUICK);
   }
 } g_dsrTestSuite;
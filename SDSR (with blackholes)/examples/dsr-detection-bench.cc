@@ -0,0 +1,302 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2026 The SDSR contributors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: The SDSR contributors, see the git history
+ */
+
+/*
+ * Blackhole detection accuracy and cost of SDSR. Runs the scenario of the dsr
+ * example (nodes on 300 x 1500 m, random waypoint, nSinks CBR flows) for every
+ * combination of node count, maximum speed and attacker count, and writes one
+ * row per run with the detection precision and recall, the time to detect, the
+ * control bytes on top of an attack free run with the same seed, the delivery
+ * ratio and the CPU time per simulated second.
+ *
+ * The attackers are spread evenly over the nodes that are neither source nor
+ * sink and start to misbehave when the data starts. Every node count and speed
+ * is first run without attackers to get the baseline of the extra control bytes.
+ *
+ * ./waf --run "dsr-detection-bench --nodes=30,50,80 --speeds=0,10,20 --attackers=1,2,4 --runs=3 --csv=detection.csv --json=detection.json"
+ */
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/applications-module.h"
+#include "ns3/mobility-module.h"
+#include "ns3/wifi-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/dsr-module.h"
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <algorithm>
+#include <cstdlib>
+#include <ctime>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("DsrDetectionBench");
+
+static uint32_t g_txPackets = 0;
+static uint32_t g_rxPackets = 0;
+
+static void
+TxPacket (Ptr<const Packet> packet)
+{
+  ++g_txPackets;
+}
+
+static void
+RxPacket (Ptr<const Packet> packet, const Address &from)
+{
+  ++g_rxPackets;
+}
+
+/// Split a comma separated list of numbers
+static std::vector<double>
+ParseList (std::string list)
+{
+  std::vector<double> values;
+  std::istringstream in (list);
+  std::string item;
+  while (std::getline (in, item, ','))
+    {
+      values.push_back (std::atof (item.c_str ()));
+    }
+  return values;
+}
+
+/// Spread count attackers evenly over the relays, the nodes that are neither source nor sink
+static std::string
+PickAttackers (uint32_t nWifis, uint32_t nSinks, uint32_t count)
+{
+  uint32_t relays = nWifis - 2 * nSinks;
+  std::ostringstream ids;
+  for (uint32_t j = 0; j < count; ++j)
+    {
+      ids << (j ? "," : "") << nSinks + j * relays / count;
+    }
+  return ids.str ();
+}
+
+/// Run one sweep point and return the CPU time in seconds
+static double
+RunOnce (uint32_t nWifis, uint32_t nSinks, double nodeSpeed, double totalTime, double dataStart,
+         DsrDetectionStats &stats)
+{
+  NodeContainer adhocNodes;
+  adhocNodes.Create (nWifis);
+
+  WifiHelper wifi;
+  wifi.SetStandard (WIFI_PHY_STANDARD_80211b);
+  YansWifiPhyHelper wifiPhy = YansWifiPhyHelper::Default ();
+  YansWifiChannelHelper wifiChannel;
+  wifiChannel.SetPropagationDelay ("ns3::ConstantSpeedPropagationDelayModel");
+  wifiChannel.AddPropagationLoss ("ns3::RangePropagationLossModel", "MaxRange", DoubleValue (250.0));
+  wifiPhy.SetChannel (wifiChannel.Create ());
+  WifiMacHelper wifiMac;
+  wifi.SetRemoteStationManager ("ns3::ConstantRateWifiManager", "DataMode", StringValue ("DsssRate11Mbps"),
+                                "ControlMode", StringValue ("DsssRate11Mbps"));
+  wifiMac.SetType ("ns3::AdhocWifiMac");
+  NetDeviceContainer allDevices = wifi.Install (wifiPhy, wifiMac, adhocNodes);
+
+  // The area of the dsr example is kept, so the node count sets the density
+  MobilityHelper adhocMobility;
+  ObjectFactory pos;
+  pos.SetTypeId ("ns3::RandomRectanglePositionAllocator");
+  pos.Set ("X", StringValue ("ns3::UniformRandomVariable[Min=0.0|Max=300.0]"));
+  pos.Set ("Y", StringValue ("ns3::UniformRandomVariable[Min=0.0|Max=1500.0]"));
+  Ptr<PositionAllocator> taPositionAlloc = pos.Create ()->GetObject<PositionAllocator> ();
+  if (nodeSpeed > 0)
+    {
+      std::ostringstream speed;
+      speed << "ns3::UniformRandomVariable[Min=0.0|Max=" << nodeSpeed << "]";
+      adhocMobility.SetMobilityModel ("ns3::RandomWaypointMobilityModel",
+                                      "Speed", StringValue (speed.str ()),
+                                      "Pause", StringValue ("ns3::ConstantRandomVariable[Constant=0.0]"),
+                                      "PositionAllocator", PointerValue (taPositionAlloc));
+    }
+  else
+    {
+      // A random waypoint node with zero speed never reaches its next waypoint
+      adhocMobility.SetPositionAllocator (taPositionAlloc);
+      adhocMobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+    }
+  adhocMobility.Install (adhocNodes);
+
+  InternetStackHelper internet;
+  DsrMainHelper dsrMain;
+  DsrHelper dsr;
+  internet.Install (adhocNodes);
+  dsrMain.Install (dsr, adhocNodes);
+  stats.Install (adhocNodes);
+
+  Ipv4AddressHelper address;
+  address.SetBase ("10.1.0.0", "255.255.0.0");
+  Ipv4InterfaceContainer allInterfaces = address.Assign (allDevices);
+
+  uint16_t port = 9;
+  for (uint32_t i = 0; i < nSinks; ++i)
+    {
+      PacketSinkHelper sink ("ns3::UdpSocketFactory", InetSocketAddress (Ipv4Address::GetAny (), port));
+      ApplicationContainer appsSink = sink.Install (adhocNodes.Get (i));
+      appsSink.Get (0)->TraceConnectWithoutContext ("Rx", MakeCallback (&RxPacket));
+
+      OnOffHelper onoff ("ns3::UdpSocketFactory", Address (InetSocketAddress (allInterfaces.GetAddress (i), port)));
+      onoff.SetAttribute ("OnTime", StringValue ("ns3::ConstantRandomVariable[Constant=1.0]"));
+      onoff.SetAttribute ("OffTime", StringValue ("ns3::ConstantRandomVariable[Constant=0.0]"));
+      onoff.SetAttribute ("PacketSize", UintegerValue (64));
+      onoff.SetAttribute ("DataRate", DataRateValue (DataRate ("0.512kbps")));
+      ApplicationContainer apps = onoff.Install (adhocNodes.Get (i + nWifis - nSinks));
+      apps.Get (0)->TraceConnectWithoutContext ("Tx", MakeCallback (&TxPacket));
+      apps.Start (Seconds (dataStart + 0.1 * i));
+      apps.Stop (Seconds (totalTime - 1.0));
+    }
+
+  g_txPackets = 0;
+  g_rxPackets = 0;
+  Simulator::Stop (Seconds (totalTime));
+  std::clock_t start = std::clock ();
+  Simulator::Run ();
+  double cpu = double (std::clock () - start) / CLOCKS_PER_SEC;
+  stats.Finish ();
+  Simulator::Destroy ();
+  return cpu;
+}
+
+int
+main (int argc, char *argv[])
+{
+  std::string nodes = "50";
+  std::string speeds = "0,10,20";
+  std::string attackers = "1,2,4";
+  uint32_t attackType = dsr::DsrAdversary::BLACKHOLE;
+  uint32_t nSinks = 10;
+  uint32_t runs = 1;
+  double totalTime = 200.0;
+  double dataStart = 50.0;
+  std::string csvFile = "dsr-detection.csv";
+  std::string jsonFile = "";
+
+  CommandLine cmd;
+  cmd.AddValue ("nodes", "Comma separated node counts to sweep", nodes);
+  cmd.AddValue ("speeds", "Comma separated maximum node speeds to sweep, 0 for static nodes", speeds);
+  cmd.AddValue ("attackers", "Comma separated attacker counts to sweep", attackers);
+  cmd.AddValue ("attackType", "1=blackhole 2=grayhole 3=selective forwarding", attackType);
+  cmd.AddValue ("nSinks", "Number of CBR flows", nSinks);
+  cmd.AddValue ("runs", "Seeds per sweep point", runs);
+  cmd.AddValue ("totalTime", "Simulated seconds per run", totalTime);
+  cmd.AddValue ("dataStart", "Time the data and the attack start", dataStart);
+  cmd.AddValue ("csv", "CSV output file, empty for none", csvFile);
+  cmd.AddValue ("json", "JSON output file, empty for none", jsonFile);
+  cmd.Parse (argc, argv);
+
+  Config::SetDefault ("ns3::WifiRemoteStationManager::NonUnicastMode", StringValue ("DsssRate11Mbps"));
+  Config::SetDefault ("ns3::dsr::DsrAdversary::StartTime", TimeValue (Seconds (dataStart)));
+
+  std::ofstream csv;
+  if (!csvFile.empty ())
+    {
+      csv.open (csvFile.c_str ());
+      csv << "nodes,speed,attack_type,run,sent,received,delivery_ratio,cpu_s,cpu_per_simulated_s,extra_control_bytes,";
+      DsrDetectionStats::WriteCsvHeaderFields (csv);
+      csv << std::endl;
+    }
+  std::ofstream json;
+  if (!jsonFile.empty ())
+    {
+      json.open (jsonFile.c_str ());
+      json << "[";
+    }
+  bool firstRow = true;
+
+  std::vector<double> nodeCounts = ParseList (nodes);
+  std::vector<double> nodeSpeeds = ParseList (speeds);
+  std::vector<double> attackerCounts = ParseList (attackers);
+  // The attack free run comes first, it is the baseline of the extra control bytes
+  attackerCounts.insert (attackerCounts.begin (), 0);
+
+  std::cout << "nodes\tspeed\tattackers\trun\tprecision\trecall\tmean ttd(s)\textra control bytes\tcpu per simulated second" << std::endl;
+  for (uint32_t n = 0; n < nodeCounts.size (); ++n)
+    {
+      uint32_t nWifis = uint32_t (nodeCounts[n]);
+      NS_ABORT_MSG_IF (nWifis <= 2 * nSinks, "Need more than " << 2 * nSinks << " nodes");
+      for (uint32_t s = 0; s < nodeSpeeds.size (); ++s)
+        {
+          for (uint32_t run = 1; run <= runs; ++run)
+            {
+              uint64_t baseline = 0;
+              for (uint32_t a = 0; a < attackerCounts.size (); ++a)
+                {
+                  uint32_t count = std::min (uint32_t (attackerCounts[a]), nWifis - 2 * nSinks);
+                  if (a > 0 && count == 0)
+                    {
+                      // The baseline already covers it
+                      continue;
+                    }
+                  Config::SetDefault ("ns3::dsr::DsrAdversary::AttackerNodes",
+                                      StringValue (PickAttackers (nWifis, nSinks, count)));
+                  Config::SetDefault ("ns3::dsr::DsrAdversary::AttackType",
+                                      EnumValue (count ? attackType : uint32_t (dsr::DsrAdversary::NONE)));
+                  SeedManager::SetSeed (10);
+                  SeedManager::SetRun (run);
+
+                  DsrDetectionStats stats;
+                  stats.SetAttackStart (Seconds (dataStart));
+                  double cpu = RunOnce (nWifis, nSinks, nodeSpeeds[s], totalTime, dataStart, stats);
+                  if (count == 0)
+                    {
+                      baseline = stats.GetControlBytes ();
+                    }
+                  int64_t extra = int64_t (stats.GetControlBytes ()) - int64_t (baseline);
+                  double ratio = g_txPackets ? double (g_rxPackets) / g_txPackets : 0;
+
+                  std::cout << nWifis << "\t" << nodeSpeeds[s] << "\t" << count << "\t" << run << "\t"
+                            << stats.GetPrecision () << "\t" << stats.GetRecall () << "\t"
+                            << stats.GetMeanTimeToDetect ().GetSeconds () << "\t" << extra << "\t"
+                            << cpu / totalTime << std::endl;
+                  if (csv.is_open ())
+                    {
+                      csv << nWifis << "," << nodeSpeeds[s] << "," << (count ? attackType : 0) << "," << run << ","
+                          << g_txPackets << "," << g_rxPackets << "," << ratio << "," << cpu << ","
+                          << cpu / totalTime << "," << extra << ",";
+                      stats.WriteCsvFields (csv);
+                      csv << std::endl;
+                    }
+                  if (json.is_open ())
+                    {
+                      json << (firstRow ? "\n" : ",\n")
+                           << "  {\"nodes\": " << nWifis << ", \"speed\": " << nodeSpeeds[s]
+                           << ", \"attack_type\": " << (count ? attackType : 0) << ", \"run\": " << run
+                           << ", \"sent\": " << g_txPackets << ", \"received\": " << g_rxPackets
+                           << ", \"delivery_ratio\": " << ratio << ", \"cpu_s\": " << cpu
+                           << ", \"cpu_per_simulated_s\": " << cpu / totalTime
+                           << ", \"extra_control_bytes\": " << extra << ", ";
+                      stats.WriteJsonFields (json);
+                      json << "}";
+                    }
+                  firstRow = false;
+                }
+            }
+        }
+    }
+  if (json.is_open ())
+    {
+      json << "\n]" << std::endl;
+    }
+  return 0;
+}
@@ -0,0 +1,127 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2026 The SDSR contributors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: The SDSR contributors, see the git history
+ */
+
+/*
+ * Micro benchmark of the node id, ip and mac address lookups done by DSR on every packet.
+ * It builds nWifis nodes with the address plan of the simisso scenario (10.1.0.0/16 on
+ * interface 1) and times the former NodeList scan against DsrNodeDirectory.
+ *
+ * ./waf --run "dsr-directory-bench --nWifis=500 --lookups=200000"
+ */
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/dsr-module.h"
+#include <ctime>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("DsrDirectoryBench");
+
+/// The lookup DsrRouting::GetIDfromIP used to do, kept as the reference
+static uint32_t
+ScanIdFromIp (Ipv4Address address)
+{
+  uint32_t nNodes = NodeList::GetNNodes ();
+  for (uint32_t i = 0; i < nNodes; ++i)
+    {
+      Ptr<Ipv4> ipv4 = NodeList::GetNode (i)->GetObject<Ipv4> ();
+      if (ipv4->GetAddress (1, 0).GetLocal () == address)
+        {
+          return i;
+        }
+    }
+  return dsr::DsrNodeDirectory::NOT_FOUND;
+}
+
+/// The lookup DsrRouting::GetIPfromMAC used to do, kept as the reference
+static Ipv4Address
+ScanIpFromMac (Mac48Address address)
+{
+  uint32_t nNodes = NodeList::GetNNodes ();
+  for (uint32_t i = 0; i < nNodes; ++i)
+    {
+      Ptr<Ipv4> ipv4 = NodeList::GetNode (i)->GetObject<Ipv4> ();
+      if (ipv4->GetNetDevice (1)->GetAddress () == address)
+        {
+          return ipv4->GetAddress (1, 0).GetLocal ();
+        }
+    }
+  return Ipv4Address ("0.0.0.0");
+}
+
+int
+main (int argc, char *argv[])
+{
+  uint32_t nWifis = 500;
+  uint32_t lookups = 200000;
+
+  CommandLine cmd;
+  cmd.AddValue ("nWifis", "Number of nodes", nWifis);
+  cmd.AddValue ("lookups", "Number of lookups of each kind", lookups);
+  cmd.Parse (argc, argv);
+
+  NodeContainer nodes;
+  nodes.Create (nWifis);
+  InternetStackHelper internet;
+  internet.Install (nodes);
+  SimpleNetDeviceHelper simple;
+  NetDeviceContainer devices = simple.Install (nodes);
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("10.1.0.0", "255.255.0.0");
+  Ipv4InterfaceContainer interfaces = ipv4.Assign (devices);
+
+  Ptr<UniformRandomVariable> pick = CreateObject<UniformRandomVariable> ();
+  std::vector<uint32_t> order (lookups);
+  for (uint32_t i = 0; i < lookups; ++i)
+    {
+      order[i] = pick->GetInteger (0, nWifis - 1);
+    }
+
+  Ptr<dsr::DsrNodeDirectory> directory = dsr::DsrNodeDirectory::Get ();
+  uint64_t check = 0;
+
+  std::clock_t start = std::clock ();
+  for (uint32_t i = 0; i < lookups; ++i)
+    {
+      check += ScanIdFromIp (interfaces.GetAddress (order[i]));
+      check += ScanIpFromMac (Mac48Address::ConvertFrom (devices.Get (order[i])->GetAddress ())).Get ();
+    }
+  double scan = double (std::clock () - start) / CLOCKS_PER_SEC;
+
+  start = std::clock ();
+  for (uint32_t i = 0; i < lookups; ++i)
+    {
+      check -= directory->GetIdFromIp (interfaces.GetAddress (order[i]));
+      check -= directory->GetIpFromMac (Mac48Address::ConvertFrom (devices.Get (order[i])->GetAddress ())).Get ();
+    }
+  double indexed = double (std::clock () - start) / CLOCKS_PER_SEC;
+
+  NS_ABORT_MSG_IF (check != 0, "The directory and the NodeList scan disagree");
+  std::cout << "nodes\tlookups\tscan(ns/lookup)\tdirectory(ns/lookup)\trebuilds" << std::endl;
+  std::cout << nWifis << "\t" << 2 * lookups << "\t"
+            << scan * 1e9 / (2 * lookups) << "\t"
+            << indexed * 1e9 / (2 * lookups) << "\t"
+            << directory->GetRebuildCount () << std::endl;
+
+  Simulator::Destroy ();
+  return 0;
+}
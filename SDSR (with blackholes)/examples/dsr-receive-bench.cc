@@ -0,0 +1,154 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2026 The SDSR contributors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: The SDSR contributors, see the git history
+ */
+
+/*
+ * Micro benchmark of DsrRouting::Receive on the data path.  It delivers nPackets
+ * synthetic source routed data packets to the final destination of a two node
+ * route and reports the heap allocations and the cpu time spent per packet.
+ * Allocations are counted by replacing the global operator new in this program.
+ *
+ * ./waf --run "dsr-receive-bench --nPackets=100000 --payload=512"
+ */
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/dsr-module.h"
+#include <cstdlib>
+#include <ctime>
+#include <new>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("DsrReceiveBench");
+
+static uint64_t g_allocations = 0;    ///< Number of calls to the global operator new
+
+void *
+operator new (std::size_t size)
+{
+  ++g_allocations;
+  void *p = std::malloc (size == 0 ? 1 : size);
+  if (p == 0)
+    {
+      throw std::bad_alloc ();
+    }
+  return p;
+}
+
+void
+operator delete (void *p) throw ()
+{
+  std::free (p);
+}
+
+/// Build a data packet as DsrRouting::SendPacket would for the route
+static Ptr<Packet>
+MakeDataPacket (std::vector<Ipv4Address> const &route, uint32_t payload)
+{
+  Ptr<Packet> packet = Create<Packet> (payload);
+  UdpHeader udpHeader;
+  udpHeader.SetSourcePort (9);
+  udpHeader.SetDestinationPort (9);
+  packet->AddHeader (udpHeader);
+
+  dsr::DsrOptionSRHeader sourceRoute;
+  sourceRoute.SetNodesAddress (route);
+  sourceRoute.SetSegmentsLeft (route.size () - 2);
+  sourceRoute.SetSalvage (0);
+  sourceRoute.SetAckFlag (1);
+  sourceRoute.SetTime (Simulator::Now ().GetMilliSeconds ());
+
+  dsr::DsrRoutingHeader dsrRoutingHeader;
+  dsrRoutingHeader.SetNextHeader (UdpL4Protocol::PROT_NUMBER);
+  dsrRoutingHeader.SetMessageType (2);
+  dsrRoutingHeader.SetSourceId (0);
+  dsrRoutingHeader.SetDestId (route.size () - 1);
+  dsrRoutingHeader.SetPayloadLength (uint16_t (sourceRoute.GetLength ()) + 2);
+  dsrRoutingHeader.AddDsrOption (sourceRoute);
+  packet->AddHeader (dsrRoutingHeader);
+  return packet;
+}
+
+int
+main (int argc, char *argv[])
+{
+  uint32_t nPackets = 100000;
+  uint32_t payload = 512;
+
+  CommandLine cmd;
+  cmd.AddValue ("nPackets", "Number of packets handed to Receive", nPackets);
+  cmd.AddValue ("payload", "Application payload in bytes", payload);
+  cmd.Parse (argc, argv);
+
+  NodeContainer nodes;
+  nodes.Create (2);
+  SimpleNetDeviceHelper simple;
+  NetDeviceContainer devices = simple.Install (nodes);
+  InternetStackHelper internet;
+  DsrMainHelper dsrMain;
+  DsrHelper dsrHelper;
+  internet.Install (nodes);
+  dsrMain.Install (dsrHelper, nodes);
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("10.1.0.0", "255.255.0.0");
+  Ipv4InterfaceContainer interfaces = ipv4.Assign (devices);
+
+  // Let DsrRouting::Start pick up the addresses
+  Simulator::Stop (Seconds (0.1));
+  Simulator::Run ();
+
+  Ptr<Node> destination = nodes.Get (1);
+  Ptr<dsr::DsrRouting> dsr = destination->GetObject<dsr::DsrRouting> ();
+  Ptr<Ipv4Interface> incomingInterface = destination->GetObject<Ipv4L3Protocol> ()->GetInterface (1);
+
+  std::vector<Ipv4Address> route;
+  route.push_back (interfaces.GetAddress (0));
+  route.push_back (interfaces.GetAddress (1));
+
+  Ipv4Header ip;
+  ip.SetSource (interfaces.GetAddress (0));
+  ip.SetDestination (interfaces.GetAddress (1));
+  ip.SetProtocol (dsr::DsrRouting::PROT_NUMBER);
+
+  std::vector<Ptr<Packet> > packets (nPackets);
+  for (uint32_t i = 0; i < nPackets; ++i)
+    {
+      packets[i] = MakeDataPacket (route, payload);
+    }
+
+  uint64_t allocations = g_allocations;
+  std::clock_t start = std::clock ();
+  for (uint32_t i = 0; i < nPackets; ++i)
+    {
+      dsr->Receive (packets[i], ip, incomingInterface);
+    }
+  double elapsed = double (std::clock () - start) / CLOCKS_PER_SEC;
+  allocations = g_allocations - allocations;
+
+  std::cout << "packets\tpayload\tallocations/packet\tns/packet" << std::endl;
+  std::cout << nPackets << "\t" << payload << "\t"
+            << double (allocations) / nPackets << "\t"
+            << elapsed * 1e9 / nPackets << std::endl;
+
+  packets.clear ();
+  Simulator::Destroy ();
+  return 0;
+}
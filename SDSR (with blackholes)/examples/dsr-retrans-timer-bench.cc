@@ -0,0 +1,211 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2026 The SDSR contributors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: The SDSR contributors, see the git history
+ */
+
+/*
+ * Event count benchmark of the DSR retransmission timers.  nFlows flows send a packet
+ * every interval and arm a link acknowledgment timer for it, the acknowledgment comes
+ * back within the timeout and cancels the timer unless it is lost (lossRate), in which
+ * case the timer fires.  The same workload runs on a map of ns-3 Timers, as DsrRouting
+ * used to keep them, and on DsrRetransTimer.  For both runs it reports the simulator
+ * events scheduled for the timers, the events the simulator executed (timers and
+ * workload) and the cpu time.
+ *
+ * ./waf --run "dsr-retrans-timer-bench --nFlows=200 --nPackets=500 --lossRate=0.05"
+ */
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/dsr-module.h"
+#include <ctime>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("DsrRetransTimerBench");
+
+/// The flows of the workload and the two timer implementations
+class RetransTimerBench
+{
+public:
+  RetransTimerBench (bool shared, uint32_t nFlows, uint32_t nPackets, double lossRate);
+  /// \return the number of timers that fired
+  uint32_t Run ();
+  /// \return the number of simulator events scheduled for the timers
+  uint64_t GetScheduledEvents () const;
+
+private:
+  dsr::LinkKey GetKey (uint32_t flow) const;
+  void Send (uint32_t flow, uint32_t left);
+  void Ack (uint32_t flow);
+  void MapExpire (uint32_t flow);
+  void SharedExpire (dsr::DsrMaintainBuffEntry & mb, uint8_t protocol);
+
+  bool m_shared;                                                        ///< Whether to use DsrRetransTimer
+  uint32_t m_nFlows;                                                    ///< Number of flows
+  uint32_t m_nPackets;                                                  ///< Packets per flow
+  double m_lossRate;                                                    ///< Share of lost acknowledgments
+  uint32_t m_expired;                                                   ///< Number of timers that fired
+  uint64_t m_mapEvents;                                                 ///< Number of Timer::Schedule calls
+  Time m_interval;                                                      ///< Time between two packets of a flow
+  Time m_timeout;                                                       ///< The link acknowledgment timeout
+  Ptr<UniformRandomVariable> m_random;                                  ///< Jitter and losses
+  std::map<dsr::LinkKey, Timer> m_mapTimer;                             ///< The timers as DsrRouting used to keep them
+  dsr::DsrRetransTimer<dsr::LinkKey, dsr::LinkKeyHash> m_sharedTimer;   ///< The shared timers
+};
+
+RetransTimerBench::RetransTimerBench (bool shared, uint32_t nFlows, uint32_t nPackets, double lossRate)
+  : m_shared (shared),
+    m_nFlows (nFlows),
+    m_nPackets (nPackets),
+    m_lossRate (lossRate),
+    m_expired (0),
+    m_mapEvents (0),
+    m_interval (MilliSeconds (200)),
+    m_timeout (MilliSeconds (100))
+{
+  m_random = CreateObject<UniformRandomVariable> ();
+  m_random->SetStream (1);
+  m_sharedTimer.SetFunction (MakeCallback (&RetransTimerBench::SharedExpire, this));
+}
+
+dsr::LinkKey
+RetransTimerBench::GetKey (uint32_t flow) const
+{
+  dsr::LinkKey key;
+  key.m_source = Ipv4Address (0x0a010000 + flow);
+  key.m_destination = Ipv4Address (0x0a020000 + flow);
+  key.m_ourAdd = key.m_source;
+  key.m_nextHop = Ipv4Address (0x0a030000 + flow % 8);
+  return key;
+}
+
+uint32_t
+RetransTimerBench::Run ()
+{
+  for (uint32_t flow = 0; flow < m_nFlows; ++flow)
+    {
+      Simulator::Schedule (MicroSeconds (m_random->GetInteger (0, 200000)),
+                           &RetransTimerBench::Send, this, flow, m_nPackets);
+    }
+  Simulator::Run ();
+  return m_expired;
+}
+
+uint64_t
+RetransTimerBench::GetScheduledEvents () const
+{
+  return m_shared ? m_sharedTimer.GetScheduledEvents () : m_mapEvents;
+}
+
+void
+RetransTimerBench::Send (uint32_t flow, uint32_t left)
+{
+  dsr::LinkKey key = GetKey (flow);
+  if (m_shared)
+    {
+      dsr::DsrMaintainBuffEntry mb (Create<Packet> (), key.m_ourAdd, key.m_nextHop, key.m_source,
+                                    key.m_destination, 0, 1, Seconds (10));
+      m_sharedTimer.Schedule (key, m_timeout, mb, 17);
+    }
+  else
+    {
+      if (m_mapTimer.find (key) == m_mapTimer.end ())
+        {
+          Timer timer (Timer::CANCEL_ON_DESTROY);
+          m_mapTimer[key] = timer;
+        }
+      m_mapTimer[key].SetFunction (&RetransTimerBench::MapExpire, this);
+      m_mapTimer[key].Remove ();
+      m_mapTimer[key].SetArguments (flow);
+      m_mapTimer[key].Schedule (m_timeout);
+      ++m_mapEvents;
+    }
+  if (m_random->GetValue () >= m_lossRate)
+    {
+      Simulator::Schedule (MicroSeconds (m_random->GetInteger (1000, 90000)), &RetransTimerBench::Ack, this, flow);
+    }
+  if (left > 1)
+    {
+      Simulator::Schedule (m_interval, &RetransTimerBench::Send, this, flow, left - 1);
+    }
+}
+
+void
+RetransTimerBench::Ack (uint32_t flow)
+{
+  dsr::LinkKey key = GetKey (flow);
+  if (m_shared)
+    {
+      m_sharedTimer.Cancel (key);
+    }
+  else if (m_mapTimer.find (key) != m_mapTimer.end ())
+    {
+      m_mapTimer[key].Cancel ();
+      m_mapTimer[key].Remove ();
+      m_mapTimer.erase (key);
+    }
+}
+
+void
+RetransTimerBench::MapExpire (uint32_t flow)
+{
+  m_mapTimer.erase (GetKey (flow));
+  ++m_expired;
+}
+
+void
+RetransTimerBench::SharedExpire (dsr::DsrMaintainBuffEntry & mb, uint8_t protocol)
+{
+  ++m_expired;
+}
+
+int
+main (int argc, char *argv[])
+{
+  uint32_t nFlows = 200;
+  uint32_t nPackets = 500;
+  double lossRate = 0.05;
+
+  CommandLine cmd;
+  cmd.AddValue ("nFlows", "Number of flows arming a timer per packet", nFlows);
+  cmd.AddValue ("nPackets", "Number of packets per flow", nPackets);
+  cmd.AddValue ("lossRate", "Share of acknowledgments that never arrive", lossRate);
+  cmd.Parse (argc, argv);
+
+  std::cout << "timers\tscheduled\texecuted\texpired\tcpu seconds" << std::endl;
+  for (uint32_t shared = 0; shared < 2; ++shared)
+    {
+      std::clock_t start = std::clock ();
+      uint64_t scheduled;
+      uint64_t executed;
+      uint32_t expired;
+      {
+        RetransTimerBench bench (shared == 1, nFlows, nPackets, lossRate);
+        expired = bench.Run ();
+        scheduled = bench.GetScheduledEvents ();
+        executed = Simulator::GetEventCount ();
+      }
+      Simulator::Destroy ();
+      double elapsed = double (std::clock () - start) / CLOCKS_PER_SEC;
+      std::cout << (shared ? "shared" : "map") << "\t" << scheduled << "\t" << executed << "\t"
+                << expired << "\t" << elapsed << std::endl;
+    }
+  return 0;
+}
@@ -0,0 +1,199 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2026 The SDSR contributors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: The SDSR contributors, see the git history
+ */
+
+/*
+ * Micro benchmark of the route reply check a source runs in a discovery storm.  It
+ * hands nReplies route replies of nHops hops, nLoops of them with a loop through an
+ * earlier relay, to the check DsrRouting::Receive and ProcessRrep used to run (peek the
+ * header, cut the loops on a copy of the route, look the route up in the blacklist, then
+ * remove the header and cut the loops again) and to DsrRrepVerifier.  For both it
+ * reports the heap allocations and the cpu time per reply.  Allocations are counted by
+ * replacing the global operator new in this program.
+ *
+ * ./waf --run "dsr-rrep-bench --nReplies=100000 --nHops=8 --nLoops=10000 --nSuspects=32"
+ */
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/dsr-module.h"
+#include <algorithm>
+#include <cstdlib>
+#include <ctime>
+#include <new>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("DsrRrepBench");
+
+static uint64_t g_allocations = 0;    ///< Number of calls to the global operator new
+
+void *
+operator new (std::size_t size)
+{
+  ++g_allocations;
+  void *p = std::malloc (size == 0 ? 1 : size);
+  if (p == 0)
+    {
+      throw std::bad_alloc ();
+    }
+  return p;
+}
+
+void
+operator delete (void *p) throw ()
+{
+  std::free (p);
+}
+
+/// The loop cut DsrRouting::RemoveDuplicates used to do, a linear search for every address
+static void
+LegacyRemoveDuplicates (std::vector<Ipv4Address>& vec)
+{
+  std::vector<Ipv4Address> vec2 (vec);
+  vec.clear ();
+  for (std::vector<Ipv4Address>::const_iterator i = vec2.begin (); i != vec2.end (); ++i)
+    {
+      std::vector<Ipv4Address>::iterator j = std::find (vec.begin (), vec.end (), *i);
+      if (j == vec.end ())
+        {
+          vec.push_back (*i);
+        }
+      else
+        {
+          vec.erase (j + 1, vec.end ());
+        }
+    }
+}
+
+/// The check of Receive and ProcessRrep before the verifier, true if the reply is accepted
+static bool
+LegacyCheck (Ptr<const Packet> packet, Ipv4Address source, dsr::DsrBlackList & blackList)
+{
+  uint8_t buf[2];
+  packet->CopyData (buf, sizeof(buf));
+  uint8_t numberAddress = (buf[1] - 2) / 4;
+  dsr::DsrOptionRrepHeader rrep;
+  rrep.SetNumberAddress (numberAddress);
+  packet->PeekHeader (rrep);
+  std::vector<Ipv4Address> nodeList = rrep.GetNodesAddress ();
+  if (nodeList.front () != source)
+    {
+      return true;
+    }
+  LegacyRemoveDuplicates (nodeList);
+  if (blackList.ContainsAny (nodeList))
+    {
+      return false;
+    }
+
+  // ProcessRrep
+  Ptr<Packet> p = packet->Copy ();
+  dsr::DsrOptionRrepHeader removed;
+  removed.SetNumberAddress (numberAddress);
+  p->RemoveHeader (removed);
+  std::vector<Ipv4Address> route = removed.GetNodesAddress ();
+  LegacyRemoveDuplicates (route);
+  return !route.empty ();
+}
+
+/// The check with the verifier, true if the reply is accepted
+static bool
+VerifierCheck (dsr::DsrRrepVerifier & verifier, Ptr<const Packet> packet, Ipv4Address source, dsr::DsrBlackList & blackList)
+{
+  if (verifier.Verify (packet, source, &blackList) == 0)
+    {
+      return false;
+    }
+  return !verifier.IsForUs () || !verifier.IsBlackListed ();
+}
+
+int
+main (int argc, char *argv[])
+{
+  uint32_t nReplies = 100000;
+  uint32_t nHops = 8;
+  uint32_t nLoops = 10000;
+  uint32_t nSuspects = 32;
+
+  CommandLine cmd;
+  cmd.AddValue ("nReplies", "Number of route replies checked", nReplies);
+  cmd.AddValue ("nHops", "Hops of every route", nHops);
+  cmd.AddValue ("nLoops", "Number of replies whose route has a loop", nLoops);
+  cmd.AddValue ("nSuspects", "Number of blacklisted nodes", nSuspects);
+  cmd.Parse (argc, argv);
+
+  Ptr<UniformRandomVariable> random = CreateObject<UniformRandomVariable> ();
+  random->SetStream (1);
+  Ipv4Address source ("10.1.0.1");
+  const uint32_t nNodes = 1000;
+
+  dsr::DsrBlackList blackList;
+  blackList.SetTimeout (Seconds (0));
+  for (uint32_t i = 0; i < nSuspects; ++i)
+    {
+      blackList.Add (Ipv4Address (0x0a010002 + random->GetInteger (0, nNodes - 1)));
+    }
+
+  std::vector<Ptr<Packet> > packets (nReplies);
+  for (uint32_t i = 0; i < nReplies; ++i)
+    {
+      std::vector<Ipv4Address> route;
+      route.push_back (source);
+      for (uint32_t hop = 0; hop < nHops; ++hop)
+        {
+          route.push_back (Ipv4Address (0x0a010002 + random->GetInteger (0, nNodes - 1)));
+        }
+      if (i < nLoops && nHops > 2)
+        {
+          // Back through an earlier relay before the destination
+          route.insert (route.end () - 1, route[1 + random->GetInteger (0, nHops - 2)]);
+        }
+      dsr::DsrOptionRrepHeader rrep;
+      rrep.SetNodesAddress (route);
+      packets[i] = Create<Packet> ();
+      packets[i]->AddHeader (rrep);
+    }
+
+  std::cout << "check\treplies\thops\tloops\taccepted\tallocations/reply\tns/reply" << std::endl;
+  for (uint32_t run = 0; run < 2; ++run)
+    {
+      dsr::DsrRrepVerifier verifier;
+      uint32_t accepted = 0;
+      uint64_t allocations = g_allocations;
+      std::clock_t start = std::clock ();
+      for (uint32_t i = 0; i < nReplies; ++i)
+        {
+          bool ok = run == 0 ? LegacyCheck (packets[i], source, blackList)
+            : VerifierCheck (verifier, packets[i], source, blackList);
+          accepted += ok ? 1 : 0;
+        }
+      double elapsed = double (std::clock () - start) / CLOCKS_PER_SEC;
+      allocations = g_allocations - allocations;
+      std::cout << (run == 0 ? "legacy" : "verifier") << "\t" << nReplies << "\t" << nHops << "\t"
+                << nLoops << "\t" << accepted << "\t"
+                << double (allocations) / nReplies << "\t"
+                << elapsed * 1e9 / nReplies << std::endl;
+    }
+
+  packets.clear ();
+  Simulator::Destroy ();
+  return 0;
+}
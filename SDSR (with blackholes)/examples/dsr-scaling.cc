@@ -0,0 +1,157 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2026 The SDSR contributors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: The SDSR contributors, see the git history
+ */
+
+/*
+ * Scaling sweep of DSR past 256 nodes. Each run places nWifis nodes on a strip
+ * whose length grows with the node count, so the density of the dsr example is
+ * kept, and drives nSinks CBR flows across it. The address plan is a /16 so
+ * that more than 254 nodes can be numbered.
+ *
+ * ./waf --run "dsr-scaling --sizes=128,256,512,1024,2048 --wideNodeIds=0"
+ */
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/applications-module.h"
+#include "ns3/mobility-module.h"
+#include "ns3/wifi-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/dsr-module.h"
+#include <sstream>
+#include <ctime>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("DsrScaling");
+
+static uint32_t g_rxPackets = 0;
+
+static void
+RxPacket (Ptr<const Packet> packet, const Address &from)
+{
+  ++g_rxPackets;
+}
+
+/// Run one sweep point and return the CPU time in seconds
+static double
+RunOnce (uint32_t nWifis, uint32_t nSinks, double totalTime, double txpDistance, uint32_t &txPackets)
+{
+  NodeContainer adhocNodes;
+  adhocNodes.Create (nWifis);
+
+  WifiHelper wifi;
+  wifi.SetStandard (WIFI_PHY_STANDARD_80211b);
+  YansWifiPhyHelper wifiPhy = YansWifiPhyHelper::Default ();
+  YansWifiChannelHelper wifiChannel;
+  wifiChannel.SetPropagationDelay ("ns3::ConstantSpeedPropagationDelayModel");
+  wifiChannel.AddPropagationLoss ("ns3::RangePropagationLossModel", "MaxRange", DoubleValue (txpDistance));
+  wifiPhy.SetChannel (wifiChannel.Create ());
+  WifiMacHelper wifiMac;
+  wifi.SetRemoteStationManager ("ns3::ConstantRateWifiManager", "DataMode", StringValue ("DsssRate11Mbps"),
+                                "ControlMode", StringValue ("DsssRate11Mbps"));
+  wifiMac.SetType ("ns3::AdhocWifiMac");
+  NetDeviceContainer allDevices = wifi.Install (wifiPhy, wifiMac, adhocNodes);
+
+  // The dsr example puts 50 nodes on 300 x 1500 m, keep that density
+  double length = 1500.0 * nWifis / 50;
+  std::ostringstream y;
+  y << "ns3::UniformRandomVariable[Min=0.0|Max=" << length << "]";
+  MobilityHelper adhocMobility;
+  adhocMobility.SetPositionAllocator ("ns3::RandomRectanglePositionAllocator",
+                                      "X", StringValue ("ns3::UniformRandomVariable[Min=0.0|Max=300.0]"),
+                                      "Y", StringValue (y.str ()));
+  adhocMobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+  adhocMobility.Install (adhocNodes);
+
+  InternetStackHelper internet;
+  DsrMainHelper dsrMain;
+  DsrHelper dsr;
+  internet.Install (adhocNodes);
+  dsrMain.Install (dsr, adhocNodes);
+
+  Ipv4AddressHelper address;
+  address.SetBase ("10.1.0.0", "255.255.0.0");
+  Ipv4InterfaceContainer allInterfaces = address.Assign (allDevices);
+
+  uint16_t port = 9;
+  for (uint32_t i = 0; i < nSinks; ++i)
+    {
+      PacketSinkHelper sink ("ns3::UdpSocketFactory", InetSocketAddress (Ipv4Address::GetAny (), port));
+      ApplicationContainer appsSink = sink.Install (adhocNodes.Get (i));
+      appsSink.Get (0)->TraceConnectWithoutContext ("Rx", MakeCallback (&RxPacket));
+
+      OnOffHelper onoff ("ns3::UdpSocketFactory", Address (InetSocketAddress (allInterfaces.GetAddress (i), port)));
+      onoff.SetAttribute ("OnTime", StringValue ("ns3::ConstantRandomVariable[Constant=1.0]"));
+      onoff.SetAttribute ("OffTime", StringValue ("ns3::ConstantRandomVariable[Constant=0.0]"));
+      onoff.SetAttribute ("PacketSize", UintegerValue (64));
+      onoff.SetAttribute ("DataRate", DataRateValue (DataRate ("0.512kbps")));
+      // Pair each sink with a source at the far end of the node list
+      ApplicationContainer apps = onoff.Install (adhocNodes.Get (nWifis - 1 - i));
+      apps.Start (Seconds (1.0 + 0.1 * i));
+      apps.Stop (Seconds (totalTime - 1.0));
+    }
+
+  g_rxPackets = 0;
+  Simulator::Stop (Seconds (totalTime));
+  std::clock_t start = std::clock ();
+  Simulator::Run ();
+  double cpu = double (std::clock () - start) / CLOCKS_PER_SEC;
+  // 0.512 kbps of 64 bytes packets is one packet per second and flow
+  txPackets = nSinks * uint32_t (totalTime - 2.0);
+  Simulator::Destroy ();
+  return cpu;
+}
+
+int
+main (int argc, char *argv[])
+{
+  std::string sizes = "128,256,512,1024";
+  uint32_t nSinks = 10;
+  double totalTime = 30.0;
+  double txpDistance = 250.0;
+  bool wideNodeIds = false;
+
+  CommandLine cmd;
+  cmd.AddValue ("sizes", "Comma separated node counts to sweep", sizes);
+  cmd.AddValue ("nSinks", "Number of CBR flows", nSinks);
+  cmd.AddValue ("totalTime", "Simulated seconds per run", totalTime);
+  cmd.AddValue ("txpDistance", "Transmit range", txpDistance);
+  cmd.AddValue ("wideNodeIds", "Use 32 bit node ids in the DSR header", wideNodeIds);
+  cmd.Parse (argc, argv);
+
+  Config::SetDefault ("ns3::dsr::DsrRouting::WideNodeIds", BooleanValue (wideNodeIds));
+  Config::SetDefault ("ns3::WifiRemoteStationManager::NonUnicastMode", StringValue ("DsssRate11Mbps"));
+
+  std::cout << "nodes\tsent\treceived\tcpu(s)\tcpu per simulated second" << std::endl;
+  std::istringstream list (sizes);
+  std::string size;
+  while (std::getline (list, size, ','))
+    {
+      uint32_t nWifis = std::atoi (size.c_str ());
+      NS_ABORT_MSG_IF (nWifis < 2 * nSinks, "Need at least " << 2 * nSinks << " nodes");
+      SeedManager::SetSeed (10);
+      SeedManager::SetRun (1);
+      uint32_t txPackets = 0;
+      double cpu = RunOnce (nWifis, nSinks, totalTime, txpDistance, txPackets);
+      std::cout << nWifis << "\t" << txPackets << "\t" << g_rxPackets << "\t"
+                << cpu << "\t" << cpu / totalTime << std::endl;
+    }
+  return 0;
+}
@@ -0,0 +1,324 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2026 The SDSR contributors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: The SDSR contributors, see the git history
+ */
+
+#include "dsr-detection-stats.h"
+#include <cmath>
+#include <cstdlib>
+#include <sstream>
+#include <limits>
+#include "ns3/dsr-routing.h"
+#include "ns3/dsr-options.h"
+#include "ns3/dsr-adversary.h"
+#include "ns3/dsr-node-directory.h"
+#include "ns3/simulator.h"
+#include "ns3/callback.h"
+#include "ns3/log.h"
+#include "ns3/node.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("DsrDetectionStats");
+
+DsrDetectionStats::DsrDetectionStats ()
+  : m_attackStart (Seconds (0)),
+    m_blackListEvents (0),
+    m_controlPackets (0),
+    m_controlBytes (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+DsrDetectionStats::~DsrDetectionStats ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+DsrDetectionStats::Install (NodeContainer nodes)
+{
+  NS_LOG_FUNCTION (this);
+  for (NodeContainer::Iterator i = nodes.Begin (); i != nodes.End (); ++i)
+    {
+      Ptr<dsr::DsrRouting> dsr = (*i)->GetObject<dsr::DsrRouting> ();
+      NS_ASSERT_MSG (dsr, "Install DSR on node " << (*i)->GetId () << " first");
+      std::ostringstream context;
+      context << (*i)->GetId ();
+      dsr->TraceConnect ("ControlTx", context.str (), MakeCallback (&DsrDetectionStats::ControlTx, this));
+      dsr->TraceConnect ("BlackList", context.str (), MakeCallback (&DsrDetectionStats::BlackList, this));
+      m_nodes.Add (*i);
+    }
+}
+
+void
+DsrDetectionStats::SetAttackStart (Time start)
+{
+  m_attackStart = start;
+}
+
+void
+DsrDetectionStats::Finish ()
+{
+  NS_LOG_FUNCTION (this);
+  for (NodeContainer::Iterator i = m_nodes.Begin (); i != m_nodes.End (); ++i)
+    {
+      Ptr<dsr::DsrAdversary> adversary = (*i)->GetObject<dsr::DsrRouting> ()->GetAdversary ();
+      // Every node reads the same attacker set from the attribute defaults
+      if (adversary && adversary->IsConfigured () && adversary->IsAttacker ((*i)->GetId ()))
+        {
+          AddAttacker ((*i)->GetId ());
+        }
+    }
+}
+
+void
+DsrDetectionStats::Reset ()
+{
+  NS_LOG_FUNCTION (this);
+  m_nodes = NodeContainer ();
+  m_attackers.clear ();
+  m_detected.clear ();
+  m_blackListEvents = 0;
+  m_controlPackets = 0;
+  m_controlBytes = 0;
+  m_controlBytesByType.clear ();
+}
+
+void
+DsrDetectionStats::AddAttacker (uint32_t nodeId)
+{
+  m_attackers.insert (nodeId);
+}
+
+void
+DsrDetectionStats::NotifyControlTx (uint8_t optionType, uint32_t bytes)
+{
+  ++m_controlPackets;
+  m_controlBytes += bytes;
+  m_controlBytesByType[optionType] += bytes;
+}
+
+void
+DsrDetectionStats::NotifyBlackListed (uint32_t detector, uint32_t suspect, Time now)
+{
+  NS_LOG_FUNCTION (this << detector << suspect << now);
+  ++m_blackListEvents;
+  // insert keeps the first detection of the suspect
+  m_detected.insert (std::make_pair (suspect, now));
+}
+
+void
+DsrDetectionStats::ControlTx (std::string context, Ptr<const Packet> packet, uint8_t optionType)
+{
+  NotifyControlTx (optionType, packet->GetSize ());
+}
+
+void
+DsrDetectionStats::BlackList (std::string context, Ipv4Address address, bool added)
+{
+  if (!added)
+    {
+      return;
+    }
+  uint32_t suspect = dsr::DsrNodeDirectory::Get ()->GetIdFromIp (address);
+  if (suspect == dsr::DsrNodeDirectory::NOT_FOUND)
+    {
+      NS_LOG_DEBUG ("No node holds the blacklisted address " << address);
+      return;
+    }
+  NotifyBlackListed (std::atoi (context.c_str ()), suspect, Simulator::Now ());
+}
+
+uint32_t
+DsrDetectionStats::GetAttackerCount () const
+{
+  return m_attackers.size ();
+}
+
+uint32_t
+DsrDetectionStats::GetDetectedCount () const
+{
+  return m_detected.size ();
+}
+
+uint32_t
+DsrDetectionStats::GetTruePositives () const
+{
+  uint32_t hits = 0;
+  for (std::map<uint32_t, Time>::const_iterator i = m_detected.begin (); i != m_detected.end (); ++i)
+    {
+      hits += m_attackers.count (i->first);
+    }
+  return hits;
+}
+
+uint32_t
+DsrDetectionStats::GetFalsePositives () const
+{
+  return GetDetectedCount () - GetTruePositives ();
+}
+
+double
+DsrDetectionStats::GetPrecision () const
+{
+  if (m_detected.empty ())
+    {
+      return std::numeric_limits<double>::quiet_NaN ();
+    }
+  return double (GetTruePositives ()) / m_detected.size ();
+}
+
+double
+DsrDetectionStats::GetRecall () const
+{
+  if (m_attackers.empty ())
+    {
+      return std::numeric_limits<double>::quiet_NaN ();
+    }
+  return double (GetTruePositives ()) / m_attackers.size ();
+}
+
+Time
+DsrDetectionStats::GetMeanTimeToDetect () const
+{
+  Time sum = Seconds (0);
+  uint32_t hits = 0;
+  for (std::map<uint32_t, Time>::const_iterator i = m_detected.begin (); i != m_detected.end (); ++i)
+    {
+      if (m_attackers.count (i->first))
+        {
+          // A suspicion raised before the attack started counts as immediate
+          sum += Max (i->second - m_attackStart, Seconds (0));
+          ++hits;
+        }
+    }
+  return hits ? sum / hits : sum;
+}
+
+Time
+DsrDetectionStats::GetMaxTimeToDetect () const
+{
+  Time worst = Seconds (0);
+  for (std::map<uint32_t, Time>::const_iterator i = m_detected.begin (); i != m_detected.end (); ++i)
+    {
+      if (m_attackers.count (i->first))
+        {
+          // Clamped as in GetMeanTimeToDetect
+          worst = Max (worst, Max (i->second - m_attackStart, Seconds (0)));
+        }
+    }
+  return worst;
+}
+
+uint32_t
+DsrDetectionStats::GetBlackListEvents () const
+{
+  return m_blackListEvents;
+}
+
+uint32_t
+DsrDetectionStats::GetControlPackets () const
+{
+  return m_controlPackets;
+}
+
+uint64_t
+DsrDetectionStats::GetControlBytes () const
+{
+  return m_controlBytes;
+}
+
+uint64_t
+DsrDetectionStats::GetControlBytes (uint8_t optionType) const
+{
+  std::map<uint8_t, uint64_t>::const_iterator i = m_controlBytesByType.find (optionType);
+  return i == m_controlBytesByType.end () ? 0 : i->second;
+}
+
+void
+DsrDetectionStats::WriteCsvHeaderFields (std::ostream &os)
+{
+  os << "attackers,detected,true_positives,false_positives,precision,recall,"
+     << "mean_time_to_detect_s,max_time_to_detect_s,blacklist_events,"
+     << "control_packets,control_bytes,rreq_bytes,rrep_bytes,rerr_bytes,ack_bytes";
+}
+
+void
+DsrDetectionStats::WriteCsvFields (std::ostream &os) const
+{
+  double precision = GetPrecision ();
+  double recall = GetRecall ();
+  os << GetAttackerCount () << "," << GetDetectedCount () << ","
+     << GetTruePositives () << "," << GetFalsePositives () << ",";
+  if (!std::isnan (precision))
+    {
+      os << precision;
+    }
+  os << ",";
+  if (!std::isnan (recall))
+    {
+      os << recall;
+    }
+  os << "," << GetMeanTimeToDetect ().GetSeconds () << "," << GetMaxTimeToDetect ().GetSeconds ()
+     << "," << GetBlackListEvents () << "," << GetControlPackets () << "," << GetControlBytes ()
+     << "," << GetControlBytes (dsr::DsrOptionRreq::OPT_NUMBER)
+     << "," << GetControlBytes (dsr::DsrOptionRrep::OPT_NUMBER)
+     << "," << GetControlBytes (dsr::DsrOptionRerr::OPT_NUMBER)
+     << "," << GetControlBytes (dsr::DsrOptionAck::OPT_NUMBER);
+}
+
+void
+DsrDetectionStats::WriteJsonFields (std::ostream &os) const
+{
+  double precision = GetPrecision ();
+  double recall = GetRecall ();
+  os << "\"attackers\": " << GetAttackerCount ()
+     << ", \"detected\": " << GetDetectedCount ()
+     << ", \"true_positives\": " << GetTruePositives ()
+     << ", \"false_positives\": " << GetFalsePositives ()
+     << ", \"precision\": ";
+  if (std::isnan (precision))
+    {
+      os << "null";
+    }
+  else
+    {
+      os << precision;
+    }
+  os << ", \"recall\": ";
+  if (std::isnan (recall))
+    {
+      os << "null";
+    }
+  else
+    {
+      os << recall;
+    }
+  os << ", \"mean_time_to_detect_s\": " << GetMeanTimeToDetect ().GetSeconds ()
+     << ", \"max_time_to_detect_s\": " << GetMaxTimeToDetect ().GetSeconds ()
+     << ", \"blacklist_events\": " << GetBlackListEvents ()
+     << ", \"control_packets\": " << GetControlPackets ()
+     << ", \"control_bytes\": " << GetControlBytes ()
+     << ", \"rreq_bytes\": " << GetControlBytes (dsr::DsrOptionRreq::OPT_NUMBER)
+     << ", \"rrep_bytes\": " << GetControlBytes (dsr::DsrOptionRrep::OPT_NUMBER)
+     << ", \"rerr_bytes\": " << GetControlBytes (dsr::DsrOptionRerr::OPT_NUMBER)
+     << ", \"ack_bytes\": " << GetControlBytes (dsr::DsrOptionAck::OPT_NUMBER);
+}
+
+} // namespace ns3
@@ -0,0 +1,150 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2026 The SDSR contributors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: The SDSR contributors, see the git history
+ */
+
+#ifndef DSR_DETECTION_STATS_H
+#define DSR_DETECTION_STATS_H
+
+#include <map>
+#include <set>
+#include <string>
+#include <ostream>
+#include "ns3/node-container.h"
+#include "ns3/nstime.h"
+#include "ns3/ipv4-address.h"
+#include "ns3/packet.h"
+
+namespace ns3 {
+/**
+ * \brief Blackhole detection accuracy and control overhead of a DSR run
+ *
+ * Counts the route requests, replies, errors and acks the nodes send and records when
+ * each node was first blacklisted by any other node. After the run the blacklisted nodes
+ * are compared with the attacker set of the DsrAdversary: the precision is the share of
+ * the blacklisted nodes that are attackers, the recall the share of the attackers that
+ * got blacklisted, and the time to detect is measured from the attack start.
+ *
+ * Install it after DsrMainHelper::Install and call Finish after Simulator::Run, before
+ * Simulator::Destroy releases the nodes.
+ */
+class DsrDetectionStats
+{
+public:
+  DsrDetectionStats ();
+  ~DsrDetectionStats ();
+  /**
+   * \brief Connect to the ControlTx and BlackList traces of the DSR instances of the nodes
+   * \param nodes nodes with DSR installed
+   */
+  void Install (NodeContainer nodes);
+  /**
+   * \brief Set the time the attackers start to misbehave, the time to detect counts from it
+   * \param start the attack start
+   */
+  void SetAttackStart (Time start);
+  /**
+   * \brief Read the attacker set from the DsrAdversary of the installed nodes
+   */
+  void Finish ();
+  /**
+   * \brief Forget all the counts, the attackers and the detections
+   */
+  void Reset ();
+  /**
+   * \brief Add a node to the attacker set
+   * \param nodeId the node id
+   */
+  void AddAttacker (uint32_t nodeId);
+  /**
+   * \brief Count a control packet
+   * \param optionType the option number of the rreq, rrep, rerr or ack it carries
+   * \param bytes the size of the DSR packet
+   */
+  void NotifyControlTx (uint8_t optionType, uint32_t bytes);
+  /**
+   * \brief Record that a node put another one on its blacklist
+   * \param detector the id of the node that blacklisted
+   * \param suspect the id of the blacklisted node
+   * \param now the time it happened
+   */
+  void NotifyBlackListed (uint32_t detector, uint32_t suspect, Time now);
+
+  /// \return the number of attackers
+  uint32_t GetAttackerCount () const;
+  /// \return the number of distinct nodes blacklisted by some node
+  uint32_t GetDetectedCount () const;
+  /// \return the number of attackers that got blacklisted
+  uint32_t GetTruePositives () const;
+  /// \return the number of honest nodes that got blacklisted
+  uint32_t GetFalsePositives () const;
+  /// \return the true positives over the detected nodes, NaN if nothing was detected
+  double GetPrecision () const;
+  /// \return the true positives over the attackers, NaN if there are no attackers
+  double GetRecall () const;
+  /// \return the mean time to detect of the detected attackers, zero if there is none
+  Time GetMeanTimeToDetect () const;
+  /// \return the longest time to detect of the detected attackers, zero if there is none
+  Time GetMaxTimeToDetect () const;
+  /// \return the number of times a node was added to some blacklist
+  uint32_t GetBlackListEvents () const;
+  /// \return the number of control packets sent
+  uint32_t GetControlPackets () const;
+  /// \return the bytes of control packets sent
+  uint64_t GetControlBytes () const;
+  /**
+   * \param optionType the option number of the rreq, rrep, rerr or ack
+   * \return the bytes of control packets of that kind sent
+   */
+  uint64_t GetControlBytes (uint8_t optionType) const;
+
+  /**
+   * \brief Write the names of the fields WriteCsvFields writes, comma separated
+   * \param os the output stream
+   */
+  static void WriteCsvHeaderFields (std::ostream &os);
+  /**
+   * \brief Write the statistics comma separated, NaN as an empty field
+   * \param os the output stream
+   */
+  void WriteCsvFields (std::ostream &os) const;
+  /**
+   * \brief Write the statistics as comma separated JSON members, NaN as null
+   * \param os the output stream
+   */
+  void WriteJsonFields (std::ostream &os) const;
+
+private:
+  /// ControlTx trace sink, the context is the node id
+  void ControlTx (std::string context, Ptr<const Packet> packet, uint8_t optionType);
+  /// BlackList trace sink, the context is the node id
+  void BlackList (std::string context, Ipv4Address address, bool added);
+
+  NodeContainer m_nodes;                        ///< nodes whose attacker set is read by Finish
+  Time m_attackStart;                           ///< the time to detect counts from here
+  std::set<uint32_t> m_attackers;               ///< ground truth
+  std::map<uint32_t, Time> m_detected;          ///< first blacklisting of each node
+  uint32_t m_blackListEvents;                   ///< additions to any blacklist
+  uint32_t m_controlPackets;                    ///< control packets sent
+  uint64_t m_controlBytes;                      ///< control bytes sent
+  std::map<uint8_t, uint64_t> m_controlBytesByType; ///< control bytes sent by option number
+};
+
+} // namespace ns3
+
+#endif /* DSR_DETECTION_STATS_H */
@@ -0,0 +1,146 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2026 The SDSR contributors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: The SDSR contributors, see the git history
+ */
+
+#include "dsr-ack-batcher.h"
+#include <algorithm>
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("DsrAckBatcher");
+
+namespace dsr {
+
+DsrAckBatcher::DsrAckBatcher ()
+  : m_holdoff (Seconds (0)),
+    m_maxIds (1),
+    m_coalesced (0)
+{
+}
+
+DsrAckBatcher::~DsrAckBatcher ()
+{
+  Clear ();
+}
+
+void
+DsrAckBatcher::SetFlushCallback (FlushCallback flush)
+{
+  m_flush = flush;
+}
+
+void
+DsrAckBatcher::SetHoldoff (Time holdoff)
+{
+  m_holdoff = holdoff;
+}
+
+Time
+DsrAckBatcher::GetHoldoff () const
+{
+  return m_holdoff;
+}
+
+void
+DsrAckBatcher::SetMaxIds (uint32_t maxIds)
+{
+  NS_ASSERT (maxIds > 0);
+  m_maxIds = maxIds;
+}
+
+void
+DsrAckBatcher::Add (DsrAckBatchKey const & key, std::vector<uint16_t> const & ackIds, uint8_t protocol,
+                    Ptr<Ipv4Route> route, std::vector<Ipv4Address> const & nodeList)
+{
+  NS_LOG_FUNCTION (this << key.m_realSrc << key.m_realDst << key.m_nextHop << ackIds.size ());
+  for (std::vector<uint16_t>::const_iterator id = ackIds.begin (); id != ackIds.end (); ++id)
+    {
+      BatchMap::iterator i = m_batches.find (key);
+      if (i != m_batches.end () && i->second.m_nodeList != nodeList)
+        {
+          NS_LOG_LOGIC ("Route changed, send the pending ack first");
+          Flush (key);
+          i = m_batches.end ();
+        }
+      if (i == m_batches.end ())
+        {
+          Batch batch;
+          batch.m_protocol = protocol;
+          batch.m_route = route;
+          batch.m_nodeList = nodeList;
+          i = m_batches.insert (std::make_pair (key, batch)).first;
+          i->second.m_flush = Simulator::Schedule (m_holdoff, &DsrAckBatcher::Flush, this, key);
+        }
+      else if (std::find (i->second.m_ackIds.begin (), i->second.m_ackIds.end (), *id) != i->second.m_ackIds.end ())
+        {
+          continue;
+        }
+      else
+        {
+          ++m_coalesced;
+        }
+      i->second.m_ackIds.push_back (*id);
+      if (i->second.m_ackIds.size () >= m_maxIds)
+        {
+          Flush (key);
+        }
+    }
+}
+
+void
+DsrAckBatcher::Flush (DsrAckBatchKey key)
+{
+  BatchMap::iterator i = m_batches.find (key);
+  if (i == m_batches.end ())
+    {
+      return;
+    }
+  Batch batch = i->second;
+  batch.m_flush.Cancel ();
+  m_batches.erase (i);
+  NS_LOG_LOGIC ("Send one ack for " << batch.m_ackIds.size () << " ids to " << key.m_nextHop);
+  m_flush (batch.m_ackIds, key, batch.m_protocol, batch.m_route, batch.m_nodeList);
+}
+
+void
+DsrAckBatcher::Clear ()
+{
+  for (BatchMap::iterator i = m_batches.begin (); i != m_batches.end (); ++i)
+    {
+      i->second.m_flush.Cancel ();
+    }
+  m_batches.clear ();
+}
+
+uint32_t
+DsrAckBatcher::GetSize () const
+{
+  return m_batches.size ();
+}
+
+uint32_t
+DsrAckBatcher::GetCoalesced () const
+{
+  return m_coalesced;
+}
+
+} // namespace dsr
+} // namespace ns3
@@ -0,0 +1,163 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2026 The SDSR contributors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: The SDSR contributors, see the git history
+ */
+
+#ifndef DSR_ACK_BATCHER_H
+#define DSR_ACK_BATCHER_H
+
+#include <vector>
+#include <unordered_map>
+#include "ns3/callback.h"
+#include "ns3/event-id.h"
+#include "ns3/ipv4-address.h"
+#include "ns3/ipv4-route.h"
+#include "ns3/nstime.h"
+#include "ns3/ptr.h"
+
+namespace ns3 {
+namespace dsr {
+/**
+ * \ingroup dsr
+ * \brief What an ack goes out as, apart from the ids it covers
+ *
+ * Acks with the same key differ only in their ack id and can be coalesced.
+ */
+struct DsrAckBatchKey
+{
+  Ipv4Address m_realSrc;     ///< source of the acked data packets
+  Ipv4Address m_realDst;     ///< destination of the acked data packets
+  Ipv4Address m_nextHop;     ///< neighbour the ack is sent to, the previous hop of the data
+  Ipv4Address m_targetDst;   ///< node the ack is meant for
+  Ipv4Address m_realSender;  ///< node that generated the ack
+  uint16_t m_flag;           ///< one hop, two hop or end to end ack
+
+  /**
+   * \brief Compare keys
+   * \param o the other key
+   * \return true if all fields are equal
+   */
+  bool operator== (DsrAckBatchKey const & o) const
+  {
+    return m_realSrc == o.m_realSrc && m_realDst == o.m_realDst && m_nextHop == o.m_nextHop
+           && m_targetDst == o.m_targetDst && m_realSender == o.m_realSender && m_flag == o.m_flag;
+  }
+};
+/**
+ * Hash of a DsrAckBatchKey
+ */
+struct DsrAckBatchKeyHash
+{
+  size_t operator () (const DsrAckBatchKey & k) const
+  {
+    size_t h = k.m_flag;
+    h = h * 31 + k.m_realSrc.Get ();
+    h = h * 31 + k.m_realDst.Get ();
+    h = h * 31 + k.m_nextHop.Get ();
+    h = h * 31 + k.m_targetDst.Get ();
+    return h * 31 + k.m_realSender.Get ();
+  }
+};
+/**
+ * \ingroup dsr
+ * \brief Holds acks back for a short while so that one ack option covers several ids
+ *
+ * The first ack for a key opens a batch and schedules its flush one holdoff later, ids
+ * for the same key arriving before that ride along. A batch is flushed early when it is
+ * full or when an ack for the same key comes with a different node list.
+ */
+class DsrAckBatcher
+{
+public:
+  /// Callback sending one ack option covering the given ids
+  typedef Callback<void, std::vector<uint16_t> const &, DsrAckBatchKey const &, uint8_t,
+                   Ptr<Ipv4Route>, std::vector<Ipv4Address> const &> FlushCallback;
+
+  DsrAckBatcher ();
+  ~DsrAckBatcher ();
+  /**
+   * \brief Set the callback sending the coalesced acks
+   * \param flush the callback
+   */
+  void SetFlushCallback (FlushCallback flush);
+  /**
+   * \brief Set how long the first ack of a batch waits for others
+   * \param holdoff the holdoff window
+   */
+  void SetHoldoff (Time holdoff);
+  /**
+   * \brief Get the holdoff window
+   * \return the holdoff window
+   */
+  Time GetHoldoff () const;
+  /**
+   * \brief Set the most ids one ack covers
+   * \param maxIds the batch size, at least one
+   */
+  void SetMaxIds (uint32_t maxIds);
+  /**
+   * \brief Queue an ack
+   * \param key what the ack goes out as
+   * \param ackIds the ids it covers
+   * \param protocol the next header value
+   * \param route the route to the next hop
+   * \param nodeList the route of the acked data packets
+   */
+  void Add (DsrAckBatchKey const & key, std::vector<uint16_t> const & ackIds, uint8_t protocol,
+            Ptr<Ipv4Route> route, std::vector<Ipv4Address> const & nodeList);
+  /**
+   * \brief Send the batch of a key now
+   * \param key the key
+   */
+  void Flush (DsrAckBatchKey key);
+  /// Drop all the batches without sending them
+  void Clear ();
+  /**
+   * \brief Number of open batches
+   * \return the number of keys with acks held back
+   */
+  uint32_t GetSize () const;
+  /**
+   * \brief Number of ids that went out on an ack opened for another id
+   * \return the ack options saved so far
+   */
+  uint32_t GetCoalesced () const;
+
+private:
+  /// Acks held back for one key
+  struct Batch
+  {
+    std::vector<uint16_t> m_ackIds;          ///< ids covered so far
+    uint8_t m_protocol;                      ///< next header value
+    Ptr<Ipv4Route> m_route;                  ///< route to the next hop
+    std::vector<Ipv4Address> m_nodeList;     ///< route of the acked data packets
+    EventId m_flush;                         ///< flush at the end of the holdoff
+  };
+  typedef std::unordered_map<DsrAckBatchKey, Batch, DsrAckBatchKeyHash> BatchMap;
+
+  BatchMap m_batches;         ///< open batches
+  FlushCallback m_flush;      ///< sends a batch
+  Time m_holdoff;             ///< holdoff window
+  uint32_t m_maxIds;          ///< most ids per ack
+  uint32_t m_coalesced;       ///< ids that rode on another ack
+};
+
+} // namespace dsr
+} // namespace ns3
+
+#endif /* DSR_ACK_BATCHER_H */
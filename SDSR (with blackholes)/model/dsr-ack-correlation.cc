@@ -0,0 +1,258 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2026 The SDSR contributors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: The SDSR contributors, see the git history
+ */
+
+#include "dsr-ack-correlation.h"
+#include <algorithm>
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("DsrAckCorrelation");
+
+namespace dsr {
+
+DsrAckCorrelation::DsrAckCorrelation ()
+  : m_timeout (Seconds (2)),
+    m_maxEntries (1024),
+    m_evicted (0)
+{
+}
+
+DsrAckCorrelation::~DsrAckCorrelation ()
+{
+  Clear ();
+}
+
+void
+DsrAckCorrelation::SetCompleteCallback (ResultCallback complete)
+{
+  m_complete = complete;
+}
+
+void
+DsrAckCorrelation::SetIncompleteCallback (ResultCallback incomplete)
+{
+  m_incomplete = incomplete;
+}
+
+void
+DsrAckCorrelation::SetTimeout (Time timeout)
+{
+  m_timeout = timeout;
+}
+
+Time
+DsrAckCorrelation::GetTimeout () const
+{
+  return m_timeout;
+}
+
+void
+DsrAckCorrelation::SetMaxEntries (uint32_t maxEntries)
+{
+  m_maxEntries = std::max (maxEntries, 1u);
+}
+
+uint32_t
+DsrAckCorrelation::GetMaxEntries () const
+{
+  return m_maxEntries;
+}
+
+bool
+DsrAckCorrelation::Expect (Ipv4Address source, uint32_t ackId, std::vector<Ipv4Address> const & route)
+{
+  NS_LOG_FUNCTION (this << source << ackId);
+  if (route.size () < 3)
+    {
+      return false;
+    }
+  DsrAckCorrelationKey key;
+  key.m_source = source;
+  key.m_ackId = ackId;
+  EntryMap::iterator i = m_entries.find (key);
+  if (i == m_entries.end ())
+    {
+      // Make room by dropping the oldest packets, their outcome stays unknown
+      while (m_entries.size () >= m_maxEntries && !m_expiry.empty ())
+        {
+          EntryMap::iterator oldest = m_entries.find (m_expiry.front ().second);
+          if (oldest != m_entries.end () && oldest->second.m_expire == m_expiry.front ().first)
+            {
+              NS_LOG_DEBUG ("Evict the acks of " << oldest->first.m_ackId);
+              m_entries.erase (oldest);
+              ++m_evicted;
+            }
+          m_expiry.pop_front ();
+        }
+      Entry entry;
+      entry.m_route = route;
+      entry.m_pending.assign (route.begin () + 2, route.end ());
+      i = m_entries.insert (std::make_pair (key, entry)).first;
+    }
+  i->second.m_expire = Simulator::Now () + m_timeout;
+  m_expiry.push_back (std::make_pair (i->second.m_expire, key));
+
+  std::unordered_map<Ipv4Address, uint32_t, Ipv4AddressHash>::iterator latest = m_latest.find (source);
+  if (latest == m_latest.end ())
+    {
+      m_latest[source] = ackId;
+    }
+  else if (ackId - latest->second < 0x80000000u)
+    {
+      // The id is after the latest one in serial number arithmetic
+      latest->second = ackId;
+    }
+  ScheduleExpiry ();
+  return true;
+}
+
+bool
+DsrAckCorrelation::Refresh (Ipv4Address source, uint32_t ackId)
+{
+  NS_LOG_FUNCTION (this << source << ackId);
+  DsrAckCorrelationKey key;
+  key.m_source = source;
+  key.m_ackId = ackId;
+  EntryMap::iterator i = m_entries.find (key);
+  if (i == m_entries.end ())
+    {
+      return false;
+    }
+  i->second.m_expire = Simulator::Now () + m_timeout;
+  m_expiry.push_back (std::make_pair (i->second.m_expire, key));
+  ScheduleExpiry ();
+  return true;
+}
+
+uint32_t
+DsrAckCorrelation::Extend (Ipv4Address source, uint16_t wireId) const
+{
+  std::unordered_map<Ipv4Address, uint32_t, Ipv4AddressHash>::const_iterator latest = m_latest.find (source);
+  if (latest == m_latest.end ())
+    {
+      return wireId;
+    }
+  // Take the id with these low bits that is closest to the latest one
+  uint32_t ackId = (latest->second & 0xffff0000u) | wireId;
+  if (ackId > latest->second && ackId - latest->second > 0x8000u)
+    {
+      ackId -= 0x10000u;
+    }
+  else if (ackId < latest->second && latest->second - ackId > 0x8000u)
+    {
+      ackId += 0x10000u;
+    }
+  return ackId;
+}
+
+bool
+DsrAckCorrelation::Acknowledge (Ipv4Address source, uint32_t ackId, Ipv4Address responder)
+{
+  NS_LOG_FUNCTION (this << source << ackId << responder);
+  DsrAckCorrelationKey key;
+  key.m_source = source;
+  key.m_ackId = ackId;
+  EntryMap::iterator i = m_entries.find (key);
+  if (i == m_entries.end ())
+    {
+      return false;
+    }
+  std::vector<Ipv4Address> & pending = i->second.m_pending;
+  std::vector<Ipv4Address>::iterator j = std::find (pending.begin (), pending.end (), responder);
+  if (j != pending.end ())
+    {
+      pending.erase (j);
+    }
+  if (pending.empty ())
+    {
+      std::vector<Ipv4Address> route;
+      route.swap (i->second.m_route);
+      m_entries.erase (i);
+      if (!m_complete.IsNull ())
+        {
+          m_complete (ackId, route, std::vector<Ipv4Address> ());
+        }
+    }
+  return true;
+}
+
+void
+DsrAckCorrelation::Purge ()
+{
+  NS_LOG_FUNCTION (this);
+  Time now = Simulator::Now ();
+  while (!m_expiry.empty () && m_expiry.front ().first <= now)
+    {
+      std::pair<Time, DsrAckCorrelationKey> item = m_expiry.front ();
+      m_expiry.pop_front ();
+      EntryMap::iterator i = m_entries.find (item.second);
+      // A packet waited for again has a later item in the queue
+      if (i == m_entries.end () || i->second.m_expire != item.first)
+        {
+          continue;
+        }
+      Entry entry;
+      std::swap (entry, i->second);
+      m_entries.erase (i);
+      NS_LOG_DEBUG ("The acks of " << item.second.m_ackId << " miss " << entry.m_pending.size () << " nodes");
+      if (!m_incomplete.IsNull ())
+        {
+          m_incomplete (item.second.m_ackId, entry.m_route, entry.m_pending);
+        }
+    }
+  ScheduleExpiry ();
+}
+
+void
+DsrAckCorrelation::ScheduleExpiry ()
+{
+  if (m_expiry.empty () || m_purgeEvent.IsRunning ())
+    {
+      return;
+    }
+  m_purgeEvent = Simulator::Schedule (m_expiry.front ().first - Simulator::Now (),
+                                      &DsrAckCorrelation::Purge, this);
+}
+
+void
+DsrAckCorrelation::Clear ()
+{
+  m_purgeEvent.Cancel ();
+  m_entries.clear ();
+  m_expiry.clear ();
+  m_latest.clear ();
+}
+
+uint32_t
+DsrAckCorrelation::GetSize () const
+{
+  return m_entries.size ();
+}
+
+uint32_t
+DsrAckCorrelation::GetEvicted () const
+{
+  return m_evicted;
+}
+
+} // namespace dsr
+} // namespace ns3
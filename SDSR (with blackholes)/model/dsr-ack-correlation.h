@@ -0,0 +1,186 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2026 The SDSR contributors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: The SDSR contributors, see the git history
+ */
+
+#ifndef DSR_ACK_CORRELATION_H
+#define DSR_ACK_CORRELATION_H
+
+#include <deque>
+#include <vector>
+#include <unordered_map>
+#include "ns3/callback.h"
+#include "ns3/event-id.h"
+#include "ns3/ipv4-address.h"
+#include "ns3/nstime.h"
+
+namespace ns3 {
+namespace dsr {
+/**
+ * \ingroup dsr
+ * \brief A data packet sent with two hop acks, as seen by its source
+ */
+struct DsrAckCorrelationKey
+{
+  Ipv4Address m_source;     ///< source of the data packet
+  uint32_t m_ackId;         ///< full 32 bit id of the data packet
+
+  /**
+   * \brief Compare keys
+   * \param o the other key
+   * \return true if all fields are equal
+   */
+  bool operator== (DsrAckCorrelationKey const & o) const
+  {
+    return m_source == o.m_source && m_ackId == o.m_ackId;
+  }
+};
+/**
+ * Hash of a DsrAckCorrelationKey
+ */
+struct DsrAckCorrelationKeyHash
+{
+  size_t operator () (const DsrAckCorrelationKey & k) const
+  {
+    return k.m_source.Get () * 31 + k.m_ackId;
+  }
+};
+/**
+ * \ingroup dsr
+ * \brief Matches the two hop acks coming back to a source against the packets it sent
+ *
+ * Every packet sent with two hop acks expects one ack from each node two or more hops down
+ * its route. The set is complete once all of them acked, and incomplete if some are still
+ * missing when the entry expires. The ack option only carries the low 16 bits of the id;
+ * Extend maps them back to the closest id the source sent, so ids do not alias when they
+ * wrap. The table holds at most MaxEntries packets, the oldest is dropped to make room.
+ */
+class DsrAckCorrelation
+{
+public:
+  /// Callback told about a finished ack set: the id, the route and the nodes that did not ack
+  typedef Callback<void, uint32_t, std::vector<Ipv4Address> const &,
+                   std::vector<Ipv4Address> const &> ResultCallback;
+
+  DsrAckCorrelation ();
+  ~DsrAckCorrelation ();
+  /**
+   * \brief Set the callback told about complete ack sets
+   * \param complete the callback
+   */
+  void SetCompleteCallback (ResultCallback complete);
+  /**
+   * \brief Set the callback told about ack sets still missing acks when they expire
+   * \param incomplete the callback
+   */
+  void SetIncompleteCallback (ResultCallback incomplete);
+  /**
+   * \brief Set how long a packet waits for its acks
+   * \param timeout the timeout
+   */
+  void SetTimeout (Time timeout);
+  /**
+   * \brief Get how long a packet waits for its acks
+   * \return the timeout
+   */
+  Time GetTimeout () const;
+  /**
+   * \brief Set the most packets tracked at once
+   * \param maxEntries the table size, at least one
+   */
+  void SetMaxEntries (uint32_t maxEntries);
+  /**
+   * \brief Get the most packets tracked at once
+   * \return the table size
+   */
+  uint32_t GetMaxEntries () const;
+  /**
+   * \brief Start waiting for the acks of a packet, a packet already waited for gets a new timeout
+   * \param source the source of the packet
+   * \param ackId the full id of the packet
+   * \param route the route of the packet
+   * \return false if the route is too short for two hop acks
+   */
+  bool Expect (Ipv4Address source, uint32_t ackId, std::vector<Ipv4Address> const & route);
+  /**
+   * \brief Give a packet already waited for a new timeout
+   * \param source the source of the packet
+   * \param ackId the full id of the packet
+   * \return false if the packet is not waited for
+   */
+  bool Refresh (Ipv4Address source, uint32_t ackId);
+  /**
+   * \brief Get the full id of a packet from the 16 bits on an ack
+   * \param source the source of the packet
+   * \param wireId the id carried by the ack
+   * \return the id closest to the latest one the source sent
+   */
+  uint32_t Extend (Ipv4Address source, uint16_t wireId) const;
+  /**
+   * \brief Account for the ack of one node
+   * \param source the source of the packet
+   * \param ackId the full id of the packet
+   * \param responder the node that generated the ack
+   * \return true if the packet is waited for
+   */
+  bool Acknowledge (Ipv4Address source, uint32_t ackId, Ipv4Address responder);
+  /// Report and drop the expired entries
+  void Purge ();
+  /// Drop all the entries without reporting them
+  void Clear ();
+  /**
+   * \brief Number of packets waiting for acks
+   * \return the number of entries
+   */
+  uint32_t GetSize () const;
+  /**
+   * \brief Number of packets dropped to make room for newer ones
+   * \return the evicted entries so far
+   */
+  uint32_t GetEvicted () const;
+
+private:
+  /// The acks still expected for one packet
+  struct Entry
+  {
+    std::vector<Ipv4Address> m_route;      ///< route of the packet
+    std::vector<Ipv4Address> m_pending;    ///< nodes that did not ack yet, in route order
+    Time m_expire;                         ///< when the set is given up
+  };
+  typedef std::unordered_map<DsrAckCorrelationKey, Entry, DsrAckCorrelationKeyHash> EntryMap;
+  /// Expiry time and key, in the order the entries were (re)started
+  typedef std::deque<std::pair<Time, DsrAckCorrelationKey> > ExpiryQueue;
+
+  /// Schedule the purge of the oldest entry
+  void ScheduleExpiry ();
+
+  EntryMap m_entries;                                           ///< packets waiting for acks
+  ExpiryQueue m_expiry;                                         ///< expiry order, stale items are skipped
+  std::unordered_map<Ipv4Address, uint32_t, Ipv4AddressHash> m_latest;   ///< latest id of each source
+  EventId m_purgeEvent;                                         ///< purge of the oldest entry
+  ResultCallback m_complete;                                    ///< told about complete sets
+  ResultCallback m_incomplete;                                  ///< told about incomplete sets
+  Time m_timeout;                                               ///< how long a packet waits
+  uint32_t m_maxEntries;                                        ///< table size
+  uint32_t m_evicted;                                           ///< entries dropped for room
+};
+
+} // namespace dsr
+} // namespace ns3
+
+#endif /* DSR_ACK_CORRELATION_H */
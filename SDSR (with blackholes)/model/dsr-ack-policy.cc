@@ -0,0 +1,238 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2026 The SDSR contributors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: The SDSR contributors, see the git history
+ */
+
+#include "dsr-ack-policy.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/enum.h"
+#include "ns3/double.h"
+#include "ns3/uinteger.h"
+#include "ns3/trace-source-accessor.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("DsrAckPolicy");
+
+namespace dsr {
+
+NS_OBJECT_ENSURE_REGISTERED (DsrAckPolicy);
+
+TypeId DsrAckPolicy::GetTypeId ()
+{
+  static TypeId tid = TypeId ("ns3::dsr::DsrAckPolicy")
+    .SetParent<Object> ()
+    .SetGroupName ("Dsr")
+  ;
+  return tid;
+}
+
+DsrAckPolicy::DsrAckPolicy ()
+{
+}
+
+DsrAckPolicy::~DsrAckPolicy ()
+{
+}
+
+void
+DsrAckPolicy::NotifyDelivered (Ipv4Address destination)
+{
+}
+
+void
+DsrAckPolicy::NotifyLost (Ipv4Address destination)
+{
+}
+
+void
+DsrAckPolicy::NotifySuspect (Ipv4Address destination, Ipv4Address suspect)
+{
+}
+
+NS_OBJECT_ENSURE_REGISTERED (DsrFixedAckPolicy);
+
+TypeId DsrFixedAckPolicy::GetTypeId ()
+{
+  static TypeId tid = TypeId ("ns3::dsr::DsrFixedAckPolicy")
+    .SetParent<DsrAckPolicy> ()
+    .SetGroupName ("Dsr")
+    .AddConstructor<DsrFixedAckPolicy> ()
+    .AddAttribute ("AckMode",
+                   "The ack mode of every data packet.",
+                   EnumValue (END_TO_END),
+                   MakeEnumAccessor (&DsrFixedAckPolicy::m_mode),
+                   MakeEnumChecker (ONE_HOP, "OneHop",
+                                    TWO_HOP, "TwoHop",
+                                    END_TO_END, "EndToEnd"))
+  ;
+  return tid;
+}
+
+DsrFixedAckPolicy::DsrFixedAckPolicy ()
+  : m_mode (END_TO_END)
+{
+}
+
+DsrFixedAckPolicy::~DsrFixedAckPolicy ()
+{
+}
+
+uint8_t
+DsrFixedAckPolicy::SelectAckFlag (Ipv4Address destination, std::vector<Ipv4Address> const & route,
+                                  uint32_t penalty)
+{
+  return m_mode;
+}
+
+NS_OBJECT_ENSURE_REGISTERED (DsrAdaptiveAckPolicy);
+
+TypeId DsrAdaptiveAckPolicy::GetTypeId ()
+{
+  static TypeId tid = TypeId ("ns3::dsr::DsrAdaptiveAckPolicy")
+    .SetParent<DsrAckPolicy> ()
+    .SetGroupName ("Dsr")
+    .AddConstructor<DsrAdaptiveAckPolicy> ()
+    .AddAttribute ("LossWeight",
+                   "The weight of the newest packet in the moving average of the loss share.",
+                   DoubleValue (0.25),
+                   MakeDoubleAccessor (&DsrAdaptiveAckPolicy::m_lossWeight),
+                   MakeDoubleChecker<double> (0.0, 1.0))
+    .AddAttribute ("EscalateLoss",
+                   "The loss share above which a destination gets two hop acks.",
+                   DoubleValue (0.2),
+                   MakeDoubleAccessor (&DsrAdaptiveAckPolicy::m_escalateLoss),
+                   MakeDoubleChecker<double> (0.0, 1.0))
+    .AddAttribute ("RelaxLoss",
+                   "The loss share below which a destination goes back to end to end acks.",
+                   DoubleValue (0.05),
+                   MakeDoubleAccessor (&DsrAdaptiveAckPolicy::m_relaxLoss),
+                   MakeDoubleChecker<double> (0.0, 1.0))
+    .AddAttribute ("SuspicionHold",
+                   "How long a destination keeps two hop acks after they blamed a relay.",
+                   TimeValue (Seconds (10)),
+                   MakeTimeAccessor (&DsrAdaptiveAckPolicy::m_suspicionHold),
+                   MakeTimeChecker ())
+    .AddAttribute ("MaxRoutePenalty",
+                   "The largest relay trust penalty of a route that still gets end to end acks.",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&DsrAdaptiveAckPolicy::m_maxRoutePenalty),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddTraceSource ("ModeChange",
+                     "A destination changed its ack mode.",
+                     MakeTraceSourceAccessor (&DsrAdaptiveAckPolicy::m_modeChangeTrace),
+                     "ns3::dsr::DsrAdaptiveAckPolicy::ModeChangeCallback")
+  ;
+  return tid;
+}
+
+DsrAdaptiveAckPolicy::PathState::PathState ()
+  : m_loss (0),
+    m_suspectUntil (Seconds (0)),
+    m_ackFlag (END_TO_END)
+{
+}
+
+DsrAdaptiveAckPolicy::DsrAdaptiveAckPolicy ()
+  : m_lossWeight (0.25),
+    m_escalateLoss (0.2),
+    m_relaxLoss (0.05),
+    m_suspicionHold (Seconds (10)),
+    m_maxRoutePenalty (0)
+{
+}
+
+DsrAdaptiveAckPolicy::~DsrAdaptiveAckPolicy ()
+{
+}
+
+uint8_t
+DsrAdaptiveAckPolicy::SelectAckFlag (Ipv4Address destination, std::vector<Ipv4Address> const & route,
+                                     uint32_t penalty)
+{
+  NS_LOG_FUNCTION (this << destination << penalty);
+  if (route.size () < 3)
+    {
+      return END_TO_END;
+    }
+  PathState & path = m_paths[destination];
+  bool suspicious = penalty > m_maxRoutePenalty || Simulator::Now () < path.m_suspectUntil;
+  uint8_t ackFlag = path.m_ackFlag;
+  if (ackFlag != TWO_HOP && (suspicious || path.m_loss > m_escalateLoss))
+    {
+      ackFlag = TWO_HOP;
+    }
+  else if (ackFlag == TWO_HOP && !suspicious && path.m_loss < m_relaxLoss)
+    {
+      ackFlag = END_TO_END;
+    }
+  if (ackFlag != path.m_ackFlag)
+    {
+      NS_LOG_DEBUG ("Destination " << destination << " changes to ack flag " << (uint32_t)ackFlag
+                                   << ", loss " << path.m_loss << " penalty " << penalty);
+      path.m_ackFlag = ackFlag;
+      m_modeChangeTrace (destination, ackFlag);
+    }
+  return ackFlag;
+}
+
+void
+DsrAdaptiveAckPolicy::Update (Ipv4Address destination, bool lost)
+{
+  PathState & path = m_paths[destination];
+  path.m_loss += m_lossWeight * ((lost ? 1.0 : 0.0) - path.m_loss);
+}
+
+void
+DsrAdaptiveAckPolicy::NotifyDelivered (Ipv4Address destination)
+{
+  NS_LOG_FUNCTION (this << destination);
+  Update (destination, false);
+}
+
+void
+DsrAdaptiveAckPolicy::NotifyLost (Ipv4Address destination)
+{
+  NS_LOG_FUNCTION (this << destination);
+  Update (destination, true);
+}
+
+void
+DsrAdaptiveAckPolicy::NotifySuspect (Ipv4Address destination, Ipv4Address suspect)
+{
+  NS_LOG_FUNCTION (this << destination << suspect);
+  m_paths[destination].m_suspectUntil = Simulator::Now () + m_suspicionHold;
+}
+
+double
+DsrAdaptiveAckPolicy::GetLoss (Ipv4Address destination) const
+{
+  PathMap::const_iterator i = m_paths.find (destination);
+  return i == m_paths.end () ? 0 : i->second.m_loss;
+}
+
+uint8_t
+DsrAdaptiveAckPolicy::GetAckFlag (Ipv4Address destination) const
+{
+  PathMap::const_iterator i = m_paths.find (destination);
+  return i == m_paths.end () ? static_cast<uint8_t> (END_TO_END) : i->second.m_ackFlag;
+}
+
+} // namespace dsr
+} // namespace ns3
@@ -0,0 +1,188 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2026 The SDSR contributors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: The SDSR contributors, see the git history
+ */
+
+#ifndef DSR_ACK_POLICY_H
+#define DSR_ACK_POLICY_H
+
+#include <vector>
+#include <unordered_map>
+#include "ns3/object.h"
+#include "ns3/nstime.h"
+#include "ns3/ipv4-address.h"
+#include "ns3/traced-callback.h"
+
+namespace ns3 {
+namespace dsr {
+/**
+ * \ingroup dsr
+ * \brief Picks the acknowledgement mode a source puts in the source route of its data
+ *
+ * The ack flag of the source route option tells the nodes down the route how to
+ * acknowledge a data packet: hop by hop, to the node two hops back, or end to end from
+ * the destination only. DsrRouting asks the policy set in its AckPolicy attribute for
+ * every data packet it originates and tells it how the packets fared, so that a policy
+ * can spend the two hop acks on the paths that need them.
+ */
+class DsrAckPolicy : public Object
+{
+public:
+  /// The values of the ack flag
+  enum AckMode
+  {
+    ONE_HOP = 1,           ///< every node acks to the node before it
+    TWO_HOP = 2,           ///< every node acks to the node two hops back, detects a dropping relay
+    END_TO_END = 3         ///< only the destination acks
+  };
+  /**
+   * \brief Get the type identificator.
+   * \return type identificator
+   */
+  static TypeId GetTypeId ();
+
+  DsrAckPolicy ();
+  virtual ~DsrAckPolicy ();
+  /**
+   * \brief Pick the ack mode of a data packet
+   * \param destination the destination of the packet
+   * \param route the source route of the packet, source and destination included
+   * \param penalty the sum of the trust penalties of the relays on the route
+   * \return the ack flag to put in the source route
+   */
+  virtual uint8_t SelectAckFlag (Ipv4Address destination, std::vector<Ipv4Address> const & route,
+                                 uint32_t penalty) = 0;
+  /**
+   * \brief A data packet reached the destination
+   * \param destination the destination
+   */
+  virtual void NotifyDelivered (Ipv4Address destination);
+  /**
+   * \brief A data packet was not acknowledged in time and is sent again
+   * \param destination the destination
+   */
+  virtual void NotifyLost (Ipv4Address destination);
+  /**
+   * \brief The two hop acks of a data packet blame a relay for dropping it
+   * \param destination the destination
+   * \param suspect the relay
+   */
+  virtual void NotifySuspect (Ipv4Address destination, Ipv4Address suspect);
+};
+
+/**
+ * \ingroup dsr
+ * \brief Always the same ack mode, end to end unless set otherwise
+ */
+class DsrFixedAckPolicy : public DsrAckPolicy
+{
+public:
+  /**
+   * \brief Get the type identificator.
+   * \return type identificator
+   */
+  static TypeId GetTypeId ();
+
+  DsrFixedAckPolicy ();
+  virtual ~DsrFixedAckPolicy ();
+
+  virtual uint8_t SelectAckFlag (Ipv4Address destination, std::vector<Ipv4Address> const & route,
+                                 uint32_t penalty);
+
+private:
+  AckMode m_mode;                                  ///< the ack mode of every packet
+};
+
+/**
+ * \ingroup dsr
+ * \brief End to end acks on clean paths, two hop acks on lossy or suspicious ones
+ *
+ * For every destination the policy keeps a moving average of the share of packets that
+ * had to be sent again. A destination goes to two hop acks when that share passes
+ * EscalateLoss, when a relay on its route has lost trust, or when two hop acks blamed a
+ * relay for it within the SuspicionHold; it goes back to end to end acks once none of
+ * that holds and the share is below RelaxLoss. A route of a single hop always uses end
+ * to end acks, the destination is the only node that could ack.
+ */
+class DsrAdaptiveAckPolicy : public DsrAckPolicy
+{
+public:
+  /**
+   * \brief Get the type identificator.
+   * \return type identificator
+   */
+  static TypeId GetTypeId ();
+  /**
+   * Callback signature for a destination changing its ack mode.
+   *
+   * \param [in] destination the destination
+   * \param [in] ackFlag the new ack flag
+   */
+  typedef void (* ModeChangeCallback)(Ipv4Address destination, uint8_t ackFlag);
+
+  DsrAdaptiveAckPolicy ();
+  virtual ~DsrAdaptiveAckPolicy ();
+
+  virtual uint8_t SelectAckFlag (Ipv4Address destination, std::vector<Ipv4Address> const & route,
+                                 uint32_t penalty);
+  virtual void NotifyDelivered (Ipv4Address destination);
+  virtual void NotifyLost (Ipv4Address destination);
+  virtual void NotifySuspect (Ipv4Address destination, Ipv4Address suspect);
+  /**
+   * \brief Get the moving average of the share of lost packets to a destination
+   * \param destination the destination
+   * \return the share, zero for a destination not seen yet
+   */
+  double GetLoss (Ipv4Address destination) const;
+  /**
+   * \brief Get the ack mode of a destination
+   * \param destination the destination
+   * \return the ack flag of its last packet, end to end for a destination not seen yet
+   */
+  uint8_t GetAckFlag (Ipv4Address destination) const;
+
+private:
+  /// What is known about the path to a destination
+  struct PathState
+  {
+    PathState ();
+    double m_loss;                                 ///< moving average of the share of lost packets
+    Time m_suspectUntil;                           ///< a relay was blamed, stay on two hop acks until then
+    uint8_t m_ackFlag;                             ///< the ack flag of the last packet
+  };
+  /**
+   * \brief Fold one packet outcome into the loss average of a destination
+   * \param destination the destination
+   * \param lost true if the packet was lost
+   */
+  void Update (Ipv4Address destination, bool lost);
+
+  typedef std::unordered_map<Ipv4Address, PathState, Ipv4AddressHash> PathMap;
+  PathMap m_paths;                                 ///< the state of every destination
+  double m_lossWeight;                             ///< weight of the newest outcome in the loss average
+  double m_escalateLoss;                           ///< loss share that turns on two hop acks
+  double m_relaxLoss;                              ///< loss share under which end to end acks come back
+  Time m_suspicionHold;                            ///< how long a blamed relay keeps two hop acks on
+  uint32_t m_maxRoutePenalty;                      ///< the relay penalty a clean route may have
+  TracedCallback<Ipv4Address, uint8_t> m_modeChangeTrace;  ///< fired when a destination changes its mode
+};
+
+} // namespace dsr
+} // namespace ns3
+
+#endif /* DSR_ACK_POLICY_H */
@@ -0,0 +1,222 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2026 The SDSR contributors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: The SDSR contributors, see the git history
+ */
+
+#include "dsr-adversary.h"
+#include <cstdlib>
+#include <sstream>
+#include "ns3/log.h"
+#include "ns3/abort.h"
+#include "ns3/simulator.h"
+#include "ns3/string.h"
+#include "ns3/enum.h"
+#include "ns3/double.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("DsrAdversary");
+
+namespace dsr {
+
+NS_OBJECT_ENSURE_REGISTERED (DsrAdversary);
+
+TypeId DsrAdversary::GetTypeId ()
+{
+  static TypeId tid = TypeId ("ns3::dsr::DsrAdversary")
+    .SetParent<Object> ()
+    .SetGroupName ("Dsr")
+    .AddConstructor<DsrAdversary> ()
+    .AddAttribute ("AttackerNodes",
+                   "The ids of the attacker nodes, separated by commas, ranges as first-last.",
+                   StringValue ("12,18"),
+                   MakeStringAccessor (&DsrAdversary::SetAttackerNodes,
+                                       &DsrAdversary::GetAttackerNodes),
+                   MakeStringChecker ())
+    .AddAttribute ("AttackType",
+                   "What the attacker nodes do.",
+                   EnumValue (BLACKHOLE),
+                   MakeEnumAccessor (&DsrAdversary::m_type),
+                   MakeEnumChecker (NONE, "None",
+                                    BLACKHOLE, "Blackhole",
+                                    GRAYHOLE, "Grayhole",
+                                    SELECTIVE_FORWARDING, "SelectiveForwarding"))
+    .AddAttribute ("DropProbability",
+                   "The probability a grayhole drops a data packet.",
+                   DoubleValue (0.5),
+                   MakeDoubleAccessor (&DsrAdversary::m_dropProbability),
+                   MakeDoubleChecker<double> (0.0, 1.0))
+    .AddAttribute ("SelectiveTargets",
+                   "The ids of the nodes whose flows a selective forwarder drops, "
+                   "separated by commas, ranges as first-last.",
+                   StringValue (""),
+                   MakeStringAccessor (&DsrAdversary::SetSelectiveTargets,
+                                       &DsrAdversary::GetSelectiveTargets),
+                   MakeStringChecker ())
+    .AddAttribute ("StartTime",
+                   "The time the attacker nodes start to misbehave.",
+                   TimeValue (Seconds (0)),
+                   MakeTimeAccessor (&DsrAdversary::m_start),
+                   MakeTimeChecker ())
+    .AddAttribute ("StopTime",
+                   "The time the attacker nodes stop to misbehave.",
+                   TimeValue (Time::Max ()),
+                   MakeTimeAccessor (&DsrAdversary::m_stop),
+                   MakeTimeChecker ())
+  ;
+  return tid;
+}
+
+DsrAdversary::DsrAdversary ()
+  : m_streamAssigned (false)
+{
+  m_uniformRandomVariable = CreateObject<UniformRandomVariable> ();
+}
+
+DsrAdversary::~DsrAdversary ()
+{
+}
+
+void
+DsrAdversary::ParseNodes (std::string nodes, std::set<uint32_t> & ids)
+{
+  ids.clear ();
+  std::istringstream list (nodes);
+  std::string item;
+  while (std::getline (list, item, ','))
+    {
+      if (item.find_first_not_of (" \t") == std::string::npos)
+        {
+          continue;
+        }
+      std::string::size_type dash = item.find ('-');
+      char *end;
+      uint32_t first = std::strtoul (item.c_str (), &end, 10);
+      uint32_t last = first;
+      if (dash != std::string::npos)
+        {
+          last = std::strtoul (item.c_str () + dash + 1, &end, 10);
+        }
+      NS_ABORT_MSG_IF (last < first, "Bad node range " << item);
+      for (uint32_t id = first; id <= last; ++id)
+        {
+          ids.insert (id);
+        }
+    }
+}
+
+std::string
+DsrAdversary::PrintNodes (std::set<uint32_t> const & ids)
+{
+  std::ostringstream os;
+  for (std::set<uint32_t>::const_iterator i = ids.begin (); i != ids.end (); ++i)
+    {
+      os << (i == ids.begin () ? "" : ",") << *i;
+    }
+  return os.str ();
+}
+
+void
+DsrAdversary::SetAttackerNodes (std::string nodes)
+{
+  ParseNodes (nodes, m_attackers);
+}
+
+std::string
+DsrAdversary::GetAttackerNodes () const
+{
+  return PrintNodes (m_attackers);
+}
+
+void
+DsrAdversary::SetSelectiveTargets (std::string nodes)
+{
+  ParseNodes (nodes, m_targets);
+}
+
+std::string
+DsrAdversary::GetSelectiveTargets () const
+{
+  return PrintNodes (m_targets);
+}
+
+bool
+DsrAdversary::IsConfigured () const
+{
+  return m_type != NONE && !m_attackers.empty ();
+}
+
+bool
+DsrAdversary::IsAttacker (uint32_t nodeId) const
+{
+  return m_attackers.find (nodeId) != m_attackers.end ();
+}
+
+bool
+DsrAdversary::IsActive (uint32_t nodeId) const
+{
+  if (m_type == NONE || !IsAttacker (nodeId))
+    {
+      return false;
+    }
+  Time now = Simulator::Now ();
+  return now >= m_start && now < m_stop;
+}
+
+bool
+DsrAdversary::ForgesReplies (uint32_t nodeId) const
+{
+  return (m_type == BLACKHOLE || m_type == GRAYHOLE) && IsActive (nodeId);
+}
+
+bool
+DsrAdversary::DropsData (uint32_t nodeId, uint32_t srcId, uint32_t dstId)
+{
+  if (!IsActive (nodeId))
+    {
+      return false;
+    }
+  switch (m_type)
+    {
+    case BLACKHOLE:
+      return true;
+    case GRAYHOLE:
+      return m_uniformRandomVariable->GetValue (0, 1) < m_dropProbability;
+    case SELECTIVE_FORWARDING:
+      return m_targets.find (srcId) != m_targets.end ()
+             || m_targets.find (dstId) != m_targets.end ();
+    default:
+      return false;
+    }
+}
+
+int64_t
+DsrAdversary::AssignStreams (int64_t stream)
+{
+  NS_LOG_FUNCTION (this << stream);
+  if (m_streamAssigned)
+    {
+      return 0;
+    }
+  m_uniformRandomVariable->SetStream (stream);
+  m_streamAssigned = true;
+  return 1;
+}
+
+} // namespace dsr
+} // namespace ns3
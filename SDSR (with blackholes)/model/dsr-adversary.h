@@ -0,0 +1,156 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2026 The SDSR contributors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: The SDSR contributors, see the git history
+ */
+
+#ifndef DSR_ADVERSARY_H
+#define DSR_ADVERSARY_H
+
+#include <set>
+#include <string>
+#include "ns3/object.h"
+#include "ns3/nstime.h"
+#include "ns3/random-variable-stream.h"
+
+namespace ns3 {
+namespace dsr {
+/**
+ * \ingroup dsr
+ * \brief Which nodes misbehave, how and when
+ *
+ * Replaces the node ids that used to be compiled into DsrRouting::Start, which are
+ * still the default (12,18). The attacker set is a list of node ids and ranges
+ * ("12,18" or "10-14,30"), so that a sweep over the attacker density only needs
+ * Config::SetDefault or DsrHelper::Set. All DsrRouting instances may share one
+ * adversary through the DsrRouting::Adversary attribute; each builds its own from the
+ * attribute defaults otherwise.
+ *
+ * - a blackhole answers route requests with forged replies and drops the data it gets
+ * - a grayhole forges replies as well but drops data with DropProbability only
+ * - a selective forwarder takes part in route discovery honestly and drops the data
+ *   of flows from or to the SelectiveTargets nodes
+ */
+class DsrAdversary : public Object
+{
+public:
+  /// Kind of misbehaviour of the attacker nodes
+  enum AttackType
+  {
+    NONE,                  ///< no attack
+    BLACKHOLE,             ///< forge replies, drop all data
+    GRAYHOLE,              ///< forge replies, drop data with a probability
+    SELECTIVE_FORWARDING   ///< drop the data of the target flows
+  };
+  /**
+   * \brief Get the type identificator.
+   * \return type identificator
+   */
+  static TypeId GetTypeId ();
+
+  DsrAdversary ();
+  virtual ~DsrAdversary ();
+  /**
+   * \brief Set the attacker nodes
+   * \param nodes node ids and ranges separated by commas, e.g. "12,18" or "10-14"
+   */
+  void SetAttackerNodes (std::string nodes);
+  /**
+   * \brief Get the attacker nodes
+   * \return the attacker node ids separated by commas
+   */
+  std::string GetAttackerNodes () const;
+  /**
+   * \brief Set the nodes whose flows a selective forwarder drops
+   * \param nodes node ids and ranges separated by commas
+   */
+  void SetSelectiveTargets (std::string nodes);
+  /**
+   * \brief Get the nodes whose flows a selective forwarder drops
+   * \return the node ids separated by commas
+   */
+  std::string GetSelectiveTargets () const;
+  /**
+   * \brief Check if an attack is configured at all
+   * \return true if there are attackers and the attack type is not NONE
+   */
+  bool IsConfigured () const;
+  /**
+   * \brief Check if a node is in the attacker set
+   * \param nodeId the node id
+   * \return true if it is
+   */
+  bool IsAttacker (uint32_t nodeId) const;
+  /**
+   * \brief Check if a node misbehaves right now
+   * \param nodeId the node id
+   * \return true if it is an attacker and the attack window is open
+   */
+  bool IsActive (uint32_t nodeId) const;
+  /**
+   * \brief Check if a node answers route requests with forged replies right now
+   * \param nodeId the node id
+   * \return true for an active blackhole or grayhole
+   */
+  bool ForgesReplies (uint32_t nodeId) const;
+  /**
+   * \brief Decide if a node drops a data packet it should forward
+   * \param nodeId the node id
+   * \param srcId the node id of the data source
+   * \param dstId the node id of the data destination
+   * \return true if the packet is dropped
+   */
+  bool DropsData (uint32_t nodeId, uint32_t srcId, uint32_t dstId);
+  /**
+   * Assign a fixed random variable stream number to the random variables
+   * used by this model.  Return the number of streams (possibly zero) that
+   * have been assigned.  Only the first call assigns one, as every node
+   * sharing the adversary calls it.
+   *
+   * \param stream first stream index to use
+   * \return the number of stream indices assigned by this model
+   */
+  int64_t AssignStreams (int64_t stream);
+
+private:
+  /**
+   * \brief Parse a list of node ids and ranges
+   * \param nodes the list
+   * \param ids the parsed ids
+   */
+  static void ParseNodes (std::string nodes, std::set<uint32_t> & ids);
+  /**
+   * \brief Print a set of node ids
+   * \param ids the ids
+   * \return the ids separated by commas
+   */
+  static std::string PrintNodes (std::set<uint32_t> const & ids);
+
+  std::set<uint32_t> m_attackers;                  ///< attacker node ids
+  std::set<uint32_t> m_targets;                    ///< node ids of the flows a selective forwarder drops
+  AttackType m_type;                               ///< kind of misbehaviour
+  double m_dropProbability;                        ///< grayhole drop probability
+  Time m_start;                                    ///< the attack window opens
+  Time m_stop;                                     ///< the attack window closes
+  Ptr<UniformRandomVariable> m_uniformRandomVariable;  ///< grayhole drop decisions
+  bool m_streamAssigned;                           ///< a stream was assigned to the random variable
+};
+
+} // namespace dsr
+} // namespace ns3
+
+#endif /* DSR_ADVERSARY_H */
@@ -0,0 +1,199 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2026 The SDSR contributors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: The SDSR contributors, see the git history
+ */
+
+#include "dsr-blacklist.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("DsrBlackList");
+
+namespace dsr {
+
+DsrBlackList::DsrBlackList ()
+  : m_timeout (Seconds (0)),
+    m_maxTimeout (Seconds (0))
+{
+}
+
+DsrBlackList::~DsrBlackList ()
+{
+}
+
+void
+DsrBlackList::SetChangeCallback (ChangeCallback change)
+{
+  m_change = change;
+}
+
+void
+DsrBlackList::SetTimeout (Time timeout)
+{
+  m_timeout = timeout;
+}
+
+Time
+DsrBlackList::GetTimeout () const
+{
+  return m_timeout;
+}
+
+void
+DsrBlackList::SetMaxTimeout (Time maxTimeout)
+{
+  m_maxTimeout = maxTimeout;
+}
+
+Time
+DsrBlackList::GetMaxTimeout () const
+{
+  return m_maxTimeout;
+}
+
+bool
+DsrBlackList::IsExpired (Entry const & entry) const
+{
+  return m_timeout.IsStrictlyPositive () && entry.m_expire <= Simulator::Now ();
+}
+
+void
+DsrBlackList::Add (Ipv4Address address)
+{
+  NS_LOG_FUNCTION (this << address);
+  Purge ();
+  std::pair<EntryMap::iterator, bool> result = m_entries.insert (std::make_pair (address, Entry ()));
+  Entry & entry = result.first->second;
+  if (result.second)
+    {
+      entry.m_strikes = 1;
+    }
+  else
+    {
+      entry.m_strikes++;
+    }
+  // Every strike doubles the hold time, up to the cap
+  Time hold = m_timeout;
+  for (uint32_t i = 1; i < entry.m_strikes && hold < m_maxTimeout; ++i)
+    {
+      hold = hold + hold;
+    }
+  if (hold > m_maxTimeout && m_maxTimeout >= m_timeout)
+    {
+      hold = m_maxTimeout;
+    }
+  entry.m_expire = Simulator::Now () + hold;
+  NS_LOG_DEBUG ("Blacklist " << address << " strike " << entry.m_strikes << " for " << hold.GetSeconds () << "s");
+  if (result.second && !m_change.IsNull ())
+    {
+      m_change (address, true);
+    }
+}
+
+bool
+DsrBlackList::Remove (Ipv4Address address)
+{
+  NS_LOG_FUNCTION (this << address);
+  if (m_entries.erase (address) == 0)
+    {
+      return false;
+    }
+  if (!m_change.IsNull ())
+    {
+      m_change (address, false);
+    }
+  return true;
+}
+
+bool
+DsrBlackList::Contains (Ipv4Address address)
+{
+  EntryMap::iterator i = m_entries.find (address);
+  if (i == m_entries.end ())
+    {
+      return false;
+    }
+  if (IsExpired (i->second))
+    {
+      Remove (address);
+      return false;
+    }
+  return true;
+}
+
+bool
+DsrBlackList::ContainsAny (std::vector<Ipv4Address> const & nodeList)
+{
+  if (m_entries.empty ())
+    {
+      return false;
+    }
+  for (std::vector<Ipv4Address>::const_iterator i = nodeList.begin (); i != nodeList.end (); ++i)
+    {
+      if (Contains (*i))
+        {
+          return true;
+        }
+    }
+  return false;
+}
+
+void
+DsrBlackList::Purge ()
+{
+  if (!m_timeout.IsStrictlyPositive ())
+    {
+      return;
+    }
+  std::vector<Ipv4Address> expired;
+  for (EntryMap::const_iterator i = m_entries.begin (); i != m_entries.end (); ++i)
+    {
+      if (IsExpired (i->second))
+        {
+          expired.push_back (i->first);
+        }
+    }
+  for (std::vector<Ipv4Address>::const_iterator i = expired.begin (); i != expired.end (); ++i)
+    {
+      Remove (*i);
+    }
+}
+
+void
+DsrBlackList::Clear ()
+{
+  m_entries.clear ();
+}
+
+uint32_t
+DsrBlackList::GetSize () const
+{
+  return m_entries.size ();
+}
+
+uint32_t
+DsrBlackList::GetStrikes (Ipv4Address address) const
+{
+  EntryMap::const_iterator i = m_entries.find (address);
+  return i == m_entries.end () ? 0 : i->second.m_strikes;
+}
+
+} // namespace dsr
+} // namespace ns3
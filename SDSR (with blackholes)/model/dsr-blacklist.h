@@ -0,0 +1,145 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2026 The SDSR contributors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: The SDSR contributors, see the git history
+ */
+
+#ifndef DSR_BLACKLIST_H
+#define DSR_BLACKLIST_H
+
+#include <vector>
+#include <unordered_map>
+#include "ns3/callback.h"
+#include "ns3/ipv4-address.h"
+#include "ns3/nstime.h"
+
+namespace ns3 {
+namespace dsr {
+/**
+ * \ingroup dsr
+ * \brief Nodes suspected of dropping data, with O(1) membership checks
+ *
+ * A node stays listed for the timeout after it was added. Adding it again while listed
+ * counts as another strike and doubles its hold time, up to the maximum timeout, so
+ * repeat offenders are kept out longer. Expired entries are dropped when they are looked
+ * up or when a new node is added, whichever comes first.
+ */
+class DsrBlackList
+{
+public:
+  /**
+   * Callback signature for nodes entering or leaving the list.
+   *
+   * \param [in] address the node address
+   * \param [in] added true if the node was added, false if it was removed
+   */
+  typedef void (* TracedCallback)(Ipv4Address address, bool added);
+  /// Callback told about every change of the list
+  typedef Callback<void, Ipv4Address, bool> ChangeCallback;
+
+  DsrBlackList ();
+  ~DsrBlackList ();
+  /**
+   * \brief Set the callback told about every change of the list
+   * \param change the callback
+   */
+  void SetChangeCallback (ChangeCallback change);
+  /**
+   * \brief Set how long a node stays listed after its first strike
+   * \param timeout the hold time, zero to keep nodes listed forever
+   */
+  void SetTimeout (Time timeout);
+  /**
+   * \brief Get the hold time of a first strike
+   * \return the hold time
+   */
+  Time GetTimeout () const;
+  /**
+   * \brief Set the longest a repeat offender stays listed
+   * \param maxTimeout the cap of the hold time
+   */
+  void SetMaxTimeout (Time maxTimeout);
+  /**
+   * \brief Get the cap of the hold time
+   * \return the cap of the hold time
+   */
+  Time GetMaxTimeout () const;
+  /**
+   * \brief List a node, or give it another strike if it is listed already
+   * \param address the node address
+   */
+  void Add (Ipv4Address address);
+  /**
+   * \brief Take a node off the list
+   * \param address the node address
+   * \return true if the node was listed
+   */
+  bool Remove (Ipv4Address address);
+  /**
+   * \brief Check whether a node is listed
+   * \param address the node address
+   * \return true if the node is listed and its entry has not expired
+   */
+  bool Contains (Ipv4Address address);
+  /**
+   * \brief Check whether a route goes through a listed node
+   * \param nodeList the route
+   * \return true if any node of the route is listed
+   */
+  bool ContainsAny (std::vector<Ipv4Address> const & nodeList);
+  /// Drop the expired entries
+  void Purge ();
+  /// Drop all the entries without calling the change callback
+  void Clear ();
+  /**
+   * \brief Number of listed nodes, expired entries not yet purged included
+   * \return the number of entries
+   */
+  uint32_t GetSize () const;
+  /**
+   * \brief Number of strikes of a listed node
+   * \param address the node address
+   * \return the strikes, zero if the node is not listed
+   */
+  uint32_t GetStrikes (Ipv4Address address) const;
+
+private:
+  /// One listed node
+  struct Entry
+  {
+    Time m_expire;             ///< when the node leaves the list
+    uint32_t m_strikes;        ///< times the node was added while listed, plus one
+  };
+  typedef std::unordered_map<Ipv4Address, Entry, Ipv4AddressHash> EntryMap;
+
+  /**
+   * \brief Check whether an entry has expired
+   * \param entry the entry
+   * \return true if the entry has expired
+   */
+  bool IsExpired (Entry const & entry) const;
+
+  EntryMap m_entries;          ///< listed nodes
+  ChangeCallback m_change;     ///< told about changes
+  Time m_timeout;              ///< hold time of a first strike
+  Time m_maxTimeout;           ///< cap of the hold time
+};
+
+} // namespace dsr
+} // namespace ns3
+
+#endif /* DSR_BLACKLIST_H */
@@ -30,8 +30,6 @@
  */
 
 #include "dsr-errorbuff.h"
-#include <algorithm>
-#include <functional>
 #include "ns3/ipv4-route.h"
 #include "ns3/socket.h"
 #include "ns3/log.h"
@@ -53,31 +51,33 @@ bool
 DsrErrorBuffer::Enqueue (DsrErrorBuffEntry & entry)
 {
   Purge ();
-  for (std::vector<DsrErrorBuffEntry>::const_iterator i = m_errorBuffer.begin (); i
+  for (std::map<uint64_t, DsrErrorBuffEntry>::const_iterator i = m_errorBuffer.begin (); i
        != m_errorBuffer.end (); ++i)
     {
-      NS_LOG_INFO ("packet id " << i->GetPacket ()->GetUid () << " " << entry.GetPacket ()->GetUid () << " source " << i->GetSource () << " " << entry.GetSource ()
-                                << " next hop " << i->GetNextHop () << " " << entry.GetNextHop () << " dst " << i->GetDestination () << " " << entry.GetDestination ());
+      NS_LOG_INFO ("packet id " << i->second.GetPacket ()->GetUid () << " " << entry.GetPacket ()->GetUid () << " source " << i->second.GetSource () << " " << entry.GetSource ()
+                                << " next hop " << i->second.GetNextHop () << " " << entry.GetNextHop () << " dst " << i->second.GetDestination () << " " << entry.GetDestination ());
 
       /// \todo check the source and destination over here
-      if ((i->GetPacket ()->GetUid () == entry.GetPacket ()->GetUid ()) && (i->GetSource () == entry.GetSource ()) && (i->GetNextHop () == entry.GetSource ())
-          && (i->GetDestination () == entry.GetDestination ()))
+      if ((i->second.GetPacket ()->GetUid () == entry.GetPacket ()->GetUid ()) && (i->second.GetSource () == entry.GetSource ()) && (i->second.GetNextHop () == entry.GetSource ())
+          && (i->second.GetDestination () == entry.GetDestination ()))
         {
           return false;
         }
     }
 
   entry.SetExpireTime (m_errorBufferTimeout);     // Initialize the send buffer timeout
+  entry.SetSequence (m_expiry.Insert (Simulator::Now () + m_errorBufferTimeout));
   /*
    * Drop the most aged packet when buffer reaches to max
    */
   if (m_errorBuffer.size () >= m_maxLen)
     {
-      Drop (m_errorBuffer.front (), "Drop the most aged packet");         // Drop the most aged packet
-      m_errorBuffer.erase (m_errorBuffer.begin ());
+      Drop (m_errorBuffer.begin ()->second, "Drop the most aged packet");         // Drop the most aged packet
+      Remove (m_errorBuffer.begin ());
     }
   // enqueue the entry
-  m_errorBuffer.push_back (entry);
+  m_errorBuffer.insert (std::make_pair (entry.GetSequence (), entry));
+  m_byLink[Link (entry.GetSource (), entry.GetNextHop ())].insert (entry.GetSequence ());
   return true;
 }
 
@@ -86,23 +86,21 @@ DsrErrorBuffer::DropPacketForErrLink (Ipv4Address source, Ipv4Address nextHop)
 {
   NS_LOG_FUNCTION (this << source << nextHop);
   Purge ();
-  std::vector<Ipv4Address> list;
-  list.push_back (source);
-  list.push_back (nextHop);
-  const std::vector<Ipv4Address> link = list;
   /*
    * Drop the packet with the error link source----------nextHop
    */
-  for (std::vector<DsrErrorBuffEntry>::iterator i = m_errorBuffer.begin (); i
-       != m_errorBuffer.end (); ++i)
+  std::map<Link, std::set<uint64_t> >::iterator i = m_byLink.find (Link (source, nextHop));
+  if (i == m_byLink.end ())
     {
-      if (LinkEqual (*i, link))
-        {
-          DropLink (*i, "DropPacketForErrLink");
-        }
+      return;
+    }
+  std::set<uint64_t> group = i->second;    // Removing the entries changes the index
+  for (std::set<uint64_t>::const_iterator j = group.begin (); j != group.end (); ++j)
+    {
+      std::map<uint64_t, DsrErrorBuffEntry>::iterator k = m_errorBuffer.find (*j);
+      DropLink (k->second, "DropPacketForErrLink");
+      Remove (k);
     }
-  m_errorBuffer.erase (std::remove_if (m_errorBuffer.begin (), m_errorBuffer.end (),
-                                       std::bind2nd (std::ptr_fun (DsrErrorBuffer::LinkEqual), link)), m_errorBuffer.end ());
 }
 
 bool
@@ -112,12 +110,12 @@ DsrErrorBuffer::Dequeue (Ipv4Address dst, DsrErrorBuffEntry & entry)
   /*
    * Dequeue the entry with destination address dst
    */
-  for (std::vector<DsrErrorBuffEntry>::iterator i = m_errorBuffer.begin (); i != m_errorBuffer.end (); ++i)
+  for (std::map<uint64_t, DsrErrorBuffEntry>::iterator i = m_errorBuffer.begin (); i != m_errorBuffer.end (); ++i)
     {
-      if (i->GetDestination () == dst)
+      if (i->second.GetDestination () == dst)
         {
-          entry = *i;
-          i = m_errorBuffer.erase (i);
+          entry = i->second;
+          Remove (i);
           NS_LOG_DEBUG ("Packet size while dequeuing " << entry.GetPacket ()->GetSize ());
           return true;
         }
@@ -131,10 +129,10 @@ DsrErrorBuffer::Find (Ipv4Address dst)
   /*
    * Make sure if the send buffer contains entry with certain dst
    */
-  for (std::vector<DsrErrorBuffEntry>::const_iterator i = m_errorBuffer.begin (); i
+  for (std::map<uint64_t, DsrErrorBuffEntry>::const_iterator i = m_errorBuffer.begin (); i
        != m_errorBuffer.end (); ++i)
     {
-      if (i->GetDestination () == dst)
+      if (i->second.GetDestination () == dst)
         {
           NS_LOG_DEBUG ("Found the packet");
           return true;
@@ -143,35 +141,48 @@ DsrErrorBuffer::Find (Ipv4Address dst)
   return false;
 }
 
-struct IsExpired
+void
+DsrErrorBuffer::Remove (std::map<uint64_t, DsrErrorBuffEntry>::iterator i)
 {
-  bool
-  operator() (DsrErrorBuffEntry const & e) const
-  {
-    // NS_LOG_DEBUG("Expire time for packet in req queue: "<<e.GetExpireTime ());
-    return (e.GetExpireTime () < Seconds (0));
-  }
-};
+  std::map<Link, std::set<uint64_t> >::iterator j = m_byLink.find (Link (i->second.GetSource (), i->second.GetNextHop ()));
+  j->second.erase (i->first);
+  if (j->second.empty ())
+    {
+      m_byLink.erase (j);
+    }
+  m_errorBuffer.erase (i);
+}
 
 void
 DsrErrorBuffer::Purge ()
 {
   /*
-   * Purge the buffer to eliminate expired entries
+   * Take the due entries off the expiry index, the live entries are not touched
    */
+  if (!m_expiry.IsDue ())
+    {
+      return;
+    }
   NS_LOG_DEBUG ("The error buffer size " << m_errorBuffer.size ());
-  IsExpired pred;
-  for (std::vector<DsrErrorBuffEntry>::iterator i = m_errorBuffer.begin (); i
-       != m_errorBuffer.end (); ++i)
+  uint64_t sequence;
+  while (m_expiry.PopDue (sequence))
     {
-      if (pred (*i))
+      std::map<uint64_t, DsrErrorBuffEntry>::iterator i = m_errorBuffer.find (sequence);
+      if (i == m_errorBuffer.end ())
+        {
+          continue;   // The entry has already left the buffer
+        }
+      if (i->second.GetExpireTime () < Seconds (0))
         {
           NS_LOG_DEBUG ("Dropping Queue Packets");
-          Drop (*i, "Drop out-dated packet ");
+          Drop (i->second, "Drop out-dated packet ");
+          Remove (i);
+        }
+      else
+        {
+          m_expiry.Reinsert (Simulator::Now () + i->second.GetExpireTime (), sequence);
         }
     }
-  m_errorBuffer.erase (std::remove_if (m_errorBuffer.begin (), m_errorBuffer.end (), pred),
-                       m_errorBuffer.end ());
 }
 
 void
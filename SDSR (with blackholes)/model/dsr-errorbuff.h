@@ -32,9 +32,12 @@
 #ifndef DSR_ERRORBUFF_H
 #define DSR_ERRORBUFF_H
 
-#include <vector>
+#include <map>
+#include <set>
+#include <utility>
 #include "ns3/ipv4-routing-protocol.h"
 #include "ns3/simulator.h"
+#include "dsr-expiry-index.h"
 
 namespace ns3 {
 namespace dsr {
@@ -62,7 +65,8 @@ public:
       m_source (s),
       m_nextHop (n),
       m_expire (exp + Simulator::Now ()),
-      m_protocol (p)
+      m_protocol (p),
+      m_sequence (0)
   {
   }
   /**
@@ -116,6 +120,14 @@ public:
   {
     return m_expire - Simulator::Now ();
   }
+  void SetSequence (uint64_t sequence)
+  {
+    m_sequence = sequence;
+  }
+  uint64_t GetSequence () const
+  {
+    return m_sequence;
+  }
   void SetProtocol (uint8_t p)
   {
     m_protocol = p;
@@ -138,6 +150,8 @@ private:
   Time m_expire;
   /// The protocol number
   uint8_t m_protocol;
+  /// The sequence number given by the expiry index of the buffer
+  uint64_t m_sequence;
 };
 
 /**
@@ -183,16 +197,24 @@ public:
     m_errorBufferTimeout = t;
   }
 
-  std::vector<DsrErrorBuffEntry> & GetBuffer ()
+  std::map<uint64_t, DsrErrorBuffEntry> & GetBuffer ()
   {
     return m_errorBuffer;
   }
 
 private:
-  /// The send buffer to cache unsent packet
-  std::vector<DsrErrorBuffEntry> m_errorBuffer;
+  /// The source and next hop of a link
+  typedef std::pair<Ipv4Address, Ipv4Address> Link;
+  /// The send buffer to cache unsent packet, by sequence number so the oldest entry comes first
+  std::map<uint64_t, DsrErrorBuffEntry> m_errorBuffer;
+  /// The sequence numbers of the entries, by link
+  std::map<Link, std::set<uint64_t> > m_byLink;
+  /// The expire times of the entries
+  DsrExpiryIndex m_expiry;
   /// Remove all expired entries
   void Purge ();
+  /// Remove an entry from the buffer and the link index
+  void Remove (std::map<uint64_t, DsrErrorBuffEntry>::iterator i);
   /// Notify that packet is dropped from queue by timeout
   void Drop (DsrErrorBuffEntry en, std::string reason);
   /// Notify that packet is dropped from queue by timeout
@@ -201,11 +223,6 @@ private:
   uint32_t m_maxLen;
   /// The maximum period of time that a routing protocol is allowed to buffer a packet for, seconds.
   Time m_errorBufferTimeout;
-  /// Check if the send buffer entry is the same or not
-  static bool LinkEqual (DsrErrorBuffEntry en, const std::vector<Ipv4Address> link)
-  {
-    return ((en.GetSource () == link[0]) && (en.GetNextHop () == link[1]));
-  }
 };
 /*******************************************************************************************************************************/
 } // namespace dsr
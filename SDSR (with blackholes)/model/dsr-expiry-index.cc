@@ -0,0 +1,69 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2026 The SDSR contributors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: The SDSR contributors, see the git history
+ */
+
+#include "dsr-expiry-index.h"
+
+namespace ns3 {
+namespace dsr {
+
+DsrExpiryIndex::DsrExpiryIndex ()
+  : m_nextSequence (0)
+{
+}
+
+uint64_t
+DsrExpiryIndex::Insert (Time expire)
+{
+  uint64_t sequence = m_nextSequence++;
+  Reinsert (expire, sequence);
+  return sequence;
+}
+
+void
+DsrExpiryIndex::Reinsert (Time expire, uint64_t sequence)
+{
+  Item item;
+  item.m_expire = expire;
+  item.m_sequence = sequence;
+  m_heap.push_back (item);
+  std::push_heap (m_heap.begin (), m_heap.end (), Later ());
+}
+
+bool
+DsrExpiryIndex::PopDue (uint64_t & sequence)
+{
+  if (!IsDue ())
+    {
+      return false;
+    }
+  sequence = m_heap.front ().m_sequence;
+  std::pop_heap (m_heap.begin (), m_heap.end (), Later ());
+  m_heap.pop_back ();
+  return true;
+}
+
+void
+DsrExpiryIndex::Clear ()
+{
+  m_heap.clear ();
+}
+
+}  // namespace dsr
+}  // namespace ns3
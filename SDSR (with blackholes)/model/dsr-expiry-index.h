@@ -0,0 +1,105 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2026 The SDSR contributors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: The SDSR contributors, see the git history
+ */
+
+#ifndef DSR_EXPIRY_INDEX_H
+#define DSR_EXPIRY_INDEX_H
+
+#include <vector>
+#include <algorithm>
+#include "ns3/nstime.h"
+#include "ns3/simulator.h"
+
+namespace ns3 {
+namespace dsr {
+/**
+ * \ingroup dsr
+ * \brief Min-heap on the expire time of the entries of a DSR buffer
+ *
+ * Every entry gets a sequence number from the index when it is enqueued, and the buffers
+ * find their entries again by that number. Whether anything has expired is answered from
+ * the top of the heap, and a purge pops the due entries one by one, so the entries that
+ * are still live are never visited. Entries removed from a buffer by other means are left
+ * in the heap and skipped once they come up, entries whose expire time was pushed back are
+ * put back into the heap with the new time.
+ */
+class DsrExpiryIndex
+{
+public:
+  DsrExpiryIndex ();
+  /**
+   * \brief Remember when a new entry expires
+   * \param expire the absolute time the entry expires
+   * \return the sequence number of the entry, larger than any handed out before
+   */
+  uint64_t Insert (Time expire);
+  /**
+   * \brief Put an entry back with a later expire time
+   * \param expire the absolute time the entry now expires
+   * \param sequence the sequence number of the entry
+   */
+  void Reinsert (Time expire, uint64_t sequence);
+  /**
+   * \brief Check if an entry has expired by now
+   * \return true if the earliest expire time in the heap has passed
+   */
+  bool IsDue () const
+  {
+    return !m_heap.empty () && m_heap.front ().m_expire < Simulator::Now ();
+  }
+  /**
+   * \brief Take the earliest entry off the heap if it has expired
+   * \param sequence the sequence number of the entry
+   * \return true if an entry was due
+   */
+  bool PopDue (uint64_t & sequence);
+  /// Forget all the entries
+  void Clear ();
+  /**
+   * \brief Get the number of entries in the heap, stale ones included
+   * \return the heap size
+   */
+  uint32_t GetSize () const
+  {
+    return m_heap.size ();
+  }
+
+private:
+  /// One entry in the heap
+  struct Item
+  {
+    Time m_expire;                                      ///< The absolute time the entry expires
+    uint64_t m_sequence;                                ///< The sequence number of the entry
+  };
+  /// Heap order, the earliest expire time on top
+  struct Later
+  {
+    bool operator() (Item const & a, Item const & b) const
+    {
+      return a.m_expire > b.m_expire;
+    }
+  };
+  std::vector<Item> m_heap;                             ///< The binary heap
+  uint64_t m_nextSequence;                              ///< The sequence number of the next entry
+};
+
+}  // namespace dsr
+}  // namespace ns3
+
+#endif /* DSR_EXPIRY_INDEX_H */
@@ -29,6 +29,7 @@
  * US Department of Defense (DoD), and ITTC at The University of Kansas.
  */
 
+#include <algorithm>
 #include "ns3/assert.h"
 #include "ns3/log.h"
 #include "ns3/header.h"
@@ -42,6 +43,40 @@ namespace dsr {
 
 NS_OBJECT_ENSURE_REGISTERED (DsrFsHeader);
 
+const uint32_t DsrFsHeader::NO_ID;
+const uint8_t DsrFsHeader::WIDE_ID_FLAG;
+
+namespace {
+/// The node id carried by a compact header for NO_ID
+const uint16_t COMPACT_NO_ID = 0xffff;
+
+void
+WriteId (Buffer::Iterator &i, uint32_t id, bool wide)
+{
+  if (wide)
+    {
+      i.WriteU32 (id);
+    }
+  else
+    {
+      NS_ASSERT_MSG (id == DsrFsHeader::NO_ID || id < COMPACT_NO_ID,
+                     "Node id " << id << " does not fit a compact header, enable wide node ids");
+      i.WriteU16 (id == DsrFsHeader::NO_ID ? COMPACT_NO_ID : uint16_t (id));
+    }
+}
+
+uint32_t
+ReadId (Buffer::Iterator &i, bool wide)
+{
+  if (wide)
+    {
+      return i.ReadU32 ();
+    }
+  uint16_t id = i.ReadU16 ();
+  return id == COMPACT_NO_ID ? DsrFsHeader::NO_ID : id;
+}
+}
+
 TypeId DsrFsHeader::GetTypeId ()
 {
   static TypeId tid = TypeId ("ns3::dsr::DsrFsHeader")
@@ -63,6 +98,7 @@ DsrFsHeader::DsrFsHeader ()
     m_payloadLen (0),
     m_sourceId (0),
     m_destId (0),
+    m_wideIds (false),
     m_data (0)
 {
 }
@@ -101,26 +137,41 @@ uint16_t DsrFsHeader::GetPayloadLength () const
   return m_payloadLen;
 }
 
-void DsrFsHeader::SetSourceId (uint16_t sourceId)
+void DsrFsHeader::SetSourceId (uint32_t sourceId)
 {
   m_sourceId = sourceId;
 }
 
-uint16_t DsrFsHeader::GetSourceId () const
+uint32_t DsrFsHeader::GetSourceId () const
 {
   return m_sourceId;
 }
 
-void DsrFsHeader::SetDestId (uint16_t destId)
+void DsrFsHeader::SetDestId (uint32_t destId)
 {
   m_destId = destId;
 }
 
-uint16_t DsrFsHeader::GetDestId () const
+uint32_t DsrFsHeader::GetDestId () const
 {
   return m_destId;
 }
 
+void DsrFsHeader::SetWideIds (bool wide)
+{
+  m_wideIds = wide;
+}
+
+bool DsrFsHeader::IsWideIds () const
+{
+  return m_wideIds;
+}
+
+uint32_t DsrFsHeader::GetFixedSize () const
+{
+  return m_wideIds ? 12 : 8;
+}
+
 void DsrFsHeader::Print (std::ostream &os) const
 {
   os
@@ -131,7 +182,7 @@ void DsrFsHeader::Print (std::ostream &os) const
 
 uint32_t DsrFsHeader::GetSerializedSize () const
 {
-  return 8;
+  return GetFixedSize ();
 }
 
 void DsrFsHeader::Serialize (Buffer::Iterator start) const
@@ -139,9 +190,9 @@ void DsrFsHeader::Serialize (Buffer::Iterator start) const
   Buffer::Iterator i = start;
 
   i.WriteU8 (m_nextHeader);
-  i.WriteU8 (m_messageType);
-  i.WriteU16 (m_sourceId);
-  i.WriteU16 (m_destId);
+  i.WriteU8 (m_wideIds ? (m_messageType | WIDE_ID_FLAG) : m_messageType);
+  WriteId (i, m_sourceId, m_wideIds);
+  WriteId (i, m_destId, m_wideIds);
   i.WriteU16 (m_payloadLen);
 
   i.Write (m_data.PeekData (), m_data.GetSize ());
@@ -153,8 +204,10 @@ uint32_t DsrFsHeader::Deserialize (Buffer::Iterator start)
 
   m_nextHeader = i.ReadU8 ();
   m_messageType = i.ReadU8 ();
-  m_sourceId = i.ReadU16 ();
-  m_destId = i.ReadU16 ();
+  m_wideIds = (m_messageType & WIDE_ID_FLAG) != 0;
+  m_messageType &= ~WIDE_ID_FLAG;
+  m_sourceId = ReadId (i, m_wideIds);
+  m_destId = ReadId (i, m_wideIds);
   m_payloadLen = i.ReadU16 ();
 
   uint32_t dataLength = GetPayloadLength ();
@@ -255,6 +308,11 @@ uint32_t DsrOptionField::GetDsrOptionsOffset ()
   return m_optionsOffset;
 }
 
+void DsrOptionField::SetDsrOptionsOffset (uint32_t optionsOffset)
+{
+  m_optionsOffset = optionsOffset;
+}
+
 Buffer DsrOptionField::GetDsrOptionBuffer ()
 {
   return m_optionData;
@@ -285,6 +343,12 @@ DsrRoutingHeader::~DsrRoutingHeader ()
 {
 }
 
+void DsrRoutingHeader::SetWideIds (bool wide)
+{
+  DsrFsHeader::SetWideIds (wide);
+  SetDsrOptionsOffset (GetFixedSize ());
+}
+
 void DsrRoutingHeader::Print (std::ostream &os) const
 {
   os
@@ -295,8 +359,8 @@ void DsrRoutingHeader::Print (std::ostream &os) const
 
 uint32_t DsrRoutingHeader::GetSerializedSize () const
 {
-  // 8 bytes is the DsrFsHeader length
-  return 8 + DsrOptionField::GetSerializedSize ();
+  // 8 bytes is the DsrFsHeader length, 12 with wide node ids
+  return GetFixedSize () + DsrOptionField::GetSerializedSize ();
 }
 
 void DsrRoutingHeader::Serialize (Buffer::Iterator start) const
@@ -304,9 +368,9 @@ void DsrRoutingHeader::Serialize (Buffer::Iterator start) const
   Buffer::Iterator i = start;
 
   i.WriteU8 (GetNextHeader ());
-  i.WriteU8 (GetMessageType ());
-  i.WriteU16 (GetSourceId ());
-  i.WriteU16 (GetDestId ());
+  i.WriteU8 (IsWideIds () ? (GetMessageType () | WIDE_ID_FLAG) : GetMessageType ());
+  WriteId (i, GetSourceId (), IsWideIds ());
+  WriteId (i, GetDestId (), IsWideIds ());
   i.WriteU16 (GetPayloadLength ());
 
   DsrOptionField::Serialize (i);
@@ -317,9 +381,11 @@ uint32_t DsrRoutingHeader::Deserialize (Buffer::Iterator start)
   Buffer::Iterator i = start;
 
   SetNextHeader (i.ReadU8 ());
-  SetMessageType (i.ReadU8 ());
-  SetSourceId (i.ReadU16 ());
-  SetDestId (i.ReadU16 ());
+  uint8_t messageType = i.ReadU8 ();
+  SetWideIds ((messageType & WIDE_ID_FLAG) != 0);
+  SetMessageType (messageType & ~WIDE_ID_FLAG);
+  SetSourceId (ReadId (i, IsWideIds ()));
+  SetDestId (ReadId (i, IsWideIds ()));
   SetPayloadLength (i.ReadU16 ());
 
   DsrOptionField::Deserialize (i, GetPayloadLength ());
@@ -327,5 +393,111 @@ uint32_t DsrRoutingHeader::Deserialize (Buffer::Iterator start)
   return GetSerializedSize ();
 }
 
+NS_OBJECT_ENSURE_REGISTERED (DsrSRHeaderPatch);
+
+const uint32_t DsrSRHeaderPatch::SR_FIXED_SIZE;
+
+TypeId DsrSRHeaderPatch::GetTypeId ()
+{
+  static TypeId tid = TypeId ("ns3::DsrSRHeaderPatch")
+    .AddConstructor<DsrSRHeaderPatch> ()
+    .SetParent<Header> ()
+  ;
+  return tid;
+}
+
+TypeId DsrSRHeaderPatch::GetInstanceTypeId () const
+{
+  return GetTypeId ();
+}
+
+DsrSRHeaderPatch::DsrSRHeaderPatch ()
+  : m_optionOffset (8)
+{
+  std::fill (m_bytes, m_bytes + sizeof (m_bytes), 0);
+}
+
+DsrSRHeaderPatch::~DsrSRHeaderPatch ()
+{
+}
+
+void DsrSRHeaderPatch::SetSalvage (uint8_t salvage)
+{
+  m_bytes[m_optionOffset + SALVAGE_OFFSET] = salvage;
+}
+
+uint8_t DsrSRHeaderPatch::GetSalvage () const
+{
+  return m_bytes[m_optionOffset + SALVAGE_OFFSET];
+}
+
+void DsrSRHeaderPatch::SetSegmentsLeft (uint8_t segmentsLeft)
+{
+  m_bytes[m_optionOffset + SEGMENTS_LEFT_OFFSET] = segmentsLeft;
+}
+
+uint8_t DsrSRHeaderPatch::GetSegmentsLeft () const
+{
+  return m_bytes[m_optionOffset + SEGMENTS_LEFT_OFFSET];
+}
+
+void DsrSRHeaderPatch::SetAckFlag (uint8_t flag)
+{
+  m_bytes[m_optionOffset + ACK_FLAG_OFFSET] = flag;
+}
+
+uint8_t DsrSRHeaderPatch::GetAckFlag () const
+{
+  return m_bytes[m_optionOffset + ACK_FLAG_OFFSET];
+}
+
+void DsrSRHeaderPatch::SetSendCount (uint16_t sendCount)
+{
+  // Network byte order, as written by DsrOptionSRHeader
+  m_bytes[m_optionOffset + SEND_COUNT_OFFSET] = sendCount >> 8;
+  m_bytes[m_optionOffset + SEND_COUNT_OFFSET + 1] = sendCount & 0xff;
+}
+
+uint16_t DsrSRHeaderPatch::GetSendCount () const
+{
+  return (m_bytes[m_optionOffset + SEND_COUNT_OFFSET] << 8) | m_bytes[m_optionOffset + SEND_COUNT_OFFSET + 1];
+}
+
+uint8_t DsrSRHeaderPatch::GetNumberAddress () const
+{
+  // The option length counts two bytes besides the route
+  return (m_bytes[m_optionOffset + 1] - 2) / 4;
+}
+
+void DsrSRHeaderPatch::Print (std::ostream &os) const
+{
+  os
+  << " salvage: " << (uint32_t)GetSalvage () << " segmentsLeft: " << (uint32_t)GetSegmentsLeft ()
+  << " ackFlag: " << (uint32_t)GetAckFlag () << " sendCount: " << GetSendCount ();
+}
+
+uint32_t DsrSRHeaderPatch::GetSerializedSize () const
+{
+  return m_optionOffset + SR_FIXED_SIZE;
+}
+
+void DsrSRHeaderPatch::Serialize (Buffer::Iterator start) const
+{
+  start.Write (m_bytes, GetSerializedSize ());
+}
+
+uint32_t DsrSRHeaderPatch::Deserialize (Buffer::Iterator start)
+{
+  Buffer::Iterator i = start;
+
+  i.Next ();
+  // The wide id flag in the message type tells the size of the fixed header
+  m_optionOffset = (i.ReadU8 () & DsrFsHeader::WIDE_ID_FLAG) ? 12 : 8;
+  start.Read (m_bytes, GetSerializedSize ());
+  NS_ASSERT_MSG (m_bytes[m_optionOffset] == 96, "The first option is not a source route");
+
+  return GetSerializedSize ();
+}
+
 }  /* namespace dsr */
 }  /* namespace ns3 */
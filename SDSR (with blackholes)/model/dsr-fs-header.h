@@ -76,6 +76,26 @@ namespace dsr {
    +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
   \endverbatim
 */
+
+/**
+* \ingroup dsr
+* \brief The wide id version of the modified Dsr fixed size header Format,
+* flagged by the W bit of the message type. Source and destination ids are
+* 32 bits, for networks with more than 65535 nodes.
+  \verbatim
+   |      0        |      1        |      2        |      3        |
+   0 1 2 3 4 5 6 7 0 1 2 3 4 5 6 7 0 1 2 3 4 5 6 7 0 1 2 3 4 5 6 7
+   +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+   |  Next Header |W| Message Type  |       Payload Length       |
+   +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+   |                           Source Id                          |
+   +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+   |                            Dest Id                           |
+   +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+   |                            Options                           |
+   +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+  \endverbatim
+*/
 class DsrFsHeader : public Header
 {
 public:
@@ -89,6 +109,11 @@ public:
    * \return instance type ID
    */
   virtual TypeId GetInstanceTypeId () const;
+  /// Node id for "no node", e.g. the unknown destination of a route request
+  static const uint32_t NO_ID = 0xffffffff;
+  /// Flag in the message type byte marking 32 bit node ids
+  static const uint8_t WIDE_ID_FLAG = 0x80;
+
   /**
    * \brief Constructor.
    */
@@ -121,22 +146,40 @@ public:
    * brief Set the source ID of the header.
    * \param sourceId the source ID of the header
    */
-  void SetSourceId (uint16_t sourceId);
+  void SetSourceId (uint32_t sourceId);
   /**
    * brief Get the source ID of the header.
    * \return source ID the source ID of the header
    */
-  uint16_t GetSourceId () const;
+  uint32_t GetSourceId () const;
   /**
    * brief Set the dest ID of the header.
    * \param destId the destination ID of the header
    */
-  void SetDestId (uint16_t destId);
+  void SetDestId (uint32_t destId);
   /**
    * brief Get the dest ID of the header.
    * \return dest ID the dest ID of the header
    */
-  uint16_t GetDestId () const;
+  uint32_t GetDestId () const;
+  /**
+   * \brief Choose between 16 bit (compact) and 32 bit (wide) node ids.
+   *
+   * Compact ids keep the 8 bytes header and address up to 65535 nodes,
+   * 0xffff being NO_ID on the wire. Wide ids grow the header to 12 bytes.
+   * \param wide true for wide ids
+   */
+  void SetWideIds (bool wide);
+  /**
+   * \brief Whether the header carries 32 bit node ids.
+   * \return true for wide ids
+   */
+  bool IsWideIds () const;
+  /**
+   * \brief Get the size of the fixed part of the header.
+   * \return 8 with compact ids, 12 with wide ids
+   */
+  uint32_t GetFixedSize () const;
   /**
    * brief Set the payload length of the header.
    * \param length the payload length of the header in bytes
@@ -186,11 +229,15 @@ private:
   /**
    * \brief The source node id
    */
-  uint16_t m_sourceId;
+  uint32_t m_sourceId;
   /**
    * \brief The destination node id
    */
-  uint16_t m_destId;
+  uint32_t m_destId;
+  /**
+   * \brief Whether the node ids are 32 bits wide
+   */
+  bool m_wideIds;
   /**
    * \brief The data of the extension.
    */
@@ -253,6 +300,13 @@ public:
    */
   Buffer GetDsrOptionBuffer ();
 
+protected:
+  /**
+   * \brief Set the offset where the options begin.
+   * \param optionsOffset the offset from the start of the extension header
+   */
+  void SetDsrOptionsOffset (uint32_t optionsOffset);
+
 private:
   /**
    * \brief Calculate padding.
@@ -296,6 +350,13 @@ public:
    * \brief Destructor.
    */
   virtual ~DsrRoutingHeader ();
+  /**
+   * \brief Choose between compact and wide node ids, see DsrFsHeader::SetWideIds.
+   *
+   * Set this before adding options, the options offset follows the fixed size.
+   * \param wide true for wide ids
+   */
+  void SetWideIds (bool wide);
   /**
    * \brief Print some informations about the packet.
    * \param os output stream
@@ -326,6 +387,119 @@ static inline std::ostream & operator<< (std::ostream& os, const DsrRoutingHeade
   return os;
 }
 
+/**
+ * \class DsrSRHeaderPatch
+ * \brief The fixed fields of the source route option leading a DSR data packet
+ *
+ * Removing this header from a data packet takes the DSR fixed header and the fixed part of
+ * the source route option right after it; adding it back writes the same bytes with the
+ * changed fields. The route is neither decoded nor copied, so a retransmission can change
+ * the ack flag without rebuilding the DSR header.
+ */
+class DsrSRHeaderPatch : public Header
+{
+public:
+  /**
+   * \brief Get the type identificator.
+   * \return type identificator
+   */
+  static TypeId GetTypeId ();
+  /**
+   * \brief Get the instance type ID.
+   * \return instance type ID
+   */
+  virtual TypeId GetInstanceTypeId () const;
+  /**
+   * \brief Constructor.
+   */
+  DsrSRHeaderPatch ();
+  /**
+   * \brief Destructor.
+   */
+  virtual ~DsrSRHeaderPatch ();
+  /**
+   * \brief Set the salvage value of the source route option.
+   * \param salvage the salvage value
+   */
+  void SetSalvage (uint8_t salvage);
+  /**
+   * \brief Get the salvage value of the source route option.
+   * \return the salvage value
+   */
+  uint8_t GetSalvage () const;
+  /**
+   * \brief Set the segments left of the source route option.
+   * \param segmentsLeft the segments left
+   */
+  void SetSegmentsLeft (uint8_t segmentsLeft);
+  /**
+   * \brief Get the segments left of the source route option.
+   * \return the segments left
+   */
+  uint8_t GetSegmentsLeft () const;
+  /**
+   * \brief Set the ack flag of the source route option.
+   * \param flag 1 for one hop, 2 for two hop and 3 for end to end acks
+   */
+  void SetAckFlag (uint8_t flag);
+  /**
+   * \brief Get the ack flag of the source route option.
+   * \return the ack flag
+   */
+  uint8_t GetAckFlag () const;
+  /**
+   * \brief Set the send count of the source route option.
+   * \param sendCount the send count
+   */
+  void SetSendCount (uint16_t sendCount);
+  /**
+   * \brief Get the send count of the source route option.
+   * \return the send count
+   */
+  uint16_t GetSendCount () const;
+  /**
+   * \brief Get the number of addresses of the route that follows.
+   * \return the number of addresses
+   */
+  uint8_t GetNumberAddress () const;
+  /**
+   * \brief Print some informations about the packet.
+   * \param os output stream
+   */
+  virtual void Print (std::ostream &os) const;
+  /**
+   * \brief Get the serialized size, known once the header was deserialized.
+   * \return size
+   */
+  virtual uint32_t GetSerializedSize () const;
+  /**
+   * \brief Serialize the packet.
+   * \param start Buffer iterator
+   */
+  virtual void Serialize (Buffer::Iterator start) const;
+  /**
+   * \brief Deserialize the packet.
+   * \param start Buffer iterator
+   * \return size of the packet
+   */
+  virtual uint32_t Deserialize (Buffer::Iterator start);
+
+  /// Size of the source route option before the route
+  static const uint32_t SR_FIXED_SIZE = 15;
+
+private:
+  /// Offsets of the patched fields in the source route option
+  enum
+  {
+    SALVAGE_OFFSET = 10,
+    SEGMENTS_LEFT_OFFSET = 11,
+    ACK_FLAG_OFFSET = 12,
+    SEND_COUNT_OFFSET = 13
+  };
+  uint8_t m_bytes[12 + SR_FIXED_SIZE];   ///< the raw bytes, fixed header first
+  uint32_t m_optionOffset;               ///< size of the fixed header
+};
+
 }  // namespace dsr
 }  // namespace ns3
 
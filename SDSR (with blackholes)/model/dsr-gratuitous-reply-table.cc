@@ -64,13 +64,13 @@ bool
 DsrGraReply::FindAndUpdate (Ipv4Address replyTo, Ipv4Address replyFrom, Time gratReplyHoldoff)
 {
   Purge ();  // purge the gratuitous reply table
-  for (std::vector<GraReplyEntry>::iterator i = m_graReply.begin ();
+  for (std::map<uint64_t, GraReplyEntry>::iterator i = m_graReply.begin ();
        i != m_graReply.end (); ++i)
     {
-      if ((i->m_replyTo == replyTo) && (i->m_hearFrom == replyFrom))
+      if ((i->second.m_replyTo == replyTo) && (i->second.m_hearFrom == replyFrom))
         {
           NS_LOG_DEBUG ("Update the reply to ip address if found the gratuitous reply entry");
-          i->m_gratReplyHoldoff = std::max (gratReplyHoldoff + Simulator::Now (), i->m_gratReplyHoldoff);
+          i->second.m_gratReplyHoldoff = std::max (gratReplyHoldoff + Simulator::Now (), i->second.m_gratReplyHoldoff);
           return true;
         }
     }
@@ -80,7 +80,8 @@ DsrGraReply::FindAndUpdate (Ipv4Address replyTo, Ipv4Address replyFrom, Time gra
 bool
 DsrGraReply::AddEntry (GraReplyEntry & graTableEntry)
 {
-  m_graReply.push_back (graTableEntry);
+  graTableEntry.m_sequence = m_expiry.Insert (graTableEntry.m_gratReplyHoldoff);
+  m_graReply.insert (std::make_pair (graTableEntry.m_sequence, graTableEntry));
   return true;
 }
 
@@ -88,10 +89,25 @@ void
 DsrGraReply::Purge ()
 {
   /*
-   * Purge the expired gratuitous reply entries
+   * Purge the expired gratuitous reply entries, only the entries taken off the expiry index are looked at
    */
-  m_graReply.erase (remove_if (m_graReply.begin (), m_graReply.end (),
-                               IsExpired ()), m_graReply.end ());
+  uint64_t sequence;
+  while (m_expiry.PopDue (sequence))
+    {
+      std::map<uint64_t, GraReplyEntry>::iterator i = m_graReply.find (sequence);
+      if (i == m_graReply.end ())
+        {
+          continue;   // The table has been cleared since
+        }
+      if (IsExpired () (i->second))
+        {
+          m_graReply.erase (i);
+        }
+      else
+        {
+          m_expiry.Reinsert (i->second.m_gratReplyHoldoff, sequence);   // The holdoff has been extended
+        }
+    }
 }
 
 } // namespace dsr
@@ -36,7 +36,8 @@
 #include "ns3/timer.h"
 #include "ns3/ipv4-address.h"
 #include "ns3/callback.h"
-#include <vector>
+#include <map>
+#include "dsr-expiry-index.h"
 
 namespace ns3 {
 namespace dsr {
@@ -50,13 +51,25 @@ struct GraReplyEntry
   Ipv4Address m_replyTo;
   Ipv4Address m_hearFrom;
   Time m_gratReplyHoldoff;
+  uint64_t m_sequence;
 
   GraReplyEntry (Ipv4Address t, Ipv4Address f, Time h)
     : m_replyTo (t),
       m_hearFrom (f),
-      m_gratReplyHoldoff (h)
+      m_gratReplyHoldoff (h),
+      m_sequence (0)
   {
   }
+  /// The time left until the entry expires, for the expiry index
+  Time GetExpireTime () const
+  {
+    return m_gratReplyHoldoff - Simulator::Now ();
+  }
+  /// The sequence number given by the expiry index
+  uint64_t GetSequence () const
+  {
+    return m_sequence;
+  }
 };
 /**
  * \ingroup dsr
@@ -91,11 +104,14 @@ public:
   void Clear ()
   {
     m_graReply.clear ();
+    m_expiry.Clear ();
   }
 
 private:
-  /// Vector of entries
-  std::vector<GraReplyEntry> m_graReply;
+  /// The entries, by sequence number
+  std::map<uint64_t, GraReplyEntry> m_graReply;
+  /// The expire times of the entries
+  DsrExpiryIndex m_expiry;
   /// The max # of gratuitous reply entries to hold
   uint32_t GraReplyTableSize;
 
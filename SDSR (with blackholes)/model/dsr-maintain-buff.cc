@@ -42,6 +42,24 @@ NS_LOG_COMPONENT_DEFINE ("DsrMaintainBuffer");
   
 namespace dsr {
 
+const uint64_t DsrMaintainBuffer::NONE;
+
+namespace {
+/// Take a sequence number out of an index, dropping the key once no entry is left with it
+template <typename Index, typename Key>
+void
+EraseSequence (Index & index, Key const & key, uint64_t sequence)
+{
+  typename Index::iterator i = index.find (key);
+  NS_ASSERT (i != index.end ());
+  i->second.erase (sequence);
+  if (i->second.empty ())
+    {
+      index.erase (i);
+    }
+}
+}
+
 uint32_t
 DsrMaintainBuffer::GetSize ()
 {
@@ -53,29 +71,22 @@ bool
 DsrMaintainBuffer::Enqueue (DsrMaintainBuffEntry & entry)
 {
   Purge ();
-  for (std::vector<DsrMaintainBuffEntry>::const_iterator i = m_maintainBuffer.begin (); i
-       != m_maintainBuffer.end (); ++i)
+  if (FindSame (entry) != NONE)
     {
-//      NS_LOG_INFO ("nexthop " << i->GetNextHop () << " " << entry.GetNextHop () << " our add " << i->GetOurAdd () << " " << entry.GetOurAdd ()
-//                              << " src " << i->GetSrc () << " " << entry.GetSrc () << " dst " << i->GetDst () << " " << entry.GetDst ()
-//                              << " ackId " << i->GetAckId () << " " << entry.GetAckId () << " SegsLeft " << (uint32_t)i->GetSegsLeft () << " " << (uint32_t)entry.GetSegsLeft ()
-//                   );
-
-      if ((i->GetNextHop () == entry.GetNextHop ()) && (i->GetOurAdd () == entry.GetOurAdd ()) && (i->GetSrc () == entry.GetSrc ())
-          && (i->GetDst () == entry.GetDst ()) && (i->GetAckId () == entry.GetAckId ()) && (i->GetSegsLeft () == entry.GetSegsLeft ()))
-        {
-          NS_LOG_DEBUG ("Same maintenance entry found");
-          return false;
-        }
+      NS_LOG_DEBUG ("Same maintenance entry found");
+      return false;
     }
 
   entry.SetExpireTime (m_maintainBufferTimeout);
+  entry.SetSequence (m_expiry.Insert (Simulator::Now () + m_maintainBufferTimeout));
   if (m_maintainBuffer.size () >= m_maxLen)
     {
       NS_LOG_DEBUG ("Drop the most aged packet");
-      m_maintainBuffer.erase (m_maintainBuffer.begin ());        // Drop the most aged packet
+      RemoveOldest ();        // Drop the most aged packet
     }
-  m_maintainBuffer.push_back (entry);
+  m_maintainBuffer.insert (std::make_pair (entry.GetSequence (), entry));
+  m_order.push_back (entry.GetSequence ());
+  Index (entry);
   return true;
 }
 
@@ -85,38 +96,41 @@ DsrMaintainBuffer::DropPacketWithNextHop (Ipv4Address nextHop)
   NS_LOG_FUNCTION (this << nextHop);
   Purge ();
   NS_LOG_INFO ("Drop Packet With next hop " << nextHop);
-  m_maintainBuffer.erase (std::remove_if (m_maintainBuffer.begin (), m_maintainBuffer.end (),
-                                          std::bind2nd (std::ptr_fun (DsrMaintainBuffer::IsEqual), nextHop)), m_maintainBuffer.end ());
+  std::unordered_map<Ipv4Address, Sequences, Ipv4AddressHash>::iterator i = m_byNextHop.find (nextHop);
+  if (i == m_byNextHop.end ())
+    {
+      return;
+    }
+  Sequences group = i->second;    // Removing the entries changes the index
+  for (Sequences::const_iterator j = group.begin (); j != group.end (); ++j)
+    {
+      Remove (m_maintainBuffer.find (*j));
+    }
 }
 
 bool
 DsrMaintainBuffer::Dequeue (Ipv4Address nextHop, DsrMaintainBuffEntry & entry)
 {
   Purge ();
-  for (std::vector<DsrMaintainBuffEntry>::iterator i = m_maintainBuffer.begin (); i != m_maintainBuffer.end (); ++i)
+  std::unordered_map<Ipv4Address, Sequences, Ipv4AddressHash>::const_iterator i = m_byNextHop.find (nextHop);
+  if (i == m_byNextHop.end ())
     {
-      if (i->GetNextHop () == nextHop)
-        {
-          entry = *i;
-          i = m_maintainBuffer.erase (i);
-          NS_LOG_DEBUG ("Packet size while dequeuing " << entry.GetPacket ()->GetSize ());
-          return true;
-        }
+      return false;
     }
-  return false;
+  std::unordered_map<uint64_t, DsrMaintainBuffEntry>::iterator j = m_maintainBuffer.find (*i->second.begin ());
+  entry = j->second;
+  Remove (j);
+  NS_LOG_DEBUG ("Packet size while dequeuing " << entry.GetPacket ()->GetSize ());
+  return true;
 }
 
 bool
 DsrMaintainBuffer::Find (Ipv4Address nextHop)
 {
-  for (std::vector<DsrMaintainBuffEntry>::const_iterator i = m_maintainBuffer.begin (); i
-       != m_maintainBuffer.end (); ++i)
+  if (m_byNextHop.find (nextHop) != m_byNextHop.end ())
     {
-      if (i->GetNextHop () == nextHop)
-        {
-          NS_LOG_DEBUG ("Found the packet in maintenance buffer");
-          return true;
-        }
+      NS_LOG_DEBUG ("Found the packet in maintenance buffer");
+      return true;
     }
   return false;
 }
@@ -124,108 +138,193 @@ DsrMaintainBuffer::Find (Ipv4Address nextHop)
 bool
 DsrMaintainBuffer::AllEqual (DsrMaintainBuffEntry & entry)
 {
-  for (std::vector<DsrMaintainBuffEntry>::iterator i = m_maintainBuffer.begin (); i
-       != m_maintainBuffer.end (); ++i)
+  uint64_t sequence = FindSame (entry);
+  if (sequence == NONE)
     {
-//      NS_LOG_DEBUG ("nexthop " << i->GetNextHop () << " " << entry.GetNextHop () << " our address " << i->GetOurAdd () << " " << entry.GetOurAdd ()
-//                               << " src " << i->GetSrc () << " " << entry.GetSrc () << " dst " << i->GetDst () << " " << entry.GetDst ()
-//                               << " ackId " << i->GetAckId () << " " << entry.GetAckId ());
-
-      if ((i->GetOurAdd () == entry.GetOurAdd ()) && (i->GetNextHop () == entry.GetNextHop ())
-          && (i->GetSrc () == entry.GetSrc ()) && (i->GetDst () == entry.GetDst ())
-          && (i->GetAckId () == entry.GetAckId ()) && (i->GetSegsLeft () == entry.GetSegsLeft ()))
-        {
-          i = m_maintainBuffer.erase (i);   // Erase the same maintain buffer entry for the received packet
-          return true;
-        }
+      return false;
     }
-  return false;
+  Remove (m_maintainBuffer.find (sequence));   // Erase the same maintain buffer entry for the received packet
+  return true;
 }
 
 bool
 DsrMaintainBuffer::NetworkEqual (DsrMaintainBuffEntry & entry)
 {
-  for (std::vector<DsrMaintainBuffEntry>::iterator i = m_maintainBuffer.begin (); i
-       != m_maintainBuffer.end (); ++i)
+  std::unordered_map<NetworkKey, Sequences, NetworkKeyHash>::const_iterator i = m_byNetwork.find (GetNetworkKey (entry));
+  if (i == m_byNetwork.end ())
     {
-//      NS_LOG_DEBUG ("nexthop " << i->GetNextHop () << " " << entry.GetNextHop () << " our address " << i->GetOurAdd () << " " << entry.GetOurAdd ()
-//                               << " src " << i->GetSrc () << " " << entry.GetSrc () << " dst " << i->GetDst () << " " << entry.GetDst ()
-//                               << " ackId " << i->GetAckId () << " " << entry.GetAckId ());
-
-      if ((i->GetOurAdd () == entry.GetOurAdd ()) && (i->GetNextHop () == entry.GetNextHop ())
-          && (i->GetSrc () == entry.GetSrc ()) && (i->GetDst () == entry.GetDst ())
-          && (i->GetAckId () == entry.GetAckId ()))
-        {
-          i = m_maintainBuffer.erase (i);   // Erase the same maintain buffer entry for the received packet
-          return true;
-        }
+      return false;
     }
-  return false;
+  RemoveFirst (i->second);   // Erase the same maintain buffer entry for the received packet
+  return true;
 }
 
 bool
 DsrMaintainBuffer::PromiscEqual (DsrMaintainBuffEntry & entry)
 {
   NS_LOG_DEBUG ("The maintenance buffer size " << m_maintainBuffer.size ());
-  for (std::vector<DsrMaintainBuffEntry>::iterator i = m_maintainBuffer.begin (); i
-       != m_maintainBuffer.end (); ++i)
+  std::unordered_map<PassiveKey, Sequences, PassiveKeyHash>::const_iterator i = m_byPassive.find (GetPassiveKey (entry));
+  if (i == m_byPassive.end ())
     {
-//      NS_LOG_DEBUG ("src " << i->GetSrc () << " " << entry.GetSrc () << " dst " << i->GetDst () << " " << entry.GetDst ()
-//                           << " SegsLeft " << (uint32_t)i->GetSegsLeft () << " " << (uint32_t)entry.GetSegsLeft () << " ackId " << (uint32_t)i->GetAckId () << " "
-//                           << (uint32_t)entry.GetAckId ()
-//                    );
-
-      if ((i->GetSrc () == entry.GetSrc ()) && (i->GetDst () == entry.GetDst ())
-          && (i->GetSegsLeft () == entry.GetSegsLeft ()) && (i->GetAckId () == entry.GetAckId ())
-          )
-        {
-          i = m_maintainBuffer.erase (i);   // Erase the same maintain buffer entry for the promisc received packet
-          return true;
-        }
+      return false;
     }
-  return false;
+  RemoveFirst (i->second);   // Erase the same maintain buffer entry for the promisc received packet
+  return true;
 }
 
 bool
 DsrMaintainBuffer::LinkEqual (DsrMaintainBuffEntry & entry)
 {
   NS_LOG_DEBUG ("The maintenance buffer size " << m_maintainBuffer.size ());
-  for (std::vector<DsrMaintainBuffEntry>::iterator i = m_maintainBuffer.begin (); i
-       != m_maintainBuffer.end (); ++i)
+  std::unordered_map<LinkKey, Sequences, LinkKeyHash>::const_iterator i = m_byLink.find (GetLinkKey (entry));
+  if (i == m_byLink.end ())
     {
-//      NS_LOG_DEBUG ("src " << i->GetSrc () << " " << entry.GetSrc () << " dst " << i->GetDst () << " " << entry.GetDst ()
-//                           << " OurAddress " << i->GetOurAdd () << " " << entry.GetOurAdd () << " next hop " << i->GetNextHop () << " "
-//                           << entry.GetNextHop ()
-//                    );
+      return false;
+    }
+  RemoveFirst (i->second);   // Erase the same maintain buffer entry for the link acked packet
+  return true;
+}
 
-      if ((i->GetSrc () == entry.GetSrc ()) && (i->GetDst () == entry.GetDst ()) && (i->GetOurAdd () == entry.GetOurAdd ())
-          && (i->GetNextHop () == entry.GetNextHop ())
-          )
+uint64_t
+DsrMaintainBuffer::FindSame (DsrMaintainBuffEntry const & entry) const
+{
+  std::unordered_map<NetworkKey, Sequences, NetworkKeyHash>::const_iterator i = m_byNetwork.find (GetNetworkKey (entry));
+  if (i == m_byNetwork.end ())
+    {
+      return NONE;
+    }
+  /*
+   * The network key covers every field but the segments left
+   */
+  for (Sequences::const_iterator j = i->second.begin (); j != i->second.end (); ++j)
+    {
+      if (m_maintainBuffer.find (*j)->second.GetSegsLeft () == entry.GetSegsLeft ())
         {
-          i = m_maintainBuffer.erase (i);   // Erase the same maintain buffer entry for the promisc received packet
-          return true;
+          return *j;
         }
     }
-  return false;
+  return NONE;
+}
+
+void
+DsrMaintainBuffer::RemoveFirst (Sequences const & group)
+{
+  Remove (m_maintainBuffer.find (*group.begin ()));
+}
+
+void
+DsrMaintainBuffer::RemoveOldest ()
+{
+  while (!m_order.empty ())
+    {
+      std::unordered_map<uint64_t, DsrMaintainBuffEntry>::iterator i = m_maintainBuffer.find (m_order.front ());
+      m_order.pop_front ();
+      if (i != m_maintainBuffer.end ())
+        {
+          Remove (i);
+          return;
+        }
+    }
+}
+
+void
+DsrMaintainBuffer::Index (DsrMaintainBuffEntry const & entry)
+{
+  uint64_t sequence = entry.GetSequence ();
+  m_byNextHop[entry.GetNextHop ()].insert (sequence);
+  m_byLink[GetLinkKey (entry)].insert (sequence);
+  m_byNetwork[GetNetworkKey (entry)].insert (sequence);
+  m_byPassive[GetPassiveKey (entry)].insert (sequence);
+}
+
+void
+DsrMaintainBuffer::Remove (std::unordered_map<uint64_t, DsrMaintainBuffEntry>::iterator i)
+{
+  NS_ASSERT (i != m_maintainBuffer.end ());
+  DsrMaintainBuffEntry const & entry = i->second;
+  uint64_t sequence = i->first;
+  EraseSequence (m_byNextHop, entry.GetNextHop (), sequence);
+  EraseSequence (m_byLink, GetLinkKey (entry), sequence);
+  EraseSequence (m_byNetwork, GetNetworkKey (entry), sequence);
+  EraseSequence (m_byPassive, GetPassiveKey (entry), sequence);
+  m_maintainBuffer.erase (i);
+  /*
+   * Entries acked out of order leave their sequence numbers behind in m_order,
+   * drop those once they outnumber the live entries
+   */
+  if (m_order.size () > 2 * m_maintainBuffer.size () + 32)
+    {
+      std::deque<uint64_t> order;
+      for (std::deque<uint64_t>::const_iterator j = m_order.begin (); j != m_order.end (); ++j)
+        {
+          if (m_maintainBuffer.find (*j) != m_maintainBuffer.end ())
+            {
+              order.push_back (*j);
+            }
+        }
+      m_order.swap (order);
+    }
 }
 
-struct IsExpired
+LinkKey
+DsrMaintainBuffer::GetLinkKey (DsrMaintainBuffEntry const & entry)
 {
-  bool
-  operator() (DsrMaintainBuffEntry const & e) const
-  {
-    // NS_LOG_DEBUG("Expire time for packet in req queue: "<<e.GetExpireTime ());
-    return (e.GetExpireTime () < Seconds (0));
-  }
-};
+  LinkKey key;
+  key.m_source = entry.GetSrc ();
+  key.m_destination = entry.GetDst ();
+  key.m_ourAdd = entry.GetOurAdd ();
+  key.m_nextHop = entry.GetNextHop ();
+  return key;
+}
+
+NetworkKey
+DsrMaintainBuffer::GetNetworkKey (DsrMaintainBuffEntry const & entry)
+{
+  NetworkKey key;
+  key.m_ackId = entry.GetAckId ();
+  key.m_ourAdd = entry.GetOurAdd ();
+  key.m_nextHop = entry.GetNextHop ();
+  key.m_source = entry.GetSrc ();
+  key.m_destination = entry.GetDst ();
+  return key;
+}
+
+PassiveKey
+DsrMaintainBuffer::GetPassiveKey (DsrMaintainBuffEntry const & entry)
+{
+  PassiveKey key;
+  key.m_ackId = entry.GetAckId ();
+  key.m_source = entry.GetSrc ();
+  key.m_destination = entry.GetDst ();
+  key.m_segsLeft = entry.GetSegsLeft ();
+  return key;
+}
 
 void
 DsrMaintainBuffer::Purge ()
 {
+  if (!m_expiry.IsDue ())
+    {
+      return;   // Nothing has expired since the last purge
+    }
   NS_LOG_DEBUG ("Purging Maintenance Buffer");
-  IsExpired pred;
-  m_maintainBuffer.erase (std::remove_if (m_maintainBuffer.begin (), m_maintainBuffer.end (), pred),
-                          m_maintainBuffer.end ());
+  uint64_t sequence;
+  while (m_expiry.PopDue (sequence))
+    {
+      std::unordered_map<uint64_t, DsrMaintainBuffEntry>::iterator i = m_maintainBuffer.find (sequence);
+      if (i == m_maintainBuffer.end ())
+        {
+          continue;   // The entry has already been acked or dropped
+        }
+      if (i->second.GetExpireTime () < Seconds (0))
+        {
+          Remove (i);
+        }
+      else
+        {
+          m_expiry.Reinsert (Simulator::Now () + i->second.GetExpireTime (), sequence);
+        }
+    }
 }
 
 }  // namespace dsr
@@ -33,8 +33,12 @@
 #define DSR_MAINTAIN_BUFF_H
 
 #include <vector>
+#include <deque>
+#include <set>
+#include <unordered_map>
 #include "ns3/ipv4-routing-protocol.h"
 #include "ns3/simulator.h"
+#include "dsr-expiry-index.h"
 #include "ns3/ipv4-header.h"
 #include "dsr-option-header.h"
 
@@ -68,6 +72,16 @@ struct LinkKey
       if (o.m_nextHop < m_nextHop) return false;
       return false;
   }
+  /**
+   * Compare maintain Buffer entries
+   * \param o
+   * \return true if all the fields are equal
+   */
+  bool operator == (const LinkKey & o) const
+  {
+    return (m_source == o.m_source) && (m_destination == o.m_destination)
+           && (m_ourAdd == o.m_ourAdd) && (m_nextHop == o.m_nextHop);
+  }
 };
 
 struct NetworkKey
@@ -97,6 +111,16 @@ struct NetworkKey
       if (o.m_nextHop < m_nextHop) return false;
       return false;
   }
+  /**
+   * Compare maintain Buffer entries
+   * \param o
+   * \return true if all the fields are equal
+   */
+  bool operator == (const NetworkKey & o) const
+  {
+    return (m_ackId == o.m_ackId) && (m_source == o.m_source) && (m_destination == o.m_destination)
+           && (m_ourAdd == o.m_ourAdd) && (m_nextHop == o.m_nextHop);
+  }
 };
 
 struct PassiveKey
@@ -123,6 +147,56 @@ struct PassiveKey
       if (o.m_segsLeft < m_segsLeft) return false;
       return false;
   }
+  /**
+   * Compare maintain Buffer entries
+   * \param o
+   * \return true if all the fields are equal
+   */
+  bool operator == (const PassiveKey & o) const
+  {
+    return (m_ackId == o.m_ackId) && (m_source == o.m_source) && (m_destination == o.m_destination)
+           && (m_segsLeft == o.m_segsLeft);
+  }
+};
+/**
+ * Hash of a LinkKey, for the indices of the maintain buffer
+ */
+struct LinkKeyHash
+{
+  size_t operator () (const LinkKey & k) const
+  {
+    size_t h = k.m_source.Get ();
+    h = h * 31 + k.m_destination.Get ();
+    h = h * 31 + k.m_ourAdd.Get ();
+    return h * 31 + k.m_nextHop.Get ();
+  }
+};
+/**
+ * Hash of a NetworkKey, for the indices of the maintain buffer
+ */
+struct NetworkKeyHash
+{
+  size_t operator () (const NetworkKey & k) const
+  {
+    size_t h = k.m_ackId;
+    h = h * 31 + k.m_source.Get ();
+    h = h * 31 + k.m_destination.Get ();
+    h = h * 31 + k.m_ourAdd.Get ();
+    return h * 31 + k.m_nextHop.Get ();
+  }
+};
+/**
+ * Hash of a PassiveKey, for the indices of the maintain buffer
+ */
+struct PassiveKeyHash
+{
+  size_t operator () (const PassiveKey & k) const
+  {
+    size_t h = k.m_ackId;
+    h = h * 31 + k.m_source.Get ();
+    h = h * 31 + k.m_destination.Get ();
+    return h * 31 + k.m_segsLeft;
+  }
 };
 
 /**
@@ -154,7 +228,8 @@ public:
       m_dst (dst),
       m_ackId (ackId),
       m_segsLeft (segs),
-      m_expire (exp + Simulator::Now ())
+      m_expire (exp + Simulator::Now ()),
+      m_sequence (0)
   {
   }
 
@@ -223,6 +298,14 @@ public:
   {
     return m_expire - Simulator::Now ();
   }
+  void SetSequence (uint64_t sequence)
+  {
+    m_sequence = sequence;
+  }
+  uint64_t GetSequence () const
+  {
+    return m_sequence;
+  }
 
 private:
   /// Data packet
@@ -241,6 +324,8 @@ private:
   uint8_t m_segsLeft;
   /// Expire time for queue entry
   Time m_expire;
+  /// The sequence number given by the expiry index of the buffer
+  uint64_t m_sequence;
 };
 /**
  * \ingroup dsr
@@ -294,20 +379,50 @@ public:
   bool PromiscEqual (DsrMaintainBuffEntry & entry);
 
 private:
-  /// The vector of maintain buffer entries
-  std::vector<DsrMaintainBuffEntry> m_maintainBuffer;
+  /// The sequence numbers of the entries sharing a key, oldest first
+  typedef std::set<uint64_t> Sequences;
+  /// The map of maintain buffer entries, keyed by the sequence number given on enqueue
+  std::unordered_map<uint64_t, DsrMaintainBuffEntry> m_maintainBuffer;
+  /// The sequence numbers in enqueue order, the ones of entries removed since are skipped
+  std::deque<uint64_t> m_order;
+  /// The entries of each next hop
+  std::unordered_map<Ipv4Address, Sequences, Ipv4AddressHash> m_byNextHop;
+  /// The entries of each link, for link acks
+  std::unordered_map<LinkKey, Sequences, LinkKeyHash> m_byLink;
+  /// The entries of each network key, for network acks and duplicate checks
+  std::unordered_map<NetworkKey, Sequences, NetworkKeyHash> m_byNetwork;
+  /// The entries of each passive key, for promiscuous acks
+  std::unordered_map<PassiveKey, Sequences, PassiveKeyHash> m_byPassive;
+  /// The expire times of the entries
+  DsrExpiryIndex m_expiry;
   std::vector<NetworkKey> m_allNetworkKey;
   /// Remove all expired entries
   void Purge ();
+  /// Add an entry to the indices
+  void Index (DsrMaintainBuffEntry const & entry);
+  /// Remove an entry from the buffer and the indices
+  void Remove (std::unordered_map<uint64_t, DsrMaintainBuffEntry>::iterator i);
+  /// Remove the oldest entry still in the buffer
+  void RemoveOldest ();
+  /**
+   * \brief Remove the oldest entry of a group
+   * \param group the entries sharing a key
+   */
+  void RemoveFirst (Sequences const & group);
+  /// Find the oldest entry of a network key that also has the same segments left field
+  uint64_t FindSame (DsrMaintainBuffEntry const & entry) const;
+  /// Get the link key of an entry
+  static LinkKey GetLinkKey (DsrMaintainBuffEntry const & entry);
+  /// Get the network key of an entry
+  static NetworkKey GetNetworkKey (DsrMaintainBuffEntry const & entry);
+  /// Get the passive key of an entry
+  static PassiveKey GetPassiveKey (DsrMaintainBuffEntry const & entry);
+  /// Returned by FindSame when there is no such entry
+  static const uint64_t NONE = ~uint64_t (0);
   /// The maximum number of packets that we allow a routing protocol to buffer.
   uint32_t m_maxLen;
   /// The maximum period of time that a routing protocol is allowed to buffer a packet for, seconds.
   Time m_maintainBufferTimeout;
-  /// Verify if the maintain buffer is equal or not
-  static bool IsEqual (DsrMaintainBuffEntry en, const Ipv4Address nextHop)
-  {
-    return (en.GetNextHop () == nextHop);
-  }
 };
 /*******************************************************************************************************************************/
 } // namespace dsr
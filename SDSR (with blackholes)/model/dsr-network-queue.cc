@@ -173,20 +173,21 @@ DsrNetworkQueue::Cleanup (void)
       return;
     }
 
+  /*
+   * The entries are stamped on enqueue and kept in that order, and all of them share
+   * the same maximum delay, so the outdated packets are always at the front
+   */
   Time now = Simulator::Now ();
-  uint32_t n = 0;
-  for (std::vector<DsrNetworkQueueEntry>::iterator i = m_dsrNetworkQueue.begin (); i != m_dsrNetworkQueue.end (); )
+  std::vector<DsrNetworkQueueEntry>::iterator i = m_dsrNetworkQueue.begin ();
+  while (i != m_dsrNetworkQueue.end () && i->GetInsertedTimeStamp () + m_maxDelay <= now)
     {
-      if (i->GetInsertedTimeStamp () + m_maxDelay > now)
-        {
-          i++;
-        }
-      else
-        {
-          NS_LOG_LOGIC ("Outdated packet");
-          i = m_dsrNetworkQueue.erase (i);
-          n++;
-        }
+      NS_LOG_LOGIC ("Outdated packet");
+      ++i;
+    }
+  uint32_t n = i - m_dsrNetworkQueue.begin ();
+  if (n > 0)
+    {
+      m_dsrNetworkQueue.erase (m_dsrNetworkQueue.begin (), i);
     }
   m_size -= n;
 }
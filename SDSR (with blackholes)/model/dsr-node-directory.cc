@@ -0,0 +1,312 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2026 The SDSR contributors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: The SDSR contributors, see the git history
+ */
+
+#include "dsr-node-directory.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/node-list.h"
+#include "ns3/net-device.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("DsrNodeDirectory");
+
+namespace dsr {
+
+NS_OBJECT_ENSURE_REGISTERED (DsrNodeDirectory);
+
+const uint32_t DsrNodeDirectory::NOT_FOUND;
+
+namespace {
+/// The shared directory, see DsrNodeDirectory::Get
+Ptr<DsrNodeDirectory> *g_directory = 0;
+}
+
+TypeId DsrNodeDirectory::GetTypeId ()
+{
+  static TypeId tid = TypeId ("ns3::dsr::DsrNodeDirectory")
+    .SetParent<Object> ()
+    .SetGroupName ("Dsr")
+    .AddConstructor<DsrNodeDirectory> ()
+  ;
+  return tid;
+}
+
+DsrNodeDirectory::DsrNodeDirectory ()
+  : m_stale (true),
+    m_nNodes (0),
+    m_rebuilds (0),
+    m_lastMissRebuild (Seconds (-1))
+{
+}
+
+DsrNodeDirectory::~DsrNodeDirectory ()
+{
+  NS_LOG_FUNCTION_NOARGS ();
+}
+
+void
+DsrNodeDirectory::DoDispose ()
+{
+  m_ipv4.clear ();
+  m_idToIp.clear ();
+  m_mainToId.clear ();
+  m_anyToId.clear ();
+  m_macToId.clear ();
+  Object::DoDispose ();
+}
+
+Ptr<DsrNodeDirectory>
+DsrNodeDirectory::Get ()
+{
+  if (g_directory == 0)
+    {
+      g_directory = new Ptr<DsrNodeDirectory> ();
+      *g_directory = CreateObject<DsrNodeDirectory> ();
+      // The NodeList goes away with the simulator, so does the directory
+      Simulator::ScheduleDestroy (&DsrNodeDirectory::Delete);
+    }
+  return *g_directory;
+}
+
+void
+DsrNodeDirectory::Delete ()
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  (*g_directory)->Dispose ();
+  *g_directory = 0;
+  delete g_directory;
+  g_directory = 0;
+}
+
+void
+DsrNodeDirectory::Invalidate ()
+{
+  m_stale = true;
+}
+
+uint64_t
+DsrNodeDirectory::MacKey (Mac48Address address)
+{
+  uint8_t buf[6];
+  address.CopyTo (buf);
+  uint64_t key = 0;
+  for (uint32_t i = 0; i < 6; ++i)
+    {
+      key = (key << 8) | buf[i];
+    }
+  return key;
+}
+
+void
+DsrNodeDirectory::Refresh ()
+{
+  if (m_stale || m_nNodes != NodeList::GetNNodes ())
+    {
+      Rebuild ();
+    }
+}
+
+bool
+DsrNodeDirectory::RefreshOnMiss ()
+{
+  /*
+   * An unknown address either belongs to nobody or was assigned after the last
+   * rebuild. Rescan once per time instant so repeated misses stay cheap, unless
+   * a lookup has just found a stale entry.
+   */
+  if (!m_stale && m_lastMissRebuild == Simulator::Now ())
+    {
+      return false;
+    }
+  m_lastMissRebuild = Simulator::Now ();
+  Rebuild ();
+  return true;
+}
+
+void
+DsrNodeDirectory::Rebuild ()
+{
+  NS_LOG_FUNCTION (this);
+  uint32_t nNodes = NodeList::GetNNodes ();
+  m_ipv4.assign (nNodes, Ptr<Ipv4> ());
+  m_idToIp.assign (nNodes, Ipv4Address ("0.0.0.0"));
+  m_mainToId.clear ();
+  m_anyToId.clear ();
+  m_macToId.clear ();
+  for (uint32_t i = 0; i < nNodes; ++i)
+    {
+      Ptr<Ipv4> ipv4 = NodeList::GetNode (i)->GetObject<Ipv4> ();
+      if (ipv4 == 0)
+        {
+          continue;
+        }
+      m_ipv4[i] = ipv4;
+      for (uint32_t j = 0; j < ipv4->GetNInterfaces (); ++j)
+        {
+          for (uint32_t k = 0; k < ipv4->GetNAddresses (j); ++k)
+            {
+              // The first node holding an address wins, as the NodeList scan did
+              m_anyToId.insert (std::make_pair (ipv4->GetAddress (j, k).GetLocal (), i));
+            }
+        }
+      if (ipv4->GetNInterfaces () < 2 || ipv4->GetNAddresses (1) == 0)
+        {
+          continue;
+        }
+      Ipv4Address main = ipv4->GetAddress (1, 0).GetLocal ();
+      m_idToIp[i] = main;
+      m_mainToId.insert (std::make_pair (main, i));
+      Address mac = ipv4->GetNetDevice (1)->GetAddress ();
+      if (Mac48Address::IsMatchingType (mac))
+        {
+          m_macToId.insert (std::make_pair (MacKey (Mac48Address::ConvertFrom (mac)), i));
+        }
+    }
+  m_nNodes = nNodes;
+  m_stale = false;
+  ++m_rebuilds;
+  NS_LOG_DEBUG ("Indexed " << nNodes << " nodes, " << m_anyToId.size () << " addresses");
+}
+
+bool
+DsrNodeDirectory::HoldsMain (uint32_t id, Ipv4Address address) const
+{
+  Ptr<Ipv4> ipv4 = m_ipv4[id];
+  return ipv4->GetNInterfaces () > 1 && ipv4->GetNAddresses (1) > 0
+         && ipv4->GetAddress (1, 0).GetLocal () == address;
+}
+
+uint32_t
+DsrNodeDirectory::FindMain (Ipv4Address address)
+{
+  std::unordered_map<Ipv4Address, uint32_t, Ipv4AddressHash>::const_iterator i = m_mainToId.find (address);
+  if (i == m_mainToId.end ())
+    {
+      return NOT_FOUND;
+    }
+  if (!HoldsMain (i->second, address))
+    {
+      NS_LOG_DEBUG ("Node " << i->second << " no longer holds " << address);
+      m_stale = true;
+      return NOT_FOUND;
+    }
+  return i->second;
+}
+
+uint32_t
+DsrNodeDirectory::FindMac (Mac48Address address)
+{
+  std::unordered_map<uint64_t, uint32_t>::const_iterator i = m_macToId.find (MacKey (address));
+  if (i == m_macToId.end ())
+    {
+      return NOT_FOUND;
+    }
+  if (m_ipv4[i->second]->GetNetDevice (1)->GetAddress () != address
+      || !HoldsMain (i->second, m_idToIp[i->second]))
+    {
+      m_stale = true;
+      return NOT_FOUND;
+    }
+  return i->second;
+}
+
+uint32_t
+DsrNodeDirectory::FindAny (Ipv4Address address)
+{
+  std::unordered_map<Ipv4Address, uint32_t, Ipv4AddressHash>::const_iterator i = m_anyToId.find (address);
+  if (i == m_anyToId.end ())
+    {
+      return NOT_FOUND;
+    }
+  if (m_ipv4[i->second]->GetInterfaceForAddress (address) == -1)
+    {
+      m_stale = true;
+      return NOT_FOUND;
+    }
+  return i->second;
+}
+
+uint32_t
+DsrNodeDirectory::GetIdFromIp (Ipv4Address address)
+{
+  NS_LOG_FUNCTION (this << address);
+  Refresh ();
+  uint32_t id = FindMain (address);
+  if (id == NOT_FOUND && RefreshOnMiss ())
+    {
+      id = FindMain (address);
+    }
+  return id;
+}
+
+Ipv4Address
+DsrNodeDirectory::GetIpFromId (uint32_t id)
+{
+  NS_LOG_FUNCTION (this << id);
+  Refresh ();
+  if (id >= m_idToIp.size () || m_ipv4[id] == 0)
+    {
+      return Ipv4Address ("0.0.0.0");
+    }
+  if (!HoldsMain (id, m_idToIp[id]))
+    {
+      NS_LOG_DEBUG ("The address of node " << id << " has changed");
+      Rebuild ();
+    }
+  return m_idToIp[id];
+}
+
+Ipv4Address
+DsrNodeDirectory::GetIpFromMac (Mac48Address address)
+{
+  NS_LOG_FUNCTION (this << address);
+  Refresh ();
+  uint32_t id = FindMac (address);
+  if (id == NOT_FOUND && RefreshOnMiss ())
+    {
+      id = FindMac (address);
+    }
+  if (id == NOT_FOUND)
+    {
+      return Ipv4Address ("0.0.0.0");
+    }
+  return m_idToIp[id];
+}
+
+Ptr<Node>
+DsrNodeDirectory::GetNodeWithAddress (Ipv4Address address)
+{
+  NS_LOG_FUNCTION (this << address);
+  Refresh ();
+  uint32_t id = FindAny (address);
+  if (id == NOT_FOUND && RefreshOnMiss ())
+    {
+      id = FindAny (address);
+    }
+  if (id == NOT_FOUND)
+    {
+      return 0;
+    }
+  return NodeList::GetNode (id);
+}
+
+} // namespace dsr
+} // namespace ns3
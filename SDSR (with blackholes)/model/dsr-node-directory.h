@@ -0,0 +1,141 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2026 The SDSR contributors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: The SDSR contributors, see the git history
+ */
+
+#ifndef DSR_NODE_DIRECTORY_H
+#define DSR_NODE_DIRECTORY_H
+
+#include <vector>
+#include <unordered_map>
+#include "ns3/object.h"
+#include "ns3/ptr.h"
+#include "ns3/nstime.h"
+#include "ns3/node.h"
+#include "ns3/ipv4.h"
+#include "ns3/ipv4-address.h"
+#include "ns3/mac48-address.h"
+
+namespace ns3 {
+namespace dsr {
+/**
+ * \ingroup dsr
+ * \brief Simulation-wide directory mapping ip address, node id, mac address and node
+ *
+ * DSR carries node ids in the fixed size header and resolves the previous hop from
+ * the mac address of every received frame, so these lookups run several times per
+ * packet. The directory indexes every node in the NodeList once and answers in
+ * constant time. Hits are checked against the node's Ipv4 before they are returned,
+ * so a node that has been renumbered is detected and the directory rebuilt; misses
+ * and NodeList growth trigger a rebuild as well.
+ */
+class DsrNodeDirectory : public Object
+{
+public:
+  /**
+   * \brief Get the type identificator.
+   * \return type identificator
+   */
+  static TypeId GetTypeId ();
+
+  DsrNodeDirectory ();
+  virtual ~DsrNodeDirectory ();
+
+  /// Returned by GetIdFromIp when the address is not known
+  static const uint32_t NOT_FOUND = 0xffffffff;
+
+  /**
+   * \brief Get the directory shared by all the DSR instances of the simulation
+   * \return the directory, created on first use and released on Simulator::Destroy
+   */
+  static Ptr<DsrNodeDirectory> Get ();
+  /**
+   * \brief Look up the id of the node whose main interface (interface 1) holds the address
+   * \param address the ip address
+   * \return the node id, NOT_FOUND if no node holds it
+   */
+  uint32_t GetIdFromIp (Ipv4Address address);
+  /**
+   * \brief Look up the main interface address of a node
+   * \param id the node id
+   * \return the address, 0.0.0.0 if the id is unknown
+   */
+  Ipv4Address GetIpFromId (uint32_t id);
+  /**
+   * \brief Look up the main interface address of the node owning a mac address
+   * \param address the mac address of interface 1
+   * \return the address, 0.0.0.0 if the mac address is unknown
+   */
+  Ipv4Address GetIpFromMac (Mac48Address address);
+  /**
+   * \brief Look up the node that has the address on any of its interfaces
+   * \param address the ip address
+   * \return the node, 0 if no node holds it
+   */
+  Ptr<Node> GetNodeWithAddress (Ipv4Address address);
+  /**
+   * \brief Mark the directory stale, it is rebuilt on the next lookup
+   *
+   * To be called after addresses have been assigned or changed.
+   */
+  void Invalidate ();
+  /**
+   * \brief Get the number of times the index has been built
+   * \return the build count
+   */
+  uint32_t GetRebuildCount () const
+  {
+    return m_rebuilds;
+  }
+
+private:
+  virtual void DoDispose ();
+  /// Rebuild the index if it is stale or the NodeList has grown
+  void Refresh ();
+  /// Rebuild the index after a miss, at most once per simulation time instant
+  bool RefreshOnMiss ();
+  /// Check that interface 1 of a node still holds the address
+  bool HoldsMain (uint32_t id, Ipv4Address address) const;
+  /// Find the node whose interface 1 holds the address, NOT_FOUND on a miss or a stale entry
+  uint32_t FindMain (Ipv4Address address);
+  /// Find the node whose interface 1 has the mac address, NOT_FOUND on a miss or a stale entry
+  uint32_t FindMac (Mac48Address address);
+  /// Find the node holding the address on any interface, NOT_FOUND on a miss or a stale entry
+  uint32_t FindAny (Ipv4Address address);
+  /// Scan the NodeList and rebuild all the maps
+  void Rebuild ();
+  /// Pack a mac address into an integer key
+  static uint64_t MacKey (Mac48Address address);
+  /// Release the shared directory
+  static void Delete ();
+
+  bool m_stale;                                                           ///< rebuild on next lookup
+  uint32_t m_nNodes;                                                      ///< NodeList size at the last rebuild
+  uint32_t m_rebuilds;                                                    ///< number of rebuilds
+  Time m_lastMissRebuild;                                                 ///< time of the last rebuild caused by a miss
+  std::vector<Ptr<Ipv4> > m_ipv4;                                         ///< ipv4 of each node, indexed by node id
+  std::vector<Ipv4Address> m_idToIp;                                      ///< main address of each node, indexed by node id
+  std::unordered_map<Ipv4Address, uint32_t, Ipv4AddressHash> m_mainToId;  ///< main address to node id
+  std::unordered_map<Ipv4Address, uint32_t, Ipv4AddressHash> m_anyToId;   ///< any interface address to node id
+  std::unordered_map<uint64_t, uint32_t> m_macToId;                       ///< mac address of interface 1 to node id
+};
+
+}  // namespace dsr
+}  // namespace ns3
+
+#endif /* DSR_NODE_DIRECTORY_H */
@@ -1149,6 +1149,8 @@ DsrOptionHeader::Alignment DsrOptionAckReqHeader::GetAlignment () const
 
 NS_OBJECT_ENSURE_REGISTERED (DsrOptionAckHeader);
 
+const uint32_t DsrOptionAckHeader::MAX_ACK_IDS;
+
 TypeId DsrOptionAckHeader::GetTypeId ()
 {
   static TypeId tid = TypeId ("ns3::dsr::DsrOptionAckHeader")
@@ -1165,31 +1167,77 @@ TypeId DsrOptionAckHeader::GetInstanceTypeId () const
 }
 
 DsrOptionAckHeader::DsrOptionAckHeader () //set the length copy the rrep header sunxu
-: m_ipv4Address (0)
+  : m_flag (0),
+    m_identification (0),
+    m_compact (false),
+    m_ipv4Address (0)
 {
   SetType (32);
-  SetLength (6 + m_ipv4Address.size () * 4);
+  UpdateLength ();
 }
 
 void DsrOptionAckHeader::SetNumberAddress (uint8_t n)
 {
   m_ipv4Address.clear ();
   m_ipv4Address.assign (n, Ipv4Address ());
+  UpdateLength ();
 }
 void DsrOptionAckHeader::SetNodesAddress (std::vector<Ipv4Address> ipv4Address)
 {
   m_ipv4Address = ipv4Address;
-  SetLength (6 + m_ipv4Address.size () * 4);
+  UpdateLength ();
 }
 void DsrOptionAckHeader::SetNodeAddress (uint8_t index, Ipv4Address addr)
 {
   m_ipv4Address.at (index) = addr;
+  UpdateLength ();
 }
 std::vector<Ipv4Address> DsrOptionAckHeader::GetNodesAddresses () const
 {
   return m_ipv4Address;
 }
 
+void DsrOptionAckHeader::SetCompact (bool compact)
+{
+  m_compact = compact;
+  UpdateLength ();
+}
+
+bool DsrOptionAckHeader::IsCompact () const
+{
+  return m_compact;
+}
+
+bool DsrOptionAckHeader::IsCompactEncoded () const
+{
+  return m_compact
+         && !m_ipv4Address.empty ()
+         && m_ipv4Address.size () <= COMPACT_MAX_HOPS
+         && m_ipv4Address.front () == m_realSrcAddress
+         && m_ipv4Address.back () == m_realDstAddress
+         && GetHopIndex (m_targetDst) != COMPACT_MAX_HOPS
+         && GetHopIndex (m_originalSender) != COMPACT_MAX_HOPS;
+}
+
+uint8_t DsrOptionAckHeader::GetHopIndex (Ipv4Address address) const
+{
+  for (uint8_t index = 0; index < m_ipv4Address.size () && index < COMPACT_MAX_HOPS; ++index)
+    {
+      if (m_ipv4Address[index] == address)
+        {
+          return index;
+        }
+    }
+  return COMPACT_MAX_HOPS;
+}
+
+void DsrOptionAckHeader::UpdateLength ()
+{
+  uint32_t size = GetSerializedSize ();
+  NS_ASSERT_MSG (size - 2 <= 0xff, "Ack node list too long for the option length field");
+  SetLength (static_cast<uint8_t> (size - 2));
+}
+
 DsrOptionAckHeader::~DsrOptionAckHeader ()
 {
 }
@@ -1206,6 +1254,7 @@ uint16_t DsrOptionAckHeader::GetAckFlag()const     // (20170826 sx)
 void DsrOptionAckHeader::SetOriginalSender(Ipv4Address orginalSender){
 
 	m_originalSender = orginalSender;
+	UpdateLength ();
 }
 
 Ipv4Address DsrOptionAckHeader::GetOriginalSender() const
@@ -1215,6 +1264,7 @@ Ipv4Address DsrOptionAckHeader::GetOriginalSender() const
 void DsrOptionAckHeader::SetTargetDst(Ipv4Address targetDst)  // Target dst is used for the two hop acknowledgment.(20170826 sx)
 {
 	m_targetDst = targetDst;
+	UpdateLength ();
 }
 Ipv4Address DsrOptionAckHeader::GetTargetDst() const       // (20170826 sx)
 {
@@ -1231,9 +1281,53 @@ uint16_t DsrOptionAckHeader::GetAckId () const
   return m_identification;
 }
 
+void DsrOptionAckHeader::SetAckIds (std::vector<uint16_t> const& ackIds)
+{
+  NS_ASSERT_MSG (!ackIds.empty () && ackIds.size () <= MAX_ACK_IDS, "Ack batch size out of range");
+  m_identification = ackIds.front ();
+  m_batchIds.assign (ackIds.begin () + 1, ackIds.end ());
+  UpdateLength ();
+}
+
+std::vector<uint16_t> DsrOptionAckHeader::GetAckIds () const
+{
+  std::vector<uint16_t> ackIds;
+  ackIds.reserve (m_batchIds.size () + 1);
+  ackIds.push_back (m_identification);
+  ackIds.insert (ackIds.end (), m_batchIds.begin (), m_batchIds.end ());
+  return ackIds;
+}
+
+bool DsrOptionAckHeader::IsBitmapEncoded () const
+{
+  if (m_batchIds.size () * 2 <= BITMAP_BITS / 8)
+    {
+      return false;
+    }
+  for (std::vector<uint16_t>::const_iterator it = m_batchIds.begin (); it != m_batchIds.end (); ++it)
+    {
+      uint16_t delta = static_cast<uint16_t> (*it - m_identification);
+      if (delta == 0 || delta > BITMAP_BITS)
+        {
+          return false;
+        }
+    }
+  return true;
+}
+
+uint32_t DsrOptionAckHeader::GetBatchSize () const
+{
+  if (m_batchIds.empty ())
+    {
+      return 0;
+    }
+  return 2 + (IsBitmapEncoded () ? BITMAP_BITS / 8 : m_batchIds.size () * 2);
+}
+
 void DsrOptionAckHeader::SetRealSrc (Ipv4Address realSrcAddress)
 {
   m_realSrcAddress = realSrcAddress;
+  UpdateLength ();
 }
 
 Ipv4Address DsrOptionAckHeader::GetRealSrc () const
@@ -1244,6 +1338,7 @@ Ipv4Address DsrOptionAckHeader::GetRealSrc () const
 void DsrOptionAckHeader::SetRealDst (Ipv4Address realDstAddress)
 {
   m_realDstAddress = realDstAddress;
+  UpdateLength ();
 }
 
 Ipv4Address DsrOptionAckHeader::GetRealDst () const
@@ -1261,54 +1356,142 @@ void DsrOptionAckHeader::Print (std::ostream &os) const
 
 uint32_t DsrOptionAckHeader::GetSerializedSize () const
 {
-   return 128 + m_ipv4Address.size () * 4;  // 32 is enough for 5 hop node list. If path is longer, than need to increase here!!!! (20170826 sx)
+  uint32_t fixedSize = IsCompactEncoded () ? COMPACT_FIXED_SIZE : FULL_FIXED_SIZE;
+  return fixedSize + GetBatchSize () + m_ipv4Address.size () * 4;
 }
 
 void DsrOptionAckHeader::Serialize (Buffer::Iterator start) const //copy rrep sunxu
 {
-
-
   Buffer::Iterator i = start;
-  uint8_t buff[4];   //increase the size of buff, due to the increase number of parameters saved in the buff. (20170826 sx)
+  uint8_t buff[4];
+  bool compact = IsCompactEncoded ();
 
   i.WriteU8 (GetType ());
   i.WriteU8 (GetLength ());
   i.WriteHtonU16 (m_identification); // transfer the ackid to u16 type
-  i.WriteHtonU16 (m_flag);           // transfer the flag to u16 type
-  WriteTo (i,m_targetDst);           // transfer the target destination to u32 type
-  WriteTo (i,m_realSrcAddress);      // transfer the real source to u32 type
-  WriteTo (i,m_realDstAddress);      // transfer the real destination to u32 type
-  WriteTo (i,m_originalSender);
+  uint16_t flag = m_batchIds.empty () ? m_flag : (m_flag | BATCH_FLAG);
+  if (compact)
+    {
+      // real source and destination are the ends of the node list, target and
+      // original sender go as indices into it
+      i.WriteHtonU16 (flag | COMPACT_FLAG);
+      i.WriteU8 (GetHopIndex (m_targetDst));
+      i.WriteU8 (GetHopIndex (m_originalSender));
+    }
+  else
+    {
+      i.WriteHtonU16 (flag);             // transfer the flag to u16 type
+      WriteTo (i,m_targetDst);           // transfer the target destination to u32 type
+      WriteTo (i,m_realSrcAddress);      // transfer the real source to u32 type
+      WriteTo (i,m_realDstAddress);      // transfer the real destination to u32 type
+      WriteTo (i,m_originalSender);
+    }
 
-   for (VectorIpv4Address_t::const_iterator it = m_ipv4Address.begin (); it != m_ipv4Address.end (); it++)
-     {
-       it->Serialize (buff);
-       i.Write (buff, 4);
-     }
+  if (!m_batchIds.empty ())
+    {
+      // the other acked ids, as a bitmap over the ids following the first
+      // one when they are close enough, as a plain list otherwise
+      bool bitmap = IsBitmapEncoded ();
+      i.WriteU8 (static_cast<uint8_t> (m_batchIds.size ()));
+      i.WriteU8 (bitmap ? 1 : 0);
+      if (bitmap)
+        {
+          uint32_t bits = 0;
+          for (std::vector<uint16_t>::const_iterator it = m_batchIds.begin (); it != m_batchIds.end (); ++it)
+            {
+              bits |= 1u << (static_cast<uint16_t> (*it - m_identification) - 1);
+            }
+          i.WriteHtonU32 (bits);
+        }
+      else
+        {
+          for (std::vector<uint16_t>::const_iterator it = m_batchIds.begin (); it != m_batchIds.end (); ++it)
+            {
+              i.WriteHtonU16 (*it);
+            }
+        }
+    }
+
+  for (VectorIpv4Address_t::const_iterator it = m_ipv4Address.begin (); it != m_ipv4Address.end (); it++)
+    {
+      it->Serialize (buff);
+      i.Write (buff, 4);
+    }
 }
 
 uint32_t DsrOptionAckHeader::Deserialize (Buffer::Iterator start) //copy rrep sunxu
 {
-	  Buffer::Iterator i = start;
-	  uint8_t buff[4];                    //increase the size of buff (20170826 sx)
-
-	  SetType (i.ReadU8 ());
-	  SetLength (i.ReadU8 ());
-	  m_identification = i.ReadNtohU16 (); // read the ackid
-	  m_flag = i.ReadNtohU16();            // read the flag
-	  ReadFrom (i,m_targetDst);            // read the target destination
-	  ReadFrom (i,m_realSrcAddress);       // read the real source
-	  ReadFrom (i,m_realDstAddress);       // read the real destination
-	  ReadFrom (i,m_originalSender);
-	  uint8_t index = 0;
-	  for (std::vector<Ipv4Address>::iterator it = m_ipv4Address.begin (); it != m_ipv4Address.end (); it++)
-	    {
-	      i.Read (buff, 4);
-	      m_address = it->Deserialize (buff);
-	      SetNodeAddress (index, m_address);
-	      ++index;
-	    }
-  return GetSerializedSize ();
+  Buffer::Iterator i = start;
+  uint8_t buff[4];
+
+  SetType (i.ReadU8 ());
+  uint8_t length = i.ReadU8 ();
+  m_identification = i.ReadNtohU16 (); // read the ackid
+  uint16_t flag = i.ReadNtohU16 ();    // read the flag
+  m_flag = flag & ~(COMPACT_FLAG | BATCH_FLAG);
+  m_compact = (flag & COMPACT_FLAG) != 0;
+
+  // The node list size follows from the option length, no need to peek at it
+  uint8_t targetIndex = 0;
+  uint8_t senderIndex = 0;
+  uint32_t fixedSize;
+  if (m_compact)
+    {
+      targetIndex = i.ReadU8 ();
+      senderIndex = i.ReadU8 ();
+      fixedSize = COMPACT_FIXED_SIZE;
+    }
+  else
+    {
+      ReadFrom (i,m_targetDst);            // read the target destination
+      ReadFrom (i,m_realSrcAddress);       // read the real source
+      ReadFrom (i,m_realDstAddress);       // read the real destination
+      ReadFrom (i,m_originalSender);
+      fixedSize = FULL_FIXED_SIZE;
+    }
+  m_batchIds.clear ();
+  if (flag & BATCH_FLAG)
+    {
+      uint8_t count = i.ReadU8 ();
+      bool bitmap = i.ReadU8 () != 0;
+      if (bitmap)
+        {
+          uint32_t bits = i.ReadNtohU32 ();
+          for (uint32_t bit = 0; bit < BITMAP_BITS; ++bit)
+            {
+              if (bits & (1u << bit))
+                {
+                  m_batchIds.push_back (static_cast<uint16_t> (m_identification + bit + 1));
+                }
+            }
+          fixedSize += 2 + BITMAP_BITS / 8;
+        }
+      else
+        {
+          for (uint8_t k = 0; k < count; ++k)
+            {
+              m_batchIds.push_back (i.ReadNtohU16 ());
+            }
+          fixedSize += 2 + count * 2;
+        }
+    }
+  uint32_t numberAddress = length + 2u >= fixedSize ? (length + 2u - fixedSize) / 4 : 0;
+  m_ipv4Address.assign (numberAddress, Ipv4Address ());
+  for (std::vector<Ipv4Address>::iterator it = m_ipv4Address.begin (); it != m_ipv4Address.end (); it++)
+    {
+      i.Read (buff, 4);
+      *it = Ipv4Address::Deserialize (buff);
+    }
+
+  if (m_compact && !m_ipv4Address.empty ())
+    {
+      m_realSrcAddress = m_ipv4Address.front ();
+      m_realDstAddress = m_ipv4Address.back ();
+      m_targetDst = targetIndex < m_ipv4Address.size () ? m_ipv4Address[targetIndex] : Ipv4Address ();
+      m_originalSender = senderIndex < m_ipv4Address.size () ? m_ipv4Address[senderIndex] : Ipv4Address ();
+    }
+  SetLength (length);
+  return i.GetDistanceFrom (start);
 }
 
 DsrOptionHeader::Alignment DsrOptionAckHeader::GetAlignment () const
@@ -606,6 +606,13 @@ public:
    * \return The segments left
    */
   uint8_t GetSegmentsLeft () const;
+  /**
+   * \brief Byte offset of the segments left field within the serialized option.
+   *
+   * Lets the receive path read the field with a short peek instead of
+   * deserializing the whole source route.
+   */
+  static const uint32_t SEGMENTS_LEFT_OFFSET = 11;
   /**
    * \brief Set the number of ipv4 address.
    * \param n the number of ipv4' address
@@ -1259,11 +1266,20 @@ private:
    +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
    |  Option Type |  Opt Data Len |         Identification         |
    +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
-   |                        ACK Source Address                     |
+   |C|B|       Ack Flag            |       Target / Sender ...      |
    +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
-   |                     ACK Destination Address                   |
+   |                    Node List Address[1..n]                    |
    +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
   \endverbatim
+
+  Without the C bit the flag is followed by the target destination, real
+  source, real destination and original sender addresses (22 + 4n bytes).
+  With it the real source and destination are the first and last node of
+  the list and target / sender are one byte hop indices into it
+  (8 + 4n bytes).  With the B bit (0x4000) an ack covers several ids: a
+  count and mode byte follow, then either a 32 bit bitmap over the ids after
+  the identification or a list of 16 bit ids.  The option length always
+  equals the serialized size - 2.
 */
 
 class DsrOptionAckHeader : public DsrOptionHeader
@@ -1297,6 +1313,22 @@ public:
    * \return request id number
    */
   uint16_t GetAckId () const;
+  /**
+   * \brief Set all the ids this ack covers.
+   *
+   * The first one goes in the identification field, the others in the
+   * batch section, as a bitmap over the 32 ids following the first one
+   * when they fit in it and as a list of 16 bit ids otherwise.
+   * \param ackIds the acked ids, at least one
+   */
+  void SetAckIds (std::vector<uint16_t> const& ackIds);
+  /**
+   * \brief Get all the ids this ack covers.
+   * \return the identification field followed by the batched ids
+   */
+  std::vector<uint16_t> GetAckIds () const;
+  /// Most ids a single ack carries
+  static const uint32_t MAX_ACK_IDS = 32;
 
   void SetAckFlag (uint16_t m_flag); //set the type of ack: 1 is one hop , 2 is two hop, 3 is end to end (20170826 sx)
 
@@ -1349,6 +1381,20 @@ public:
      * \return the vector of ipv4 address
      */
     std::vector<Ipv4Address> GetNodesAddresses () const;
+  /**
+   * \brief Ask for the compact encoding.
+   *
+   * It is only used when the real source and destination are the ends of
+   * the node list and target / original sender are on it, otherwise the
+   * full encoding is written.
+   * \param compact true to use the compact encoding when possible
+   */
+  void SetCompact (bool compact);
+  /**
+   * \brief Whether the compact encoding was asked for or received.
+   * \return the compact flag
+   */
+  bool IsCompact () const;
   /**
    * \brief Serialize the packet.
    * \param start Buffer iterator
@@ -1367,6 +1413,35 @@ public:
   virtual Alignment GetAlignment () const;
 
 private:
+  static const uint16_t COMPACT_FLAG = 0x8000;    ///< flag bit marking the compact encoding
+  static const uint32_t FULL_FIXED_SIZE = 22;     ///< fixed part of the full encoding
+  static const uint32_t COMPACT_FIXED_SIZE = 8;   ///< fixed part of the compact encoding
+  static const uint8_t COMPACT_MAX_HOPS = 0xff;   ///< hop index meaning "not on the list"
+  static const uint16_t BATCH_FLAG = 0x4000;      ///< flag bit marking a batch section
+  static const uint32_t BITMAP_BITS = 32;         ///< ids covered by the batch bitmap
+  /**
+   * \brief Whether the batched ids go as a bitmap.
+   * \return true if they all follow the first id closely and the bitmap is smaller
+   */
+  bool IsBitmapEncoded () const;
+  /**
+   * \brief Size of the batch section.
+   * \return 0 if the ack covers a single id
+   */
+  uint32_t GetBatchSize () const;
+  /**
+   * \brief Whether the header goes out in the compact encoding.
+   * \return true if compact was asked for and the addresses allow it
+   */
+  bool IsCompactEncoded () const;
+  /**
+   * \brief Find an address on the node list.
+   * \param address the address to look for
+   * \return its index, COMPACT_MAX_HOPS if it is not on the list
+   */
+  uint8_t GetHopIndex (Ipv4Address address) const;
+  /// Keep the option length in step with the encoding
+  void UpdateLength ();
   /**
    * \brief identification field
    */
@@ -1385,10 +1460,10 @@ private:
    * \brief ack destination address
    */
   Ipv4Address m_realDstAddress;
-  /*
-   * Ipv4 address to write when desearizing the packet
-   */
-  Ipv4Address m_address;
+  /// use the compact encoding when possible
+  bool m_compact;
+  /// ids acked on top of m_identification
+  std::vector<uint16_t> m_batchIds;
   /**
    * \brief A vector of IPv4 Address.
    */
@@ -59,6 +59,7 @@
 #include "dsr-option-header.h"
 #include "dsr-options.h"
 #include "dsr-rcache.h"
+#include "dsr-node-directory.h"
 
 namespace ns3 {
 
@@ -349,34 +350,18 @@ uint32_t
 DsrOptions::GetIDfromIP (Ipv4Address address)
 {
   NS_LOG_FUNCTION (this << address);
-  int32_t nNodes = NodeList::GetNNodes ();
-  for (int32_t i = 0; i < nNodes; ++i)
+  uint32_t id = DsrNodeDirectory::Get ()->GetIdFromIp (address);
+  if (id == DsrNodeDirectory::NOT_FOUND)
     {
-      Ptr<Node> node = NodeList::GetNode (i);
-      Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
-      if (ipv4->GetAddress (1, 0).GetLocal () == address)
-        {
-          return i;
-        }
+      return DsrFsHeader::NO_ID;
     }
-  return 255;
+  return id;
 }
 
 Ptr<Node> DsrOptions::GetNodeWithAddress (Ipv4Address ipv4Address)
 {
   NS_LOG_FUNCTION (this << ipv4Address);
-  int32_t nNodes = NodeList::GetNNodes ();
-  for (int32_t i = 0; i < nNodes; ++i)
-    {
-      Ptr<Node> node = NodeList::GetNode (i);
-      Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
-      int32_t ifIndex = ipv4->GetInterfaceForAddress (ipv4Address);
-      if (ifIndex != -1)
-        {
-          return node;
-        }
-    }
-  return 0;
+  return DsrNodeDirectory::Get ()->GetNodeWithAddress (ipv4Address);
 }
 
 NS_OBJECT_ENSURE_REGISTERED (DsrOptionPad1);
@@ -566,10 +551,11 @@ uint8_t DsrOptionRreq::Process (Ptr<Packet> packet, Ptr<Packet> dsrP, Ipv4Addres
    * Construct the dsr routing header for later use
    */
   DsrRoutingHeader dsrRoutingHeader;
+  dsrRoutingHeader.SetWideIds (dsr->IsWideNodeIds ());
   dsrRoutingHeader.SetNextHeader (protocol);
   dsrRoutingHeader.SetMessageType (1);
   dsrRoutingHeader.SetSourceId (GetIDfromIP (source));
-  dsrRoutingHeader.SetDestId (255);
+  dsrRoutingHeader.SetDestId (DsrFsHeader::NO_ID);
 
   // check whether we have received this request or not, if not, it will save the request in the table for
   // later use, if not found, return false, and push the newly received source request entry in the cache
@@ -621,7 +607,7 @@ uint8_t DsrOptionRreq::Process (Ptr<Packet> packet, Ptr<Packet> dsrP, Ipv4Addres
                                               saveRoute);
 
 
-      if(node->GetId() == 34 || node->GetId() == 25){  // blackhole test let 32 and 25 be blackhole attack
+      if(dsr->GetAdversary ()->ForgesReplies (node->GetId ())){  // blackhole / grayhole answer with a forged reply
           	  Ipv4Address nextHop; // Declare the next hop address to use
           	               std::vector<Ipv4Address> changeRoute (nodeList);
           	               changeRoute.push_back (ipv4Address);    // push back our own address
@@ -640,6 +626,7 @@ uint8_t DsrOptionRreq::Process (Ptr<Packet> packet, Ptr<Packet> dsrP, Ipv4Addres
           	                     Ipv4Address replyDst = m_finalRoute.front ();
 
           	                     DsrRoutingHeader dsrRoutingHeader;
+          	                     dsrRoutingHeader.SetWideIds (dsr->IsWideNodeIds ());
           	                     dsrRoutingHeader.SetNextHeader (protocol);
           	                     dsrRoutingHeader.SetMessageType (1);
           	                     dsrRoutingHeader.SetSourceId (GetIDfromIP (targetAddress));
@@ -691,6 +678,7 @@ uint8_t DsrOptionRreq::Process (Ptr<Packet> packet, Ptr<Packet> dsrP, Ipv4Addres
            * This part add dsr header to the packet and send route reply packet
            */
           DsrRoutingHeader dsrRoutingHeader;
+          dsrRoutingHeader.SetWideIds (dsr->IsWideNodeIds ());
           dsrRoutingHeader.SetNextHeader (protocol);
           dsrRoutingHeader.SetMessageType (1);
           dsrRoutingHeader.SetSourceId (GetIDfromIP (ipv4Address));
@@ -903,10 +891,11 @@ uint8_t DsrOptionRreq::Process (Ptr<Packet> packet, Ptr<Packet> dsrP, Ipv4Addres
                * This part add dsr header to the packet and send route reply packet
                */
               DsrRoutingHeader dsrRoutingHeader;
+              dsrRoutingHeader.SetWideIds (dsr->IsWideNodeIds ());
               dsrRoutingHeader.SetNextHeader (protocol);
               dsrRoutingHeader.SetMessageType (1);
               dsrRoutingHeader.SetSourceId (GetIDfromIP (realSource));
-              dsrRoutingHeader.SetDestId (255);
+              dsrRoutingHeader.SetDestId (DsrFsHeader::NO_ID);
 
               uint8_t length = rrep.GetLength ();  // Get the length of the rrep header excluding the type header
               dsrRoutingHeader.SetPayloadLength (length + 2);
@@ -1180,6 +1169,7 @@ uint8_t DsrOptionRrep::Process (Ptr<Packet> packet, Ptr<Packet> dsrP, Ipv4Addres
        * This part add dsr routing header to the packet and send reply
        */
       DsrRoutingHeader dsrRoutingHeader;
+      dsrRoutingHeader.SetWideIds (dsr->IsWideNodeIds ());
       dsrRoutingHeader.SetNextHeader (protocol);
 
       length = rrep.GetLength ();    // Get the length of the rrep header excluding the type header
@@ -1393,11 +1383,8 @@ uint8_t DsrOptionSR::Process (Ptr<Packet> packet, Ptr<Packet> dsrP, Ipv4Address
       Ipv4Address nextAddress;
 
       // Get the option type value
-      uint32_t size = p->GetSize ();
-      uint8_t *data = new uint8_t[size];
-      p->CopyData (data, size);
       uint8_t optionType = 0;
-      optionType = *(data);
+      p->CopyData (&optionType, 1);
       /// When the option type is 160, means there is ACK request header after the source route, we need
       /// to send back acknowledgment
       if (optionType == 160)
@@ -1546,10 +1533,9 @@ uint8_t DsrOptionRerr::Process (Ptr<Packet> packet, Ptr<Packet> dsrP, Ipv4Addres
 {
   NS_LOG_FUNCTION (this << packet << dsrP << ipv4Address << source << ipv4Header << (uint32_t)protocol << isPromisc);
   Ptr<Packet> p = packet->Copy ();
-  uint32_t size = p->GetSize ();
-  uint8_t *data = new uint8_t[size];
-  p->CopyData (data, size);
-  uint8_t errorType = *(data + 2);
+  uint8_t buf[3] = { 0, 0, 0 };
+  p->CopyData (buf, sizeof(buf));
+  uint8_t errorType = buf[2];
   /*
    * Get the node from Ip address and get the dsr extension object
    */
@@ -1785,14 +1771,8 @@ uint8_t DsrOptionAck::Process (Ptr<Packet> packet, Ptr<Packet> dsrP, Ipv4Address
    * Remove the ACK header
    */
   Ptr<Packet> p = packet->Copy ();
-  // get the size of node list in ack header. (20170825 sx)
-  uint8_t buf[2];
-  p->CopyData (buf, sizeof(buf));
-  uint8_t numberAddress = (buf[1] - 6) / 4;
-
+  // the ack header sizes its node list from the option length
   DsrOptionAckHeader ack;
-  ack.SetNumberAddress(numberAddress);
-
   p->RemoveHeader (ack);
 
   NS_LOG_DEBUG ("The next header value " << (uint32_t)protocol);
@@ -1805,7 +1785,7 @@ uint8_t DsrOptionAck::Process (Ptr<Packet> packet, Ptr<Packet> dsrP, Ipv4Address
   Ipv4Address realDst = ack.GetRealDst ();
   Ipv4Address originalSender = ack.GetOriginalSender();//(20170831 sx)
   Ipv4Address targetDst = ack.GetTargetDst(); //(20170826 sx)
-  uint16_t ackId = ack.GetAckId ();           //(20170826 sx)
+  std::vector<uint16_t> ackIds = ack.GetAckIds (); // one ack may cover several packets
   uint16_t ackFlag = ack.GetAckFlag();        //(20170826 sx)
   /*
    * Get the node with ip address and get the dsr extension and route cache objects
@@ -1815,13 +1795,13 @@ uint8_t DsrOptionAck::Process (Ptr<Packet> packet, Ptr<Packet> dsrP, Ipv4Address
 
   if(ackFlag == 1){
 	  dsr->UpdateRouteEntry (realDst);
-	  dsr->CallCancelPacketTimer (ackId, ipv4Header, realSrc, realDst);
+	  dsr->CallCancelPacketTimer (ackIds, ipv4Header, realSrc, realDst);
   }
   if(ackFlag == 2){
 	  if(targetDst == ipv4Address){//(20170831 sx)
 		  if(realSrc == ipv4Address){
 			  dsr->UpdateRouteEntry (realDst);
-			  dsr->CallCancelPacketTimer (ackId, ipv4Header, realSrc, realDst);
+			  dsr->CallCancelPacketTimer (ackIds, ipv4Header, realSrc, realDst);
 			  return ack.GetSerializedSize ();
 		  }
 		  Ipv4Address nexthop = ReverseSearchNextHop(ipv4Address,nodeList);
@@ -1832,37 +1812,17 @@ uint8_t DsrOptionAck::Process (Ptr<Packet> packet, Ptr<Packet> dsrP, Ipv4Address
 		   newTargetDst = ReverseSearchNextTwoHop(ipv4Address, nodeList);
 		  if(nexthop == "0.0.0.0"){
 
-			  std::map<uint16_t, std::vector<Ipv4Address>>::iterator it = m_ackPair.find(ackId);
-			  if (it == m_ackPair.end()) {  //(2017831 sx form the datastructure the first pa is ackid and ths sec is the list of original Sender)
-				  std::vector<Ipv4Address> vec;
-			     vec.push_back(originalSender);
-			     m_ackPair.insert(make_pair(ackId, vec));
-			  }else{
-				  std::vector<Ipv4Address>::iterator iter = std::find(it->second.begin(),it->second.end(),originalSender);
-				  if(iter == it->second.end())
-					  it->second.push_back(originalSender);
-			  }
-
-               /*std::cout<<"test the ack list\n";
-			  for (it = m_ackPair.begin(); it != m_ackPair.end(); ++it) {
-			      std::vector<Ipv4Address>::iterator it_inner;
-			      for (it_inner = it->second.begin(); it_inner != it->second.end(); ++it_inner) {
-			              std::cout<<"the id is "<<it->first<<"and the address is"<<*it_inner<<"\n";
-			          }
-			  }*/
-
-
 			  dsr->UpdateRouteEntry (realDst);
-			  dsr->CallCancelPacketTimer (ackId, ipv4Header, realSrc, realDst);
+			  dsr->CallCancelPacketTimer (ackIds, ipv4Header, realSrc, realDst);
 		  }else{
 			  if(newTargetDst != "0.0.0.0"){
 
 				  m_ipv4Route = SetRoute (nexthop, ipv4Address);
-				  dsr->SendAck (ackId, nexthop, realSrc, realDst, protocol, m_ipv4Route,nodeList, ackFlag,newTargetDst,originalSender);
+				  dsr->SendAck (ackIds, nexthop, realSrc, realDst, protocol, m_ipv4Route,nodeList, ackFlag,newTargetDst,originalSender);
 			  }else{
 
 				  m_ipv4Route = SetRoute (nexthop, ipv4Address);
-				  dsr->SendAck (ackId, nexthop, realSrc, realDst, protocol, m_ipv4Route,nodeList, ackFlag,nexthop,originalSender);
+				  dsr->SendAck (ackIds, nexthop, realSrc, realDst, protocol, m_ipv4Route,nodeList, ackFlag,nexthop,originalSender);
 			  }
 		  }
   	  }
@@ -1873,14 +1833,14 @@ uint8_t DsrOptionAck::Process (Ptr<Packet> packet, Ptr<Packet> dsrP, Ipv4Address
 
   		  m_ipv4Route = SetRoute (nexthop, ipv4Address);
 
-  		  dsr->SendAck (ackId, nexthop, realSrc, realDst, protocol, m_ipv4Route,nodeList, ackFlag,targetDst,originalSender);
+  		  dsr->SendAck (ackIds, nexthop, realSrc, realDst, protocol, m_ipv4Route,nodeList, ackFlag,targetDst,originalSender);
      }
   }
   if(ackFlag == 3){
   	  if(targetDst == ipv4Address){
 
   		  dsr->UpdateRouteEntry (realDst);
-   		  dsr->CallCancelPacketTimer (ackId, ipv4Header, realSrc, realDst);
+   		  dsr->CallCancelPacketTimer (ackIds, ipv4Header, realSrc, realDst);
    		  /*if(ipv4Address == realSrc){
    			std::vector<Ipv4Address>::iterator iter = std::find(m_test.begin(),m_test.end(),originalSender);
    			if(iter == m_test.end())
@@ -1899,7 +1859,7 @@ uint8_t DsrOptionAck::Process (Ptr<Packet> packet, Ptr<Packet> dsrP, Ipv4Address
 
   	  		  m_ipv4Route = SetRoute (nexthop, ipv4Address);
 
-  	  		  dsr->SendAck (ackId, nexthop, realSrc, realDst, protocol, m_ipv4Route,nodeList, ackFlag,targetDst,originalSender);
+  	  		  dsr->SendAck (ackIds, nexthop, realSrc, realDst, protocol, m_ipv4Route,nodeList, ackFlag,targetDst,originalSender);
    	  }
   }
 /* probably will not be used again
@@ -263,7 +263,6 @@ protected:
 
   std::vector<Ipv4Address> m_test;//sunxu!!!
 
-  std::map<uint16_t, std::vector<Ipv4Address>> m_ackPair; //(2017831 sunxu!!!)
   /**
    * \brief The vector of final Ipv4 address.
    */
@@ -30,8 +30,6 @@
  */
 
 #include "dsr-passive-buff.h"
-#include <algorithm>
-#include <functional>
 #include "ns3/ipv4-route.h"
 #include "ns3/socket.h"
 #include "ns3/log.h"
@@ -73,7 +71,7 @@ bool
 DsrPassiveBuffer::Enqueue (DsrPassiveBuffEntry & entry)
 {
   Purge ();
-  for (std::vector<DsrPassiveBuffEntry>::const_iterator i = m_passiveBuffer.begin (); i
+  for (std::map<uint64_t, DsrPassiveBuffEntry>::const_iterator i = m_passiveBuffer.begin (); i
        != m_passiveBuffer.end (); ++i)
     {
 //      NS_LOG_INFO ("packet id " << i->GetPacket ()->GetUid () << " " << entry.GetPacket ()->GetUid () << " source " << i->GetSource () << " " << entry.GetSource ()
@@ -81,32 +79,33 @@ DsrPassiveBuffer::Enqueue (DsrPassiveBuffEntry & entry)
 //                                     << entry.GetIdentification () << " fragment " << i->GetFragmentOffset () << " " << entry.GetFragmentOffset ()
 //                                     << " segLeft " << i->GetSegsLeft () << " " << entry.GetSegsLeft ());
 
-      if ((i->GetPacket ()->GetUid () == entry.GetPacket ()->GetUid ()) && (i->GetSource () == entry.GetSource ()) && (i->GetNextHop () == entry.GetNextHop ())
-          && (i->GetDestination () == entry.GetDestination ()) && (i->GetIdentification () == entry.GetIdentification ()) && (i->GetFragmentOffset () == entry.GetFragmentOffset ())
-          && (i->GetSegsLeft () == entry.GetSegsLeft () + 1))
+      if ((i->second.GetPacket ()->GetUid () == entry.GetPacket ()->GetUid ()) && (i->second.GetSource () == entry.GetSource ()) && (i->second.GetNextHop () == entry.GetNextHop ())
+          && (i->second.GetDestination () == entry.GetDestination ()) && (i->second.GetIdentification () == entry.GetIdentification ()) && (i->second.GetFragmentOffset () == entry.GetFragmentOffset ())
+          && (i->second.GetSegsLeft () == entry.GetSegsLeft () + 1))
         {
           return false;
         }
     }
 
   entry.SetExpireTime (m_passiveBufferTimeout);     // Initialize the send buffer timeout
+  entry.SetSequence (m_expiry.Insert (Simulator::Now () + m_passiveBufferTimeout));
   /*
    * Drop the most aged packet when buffer reaches to max
    */
   if (m_passiveBuffer.size () >= m_maxLen)
     {
-      Drop (m_passiveBuffer.front (), "Drop the most aged packet");         // Drop the most aged packet
+      Drop (m_passiveBuffer.begin ()->second, "Drop the most aged packet");         // Drop the most aged packet
       m_passiveBuffer.erase (m_passiveBuffer.begin ());
     }
   // enqueue the entry
-  m_passiveBuffer.push_back (entry);
+  m_passiveBuffer.insert (std::make_pair (entry.GetSequence (), entry));
   return true;
 }
 
 bool
 DsrPassiveBuffer::AllEqual (DsrPassiveBuffEntry & entry)
 {
-  for (std::vector<DsrPassiveBuffEntry>::iterator i = m_passiveBuffer.begin (); i
+  for (std::map<uint64_t, DsrPassiveBuffEntry>::iterator i = m_passiveBuffer.begin (); i
        != m_passiveBuffer.end (); ++i)
     {
 //      NS_LOG_INFO ("packet id " << i->GetPacket ()->GetUid () << " " << entry.GetPacket ()->GetUid () << " source " << i->GetSource () << " " << entry.GetSource ()
@@ -114,11 +113,11 @@ DsrPassiveBuffer::AllEqual (DsrPassiveBuffEntry & entry)
 //                                     << entry.GetIdentification () << " fragment " << i->GetFragmentOffset () << " " << entry.GetFragmentOffset ()
 //                                     << " segLeft " << (uint32_t) i->GetSegsLeft () << " " << (uint32_t) entry.GetSegsLeft ());
 
-      if ((i->GetPacket ()->GetUid () == entry.GetPacket ()->GetUid ()) && (i->GetSource () == entry.GetSource ()) && (i->GetNextHop () == entry.GetNextHop ())
-          && (i->GetDestination () == entry.GetDestination ()) && (i->GetIdentification () == entry.GetIdentification ()) && (i->GetFragmentOffset () == entry.GetFragmentOffset ())
-          && (i->GetSegsLeft () == entry.GetSegsLeft () + 1))
+      if ((i->second.GetPacket ()->GetUid () == entry.GetPacket ()->GetUid ()) && (i->second.GetSource () == entry.GetSource ()) && (i->second.GetNextHop () == entry.GetNextHop ())
+          && (i->second.GetDestination () == entry.GetDestination ()) && (i->second.GetIdentification () == entry.GetIdentification ()) && (i->second.GetFragmentOffset () == entry.GetFragmentOffset ())
+          && (i->second.GetSegsLeft () == entry.GetSegsLeft () + 1))
         {
-          i = m_passiveBuffer.erase (i);   // Erase the same maintain buffer entry for the received packet
+          m_passiveBuffer.erase (i);   // Erase the same maintain buffer entry for the received packet
           return true;
         }
     }
@@ -132,12 +131,12 @@ DsrPassiveBuffer::Dequeue (Ipv4Address dst, DsrPassiveBuffEntry & entry)
   /*
    * Dequeue the entry with destination address dst
    */
-  for (std::vector<DsrPassiveBuffEntry>::iterator i = m_passiveBuffer.begin (); i != m_passiveBuffer.end (); ++i)
+  for (std::map<uint64_t, DsrPassiveBuffEntry>::iterator i = m_passiveBuffer.begin (); i != m_passiveBuffer.end (); ++i)
     {
-      if (i->GetDestination () == dst)
+      if (i->second.GetDestination () == dst)
         {
-          entry = *i;
-          i = m_passiveBuffer.erase (i);
+          entry = i->second;
+          m_passiveBuffer.erase (i);
           NS_LOG_DEBUG ("Packet size while dequeuing " << entry.GetPacket ()->GetSize ());
           return true;
         }
@@ -151,10 +150,10 @@ DsrPassiveBuffer::Find (Ipv4Address dst)
   /*
    * Make sure if the send buffer contains entry with certain dst
    */
-  for (std::vector<DsrPassiveBuffEntry>::const_iterator i = m_passiveBuffer.begin (); i
+  for (std::map<uint64_t, DsrPassiveBuffEntry>::const_iterator i = m_passiveBuffer.begin (); i
        != m_passiveBuffer.end (); ++i)
     {
-      if (i->GetDestination () == dst)
+      if (i->second.GetDestination () == dst)
         {
           NS_LOG_DEBUG ("Found the packet");
           return true;
@@ -163,35 +162,36 @@ DsrPassiveBuffer::Find (Ipv4Address dst)
   return false;
 }
 
-struct IsExpired
-{
-  bool
-  operator() (DsrPassiveBuffEntry const & e) const
-  {
-    // NS_LOG_DEBUG("Expire time for packet in req queue: "<<e.GetExpireTime ());
-    return (e.GetExpireTime () < Seconds (0));
-  }
-};
-
 void
 DsrPassiveBuffer::Purge ()
 {
   /*
-   * Purge the buffer to eliminate expired entries
+   * Take the due entries off the expiry index, the live entries are not touched
    */
+  if (!m_expiry.IsDue ())
+    {
+      return;
+    }
   NS_LOG_DEBUG ("The passive buffer size " << m_passiveBuffer.size ());
-  IsExpired pred;
-  for (std::vector<DsrPassiveBuffEntry>::iterator i = m_passiveBuffer.begin (); i
-       != m_passiveBuffer.end (); ++i)
+  uint64_t sequence;
+  while (m_expiry.PopDue (sequence))
     {
-      if (pred (*i))
+      std::map<uint64_t, DsrPassiveBuffEntry>::iterator i = m_passiveBuffer.find (sequence);
+      if (i == m_passiveBuffer.end ())
+        {
+          continue;   // The entry has already left the buffer
+        }
+      if (i->second.GetExpireTime () < Seconds (0))
         {
           NS_LOG_DEBUG ("Dropping Queue Packets");
-          Drop (*i, "Drop out-dated packet ");
+          Drop (i->second, "Drop out-dated packet ");
+          m_passiveBuffer.erase (i);
+        }
+      else
+        {
+          m_expiry.Reinsert (Simulator::Now () + i->second.GetExpireTime (), sequence);
         }
     }
-  m_passiveBuffer.erase (std::remove_if (m_passiveBuffer.begin (), m_passiveBuffer.end (), pred),
-                       m_passiveBuffer.end ());
 }
 
 void
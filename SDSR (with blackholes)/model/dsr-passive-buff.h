@@ -32,9 +32,11 @@
 #ifndef DSR_PASSIVEBUFF_H
 #define DSR_PASSIVEBUFF_H
 
+#include <map>
 #include <vector>
 #include "ns3/ipv4-routing-protocol.h"
 #include "ns3/simulator.h"
+#include "dsr-expiry-index.h"
 
 namespace ns3 {
 namespace dsr {
@@ -69,7 +71,8 @@ public:
       m_fragmentOffset (f),
       m_segsLeft (seg),
       m_expire (exp + Simulator::Now ()),
-      m_protocol (p)
+      m_protocol (p),
+      m_sequence (0)
   {
   }
   /**
@@ -146,6 +149,14 @@ public:
   {
     return m_expire - Simulator::Now ();
   }
+  void SetSequence (uint64_t sequence)
+  {
+    m_sequence = sequence;
+  }
+  uint64_t GetSequence () const
+  {
+    return m_sequence;
+  }
   void SetProtocol (uint8_t p)
   {
     m_protocol = p;
@@ -172,6 +183,8 @@ private:
   Time m_expire;
   /// The protocol number
   uint8_t m_protocol;
+  /// The sequence number given by the expiry index of the buffer
+  uint64_t m_sequence;
 };
 
 /**
@@ -218,8 +231,10 @@ public:
   }
 
 private:
-  /// The send buffer to cache unsent packet
-  std::vector<DsrPassiveBuffEntry> m_passiveBuffer;
+  /// The send buffer to cache unsent packet, by sequence number so the oldest entry comes first
+  std::map<uint64_t, DsrPassiveBuffEntry> m_passiveBuffer;
+  /// The expire times of the entries
+  DsrExpiryIndex m_expiry;
   /// Remove all expired entries
   void Purge ();
   /// Notify that packet is dropped from queue by timeout
@@ -73,6 +73,13 @@ bool CompareRoutesExpire (const DsrRouteCacheEntry &a, const DsrRouteCacheEntry
   return a.GetExpireTime () > b.GetExpireTime ();
 }
 
+bool CompareRoutesPenalty (const std::pair<uint32_t, std::list<DsrRouteCacheEntry>::iterator> &a,
+                           const std::pair<uint32_t, std::list<DsrRouteCacheEntry>::iterator> &b)
+{
+  // compare based on trust penalty, then on expire time
+  return a.first < b.first || (a.first == b.first && CompareRoutesExpire (*a.second, *b.second));
+}
+
 void Link::Print () const
 {
   NS_LOG_DEBUG (m_low << "----" << m_high);
@@ -87,6 +94,33 @@ DsrNodeStab::~DsrNodeStab ()
 {
 }
 
+DsrNodeTrust::DsrNodeTrust ()
+  : m_delivered (0),
+    m_lost (0)
+{
+}
+
+void
+DsrNodeTrust::Update (bool delivered, double decay)
+{
+  m_delivered *= decay;
+  m_lost *= decay;
+  if (delivered)
+    {
+      m_delivered += 1;
+    }
+  else
+    {
+      m_lost += 1;
+    }
+}
+
+double
+DsrNodeTrust::GetTrust () const
+{
+  return (m_delivered + 1) / (m_delivered + m_lost + 1);
+}
+
 DsrLinkStab::DsrLinkStab (Time linkStab)
   : m_linkStability (linkStab + Simulator::Now ())
 {
@@ -101,6 +135,118 @@ void DsrLinkStab::Print ( ) const
   NS_LOG_LOGIC ("LifeTime: " << GetLinkStability ().GetSeconds ());
 }
 
+const uint32_t DsrPathHeap::NONE;
+
+/// The shortest path estimate of an unreachable node
+static const uint32_t MAX_DISTANCE = 0xffffffff;
+
+void
+DsrPathHeap::Reserve (uint32_t size)
+{
+  if (m_position.size () < size)
+    {
+      m_position.resize (size, NONE);
+    }
+}
+
+void
+DsrPathHeap::Push (uint32_t node, uint32_t key)
+{
+  NS_ASSERT (node < m_position.size ());
+  uint32_t pos = m_position[node];
+  if (pos == NONE)
+    {
+      pos = m_heap.size ();
+      m_heap.push_back (std::make_pair (key, node));
+      m_position[node] = pos;
+    }
+  else
+    {
+      m_heap[pos].first = key;
+    }
+  SiftUp (pos);
+  SiftDown (m_position[node]);
+}
+
+uint32_t
+DsrPathHeap::Pop ()
+{
+  NS_ASSERT (!m_heap.empty ());
+  uint32_t node = m_heap.front ().second;
+  m_position[node] = NONE;
+  if (m_heap.size () > 1)
+    {
+      m_heap.front () = m_heap.back ();
+      m_position[m_heap.front ().second] = 0;
+      m_heap.pop_back ();
+      SiftDown (0);
+    }
+  else
+    {
+      m_heap.pop_back ();
+    }
+  return node;
+}
+
+void
+DsrPathHeap::Clear ()
+{
+  for (std::vector<std::pair<uint32_t, uint32_t> >::const_iterator i = m_heap.begin (); i != m_heap.end (); ++i)
+    {
+      m_position[i->second] = NONE;
+    }
+  m_heap.clear ();
+}
+
+void
+DsrPathHeap::SiftUp (uint32_t pos)
+{
+  while (pos > 0)
+    {
+      uint32_t parent = (pos - 1) / 2;
+      if (!(m_heap[pos] < m_heap[parent]))
+        {
+          break;
+        }
+      Swap (pos, parent);
+      pos = parent;
+    }
+}
+
+void
+DsrPathHeap::SiftDown (uint32_t pos)
+{
+  uint32_t size = m_heap.size ();
+  while (true)
+    {
+      uint32_t smallest = pos;
+      uint32_t left = 2 * pos + 1;
+      uint32_t right = left + 1;
+      if (left < size && m_heap[left] < m_heap[smallest])
+        {
+          smallest = left;
+        }
+      if (right < size && m_heap[right] < m_heap[smallest])
+        {
+          smallest = right;
+        }
+      if (smallest == pos)
+        {
+          break;
+        }
+      Swap (pos, smallest);
+      pos = smallest;
+    }
+}
+
+void
+DsrPathHeap::Swap (uint32_t a, uint32_t b)
+{
+  std::swap (m_heap[a], m_heap[b]);
+  m_position[m_heap[a].second] = a;
+  m_position[m_heap[b].second] = b;
+}
+
 typedef std::list<DsrRouteCacheEntry>::value_type route_pair;
 
 DsrRouteCacheEntry::DsrRouteCacheEntry (IP_VECTOR const  & ip, Ipv4Address dst, Time exp)
@@ -146,8 +292,12 @@ TypeId DsrRouteCache::GetTypeId ()
 
 DsrRouteCache::DsrRouteCache ()
   : m_vector (0),
+    m_trustDecay (0.9),
+    m_trustPenalty (4),
     m_maxEntriesEachDst (3),
     m_isLinkCache (false),
+    m_linkCount (0),
+    m_treeRoot (DsrPathHeap::NONE),
     m_ntimer (Timer::CANCEL_ON_DESTROY),
     m_delay (MilliSeconds (100))
 {
@@ -164,6 +314,7 @@ DsrRouteCache::~DsrRouteCache ()
   NS_LOG_FUNCTION_NOARGS ();
   // clear the route cache when done
   m_sortedRoutes.clear ();
+  m_hopIndex.clear ();
 }
 
 void
@@ -178,28 +329,21 @@ bool
 DsrRouteCache::UpdateRouteEntry (Ipv4Address dst)
 {
   NS_LOG_FUNCTION (this << dst);
-  std::map<Ipv4Address, std::list<DsrRouteCacheEntry> >::const_iterator i =
-    m_sortedRoutes.find (dst);
-  if (i == m_sortedRoutes.end ())
+  if (!PurgeRoutes (dst))
     {
       NS_LOG_LOGIC ("Failed to find the route entry for the destination " << dst);
       return false;
     }
   else
     {
-      std::list<DsrRouteCacheEntry> rtVector = i->second;
-      DsrRouteCacheEntry successEntry = rtVector.front ();
-      successEntry.SetExpireTime (RouteCacheTimeout);
-      rtVector.pop_front ();
-      rtVector.push_back (successEntry);
-      rtVector.sort (CompareRoutesExpire);      // sort the route vector first
-      m_sortedRoutes.erase (dst);               // erase the entry first
       /*
-       * Save the new route cache along with the destination address in map
+       * Only the expire time of the first entry changes, the routes stay the same
        */
-      std::pair<std::map<Ipv4Address, std::list<DsrRouteCacheEntry> >::iterator, bool> result =
-        m_sortedRoutes.insert (std::make_pair (dst, rtVector));
-      return result.second;
+      std::list<DsrRouteCacheEntry> & rtVector = m_sortedRoutes.find (dst)->second;
+      rtVector.front ().SetExpireTime (RouteCacheTimeout);
+      rtVector.splice (rtVector.end (), rtVector, rtVector.begin ());
+      SortRoutes (rtVector);      // sort the route vector first
+      return true;
     }
   return false;
 }
@@ -212,79 +356,192 @@ DsrRouteCache::LookupRoute (Ipv4Address id, DsrRouteCacheEntry & rt)
     {
       return LookupRoute_Link (id, rt);
     }
-  else
+  DsrRouteCacheEntry const * entry = LookupRouteEntry (id);
+  if (entry == 0)
     {
-      Purge ();  // Purge first to remove expired entries
-      if (m_sortedRoutes.empty ())
+      return false;
+    }
+  rt = *entry;  // use the first entry in the route vector
+  return true;
+}
+
+DsrRouteCacheEntry const *
+DsrRouteCache::LookupRouteEntry (Ipv4Address id)
+{
+  NS_LOG_FUNCTION (this << id);
+  if (IsLinkCache ())
+    {
+      return LookupRoute_Link (id, m_linkLookupEntry) ? &m_linkLookupEntry : 0;
+    }
+  /*
+   * Only the routes this lookup reads are purged, the rest of the cache is left alone
+   */
+  if (!PurgeRoutes (id))
+    {
+      NS_LOG_LOGIC ("No Direct Route to " << id << " found");
+      std::map<Ipv4Address, std::map<Ipv4Address, uint32_t> >::const_iterator hop = m_hopIndex.find (id);
+      if (hop == m_hopIndex.end ())
         {
-          NS_LOG_LOGIC ("Route to " << id << " not found; m_sortedRoutes is empty");
-          return false;
+          NS_LOG_LOGIC ("Route to " << id << " not found; no route passes through it");
+          return 0;
+        }
+      /*
+       * Purging a destination may change the index, so take the destinations out first
+       */
+      std::vector<Ipv4Address> destinations;
+      destinations.reserve (hop->second.size ());
+      for (std::map<Ipv4Address, uint32_t>::const_iterator j = hop->second.begin (); j != hop->second.end (); ++j)
+        {
+          destinations.push_back (j->first);
         }
-      std::map<Ipv4Address, std::list<DsrRouteCacheEntry> >::const_iterator i = m_sortedRoutes.find (id);
-      if (i == m_sortedRoutes.end ())
+      DsrRouteCacheEntry changeEntry; // Create the route entry
+      bool found = false;
+      for (std::vector<Ipv4Address>::const_iterator j = destinations.begin (); j != destinations.end (); ++j)
         {
-          NS_LOG_LOGIC ("No Direct Route to " << id << " found");
-          for (std::map<Ipv4Address, std::list<DsrRouteCacheEntry> >::const_iterator j =
-                 m_sortedRoutes.begin (); j != m_sortedRoutes.end (); ++j)
+          if (!PurgeRoutes (*j))
+            {
+              continue;
+            }
+          std::list<DsrRouteCacheEntry> const & rtVector = m_sortedRoutes.find (*j)->second;
+          /*
+           * Loop through the possibly multiple routes within the route vector
+           */
+          for (std::list<DsrRouteCacheEntry>::const_iterator k = rtVector.begin (); k != rtVector.end (); ++k)
             {
-              std::list<DsrRouteCacheEntry> rtVector = j->second; // The route cache vector linked with destination address
+              DsrRouteCacheEntry::IP_VECTOR const & routeVector = k->PeekVector ();
+              DsrRouteCacheEntry::IP_VECTOR::const_iterator l = std::find (routeVector.begin (), routeVector.end (), id);
               /*
-               * Loop through the possibly multiple routes within the route vector
+               * When id is an intermediate hop of the route, which means we have found a route with the destination
+               * address we are looking for. The last one found is kept, as the full scan used to do
                */
-              for (std::list<DsrRouteCacheEntry>::const_iterator k = rtVector.begin (); k != rtVector.end (); ++k)
+              if (l != routeVector.begin () && l != routeVector.end () && (l + 1) != routeVector.end ())
                 {
-                  // return the first route in the route vector
-                  DsrRouteCacheEntry::IP_VECTOR routeVector = k->GetVector ();
-                  DsrRouteCacheEntry::IP_VECTOR changeVector;
-
-                  for (DsrRouteCacheEntry::IP_VECTOR::iterator l = routeVector.begin (); l != routeVector.end (); ++l)
-                    {
-                      if (*l != id)
-                        {
-                          changeVector.push_back (*l);
-                        }
-                      else
-                        {
-                          changeVector.push_back (*l);
-                          break;
-                        }
-                    }
-                  /*
-                   * When the changed vector is smaller in size and larger than 1, which means we have found a route with the destination
-                   * address we are looking for
-                   */
-                  if ((changeVector.size () < routeVector.size ())  && (changeVector.size () > 1))
-                    {
-                      DsrRouteCacheEntry changeEntry; // Create the route entry
-                      changeEntry.SetVector (changeVector);
-                      changeEntry.SetDestination (id);
-                      // Use the expire time from original route entry
-                      changeEntry.SetExpireTime (k->GetExpireTime ());
-                      // We need to add new route entry here
-                      std::list<DsrRouteCacheEntry> newVector;
-                      newVector.push_back (changeEntry);
-                      newVector.sort (CompareRoutesExpire);  // sort the route vector first
-                      m_sortedRoutes[id] = newVector;   // Only get the first sub route and add it in route cache
-                      NS_LOG_INFO ("We have a sub-route to " << id << " add it in route cache");
-                    }
+                  changeEntry.SetVector (DsrRouteCacheEntry::IP_VECTOR (routeVector.begin (), l + 1));
+                  changeEntry.SetDestination (id);
+                  // Use the expire time from original route entry
+                  changeEntry.SetExpireTime (k->GetExpireTime ());
+                  found = true;
                 }
             }
         }
-      NS_LOG_INFO ("Here we check the route cache again after updated the sub routes");
-      std::map<Ipv4Address, std::list<DsrRouteCacheEntry> >::const_iterator m = m_sortedRoutes.find (id);
-      if (m == m_sortedRoutes.end ())
+      if (found)
+        {
+          // We need to add new route entry here
+          std::list<DsrRouteCacheEntry> newVector;
+          newVector.push_back (changeEntry);
+          SetRoutes (id, newVector);   // Only get the first sub route and add it in route cache
+          NS_LOG_INFO ("We have a sub-route to " << id << " add it in route cache");
+        }
+    }
+  NS_LOG_INFO ("Here we check the route cache again after updated the sub routes");
+  std::map<Ipv4Address, std::list<DsrRouteCacheEntry> >::const_iterator m = m_sortedRoutes.find (id);
+  if (m == m_sortedRoutes.end ())
+    {
+      NS_LOG_LOGIC ("No updated route till last time");
+      return 0;
+    }
+  /*
+   * We have a direct route to the destination address
+   */
+  NS_LOG_LOGIC ("Route to " << id << " with route size " << m->second.size ());
+  return &m->second.front ();  // use the first entry in the route vector
+}
+
+void
+DsrRouteCache::IndexRoute (Ipv4Address dst, DsrRouteCacheEntry::IP_VECTOR const & route, bool add)
+{
+  if (route.size () < 3)
+    {
+      return;
+    }
+  for (DsrRouteCacheEntry::IP_VECTOR::const_iterator i = route.begin () + 1; i != route.end () - 1; ++i)
+    {
+      if (add)
+        {
+          ++m_hopIndex[*i][dst];
+          continue;
+        }
+      std::map<Ipv4Address, std::map<Ipv4Address, uint32_t> >::iterator hop = m_hopIndex.find (*i);
+      NS_ASSERT (hop != m_hopIndex.end ());
+      std::map<Ipv4Address, uint32_t>::iterator j = hop->second.find (dst);
+      NS_ASSERT (j != hop->second.end ());
+      if (--j->second == 0)
+        {
+          hop->second.erase (j);
+          if (hop->second.empty ())
+            {
+              m_hopIndex.erase (hop);
+            }
+        }
+    }
+}
+
+bool
+DsrRouteCache::SetRoutes (Ipv4Address dst, std::list<DsrRouteCacheEntry> const & rtVector)
+{
+  std::map<Ipv4Address, std::list<DsrRouteCacheEntry> >::iterator i = m_sortedRoutes.find (dst);
+  if (i != m_sortedRoutes.end ())
+    {
+      for (std::list<DsrRouteCacheEntry>::const_iterator j = i->second.begin (); j != i->second.end (); ++j)
+        {
+          IndexRoute (dst, j->PeekVector (), false);
+        }
+      if (rtVector.empty ())
+        {
+          m_sortedRoutes.erase (i);
+          return true;
+        }
+      i->second = rtVector;
+    }
+  else
+    {
+      if (rtVector.empty ())
         {
-          NS_LOG_LOGIC ("No updated route till last time");
           return false;
         }
+      i = m_sortedRoutes.insert (std::make_pair (dst, rtVector)).first;
+    }
+  for (std::list<DsrRouteCacheEntry>::const_iterator j = i->second.begin (); j != i->second.end (); ++j)
+    {
+      IndexRoute (dst, j->PeekVector (), true);
+    }
+  return true;
+}
+
+bool
+DsrRouteCache::PurgeRoutes (Ipv4Address dst)
+{
+  std::map<Ipv4Address, std::list<DsrRouteCacheEntry> >::iterator i = m_sortedRoutes.find (dst);
+  if (i == m_sortedRoutes.end ())
+    {
+      return false;
+    }
+  std::list<DsrRouteCacheEntry> & rtVector = i->second;
+  for (std::list<DsrRouteCacheEntry>::iterator j = rtVector.begin (); j != rtVector.end (); )
+    {
       /*
-       * We have a direct route to the destination address
+       * First verify if the route has expired or not
        */
-      std::list<DsrRouteCacheEntry> rtVector = m->second;
-      rt = rtVector.front ();  // use the first entry in the route vector
-      NS_LOG_LOGIC ("Route to " << id << " with route size " << rtVector.size ());
-      return true;
+      if (j->GetExpireTime () <= Seconds (0))
+        {
+          /*
+           * When the expire time has passed, erase the certain route
+           */
+          NS_LOG_DEBUG ("Erase the expired route for " << dst << " with expire time " << j->GetExpireTime ());
+          IndexRoute (dst, j->PeekVector (), false);
+          j = rtVector.erase (j);
+        }
+      else
+        {
+          ++j;
+        }
     }
+  if (rtVector.empty ())
+    {
+      m_sortedRoutes.erase (i);
+      return false;
+    }
+  return true;
 }
 
 void
@@ -320,113 +577,396 @@ DsrRouteCache::RebuildBestRouteTable (Ipv4Address source)
   /**
    * \brief The followings are initialize-single-source
    */
-  // @d shortest-path estimate
-  std::map<Ipv4Address, uint32_t> d;
-  // @pre preceeding node
-  std::map<Ipv4Address, Ipv4Address> pre;
-  for (std::map<Ipv4Address, std::map<Ipv4Address, uint32_t> >::iterator i = m_netGraph.begin (); i != m_netGraph.end (); ++i)
+  m_treeRoot = GetGraphIndex (source);
+  m_distance.assign (m_graphNodes.size (), MAX_DISTANCE);
+  m_preceding.assign (m_graphNodes.size (), DsrPathHeap::NONE);
+  m_pathHeap.Clear ();
+  m_distance[m_treeRoot] = 0;
+  m_pathHeap.Push (m_treeRoot, 0);
+  PropagateTree ();
+}
+
+void
+DsrRouteCache::PropagateTree ()
+{
+  while (!m_pathHeap.IsEmpty ())
     {
-      if (i->second.find (source) != i->second.end ())
+      uint32_t node = m_pathHeap.Pop ();
+      std::vector<GraphEdge> const &edges = m_graphAdj[node];
+      for (std::vector<GraphEdge>::const_iterator i = edges.begin (); i != edges.end (); ++i)
         {
-          d[i->first] = i->second[source];
-          pre[i->first] = source;
+          Relax (node, i->m_to, i->m_weight);
         }
-      else
+    }
+}
+
+void
+DsrRouteCache::Relax (uint32_t from, uint32_t to, uint32_t weight)
+{
+  if (m_distance[from] == MAX_DISTANCE)
+    {
+      return;
+    }
+  uint32_t distance = m_distance[from] + weight;
+  if (distance < m_distance[to])
+    {
+      m_distance[to] = distance;
+      m_preceding[to] = from;
+      m_pathHeap.Push (to, distance);
+    }
+  /*
+   *  Selects the shortest-length route that has the longest expected lifetime
+   *  (highest minimum timeout of any link in the route)
+   *  For the computation overhead and complexity
+   *  Here I just implement kind of greedy strategy to select link with the longest expected lifetime when there is two options
+   */
+  else if (distance == m_distance[to] && to != m_treeRoot && m_preceding[to] != from
+           && HasLongerLifetime (to, from))
+    {
+      NS_LOG_INFO ("Select the link with longest expected lifetime");
+      m_preceding[to] = from;
+    }
+}
+
+bool
+DsrRouteCache::HasLongerLifetime (uint32_t node, uint32_t via)
+{
+  GraphEdge const *oldlink = FindEdge (node, m_preceding[node]);
+  GraphEdge const *newlink = FindEdge (node, via);
+  if (oldlink != 0 && newlink != 0)
+    {
+      return oldlink->m_expire < newlink->m_expire;
+    }
+  NS_LOG_INFO ("Link Stability Info Corrupt");
+  return false;
+}
+
+void
+DsrRouteCache::RepairSubtree (uint32_t child)
+{
+  NS_LOG_FUNCTION (this << m_graphNodes[child]);
+  /*
+   * Collect the nodes whose best route went through the removed link, the
+   * children of every node are chained through the preceding indices
+   */
+  uint32_t size = m_graphNodes.size ();
+  std::vector<uint32_t> firstChild (size, DsrPathHeap::NONE);
+  std::vector<uint32_t> nextSibling (size, DsrPathHeap::NONE);
+  for (uint32_t i = 0; i < size; ++i)
+    {
+      uint32_t parent = m_preceding[i];
+      if (parent != DsrPathHeap::NONE)
         {
-          d[i->first] = MAXWEIGHT;
-          pre[i->first] = Ipv4Address ("255.255.255.255");
+          nextSibling[i] = firstChild[parent];
+          firstChild[parent] = i;
         }
     }
-  d[source] = 0;
-  /**
-   * \brief The followings are core of dijskra algorithm
+  std::vector<uint32_t> affected (1, child);
+  for (uint32_t i = 0; i < affected.size (); ++i)
+    {
+      for (uint32_t c = firstChild[affected[i]]; c != DsrPathHeap::NONE; c = nextSibling[c])
+        {
+          affected.push_back (c);
+        }
+    }
+  for (std::vector<uint32_t>::const_iterator i = affected.begin (); i != affected.end (); ++i)
+    {
+      m_distance[*i] = MAX_DISTANCE;
+      m_preceding[*i] = DsrPathHeap::NONE;
+    }
+  /*
+   * Seed them from their neighbors outside the subtree, whose routes are unchanged,
+   * and settle the subtree again
+   */
+  for (std::vector<uint32_t>::const_iterator i = affected.begin (); i != affected.end (); ++i)
+    {
+      std::vector<GraphEdge> const &edges = m_graphAdj[*i];
+      for (std::vector<GraphEdge>::const_iterator j = edges.begin (); j != edges.end (); ++j)
+        {
+          Relax (j->m_to, *i, j->m_weight);
+        }
+    }
+  PropagateTree ();
+}
+
+uint32_t
+DsrRouteCache::GetGraphIndex (Ipv4Address address)
+{
+  uint32_t index = FindGraphIndex (address);
+  if (index != DsrPathHeap::NONE)
+    {
+      return index;
+    }
+  index = m_graphNodes.size ();
+  m_graphIndex[address] = index;
+  m_graphNodes.push_back (address);
+  m_graphAdj.push_back (std::vector<GraphEdge> ());
+  m_nodeStab.push_back (DsrNodeStab (Seconds (0)));
+  m_nodeTrust.push_back (DsrNodeTrust ());
+  m_distance.push_back (MAX_DISTANCE);
+  m_preceding.push_back (DsrPathHeap::NONE);
+  m_pathHeap.Reserve (index + 1);
+  return index;
+}
+
+uint32_t
+DsrRouteCache::FindGraphIndex (Ipv4Address address) const
+{
+  std::unordered_map<Ipv4Address, uint32_t, Ipv4AddressHash>::const_iterator i = m_graphIndex.find (address);
+  if (i == m_graphIndex.end ())
+    {
+      return DsrPathHeap::NONE;
+    }
+  return i->second;
+}
+
+DsrRouteCache::GraphEdge *
+DsrRouteCache::FindEdge (uint32_t from, uint32_t to)
+{
+  std::vector<GraphEdge> &edges = m_graphAdj[from];
+  for (std::vector<GraphEdge>::iterator i = edges.begin (); i != edges.end (); ++i)
+    {
+      if (i->m_to == to)
+        {
+          return &(*i);
+        }
+    }
+  return 0;
+}
+
+bool
+DsrRouteCache::IsNodeCached (uint32_t node) const
+{
+  return m_nodeStab[node].GetNodeStability () > Seconds (0);
+}
+
+uint32_t
+DsrRouteCache::GetLinkWeight (uint32_t a, uint32_t b) const
+{
+  /*
+   * One hop plus the trust penalty of both ends. A relay is an end of two links of the route
+   * so it counts twice, the source and the destination are the same for every route they share
    */
-  // the node set which shortest distance has been calculated, if true calculated
-  std::map<Ipv4Address, bool> s;
-  double temp = MAXWEIGHT;
-  Ipv4Address tempip = Ipv4Address ("255.255.255.255");
-  for (uint32_t i = 0; i < m_netGraph.size (); i++)
-    {
-      temp = MAXWEIGHT;
-      for (std::map<Ipv4Address,uint32_t>::const_iterator j = d.begin (); j != d.end (); ++j)
+  return 1 + GetNodePenalty (a) + GetNodePenalty (b);
+}
+
+uint32_t
+DsrRouteCache::GetNodePenalty (uint32_t node) const
+{
+  return static_cast<uint32_t> (m_trustPenalty * (1 - m_nodeTrust[node].GetTrust ()) + 0.5);
+}
+
+uint32_t
+DsrRouteCache::GetRoutePenalty (DsrRouteCacheEntry::IP_VECTOR const & route) const
+{
+  uint32_t penalty = 0;
+  for (uint32_t i = 1; i + 1 < route.size (); ++i)
+    {
+      uint32_t node = FindGraphIndex (route[i]);
+      if (node != DsrPathHeap::NONE)
         {
-          Ipv4Address ip = j->first;
-          if (s.find (ip) == s.end ())
+          penalty += GetNodePenalty (node);
+        }
+    }
+  return penalty;
+}
+
+double
+DsrRouteCache::GetTrust (Ipv4Address node) const
+{
+  uint32_t index = FindGraphIndex (node);
+  return index == DsrPathHeap::NONE ? 1 : m_nodeTrust[index].GetTrust ();
+}
+
+void
+DsrRouteCache::UpdateTrust (Ipv4Address node, bool delivered)
+{
+  NS_LOG_FUNCTION (this << node << delivered);
+  uint32_t index = GetGraphIndex (node);
+  uint32_t penalty = GetNodePenalty (index);
+  m_nodeTrust[index].Update (delivered, m_trustDecay);
+  if (GetNodePenalty (index) == penalty)
+    {
+      return;
+    }
+  NS_LOG_DEBUG ("The trust in " << node << " is now " << m_nodeTrust[index].GetTrust ());
+  // Only the links of the node change weight
+  bool heavier = GetNodePenalty (index) > penalty;
+  std::vector<uint32_t> children;
+  for (std::vector<GraphEdge>::iterator i = m_graphAdj[index].begin (); i != m_graphAdj[index].end (); ++i)
+    {
+      i->m_weight = GetLinkWeight (index, i->m_to);
+      FindEdge (i->m_to, index)->m_weight = i->m_weight;
+      if (m_treeRoot != DsrPathHeap::NONE && m_preceding[i->m_to] == index)
+        {
+          children.push_back (i->m_to);
+        }
+    }
+  if (m_treeRoot != DsrPathHeap::NONE)
+    {
+      if (!heavier)
+        {
+          // Lighter links can only shorten routes, as a new link does
+          for (std::vector<GraphEdge>::const_iterator i = m_graphAdj[index].begin (); i != m_graphAdj[index].end (); ++i)
             {
-              /*
-               * \brief The followings are for comparison
-               */
-              if (j->second <= temp)
-                {
-                  temp = j->second;
-                  tempip = ip;
-                }
+              Relax (index, i->m_to, i->m_weight);
+              Relax (i->m_to, index, i->m_weight);
             }
+          PropagateTree ();
         }
-      if (!tempip.IsBroadcast ())
+      else if (m_preceding[index] != DsrPathHeap::NONE)
         {
-          s[tempip] = true;
-          for (std::map<Ipv4Address, uint32_t>::const_iterator k = m_netGraph[tempip].begin (); k != m_netGraph[tempip].end (); ++k)
+          // The node hangs from a heavier link, its subtree holds every route through it
+          RepairSubtree (index);
+        }
+      else
+        {
+          // Only the tree links down from the node got heavier
+          for (std::vector<uint32_t>::const_iterator i = children.begin (); i != children.end (); ++i)
             {
-              if (s.find (k->first) == s.end () && d[k->first] > d[tempip] + k->second)
+              if (m_preceding[*i] == index)
                 {
-                  d[k->first] = d[tempip] + k->second;
-                  pre[k->first] = tempip;
-                }
-              /*
-               *  Selects the shortest-length route that has the longest expected lifetime
-               *  (highest minimum timeout of any link in the route)
-               *  For the computation overhead and complexity
-               *  Here I just implement kind of greedy strategy to select link with the longest expected lifetime when there is two options
-               */
-              else if (d[k->first] == d[tempip] + k->second)
-                {
-                  std::map<Link, DsrLinkStab>::iterator oldlink = m_linkCache.find (Link (k->first, pre[k->first]));
-                  std::map<Link, DsrLinkStab>::iterator newlink = m_linkCache.find (Link (k->first, tempip));
-                  if (oldlink != m_linkCache.end () && newlink != m_linkCache.end ())
-                    {
-                      if (oldlink->second.GetLinkStability () < newlink->second.GetLinkStability ())
-                        {
-                          NS_LOG_INFO ("Select the link with longest expected lifetime");
-                          d[k->first] = d[tempip] + k->second;
-                          pre[k->first] = tempip;
-                        }
-                    }
-                  else
-                    {
-                      NS_LOG_INFO ("Link Stability Info Corrupt");
-                    }
+                  RepairSubtree (*i);
                 }
             }
         }
     }
-  // clean the best route table
-  m_bestRoutesTable_link.clear ();
-  for (std::map<Ipv4Address, Ipv4Address>::iterator i = pre.begin (); i != pre.end (); ++i)
+  // Reorder the cached paths going through the node
+  std::map<Ipv4Address, std::map<Ipv4Address, uint32_t> >::const_iterator hop = m_hopIndex.find (node);
+  if (hop == m_hopIndex.end ())
     {
-      // loop for all vertexes
-      DsrRouteCacheEntry::IP_VECTOR route;
-      Ipv4Address iptemp = i->first;
+      return;
+    }
+  for (std::map<Ipv4Address, uint32_t>::const_iterator i = hop->second.begin (); i != hop->second.end (); ++i)
+    {
+      RepositionRoutes (m_sortedRoutes.find (i->first)->second, node);
+    }
+}
 
-      if (!i->second.IsBroadcast () && iptemp != source)
+void
+DsrRouteCache::RepositionRoutes (routeEntryVector & rtVector, Ipv4Address node) const
+{
+  routeEntryVector moved;
+  for (routeEntryVector::iterator i = rtVector.begin (); i != rtVector.end (); )
+    {
+      DsrRouteCacheEntry::IP_VECTOR const & route = i->PeekVector ();
+      routeEntryVector::iterator next = i;
+      ++next;
+      if (route.size () > 2 && std::find (route.begin () + 1, route.end () - 1, node) != route.end () - 1)
         {
-          while (iptemp != source)
-            {
-              route.push_back (iptemp);
-              iptemp = pre[iptemp];
-            }
-          route.push_back (source);
-          // Reverse the route
-          DsrRouteCacheEntry::IP_VECTOR reverseroute;
-          for (DsrRouteCacheEntry::IP_VECTOR::reverse_iterator j = route.rbegin (); j != route.rend (); ++j)
+          moved.splice (moved.end (), rtVector, i);
+        }
+      i = next;
+    }
+  // The other routes keep their order, each moved one goes back after the routes that rank before it
+  while (!moved.empty ())
+    {
+      std::pair<uint32_t, routeEntryVector::iterator> route (GetRoutePenalty (moved.front ().PeekVector ()), moved.begin ());
+      routeEntryVector::iterator j = rtVector.begin ();
+      while (j != rtVector.end ()
+             && !CompareRoutesPenalty (route, std::make_pair (GetRoutePenalty (j->PeekVector ()), j)))
+        {
+          ++j;
+        }
+      rtVector.splice (j, moved, moved.begin ());
+    }
+}
+
+void
+DsrRouteCache::SortRoutes (routeEntryVector & rtVector) const
+{
+  if (rtVector.size () < 2)
+    {
+      return;
+    }
+  // Compute the penalty of each route once instead of on every comparison
+  std::vector<std::pair<uint32_t, routeEntryVector::iterator> > order;
+  for (routeEntryVector::iterator i = rtVector.begin (); i != rtVector.end (); ++i)
+    {
+      order.push_back (std::make_pair (GetRoutePenalty (i->GetVector ()), i));
+    }
+  std::stable_sort (order.begin (), order.end (), CompareRoutesPenalty);
+  for (std::vector<std::pair<uint32_t, routeEntryVector::iterator> >::const_iterator i = order.begin (); i != order.end (); ++i)
+    {
+      rtVector.splice (rtVector.end (), rtVector, i->second);
+    }
+}
+
+void
+DsrRouteCache::AddGraphLink (uint32_t a, uint32_t b, DsrLinkStab const & stab)
+{
+  NS_LOG_FUNCTION (this << m_graphNodes[a] << m_graphNodes[b]);
+  uint32_t weight = GetLinkWeight (a, b);
+  GraphEdge *forward = FindEdge (a, b);
+  if (forward == 0)
+    {
+      GraphEdge edge;
+      edge.m_weight = weight;
+      edge.m_expire = Simulator::Now () + stab.GetLinkStability ();
+      edge.m_to = b;
+      m_graphAdj[a].push_back (edge);
+      edge.m_to = a;
+      m_graphAdj[b].push_back (edge);
+      ++m_linkCount;
+    }
+  else
+    {
+      SetLinkStab (*forward, a, stab);
+    }
+  if (m_treeRoot != DsrPathHeap::NONE)
+    {
+      // A new or refreshed link can only shorten routes or win a tie-break
+      Relax (a, b, weight);
+      Relax (b, a, weight);
+      PropagateTree ();
+    }
+}
+
+void
+DsrRouteCache::SetLinkStab (GraphEdge & edge, uint32_t from, DsrLinkStab const & stab)
+{
+  edge.m_expire = Simulator::Now () + stab.GetLinkStability ();
+  FindEdge (edge.m_to, from)->m_expire = edge.m_expire;
+}
+
+void
+DsrRouteCache::RemoveGraphLink (uint32_t a, uint32_t b)
+{
+  NS_LOG_FUNCTION (this << m_graphNodes[a] << m_graphNodes[b]);
+  bool found = false;
+  for (uint32_t end = 0; end < 2; ++end)
+    {
+      std::vector<GraphEdge> &edges = m_graphAdj[end == 0 ? a : b];
+      uint32_t to = (end == 0 ? b : a);
+      for (std::vector<GraphEdge>::iterator i = edges.begin (); i != edges.end (); ++i)
+        {
+          if (i->m_to == to)
             {
-              reverseroute.push_back (*j);
+              *i = edges.back ();
+              edges.pop_back ();
+              found = true;
+              break;
             }
-          NS_LOG_LOGIC ("Add newly calculated best routes");
-          PrintVector (reverseroute);
-          m_bestRoutesTable_link[i->first] = reverseroute;
         }
     }
+  if (!found)
+    {
+      return;
+    }
+  --m_linkCount;
+  if (m_treeRoot == DsrPathHeap::NONE)
+    {
+      return;
+    }
+  // Only a link of the shortest path tree changes any route
+  if (m_preceding[b] == a)
+    {
+      RepairSubtree (b);
+    }
+  else if (m_preceding[a] == b)
+    {
+      RepairSubtree (a);
+    }
 }
 
 bool
@@ -435,28 +975,31 @@ DsrRouteCache::LookupRoute_Link (Ipv4Address id, DsrRouteCacheEntry & rt)
   NS_LOG_FUNCTION (this << id);
   /// We need to purge the link node cache
   PurgeLinkNode ();
-  std::map<Ipv4Address, DsrRouteCacheEntry::IP_VECTOR>::const_iterator i = m_bestRoutesTable_link.find (id);
-  if (i == m_bestRoutesTable_link.end ())
+  uint32_t index = FindGraphIndex (id);
+  if (m_treeRoot == DsrPathHeap::NONE || index == DsrPathHeap::NONE
+      || index == m_treeRoot || m_preceding[index] == DsrPathHeap::NONE)
     {
       NS_LOG_INFO ("No route find to " << id);
       return false;
     }
   else
     {
-      if (i->second.size () < 2)
+      // Walk the tree back to the source and reverse the route
+      DsrRouteCacheEntry::IP_VECTOR route;
+      for (uint32_t node = index; node != m_treeRoot; node = m_preceding[node])
         {
-          NS_LOG_LOGIC ("Route to " << id << " error");
-          return false;
+          route.push_back (m_graphNodes[node]);
         }
+      route.push_back (m_graphNodes[m_treeRoot]);
+      std::reverse (route.begin (), route.end ());
 
       DsrRouteCacheEntry newEntry; // Create the route entry
-      newEntry.SetVector (i->second);
+      newEntry.SetVector (route);
       newEntry.SetDestination (id);
       newEntry.SetExpireTime (RouteCacheTimeout);
-      NS_LOG_INFO ("Route to " << id << " found with the length " << i->second.size ());
+      NS_LOG_INFO ("Route to " << id << " found with the length " << route.size ());
       rt = newEntry;
-      std::vector<Ipv4Address> path = rt.GetVector ();
-      PrintVector (path);
+      PrintVector (route);
       return true;
     }
 }
@@ -465,34 +1008,26 @@ void
 DsrRouteCache::PurgeLinkNode ()
 {
   NS_LOG_FUNCTION (this);
-  for (std::map<Link, DsrLinkStab>::iterator i = m_linkCache.begin (); i != m_linkCache.end (); )
+  /*
+   * Each link is checked once, from its end with the smaller graph index. The node
+   * cache needs no purge, a node whose stability ran out is no longer cached
+   */
+  std::vector<std::pair<uint32_t, uint32_t> > expired;
+  for (uint32_t i = 0; i < m_graphAdj.size (); ++i)
     {
-      NS_LOG_DEBUG ("The link stability " << i->second.GetLinkStability ().GetSeconds ());
-      std::map<Link, DsrLinkStab>::iterator itmp = i;
-      if (i->second.GetLinkStability () <= Seconds (0))
-        {
-          ++i;
-          m_linkCache.erase (itmp);
-        }
-      else
+      for (std::vector<GraphEdge>::const_iterator j = m_graphAdj[i].begin (); j != m_graphAdj[i].end (); ++j)
         {
-          ++i;
+          if (j->m_to > i && j->m_expire <= Simulator::Now ())
+            {
+              expired.push_back (std::make_pair (i, j->m_to));
+            }
         }
     }
-  /// may need to remove them after verify
-  for (std::map<Ipv4Address, DsrNodeStab>::iterator i = m_nodeCache.begin (); i != m_nodeCache.end (); )
+  // Repair the routes that used the expired links
+  for (std::vector<std::pair<uint32_t, uint32_t> >::const_iterator i = expired.begin (); i != expired.end (); ++i)
     {
-      NS_LOG_DEBUG ("The node stability " << i->second.GetNodeStability ().GetSeconds ());
-      std::map<Ipv4Address, DsrNodeStab>::iterator itmp = i;
-      if (i->second.GetNodeStability () <= Seconds (0))
-        {
-          ++i;
-          m_nodeCache.erase (itmp);
-        }
-      else
-        {
-          ++i;
-        }
+      NS_LOG_DEBUG ("The link " << m_graphNodes[i->first] << "----" << m_graphNodes[i->second] << " expired");
+      RemoveGraphLink (i->first, i->second);
     }
 }
 
@@ -500,59 +1035,57 @@ void
 DsrRouteCache::UpdateNetGraph ()
 {
   NS_LOG_FUNCTION (this);
-  m_netGraph.clear ();
-  for (std::map<Link, DsrLinkStab>::iterator i = m_linkCache.begin (); i != m_linkCache.end (); ++i)
+  for (uint32_t i = 0; i < m_graphAdj.size (); ++i)
     {
-      // Here the weight is set as 1
-      /// \todo May need to set different weight for different link here later
-      uint32_t weight = 1;
-      m_netGraph[i->first.m_low][i->first.m_high] = weight;
-      m_netGraph[i->first.m_high][i->first.m_low] = weight;
+      for (std::vector<GraphEdge>::iterator j = m_graphAdj[i].begin (); j != m_graphAdj[i].end (); ++j)
+        {
+          j->m_weight = GetLinkWeight (i, j->m_to);
+        }
+    }
+  if (m_treeRoot != DsrPathHeap::NONE)
+    {
+      RebuildBestRouteTable (m_graphNodes[m_treeRoot]);
     }
 }
 
 bool
-DsrRouteCache::IncStability (Ipv4Address node)
+DsrRouteCache::IncStability (uint32_t node)
 {
-  NS_LOG_FUNCTION (this << node);
-  std::map<Ipv4Address, DsrNodeStab>::const_iterator i = m_nodeCache.find (node);
-  if (i == m_nodeCache.end ())
+  NS_LOG_FUNCTION (this << m_graphNodes[node]);
+  if (!IsNodeCached (node))
     {
       NS_LOG_INFO ("The initial stability " << m_initStability.GetSeconds ());
-      DsrNodeStab ns (m_initStability);
-      m_nodeCache[node] = ns;
+      m_nodeStab[node] = DsrNodeStab (m_initStability);
       return false;
     }
   else
     {
       /// \todo get rid of the debug here
-      NS_LOG_INFO ("The node stability " << i->second.GetNodeStability ().GetSeconds ());
-      NS_LOG_INFO ("The stability here " << Time (i->second.GetNodeStability () * m_stabilityIncrFactor).GetSeconds ());
-      DsrNodeStab ns (Time (i->second.GetNodeStability () * m_stabilityIncrFactor));
-      m_nodeCache[node] = ns;
+      DsrNodeStab const &ns = m_nodeStab[node];
+      NS_LOG_INFO ("The node stability " << ns.GetNodeStability ().GetSeconds ());
+      NS_LOG_INFO ("The stability here " << Time (ns.GetNodeStability () * m_stabilityIncrFactor).GetSeconds ());
+      m_nodeStab[node] = DsrNodeStab (Time (ns.GetNodeStability () * m_stabilityIncrFactor));
       return true;
     }
   return false;
 }
 
 bool
-DsrRouteCache::DecStability (Ipv4Address node)
+DsrRouteCache::DecStability (uint32_t node)
 {
-  NS_LOG_FUNCTION (this << node);
-  std::map<Ipv4Address, DsrNodeStab>::const_iterator i = m_nodeCache.find (node);
-  if (i == m_nodeCache.end ())
+  NS_LOG_FUNCTION (this << m_graphNodes[node]);
+  if (!IsNodeCached (node))
     {
-      DsrNodeStab ns (m_initStability);
-      m_nodeCache[node] = ns;
+      m_nodeStab[node] = DsrNodeStab (m_initStability);
       return false;
     }
   else
     {
       /// \todo remove it here
-      NS_LOG_INFO ("The stability here " << i->second.GetNodeStability ().GetSeconds ());
-      NS_LOG_INFO ("The stability here " << Time (i->second.GetNodeStability () / m_stabilityDecrFactor).GetSeconds ());
-      DsrNodeStab ns (Time (i->second.GetNodeStability () / m_stabilityDecrFactor));
-      m_nodeCache[node] = ns;
+      DsrNodeStab const &ns = m_nodeStab[node];
+      NS_LOG_INFO ("The stability here " << ns.GetNodeStability ().GetSeconds ());
+      NS_LOG_INFO ("The stability here " << Time (ns.GetNodeStability () / m_stabilityDecrFactor).GetSeconds ());
+      m_nodeStab[node] = DsrNodeStab (Time (ns.GetNodeStability () / m_stabilityDecrFactor));
       return true;
     }
   return false;
@@ -567,28 +1100,30 @@ DsrRouteCache::AddRoute_Link (DsrRouteCacheEntry::IP_VECTOR nodelist, Ipv4Addres
   PurgeLinkNode ();
   for (uint32_t i = 0; i < nodelist.size () - 1; i++)
     {
+      uint32_t from = GetGraphIndex (nodelist[i]);
+      uint32_t to = GetGraphIndex (nodelist[i + 1]);
       DsrNodeStab ns;                /// This is the node stability
       ns.SetNodeStability (m_initStability);
 
-      if (m_nodeCache.find (nodelist[i]) == m_nodeCache.end ())
+      if (!IsNodeCached (from))
         {
-          m_nodeCache[nodelist[i]] = ns;
+          m_nodeStab[from] = ns;
         }
-      if (m_nodeCache.find (nodelist[i + 1]) == m_nodeCache.end ())
+      if (!IsNodeCached (to))
         {
-          m_nodeCache[nodelist[i + 1]] = ns;
+          m_nodeStab[to] = ns;
         }
       Link link (nodelist[i], nodelist[i + 1]);         /// Link represent the one link for the route
       DsrLinkStab stab;                /// Link stability
       stab.SetLinkStability (m_initStability);
       /// Set the link stability as the smallest node stability
-      if (m_nodeCache[nodelist[i]].GetNodeStability () < m_nodeCache[nodelist[i + 1]].GetNodeStability ())
+      if (m_nodeStab[from].GetNodeStability () < m_nodeStab[to].GetNodeStability ())
         {
-          stab.SetLinkStability (m_nodeCache[nodelist[i]].GetNodeStability ());
+          stab.SetLinkStability (m_nodeStab[from].GetNodeStability ());
         }
       else
         {
-          stab.SetLinkStability (m_nodeCache[nodelist[i + 1]].GetNodeStability ());
+          stab.SetLinkStability (m_nodeStab[to].GetNodeStability ());
         }
       if (stab.GetLinkStability () < m_minLifeTime)
         {
@@ -596,14 +1131,16 @@ DsrRouteCache::AddRoute_Link (DsrRouteCacheEntry::IP_VECTOR nodelist, Ipv4Addres
           /// Set the link stability as the m)minLifeTime, default is 1 second
           stab.SetLinkStability (m_minLifeTime);
         }
-      m_linkCache[link] = stab;
+      AddGraphLink (from, to, stab);
       NS_LOG_DEBUG ("Add a new link");
       link.Print ();
       NS_LOG_DEBUG ("Link Info");
       stab.Print ();
     }
-  UpdateNetGraph ();
-  RebuildBestRouteTable (source);
+  if (m_treeRoot == DsrPathHeap::NONE || m_graphNodes[m_treeRoot] != source)
+    {
+      RebuildBestRouteTable (source);
+    }
   return true;
 }
 
@@ -620,14 +1157,20 @@ DsrRouteCache::UseExtends (DsrRouteCacheEntry::IP_VECTOR rt)
     }
   for (DsrRouteCacheEntry::IP_VECTOR::iterator i = rt.begin (); i != rt.end () - 1; ++i)
     {
-      Link link (*i, *(i + 1));
-      if (m_linkCache.find (link) != m_linkCache.end ())
+      uint32_t from = FindGraphIndex (*i);
+      uint32_t to = FindGraphIndex (*(i + 1));
+      GraphEdge *forward = 0;
+      if (from != DsrPathHeap::NONE && to != DsrPathHeap::NONE)
+        {
+          forward = FindEdge (from, to);
+        }
+      if (forward != 0)
         {
-          if (m_linkCache[link].GetLinkStability () < m_useExtends)
+          if (forward->m_expire - Simulator::Now () < m_useExtends)
             {
-              m_linkCache[link].SetLinkStability (m_useExtends);
+              SetLinkStab (*forward, from, DsrLinkStab (m_useExtends));
               /// \todo remove after debug
-              NS_LOG_INFO ("The time of the link " << m_linkCache[link].GetLinkStability ().GetSeconds ());
+              NS_LOG_INFO ("The time of the link " << m_useExtends.GetSeconds ());
             }
         }
       else
@@ -638,12 +1181,13 @@ DsrRouteCache::UseExtends (DsrRouteCacheEntry::IP_VECTOR rt)
   /// Increase the stability of the node cache
   for (DsrRouteCacheEntry::IP_VECTOR::iterator i = rt.begin (); i != rt.end (); ++i)
     {
-      if (m_nodeCache.find (*i) != m_nodeCache.end ())
+      uint32_t node = FindGraphIndex (*i);
+      if (node != DsrPathHeap::NONE && IsNodeCached (node))
         {
           NS_LOG_LOGIC ("Increase the stability");
-          if (m_nodeCache[*i].GetNodeStability () <= m_initStability)
+          if (m_nodeStab[node].GetNodeStability () <= m_initStability)
             {
-              IncStability (*i);
+              IncStability (node);
             }
           else
             {
@@ -657,29 +1201,21 @@ bool
 DsrRouteCache::AddRoute (DsrRouteCacheEntry & rt)
 {
   NS_LOG_FUNCTION (this);
-  Purge ();
   std::list<DsrRouteCacheEntry> rtVector;   // Declare the route cache entry vector
   Ipv4Address dst = rt.GetDestination ();
-  std::vector<Ipv4Address> route = rt.GetVector ();
 
   NS_LOG_DEBUG ("The route destination we have " << dst);
-  std::map<Ipv4Address, std::list<DsrRouteCacheEntry> >::const_iterator i =
-    m_sortedRoutes.find (dst);
-
-  if (i == m_sortedRoutes.end ())
+  if (!PurgeRoutes (dst))
     {
       rtVector.push_back (rt);
-      m_sortedRoutes.erase (dst);   // Erase the route entries for dst first
       /**
        * Save the new route cache along with the destination address in map
        */
-      std::pair<std::map<Ipv4Address, std::list<DsrRouteCacheEntry> >::iterator, bool> result =
-        m_sortedRoutes.insert (std::make_pair (dst, rtVector));
-      return result.second;
+      return SetRoutes (dst, rtVector);
     }
   else
     {
-      rtVector = i->second;
+      rtVector = m_sortedRoutes.find (dst)->second;
       NS_LOG_DEBUG ("The existing route size " << rtVector.size () << " for destination address " << dst);
       /**
        * \brief Drop the most aged packet when buffer reaches to max
@@ -702,18 +1238,15 @@ DsrRouteCache::AddRoute (DsrRouteCacheEntry & rt)
               rtVector.push_back (rt);
               // This sort function will sort the route cache entries based on the size of route in each of the
               // route entries
-              rtVector.sort (CompareRoutesExpire);
+              SortRoutes (rtVector);
               NS_LOG_DEBUG ("The first time" << rtVector.front ().GetExpireTime ().GetSeconds () << " The second time "
                                              << rtVector.back ().GetExpireTime ().GetSeconds ());
               NS_LOG_DEBUG ("The first hop" << rtVector.front ().GetVector ().size () << " The second hop "
                                             << rtVector.back ().GetVector ().size ());
-              m_sortedRoutes.erase (dst);               // erase the route entries for dst first
               /**
                * Save the new route cache along with the destination address in map
                */
-              std::pair<std::map<Ipv4Address, std::list<DsrRouteCacheEntry> >::iterator, bool> result =
-                m_sortedRoutes.insert (std::make_pair (dst, rtVector));
-              return result.second;
+              return SetRoutes (dst, rtVector);
             }
           else
             {
@@ -743,14 +1276,11 @@ bool DsrRouteCache::FindSameRoute (DsrRouteCacheEntry & rt, std::list<DsrRouteCa
             {
               i->SetExpireTime (rt.GetExpireTime ());
             }
-          m_sortedRoutes.erase (rt.GetDestination ()); // erase the entry first
-          rtVector.sort (CompareRoutesExpire);  // sort the route vector first
+          SortRoutes (rtVector);  // sort the route vector first
           /*
            * Save the new route cache along with the destination address in map
            */
-          std::pair<std::map<Ipv4Address, std::list<DsrRouteCacheEntry> >::iterator, bool> result =
-            m_sortedRoutes.insert (std::make_pair (rt.GetDestination (), rtVector));
-          return result.second;
+          return SetRoutes (rt.GetDestination (), rtVector);
         }
     }
   return false;
@@ -760,9 +1290,9 @@ bool
 DsrRouteCache::DeleteRoute (Ipv4Address dst)
 {
   NS_LOG_FUNCTION (this << dst);
-  Purge (); // purge the route cache first to remove timeout entries
-  if (m_sortedRoutes.erase (dst) != 0)
+  if (PurgeRoutes (dst)) // purge the routes first to remove timeout entries
     {
+      SetRoutes (dst, std::list<DsrRouteCacheEntry> ());
       NS_LOG_LOGIC ("Route deletion to " << dst << " successful");
       return true;
     }
@@ -782,36 +1312,35 @@ DsrRouteCache::DeleteAllRoutesIncludeLink (Ipv4Address errorSrc, Ipv4Address unr
        * The followings are for cleaning the broken link in link cache
        * We basically remove the link between errorSrc and unreachNode
        */
-      Link link1 (errorSrc, unreachNode);
-      Link link2 (unreachNode, errorSrc);
-      // erase the two kind of links to make sure the link is removed from the link cache
+      uint32_t from = FindGraphIndex (errorSrc);
+      uint32_t to = FindGraphIndex (unreachNode);
       NS_LOG_DEBUG ("Erase the route");
-      m_linkCache.erase (link1);
-      /// \todo get rid of this one
-      NS_LOG_DEBUG ("The link cache size " << m_linkCache.size());
-      m_linkCache.erase (link2);
-      NS_LOG_DEBUG ("The link cache size " << m_linkCache.size());
-
-      std::map<Ipv4Address, DsrNodeStab>::iterator i = m_nodeCache.find (errorSrc);
-      if (i == m_nodeCache.end ())
+      if (from != DsrPathHeap::NONE && to != DsrPathHeap::NONE)
+        {
+          RemoveGraphLink (from, to);
+        }
+      NS_LOG_DEBUG ("The link cache size " << m_linkCount);
+
+      if (from == DsrPathHeap::NONE || !IsNodeCached (from))
         {
           NS_LOG_LOGIC ("Update the node stability unsuccessfully");
         }
       else
         {
-          DecStability (i->first);
+          DecStability (from);
         }
-      i = m_nodeCache.find (unreachNode);
-      if (i == m_nodeCache.end ())
+      if (to == DsrPathHeap::NONE || !IsNodeCached (to))
         {
           NS_LOG_LOGIC ("Update the node stability unsuccessfully");
         }
       else
         {
-          DecStability (i->first);
+          DecStability (to);
+        }
+      if (m_treeRoot == DsrPathHeap::NONE || m_graphNodes[m_treeRoot] != node)
+        {
+          RebuildBestRouteTable (node);
         }
-      UpdateNetGraph ();
-      RebuildBestRouteTable (node);
     }
   else
     {
@@ -830,7 +1359,6 @@ DsrRouteCache::DeleteAllRoutesIncludeLink (Ipv4Address errorSrc, Ipv4Address unr
       for (std::map<Ipv4Address, std::list<DsrRouteCacheEntry> >::iterator j =
              m_sortedRoutes.begin (); j != m_sortedRoutes.end (); )
         {
-          std::map<Ipv4Address, std::list<DsrRouteCacheEntry> >::iterator jtmp = j;
           Ipv4Address address = j->first;
           std::list<DsrRouteCacheEntry> rtVector = j->second;
           /*
@@ -908,22 +1436,18 @@ DsrRouteCache::DeleteAllRoutesIncludeLink (Ipv4Address errorSrc, Ipv4Address unr
                 }
             }
           ++j;
-          if (!IsLinkCache ())
-            {
-              m_sortedRoutes.erase (jtmp);
-            }
           if (rtVector.size ())
             {
               /*
                * Save the new route cache along with the destination address in map
                */
-              rtVector.sort (CompareRoutesExpire);
-              m_sortedRoutes[address] = rtVector;
+              SortRoutes (rtVector);
             }
           else
             {
               NS_LOG_DEBUG ("There is no route left for that destination " << address);
             }
+          SetRoutes (address, rtVector);
         }
     }
 }
@@ -974,56 +1498,8 @@ DsrRouteCache::Purge ()
   for (std::map<Ipv4Address, std::list<DsrRouteCacheEntry> >::iterator i =
          m_sortedRoutes.begin (); i != m_sortedRoutes.end (); )
     {
-      // Loop of route cache entry with the route size
-      std::map<Ipv4Address, std::list<DsrRouteCacheEntry> >::iterator itmp = i;
-      /*
-       * The route cache entry vector
-       */
-      Ipv4Address dst = i->first;
-      std::list<DsrRouteCacheEntry> rtVector = i->second;
-      NS_LOG_DEBUG ("The route vector size of 1 " << dst << " " << rtVector.size ());
-      if (rtVector.size ())
-        {
-          for (std::list<DsrRouteCacheEntry>::iterator j = rtVector.begin (); j != rtVector.end (); )
-            {
-              NS_LOG_DEBUG ("The expire time of every entry with expire time " << j->GetExpireTime ());
-              /*
-               * First verify if the route has expired or not
-               */
-              if (j->GetExpireTime () <= Seconds (0))
-                {
-                  /*
-                   * When the expire time has passed, erase the certain route
-                   */
-                  NS_LOG_DEBUG ("Erase the expired route for " << dst << " with expire time " << j->GetExpireTime ());
-                  j = rtVector.erase (j);
-                }
-              else
-                {
-                  ++j;
-                }
-            }
-          NS_LOG_DEBUG ("The route vector size of 2 " << dst << " " << rtVector.size ());
-          if (rtVector.size ())
-            {
-              ++i;
-              m_sortedRoutes.erase (itmp); // erase the entry first
-              /*
-               * Save the new route cache along with the destination address in map
-               */
-              m_sortedRoutes.insert (std::make_pair (dst, rtVector));
-            }
-          else
-            {
-              ++i;
-              m_sortedRoutes.erase (itmp);
-            }
-        }
-      else
-        {
-          ++i;
-          m_sortedRoutes.erase (itmp);
-        }
+      Ipv4Address dst = (i++)->first;
+      PurgeRoutes (dst);
     }
   return;
 }
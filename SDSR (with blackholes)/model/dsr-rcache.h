@@ -39,6 +39,7 @@
 #include <sys/types.h>
 #include <iostream>
 #include <vector>
+#include <unordered_map>
 
 #include "ns3/simulator.h"
 #include "ns3/timer.h"
@@ -171,6 +172,83 @@ private:
   Time m_nodeStability;
 };
 
+/**
+ * \ingroup dsr
+ * \brief Trust in a node as a relay, fed by the two hop acks of the packets it should forward
+ *
+ * Delivered and lost packets are counted with an exponential decay so that old evidence
+ * fades out. The trust is (delivered + 1) / (delivered + lost + 1), so a node starts fully
+ * trusted and only losses lower it.
+ */
+class DsrNodeTrust
+{
+public:
+  DsrNodeTrust ();
+  /**
+   * \brief Account for one packet the node should have forwarded
+   * \param delivered true if the packet made it past the node
+   * \param decay the weight kept by the former evidence, in [0, 1]
+   */
+  void Update (bool delivered, double decay);
+  /**
+   * \brief Get the trust
+   * \return the trust, in (0, 1]
+   */
+  double GetTrust () const;
+private:
+  double m_delivered;   ///< decayed count of delivered packets
+  double m_lost;        ///< decayed count of lost packets
+};
+
+/**
+ * \ingroup dsr
+ * \brief Indexed binary min-heap of node indices used by the link cache shortest path search
+ *
+ * Every node index sits at most once in the heap and its key can be changed in place,
+ * so a relaxation costs O(log n) instead of the former linear scan for the closest node.
+ */
+class DsrPathHeap
+{
+public:
+  static const uint32_t NONE = 0xffffffff;              ///< Position of a node not in the heap
+
+  /**
+   * \brief Make room for the node indices [0, size)
+   * \param size the number of node indices
+   */
+  void Reserve (uint32_t size);
+  /**
+   * \brief Insert a node or change its key if it is already queued
+   * \param node the node index
+   * \param key the shortest path estimate of the node
+   */
+  void Push (uint32_t node, uint32_t key);
+  /**
+   * \brief Remove the node with the smallest key, ties go to the smallest index
+   * \return the node index
+   */
+  uint32_t Pop ();
+  /**
+   * \brief Remove all the queued nodes
+   */
+  void Clear ();
+  bool IsEmpty () const
+  {
+    return m_heap.empty ();
+  }
+
+private:
+  /// Move the entry at pos up until the heap order holds
+  void SiftUp (uint32_t pos);
+  /// Move the entry at pos down until the heap order holds
+  void SiftDown (uint32_t pos);
+  /// Swap the entries at a and b and fix their positions
+  void Swap (uint32_t a, uint32_t b);
+
+  std::vector<std::pair<uint32_t, uint32_t> > m_heap;   ///< The (key, node index) entries in heap order
+  std::vector<uint32_t> m_position;                     ///< The heap position of each node index
+};
+
 class DsrRouteCacheEntry
 {
 public:
@@ -212,6 +290,14 @@ public:
   {
     return m_path;
   }
+  /**
+   * \brief Access the route without copying it
+   * \return the route, valid as long as the entry is
+   */
+  IP_VECTOR const & PeekVector () const
+  {
+    return m_path;
+  }
   void SetVector (IP_VECTOR v)
   {
     m_path = v;
@@ -365,6 +451,22 @@ public:
   {
     m_initStability = initStability;
   }
+  double GetTrustDecay () const
+  {
+    return m_trustDecay;
+  }
+  void SetTrustDecay (double trustDecay)
+  {
+    m_trustDecay = trustDecay;
+  }
+  uint32_t GetTrustPenalty () const
+  {
+    return m_trustPenalty;
+  }
+  void SetTrustPenalty (uint32_t trustPenalty)
+  {
+    m_trustPenalty = trustPenalty;
+  }
   Time GetMinLifeTime () const
   {
     return m_minLifeTime;
@@ -401,6 +503,13 @@ public:
    * \return true on success
    */
   bool LookupRoute (Ipv4Address id, DsrRouteCacheEntry & rt);
+  /**
+   * \brief Lookup route cache entry with destination address id without copying it
+   * \param id destination address
+   * \return the entry stored in the route cache, 0 if there is no route. The entry stays
+   * valid until the next call that changes the route cache
+   */
+  DsrRouteCacheEntry const * LookupRouteEntry (Ipv4Address id);
   /**
    * \brief Print the route vector elements
    * \param vec the route vector
@@ -546,6 +655,8 @@ private:
   Time m_initStability;
   Time m_minLifeTime;
   Time m_useExtends;
+  double m_trustDecay;                                  ///< The weight kept by the former trust evidence
+  uint32_t m_trustPenalty;                              ///< The extra hops a relay of no trust counts for
   /**
    * Define the route cache data structure
    */
@@ -563,20 +674,58 @@ private:
 
   bool m_subRoute;                                              ///< Check if save the sub route entries or not
   /**
-   * The link cache to update all the link status, bi-link is two link for link is a struct
-   * when the weight is calculated we normalized them: 100*weight/max of Weight
+   * Reverse index of the path cache, for every intermediate hop the destinations whose routes
+   * pass through it together with the number of such routes. A sub route lookup only visits
+   * these destinations instead of every route in the cache
    */
-  #define MAXWEIGHT 0xFFFF;
+  std::map<Ipv4Address, std::map<Ipv4Address, uint32_t> > m_hopIndex;
+  DsrRouteCacheEntry m_linkLookupEntry;                         ///< The entry built by the last link cache lookup
   /**
-   * Current network graph state for this node, double is weight, which is calculated by the node information
-   * and link information, any time some changes of link cache and node cache
-   * change the weight and then recompute the best choice for each node
+   * \brief Add or remove the intermediate hops of a route in the reverse hop index
+   * \param dst the destination the route is stored with
+   * \param route the route
+   * \param add true to add the hops, false to remove them
    */
-  std::map<Ipv4Address, std::map<Ipv4Address, uint32_t> > m_netGraph;
-
-  std::map<Ipv4Address, DsrRouteCacheEntry::IP_VECTOR> m_bestRoutesTable_link;     ///< for link route cache
-  std::map<Link, DsrLinkStab> m_linkCache;                                         ///< The data structure to store link info
-  std::map<Ipv4Address, DsrNodeStab> m_nodeCache;                                  ///< The data structure to store node info
+  void IndexRoute (Ipv4Address dst, DsrRouteCacheEntry::IP_VECTOR const & route, bool add);
+  /**
+   * \brief Replace the route list of a destination and keep the reverse hop index up to date
+   * \param dst the destination
+   * \param rtVector the new route list, an empty list removes the destination
+   * \return true in success
+   */
+  bool SetRoutes (Ipv4Address dst, routeEntryVector const & rtVector);
+  /**
+   * \brief Remove the expired routes of one destination, the destination is removed once it has no route left
+   * \param dst the destination
+   * \return true if the destination still has routes
+   */
+  bool PurgeRoutes (Ipv4Address dst);
+  /**
+   * One direction of a link in the network graph, both directions of a link carry the same stability
+   */
+  struct GraphEdge
+  {
+    uint32_t m_to;                                      ///< The graph index of the neighbor
+    uint32_t m_weight;                                  ///< The weight of the link
+    Time m_expire;                                      ///< The time the link stability runs out
+  };
+  /**
+   * Current network graph state for this node, it is the link cache and the node cache at once.
+   * Every address seen in the link cache gets a dense graph index, the links of a node are kept
+   * in one flat vector and a node whose stability has run out counts as not cached. Any time a link
+   * is added or removed the shortest path tree rooted at this node is repaired instead of being
+   * recomputed from scratch
+   */
+  std::unordered_map<Ipv4Address, uint32_t, Ipv4AddressHash> m_graphIndex;         ///< The graph index of each address
+  std::vector<Ipv4Address> m_graphNodes;                                           ///< The address of each graph index
+  std::vector<std::vector<GraphEdge> > m_graphAdj;                                 ///< The links of each graph index
+  std::vector<DsrNodeStab> m_nodeStab;                                             ///< The node stability of each graph index
+  std::vector<DsrNodeTrust> m_nodeTrust;                                           ///< The relay trust of each graph index
+  uint32_t m_linkCount;                                                            ///< The number of links in the graph
+  uint32_t m_treeRoot;                                                             ///< The graph index of the tree source, NONE before the first build
+  std::vector<uint32_t> m_distance;                                                ///< The shortest path estimate of each graph index
+  std::vector<uint32_t> m_preceding;                                               ///< The preceding graph index on the best route, NONE if unreachable
+  DsrPathHeap m_pathHeap;                                                          ///< The nodes waiting to be settled
   /**
    * \brief used by LookupRoute when LinkCache
    * \param id the ip address we are looking for
@@ -585,18 +734,111 @@ private:
   bool LookupRoute_Link (Ipv4Address id, DsrRouteCacheEntry & rt);
   /**
    * \brief increase the stability of the node
-   * \param node the ip address of the node we want to increase stability
+   * \param node the graph index of the node we want to increase stability
    */
-  bool IncStability (Ipv4Address node);
+  bool IncStability (uint32_t node);
   /**
    * \brief decrease the stability of the node
-   * \param node the ip address of the node we want to decrease stability
+   * \param node the graph index of the node we want to decrease stability
+   */
+  bool DecStability (uint32_t node);
+  /**
+   * \brief Check if the node cache holds a node
+   * \param node the graph index of the node
+   * \return true if the stability of the node has not run out
+   */
+  bool IsNodeCached (uint32_t node) const;
+  /**
+   * \brief Get the graph index of an address, allocating one if the address is new
+   * \param address the ip address of the node
+   * \return the graph index
+   */
+  uint32_t GetGraphIndex (Ipv4Address address);
+  /**
+   * \brief Get the graph index of an address
+   * \param address the ip address of the node
+   * \return the graph index, DsrPathHeap::NONE if the address is not in the graph
+   */
+  uint32_t FindGraphIndex (Ipv4Address address) const;
+  /**
+   * \brief Find one direction of a link
+   * \param from the graph index of one end
+   * \param to the graph index of the other end
+   * \return the edge stored with from, 0 if there is no such link
+   */
+  GraphEdge * FindEdge (uint32_t from, uint32_t to);
+  /**
+   * \brief Add or refresh a link in the network graph and repair the shortest path tree
+   * \param a the graph index of one end of the link
+   * \param b the graph index of the other end of the link
+   * \param stab the link stability
+   */
+  void AddGraphLink (uint32_t a, uint32_t b, DsrLinkStab const & stab);
+  /**
+   * \brief Set the stability of both directions of a link
+   * \param edge one direction of the link
+   * \param from the graph index the edge is stored with
+   * \param stab the link stability
    */
-  bool DecStability (Ipv4Address node);
+  void SetLinkStab (GraphEdge & edge, uint32_t from, DsrLinkStab const & stab);
+  /**
+   * \brief Remove a link from the network graph and repair the shortest path tree
+   * \param a the graph index of one end of the link
+   * \param b the graph index of the other end of the link
+   */
+  void RemoveGraphLink (uint32_t a, uint32_t b);
+  /**
+   * \brief Get the weight of a link
+   * \param a the graph index of one end of the link
+   * \param b the graph index of the other end of the link
+   * \return the weight used by the shortest path search
+   */
+  uint32_t GetLinkWeight (uint32_t a, uint32_t b) const;
+  /**
+   * \brief Get the extra weight of a node for its trust
+   * \param node the graph index of the node
+   * \return the penalty, zero for a fully trusted node
+   */
+  uint32_t GetNodePenalty (uint32_t node) const;
+  /**
+   * \brief Sort the routes of a destination, the most trusted and then longest living first
+   * \param rtVector the routes
+   */
+  void SortRoutes (routeEntryVector & rtVector) const;
+  /**
+   * \brief Put the routes of a destination that go through a relay back in order after the
+   * trust in the relay changed, the other routes are not moved
+   * \param rtVector the routes, sorted but for the ones through the relay
+   * \param node the relay address
+   */
+  void RepositionRoutes (routeEntryVector & rtVector, Ipv4Address node) const;
+  /**
+   * \brief Relax the link from one node to another of the shortest path tree
+   * \param from the graph index of the settled end
+   * \param to the graph index of the other end
+   * \param weight the weight of the link
+   */
+  void Relax (uint32_t from, uint32_t to, uint32_t weight);
+  /**
+   * \brief Settle the queued nodes, this is the core of the dijkstra algorithm
+   */
+  void PropagateTree ();
+  /**
+   * \brief Recompute the part of the tree that hung from a removed tree link
+   * \param child the graph index below the removed link
+   */
+  void RepairSubtree (uint32_t child);
+  /**
+   * \brief Tie-break between two routes of the same length
+   * \param node the graph index of the node to reach
+   * \param via the graph index of the candidate preceding node
+   * \return true if the link from via has a longer expected lifetime than the current one
+   */
+  bool HasLongerLifetime (uint32_t node, uint32_t via);
 
 public:
   /**
-   * \brief Dijsktra algorithm to get the best route from m_netGraph and update the m_bestRoutesTable_link
+   * \brief Dijsktra algorithm to get the best route from the network graph and update the shortest path tree
    * when current graph information has changed
    * \param type The type of the cache
    */
@@ -604,7 +846,8 @@ public:
   bool IsLinkCache ();
   bool AddRoute_Link (DsrRouteCacheEntry::IP_VECTOR nodelist, Ipv4Address node);
   /**
-   *  \brief USE MAXWEIGHT TO REPRESENT MAX; USE BROADCAST ADDRESS TO REPRESENT NULL PRECEEDING ADDRESS
+   *  \brief Recompute the whole shortest path tree rooted at source, links added or removed
+   *  later are repaired incrementally
    *  \param source The source address the routes based on
    */
   void RebuildBestRouteTable (Ipv4Address source);
@@ -617,9 +860,29 @@ public:
    */
   void UseExtends (DsrRouteCacheEntry::IP_VECTOR rt);
   /**
-   *  \brief Update the Net Graph for the link and node cache has changed
+   *  \brief Recompute the weight of every link of the Net Graph and rebuild the tree if one
+   *  has been built
    */
   void UpdateNetGraph ();
+  /**
+   * \brief Account for a packet a relay should have forwarded, the link weights and the route
+   * order follow the new trust
+   * \param node the relay address
+   * \param delivered true if the packet made it past the relay
+   */
+  void UpdateTrust (Ipv4Address node, bool delivered);
+  /**
+   * \brief Get the trust in a relay
+   * \param node the relay address
+   * \return the trust, one for a node nothing is known about
+   */
+  double GetTrust (Ipv4Address node) const;
+  /**
+   * \brief Get the trust penalty of a route
+   * \param route the route, its first and last node are not relays and do not count
+   * \return the sum of the penalties of the relays
+   */
+  uint32_t GetRoutePenalty (DsrRouteCacheEntry::IP_VECTOR const & route) const;
   //---------------------------------------------------------------------------------------
   /**
    * The following code handles link-layer acks
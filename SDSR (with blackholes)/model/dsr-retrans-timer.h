@@ -0,0 +1,407 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2026 The SDSR contributors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: The SDSR contributors, see the git history
+ */
+
+#ifndef DSR_RETRANS_TIMER_H
+#define DSR_RETRANS_TIMER_H
+
+#include <vector>
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
+#include "ns3/simulator.h"
+#include "ns3/event-id.h"
+#include "ns3/callback.h"
+#include "ns3/ipv4-address.h"
+#include "dsr-maintain-buff.h"
+
+namespace ns3 {
+namespace dsr {
+/**
+ * \ingroup dsr
+ * \brief Retransmission timers of the packets in the maintenance buffer
+ *
+ * Every key has its own deadline and buffer entry, but all the timers share
+ * a single simulator event scheduled for the earliest deadline.  A stopped
+ * timer leaves its heap item behind, the item is skipped once it surfaces.
+ * The retry count of a key outlives its timer until the key is cancelled.
+ */
+template <typename Key, typename Hash>
+class DsrRetransTimer
+{
+public:
+  /// Function called with the buffered entry and the protocol number when a timer expires
+  typedef Callback<void, DsrMaintainBuffEntry &, uint8_t> ExpireCallback;
+
+  DsrRetransTimer ()
+    : m_running (0),
+      m_nextGeneration (0),
+      m_events (0),
+      m_expiring (false)
+  {
+  }
+  ~DsrRetransTimer ()
+  {
+    m_event.Cancel ();
+  }
+  /**
+   * \param expire the function to call when a timer expires
+   */
+  void SetFunction (ExpireCallback expire)
+  {
+    m_expire = expire;
+  }
+  /**
+   * Arm the timer of a key, replacing the one already running
+   *
+   * \param key the key of the timer
+   * \param delay the delay from now
+   * \param mb the entry handed to the expire function
+   * \param protocol the protocol number handed to the expire function
+   */
+  void Schedule (Key const & key, Time delay, DsrMaintainBuffEntry const & mb, uint8_t protocol);
+  /**
+   * Stop the timer of a key and forget its retry count
+   *
+   * \param key the key of the timer
+   */
+  void Cancel (Key const & key);
+  /**
+   * Delay all the running timers towards a next hop
+   *
+   * \param nextHop the next hop of the buffered entries
+   * \param delay the time added to each of the timers
+   */
+  void Shift (Ipv4Address nextHop, Time delay);
+  /**
+   * \param key the key of the timer
+   * \return true if the timer of the key is running
+   */
+  bool IsRunning (Key const & key) const;
+  /**
+   * \param key the key of the timer
+   * \return the time left before the timer of the key expires, zero if it is not running
+   */
+  Time GetDelayLeft (Key const & key) const;
+  /**
+   * \param key the key of the timer
+   * \return the retry count of the key
+   */
+  uint32_t GetRetries (Key const & key) const;
+  /**
+   * \param key the key of the timer
+   * \param retries the retry count of the key
+   */
+  void SetRetries (Key const & key, uint32_t retries);
+  /**
+   * \return the number of running timers
+   */
+  uint32_t GetSize () const
+  {
+    return m_running;
+  }
+  /**
+   * \return the number of simulator events scheduled so far
+   */
+  uint64_t GetScheduledEvents () const
+  {
+    return m_events;
+  }
+  /**
+   * Stop all the timers and forget all the retry counts
+   */
+  void Clear ();
+
+private:
+  /// The state of one key
+  struct Slot
+  {
+    uint32_t m_retries;                 ///< The retry count
+    bool m_running;                     ///< Whether the timer is armed
+    Time m_deadline;                    ///< The absolute expire time
+    uint64_t m_generation;              ///< Arm order, breaks ties between equal deadlines
+    DsrMaintainBuffEntry m_entry;       ///< The entry handed to the expire function
+    uint8_t m_protocol;                 ///< The protocol number handed to the expire function
+    Ipv4Address m_nextHop;              ///< The next hop of the entry
+    Slot ()
+      : m_retries (0),
+        m_running (false),
+        m_generation (0),
+        m_protocol (0)
+    {
+    }
+  };
+  /// A deadline in the heap, stale once the slot has been stopped or moved
+  struct Item
+  {
+    Time m_deadline;                    ///< The absolute expire time
+    uint64_t m_generation;              ///< The generation of the slot
+    Key m_key;                          ///< The key of the slot
+  };
+  /// Order of the heap, the earliest deadline on top
+  struct Later
+  {
+    bool operator() (Item const & a, Item const & b) const
+    {
+      if (a.m_deadline != b.m_deadline)
+        {
+          return a.m_deadline > b.m_deadline;
+        }
+      return a.m_generation > b.m_generation;
+    }
+  };
+  typedef std::unordered_map<Key, Slot, Hash> Slots;
+
+  /// Stop the timer of a slot, the retry count is kept
+  void Stop (Key const & key, Slot & slot);
+  /// Push the deadline of a slot into the heap
+  void Push (Key const & key, Slot const & slot);
+  /// \return true if the item still matches a running timer
+  bool IsCurrent (Item const & item) const;
+  /// Fire all the timers that are due
+  void Expire ();
+  /// Schedule the simulator event for the earliest deadline
+  void Rearm ();
+
+  Slots m_slots;                                                            ///< The state of every key
+  std::vector<Item> m_heap;                                                 ///< The deadlines, earliest first
+  std::unordered_map<Ipv4Address, std::unordered_set<Key, Hash>, Ipv4AddressHash> m_byNextHop;  ///< The running keys by next hop
+  uint32_t m_running;                                                       ///< The number of running timers
+  uint64_t m_nextGeneration;                                                ///< The generation of the next armed timer
+  uint64_t m_events;                                                        ///< The number of simulator events scheduled
+  EventId m_event;                                                          ///< The simulator event for the earliest deadline
+  Time m_eventTime;                                                         ///< The time m_event is scheduled for
+  bool m_expiring;                                                          ///< Whether Expire is running
+  ExpireCallback m_expire;                                                  ///< The expire function
+};
+
+template <typename Key, typename Hash>
+void
+DsrRetransTimer<Key, Hash>::Schedule (Key const & key, Time delay, DsrMaintainBuffEntry const & mb, uint8_t protocol)
+{
+  Slot & slot = m_slots[key];
+  Stop (key, slot);
+  slot.m_running = true;
+  slot.m_deadline = Simulator::Now () + delay;
+  slot.m_generation = m_nextGeneration++;
+  slot.m_entry = mb;
+  slot.m_protocol = protocol;
+  slot.m_nextHop = mb.GetNextHop ();
+  m_byNextHop[slot.m_nextHop].insert (key);
+  ++m_running;
+  Push (key, slot);
+  if (!m_event.IsRunning () || slot.m_deadline < m_eventTime)
+    {
+      Rearm ();
+    }
+}
+
+template <typename Key, typename Hash>
+void
+DsrRetransTimer<Key, Hash>::Cancel (Key const & key)
+{
+  typename Slots::iterator i = m_slots.find (key);
+  if (i == m_slots.end ())
+    {
+      return;
+    }
+  Stop (key, i->second);
+  m_slots.erase (i);
+}
+
+template <typename Key, typename Hash>
+void
+DsrRetransTimer<Key, Hash>::Shift (Ipv4Address nextHop, Time delay)
+{
+  typename std::unordered_map<Ipv4Address, std::unordered_set<Key, Hash>, Ipv4AddressHash>::const_iterator group = m_byNextHop.find (nextHop);
+  if (group == m_byNextHop.end ())
+    {
+      return;
+    }
+  /*
+   * The deadlines only move later, so the old items are recognised as stale
+   * and the simulator event never needs to be earlier
+   */
+  for (typename std::unordered_set<Key, Hash>::const_iterator k = group->second.begin (); k != group->second.end (); ++k)
+    {
+      Slot & slot = m_slots.find (*k)->second;
+      slot.m_deadline += delay;
+      Push (*k, slot);
+    }
+}
+
+template <typename Key, typename Hash>
+bool
+DsrRetransTimer<Key, Hash>::IsRunning (Key const & key) const
+{
+  typename Slots::const_iterator i = m_slots.find (key);
+  return (i != m_slots.end () && i->second.m_running);
+}
+
+template <typename Key, typename Hash>
+Time
+DsrRetransTimer<Key, Hash>::GetDelayLeft (Key const & key) const
+{
+  typename Slots::const_iterator i = m_slots.find (key);
+  if (i == m_slots.end () || !i->second.m_running)
+    {
+      return Seconds (0);
+    }
+  return i->second.m_deadline - Simulator::Now ();
+}
+
+template <typename Key, typename Hash>
+uint32_t
+DsrRetransTimer<Key, Hash>::GetRetries (Key const & key) const
+{
+  typename Slots::const_iterator i = m_slots.find (key);
+  if (i == m_slots.end ())
+    {
+      return 0;
+    }
+  return i->second.m_retries;
+}
+
+template <typename Key, typename Hash>
+void
+DsrRetransTimer<Key, Hash>::SetRetries (Key const & key, uint32_t retries)
+{
+  m_slots[key].m_retries = retries;
+}
+
+template <typename Key, typename Hash>
+void
+DsrRetransTimer<Key, Hash>::Clear ()
+{
+  m_event.Cancel ();
+  m_slots.clear ();
+  m_heap.clear ();
+  m_byNextHop.clear ();
+  m_running = 0;
+}
+
+template <typename Key, typename Hash>
+void
+DsrRetransTimer<Key, Hash>::Stop (Key const & key, Slot & slot)
+{
+  if (!slot.m_running)
+    {
+      return;
+    }
+  slot.m_running = false;
+  --m_running;
+  typename std::unordered_map<Ipv4Address, std::unordered_set<Key, Hash>, Ipv4AddressHash>::iterator group = m_byNextHop.find (slot.m_nextHop);
+  group->second.erase (key);
+  if (group->second.empty ())
+    {
+      m_byNextHop.erase (group);
+    }
+  /*
+   * The simulator event is left alone, it finds nothing due and moves on to the
+   * next deadline; the heap is rebuilt once stale items outnumber the timers
+   */
+  if (m_heap.size () > 2 * m_running + 32)
+    {
+      std::vector<Item> heap;
+      for (typename std::vector<Item>::const_iterator i = m_heap.begin (); i != m_heap.end (); ++i)
+        {
+          if (IsCurrent (*i))
+            {
+              heap.push_back (*i);
+            }
+        }
+      std::make_heap (heap.begin (), heap.end (), Later ());
+      m_heap.swap (heap);
+    }
+}
+
+template <typename Key, typename Hash>
+void
+DsrRetransTimer<Key, Hash>::Push (Key const & key, Slot const & slot)
+{
+  Item item;
+  item.m_deadline = slot.m_deadline;
+  item.m_generation = slot.m_generation;
+  item.m_key = key;
+  m_heap.push_back (item);
+  std::push_heap (m_heap.begin (), m_heap.end (), Later ());
+}
+
+template <typename Key, typename Hash>
+bool
+DsrRetransTimer<Key, Hash>::IsCurrent (Item const & item) const
+{
+  typename Slots::const_iterator i = m_slots.find (item.m_key);
+  return (i != m_slots.end () && i->second.m_running
+          && i->second.m_generation == item.m_generation
+          && i->second.m_deadline == item.m_deadline);
+}
+
+template <typename Key, typename Hash>
+void
+DsrRetransTimer<Key, Hash>::Expire ()
+{
+  m_expiring = true;
+  while (!m_heap.empty () && m_heap.front ().m_deadline <= Simulator::Now ())
+    {
+      Item item = m_heap.front ();
+      std::pop_heap (m_heap.begin (), m_heap.end (), Later ());
+      m_heap.pop_back ();
+      if (!IsCurrent (item))
+        {
+          continue;
+        }
+      Slot & slot = m_slots.find (item.m_key)->second;
+      Stop (item.m_key, slot);
+      // The expire function may arm or cancel this key again
+      DsrMaintainBuffEntry mb = slot.m_entry;
+      uint8_t protocol = slot.m_protocol;
+      m_expire (mb, protocol);
+    }
+  m_expiring = false;
+  Rearm ();
+}
+
+template <typename Key, typename Hash>
+void
+DsrRetransTimer<Key, Hash>::Rearm ()
+{
+  if (m_expiring)
+    {
+      return;
+    }
+  while (!m_heap.empty () && !IsCurrent (m_heap.front ()))
+    {
+      std::pop_heap (m_heap.begin (), m_heap.end (), Later ());
+      m_heap.pop_back ();
+    }
+  m_event.Cancel ();
+  if (m_heap.empty ())
+    {
+      return;
+    }
+  m_eventTime = m_heap.front ().m_deadline;
+  m_event = Simulator::Schedule (m_eventTime - Simulator::Now (), &DsrRetransTimer<Key, Hash>::Expire, this);
+  ++m_events;
+}
+
+} // namespace dsr
+} // namespace ns3
+
+#endif /* DSR_RETRANS_TIMER_H */
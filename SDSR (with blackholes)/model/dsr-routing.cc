@@ -52,6 +52,7 @@
 #include "ns3/node-list.h"
 #include "ns3/double.h"
 #include "ns3/pointer.h"
+#include "ns3/object-factory.h"
 #include "ns3/timer.h"
 #include "ns3/object-vector.h"
 #include "ns3/ipv4-address.h"
@@ -130,6 +131,25 @@ TypeId DsrRouting::GetTypeId ()
                    MakePointerAccessor (&DsrRouting::SetPassiveBuffer,
                                         &DsrRouting::GetPassiveBuffer),
                    MakePointerChecker<DsrPassiveBuffer> ())
+    .AddAttribute ("Adversary",
+                   "The attacker nodes and what they do, "
+                   "built from the DsrAdversary defaults when not set.",
+                   PointerValue (0),
+                   MakePointerAccessor (&DsrRouting::SetAdversary,
+                                        &DsrRouting::GetAdversary),
+                   MakePointerChecker<DsrAdversary> ())
+    .AddAttribute ("AckPolicy",
+                   "Picks the ack mode of the data packets this node originates, "
+                   "built from AckPolicyType when not set.",
+                   PointerValue (0),
+                   MakePointerAccessor (&DsrRouting::SetAckPolicy,
+                                        &DsrRouting::GetAckPolicy),
+                   MakePointerChecker<DsrAckPolicy> ())
+    .AddAttribute ("AckPolicyType",
+                   "The type of the ack policy every node builds for itself.",
+                   TypeIdValue (DsrAdaptiveAckPolicy::GetTypeId ()),
+                   MakeTypeIdAccessor (&DsrRouting::m_ackPolicyTypeId),
+                   MakeTypeIdChecker ())
     .AddAttribute ("MaxSendBuffLen",
                    "Maximum number of packets that can be stored "
                    "in send buffer.",
@@ -307,6 +327,18 @@ TypeId DsrRouting::GetTypeId ()
                    TimeValue (Seconds (120)),
                    MakeTimeAccessor (&DsrRouting::m_useExtends),
                    MakeTimeChecker ())
+    .AddAttribute ("TrustDecay",
+                   "The weight the former two hop ack evidence keeps in the trust of a relay "
+                   "when a new outcome is accounted for.",
+                   DoubleValue (0.9),
+                   MakeDoubleAccessor (&DsrRouting::m_trustDecay),
+                   MakeDoubleChecker<double> (0.0, 1.0))
+    .AddAttribute ("TrustPenalty",
+                   "The extra hops a relay of no trust counts for in the route selection, "
+                   "zero ignores the trust.",
+                   UintegerValue (4),
+                   MakeUintegerAccessor (&DsrRouting::m_trustPenalty),
+                   MakeUintegerChecker<uint32_t> ())
     .AddAttribute ("EnableSubRoute",
                    "Enables saving of sub route when receiving "
                    "route error messages, only available when "
@@ -340,6 +372,57 @@ TypeId DsrRouting::GetTypeId ()
                    BooleanValue (true),
                    MakeBooleanAccessor (&DsrRouting::m_linkAck),
                    MakeBooleanChecker ())
+    .AddAttribute ("WideNodeIds",
+                   "Carry 32 bit node ids in the fixed size header instead of 16 bit ones, "
+                   "needed with more than 65535 nodes.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&DsrRouting::m_wideNodeIds),
+                   MakeBooleanChecker ())
+    .AddAttribute ("CompactAck",
+                   "Send the ack option with the real source / destination taken from the node list "
+                   "and one byte hop indices for target and original sender.",
+                   BooleanValue (true),
+                   MakeBooleanAccessor (&DsrRouting::m_compactAck),
+                   MakeBooleanChecker ())
+    .AddAttribute ("AckHoldoff",
+                   "How long an ack waits for acks of other packets of the same flow to the same "
+                   "previous hop so that they go out as one ack option, zero sends every ack at once.",
+                   TimeValue (Seconds (0)),
+                   MakeTimeAccessor (&DsrRouting::m_ackHoldoff),
+                   MakeTimeChecker ())
+    .AddAttribute ("MaxAckBatch",
+                   "The max number of packet ids one ack option covers.",
+                   UintegerValue (DsrOptionAckHeader::MAX_ACK_IDS),
+                   MakeUintegerAccessor (&DsrRouting::m_maxAckBatch),
+                   MakeUintegerChecker<uint32_t> (1, DsrOptionAckHeader::MAX_ACK_IDS))
+    .AddAttribute ("BlackholeDefense",
+                   "Whether a source avoids routes through blacklisted nodes and checks the "
+                   "route replies it gets against its blacklist.",
+                   BooleanValue (true),
+                   MakeBooleanAccessor (&DsrRouting::m_blackholeDefense),
+                   MakeBooleanChecker ())
+    .AddAttribute ("BlackListTimeout",
+                   "How long a node suspected of dropping data stays in the blacklist, every further "
+                   "strike while listed doubles it. Zero keeps suspects listed forever.",
+                   TimeValue (Seconds (60)),
+                   MakeTimeAccessor (&DsrRouting::m_blackListTimeout),
+                   MakeTimeChecker ())
+    .AddAttribute ("MaxBlackListTimeout",
+                   "The longest a repeat suspect stays in the blacklist.",
+                   TimeValue (Seconds (480)),
+                   MakeTimeAccessor (&DsrRouting::m_maxBlackListTimeout),
+                   MakeTimeChecker ())
+    .AddAttribute ("AckCorrelationTimeout",
+                   "How long the source waits for the two hop acks of a packet before the "
+                   "nodes that did not ack are looked at for a blackhole.",
+                   TimeValue (Seconds (2)),
+                   MakeTimeAccessor (&DsrRouting::m_ackCorrelationTimeout),
+                   MakeTimeChecker ())
+    .AddAttribute ("MaxAckCorrelations",
+                   "The max number of packets the source waits for two hop acks of at once.",
+                   UintegerValue (1024),
+                   MakeUintegerAccessor (&DsrRouting::m_maxAckCorrelations),
+                   MakeUintegerChecker<uint32_t> (1))
     .AddTraceSource ("Tx",
                      "Send DSR packet.",
                      MakeTraceSourceAccessor (&DsrRouting::m_txPacketTrace),
@@ -348,6 +431,14 @@ TypeId DsrRouting::GetTypeId ()
                      "Drop DSR packet",
                      MakeTraceSourceAccessor (&DsrRouting::m_dropTrace),
                      "ns3::Packet::TracedCallback")
+    .AddTraceSource ("BlackList",
+                     "A node entered or left the blacklist.",
+                     MakeTraceSourceAccessor (&DsrRouting::m_blackListTrace),
+                     "ns3::dsr::DsrBlackList::TracedCallback")
+    .AddTraceSource ("ControlTx",
+                     "Send a route request, reply, error or ack.",
+                     MakeTraceSourceAccessor (&DsrRouting::m_controlTxTrace),
+                     "ns3::dsr::DsrRouting::ControlTxCallback")
   ;
   return tid;
 }
@@ -357,6 +448,15 @@ DsrRouting::DsrRouting ()
   NS_LOG_FUNCTION_NOARGS ();
 
   m_uniformRandomVariable = CreateObject<UniformRandomVariable> ();
+  m_directory = DsrNodeDirectory::Get ();
+
+  m_linkAckTimer.SetFunction (MakeCallback (&DsrRouting::LinkScheduleTimerExpire, this));
+  m_passiveAckTimer.SetFunction (MakeCallback (&DsrRouting::PassiveScheduleTimerExpire, this));
+  m_addressForwardTimer.SetFunction (MakeCallback (&DsrRouting::NetworkScheduleTimerExpire, this));
+  m_ackBatcher.SetFlushCallback (MakeCallback (&DsrRouting::SendAckNow, this));
+  m_blackList.SetChangeCallback (MakeCallback (&DsrRouting::NotifyBlackList, this));
+  m_ackCorrelation.SetCompleteCallback (MakeCallback (&DsrRouting::AckSetComplete, this));
+  m_ackCorrelation.SetIncompleteCallback (MakeCallback (&DsrRouting::handleBlackList, this));
 
   /*
    * The following Ptr statements created objects for all the options header for DSR, and each of them have
@@ -447,28 +547,23 @@ void DsrRouting::Start ()
   passiveBuffer->SetMaxQueueLen (m_maxSendBuffLen);
   passiveBuffer->SetPassiveBufferTimeout (m_sendBufferTimeout);
   SetPassiveBuffer (passiveBuffer);
+  // The interfaces have been configured by now, index them on the next lookup
+  m_directory->Invalidate ();
 
-  /*sx blackhole option*/
-  uint16_t count = 2; // 1 = 1 blackhole, 2 = 2 blackholes 3 = no blackhole
-   switch (count) {
-      case 1:
-
-    	  if(m_node->GetId() == 12)
-    		  blackHole = true;
-    	  blackattack = true;
-          break;
-      case 2:
-    	  if(m_node->GetId() == 12 || m_node->GetId() == 18)
-    	       blackHole = true;
-    	  blackattack = true;
-        break;
-      case 3:
-    	  blackHole = false;
-    	  blackattack = false;
-        break;
-      default:
-        NS_FATAL_ERROR ("not find the blackhole option!");
-        break;
+  // Attacker nodes and their behaviour come from the adversary model
+  if (m_adversary == 0)
+    {
+      m_adversary = CreateObject<DsrAdversary> ();
+    }
+  if (m_adversary->IsAttacker (m_node->GetId ()))
+    {
+      NS_LOG_INFO ("Node " << m_node->GetId () << " is an attacker");
+    }
+  if (m_ackPolicy == 0)
+    {
+      ObjectFactory factory;
+      factory.SetTypeId (m_ackPolicyTypeId);
+      m_ackPolicy = factory.Create<DsrAckPolicy> ();
     }
 
 
@@ -483,6 +578,15 @@ void DsrRouting::Start ()
   m_maintainBuffer.SetMaintainBufferTimeout (m_maxMaintainTime);
   // Set the gratuitous reply table size
   m_graReply.SetGraTableSize (m_graReplyTableSize);
+  // Set the ack coalescing parameters
+  m_ackBatcher.SetHoldoff (m_ackHoldoff);
+  m_ackBatcher.SetMaxIds (m_maxAckBatch);
+  // Set the blacklist parameters
+  m_blackList.SetTimeout (m_blackListTimeout);
+  m_blackList.SetMaxTimeout (m_maxBlackListTimeout);
+  // Set the two hop ack correlation parameters
+  m_ackCorrelation.SetTimeout (m_ackCorrelationTimeout);
+  m_ackCorrelation.SetMaxEntries (m_maxAckCorrelations);
 
   if (m_mainAddress == Ipv4Address ())
     {
@@ -510,6 +614,8 @@ void DsrRouting::Start ()
               routeCache->SetInitStability (m_initStability);
               routeCache->SetMinLifeTime (m_minLifeTime);
               routeCache->SetUseExtends (m_useExtends);
+              routeCache->SetTrustDecay (m_trustDecay);
+              routeCache->SetTrustPenalty (m_trustPenalty);
               routeCache->ScheduleTimer ();
               // The call back to handle link error and send error message to appropriate nodes
               /// TODO whether this SendRerrWhenBreaksLinkToNextHop is used or not
@@ -690,6 +796,14 @@ DsrRouting::DoDispose (void)
             }
         }
     }
+  m_linkAckTimer.Clear ();
+  m_passiveAckTimer.Clear ();
+  m_addressForwardTimer.Clear ();
+  m_ackBatcher.Clear ();
+  m_blackList.Clear ();
+  m_ackCorrelation.Clear ();
+  m_ackPolicy = 0;
+  m_directory = 0;
   IpL4Protocol::DoDispose ();
 }
 
@@ -699,6 +813,30 @@ DsrRouting::SetNode (Ptr<Node> node)
   m_node = node;
 }
 
+void
+DsrRouting::SetAdversary (Ptr<dsr::DsrAdversary> adversary)
+{
+  m_adversary = adversary;
+}
+
+Ptr<dsr::DsrAdversary>
+DsrRouting::GetAdversary () const
+{
+  return m_adversary;
+}
+
+void
+DsrRouting::SetAckPolicy (Ptr<dsr::DsrAckPolicy> ackPolicy)
+{
+  m_ackPolicy = ackPolicy;
+}
+
+Ptr<dsr::DsrAckPolicy>
+DsrRouting::GetAckPolicy () const
+{
+  return m_ackPolicy;
+}
+
 Ptr<Node>
 DsrRouting::GetNode () const
 {
@@ -749,18 +887,7 @@ Ptr<Node>
 DsrRouting::GetNodeWithAddress (Ipv4Address ipv4Address)
 {
   NS_LOG_FUNCTION (this << ipv4Address);
-  int32_t nNodes = NodeList::GetNNodes ();
-  for (int32_t i = 0; i < nNodes; ++i)
-    {
-      Ptr<Node> node = NodeList::GetNode (i);
-      Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
-      int32_t ifIndex = ipv4->GetInterfaceForAddress (ipv4Address);
-      if (ifIndex != -1)
-        {
-          return node;
-        }
-    }
-  return 0;
+  return m_directory->GetNodeWithAddress (ipv4Address);
 }
 
 bool DsrRouting::IsLinkCache ()
@@ -812,19 +939,7 @@ Ipv4Address
 DsrRouting::GetIPfromMAC (Mac48Address address)
 {
   NS_LOG_FUNCTION (this << address);
-  int32_t nNodes = NodeList::GetNNodes ();
-  for (int32_t i = 0; i < nNodes; ++i)
-    {
-      Ptr<Node> node = NodeList::GetNode (i);
-      Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
-      Ptr<NetDevice> netDevice = ipv4->GetNetDevice (1);
-
-      if (netDevice->GetAddress () == address)
-        {
-          return ipv4->GetAddress (1, 0).GetLocal ();
-        }
-    }
-  return 0;
+  return m_directory->GetIpFromMac (address);
 }
 
 void DsrRouting::PrintVector (std::vector<Ipv4Address>& vec)
@@ -897,38 +1012,37 @@ DsrRouting::GetProtocolNumber (void) const
   return PROT_NUMBER;
 }
 
-uint16_t
+uint32_t
 DsrRouting::GetIDfromIP (Ipv4Address address)
 {
-  int32_t nNodes = NodeList::GetNNodes ();
-  for (int32_t i = 0; i < nNodes; ++i)
+  uint32_t id = m_directory->GetIdFromIp (address);
+  if (id == DsrNodeDirectory::NOT_FOUND)
     {
-      Ptr<Node> node = NodeList::GetNode (i);
-      Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
-      if (ipv4->GetAddress (1, 0).GetLocal () == address)
-        {
-          return uint16_t (i);
-        }
+      return DsrFsHeader::NO_ID;
     }
-  return 256;
+  return id;
 }
 
 Ipv4Address
-DsrRouting::GetIPfromID (uint16_t id)
+DsrRouting::GetIPfromID (uint32_t id)
 {
-  if (id >= 256)
+  if (id == DsrFsHeader::NO_ID)
     {
       NS_LOG_DEBUG ("Exceed the node range");
       return "0.0.0.0";
     }
   else
     {
-      Ptr<Node> node = NodeList::GetNode (uint32_t (id));
-      Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
-      return ipv4->GetAddress (1, 0).GetLocal ();
+      return m_directory->GetIpFromId (id);
     }
 }
 
+bool
+DsrRouting::IsWideNodeIds () const
+{
+  return m_wideNodeIds;
+}
+
 uint32_t
 DsrRouting::GetPriority (DsrMessageType messageType)
 {
@@ -957,20 +1071,21 @@ void DsrRouting::CheckSendBuffer ()
   NS_LOG_INFO (Simulator::Now ().GetSeconds ()
                << " Checking send buffer at " << m_mainAddress << " with size " << m_sendBuffer.GetSize ());
 
-  for (std::vector<DsrSendBuffEntry>::iterator i = m_sendBuffer.GetBuffer ().begin (); i != m_sendBuffer.GetBuffer ().end (); )
+  std::vector<Ipv4Address> destinations;
+  m_sendBuffer.GetDestinations (destinations);
+  for (std::vector<Ipv4Address>::const_iterator d = destinations.begin (); d != destinations.end (); ++d)
     {
       NS_LOG_DEBUG ("Here we try to find the data packet in the send buffer");
-      Ipv4Address destination = i->GetDestination ();
+      Ipv4Address destination = *d;
       DsrRouteCacheEntry toDst;
       bool findRoute = m_routeCache->LookupRoute (destination, toDst);
-      if (findRoute)
+      DsrSendBuffEntry entry;
+      while (findRoute && m_sendBuffer.Dequeue (destination, entry))
         {
           NS_LOG_INFO ("We have found a route for the packet");
-          Ptr<const Packet> packet = i->GetPacket ();
+          Ptr<const Packet> packet = entry.GetPacket ();
           Ptr<Packet> cleanP = packet->Copy ();
-          uint8_t protocol = i->GetProtocol ();
-
-          i = m_sendBuffer.GetBuffer ().erase (i);
+          uint8_t protocol = entry.GetProtocol ();
 
           DsrRoutingHeader dsrRoutingHeader;
           Ptr<Packet> copyP = packet->Copy ();
@@ -983,18 +1098,13 @@ void DsrRouting::CheckSendBuffer ()
           /*
            * Peek data to get the option type as well as length and segmentsLeft field
            */
-          uint32_t size = copyP->GetSize ();
-          uint8_t *data = new uint8_t[size];
-          copyP->CopyData (data, size);
-
-          uint8_t optionType = 0;
-          optionType = *(data);
+          uint8_t optionType = PeekOptionType (copyP);
 
           if (optionType == 3)
             {
               Ptr<dsr::DsrOptions> dsrOption;
               DsrOptionHeader dsrOptionHeader;
-              uint8_t errorType = *(data + 2);
+              uint8_t errorType = m_optionPeek[2];
 
               if (errorType == 1) // This is the Route Error Option
                 {
@@ -1032,17 +1142,19 @@ void DsrRouting::CheckSendBuffer ()
 
                   SetRoute (nextHop, m_mainAddress);
                   uint8_t length = (sourceRoute.GetLength () + newUnreach.GetLength ());
-                  dsrRoutingHeader.SetNextHeader (protocol);
-                  dsrRoutingHeader.SetMessageType (1);
-                  dsrRoutingHeader.SetSourceId (GetIDfromIP (m_mainAddress));
+                  DsrRoutingHeader newDsrRoutingHeader;
+                  newDsrRoutingHeader.SetWideIds (m_wideNodeIds);
+                  newDsrRoutingHeader.SetNextHeader (protocol);
+                  newDsrRoutingHeader.SetMessageType (1);
+                  newDsrRoutingHeader.SetSourceId (GetIDfromIP (m_mainAddress));
                   m_id = GetIDfromIP (m_mainAddress);
-                  dsrRoutingHeader.SetDestId (255);
-                  dsrRoutingHeader.SetPayloadLength (uint16_t (length) + 4);
-                  dsrRoutingHeader.AddDsrOption (newUnreach);
-                  dsrRoutingHeader.AddDsrOption (sourceRoute);
+                  newDsrRoutingHeader.SetDestId (DsrFsHeader::NO_ID);
+                  newDsrRoutingHeader.SetPayloadLength (uint16_t (length) + 4);
+                  newDsrRoutingHeader.AddDsrOption (newUnreach);
+                  newDsrRoutingHeader.AddDsrOption (sourceRoute);
 
                   Ptr<Packet> newPacket = Create<Packet> ();
-                  newPacket->AddHeader (dsrRoutingHeader); // Add the routing header with rerr and sourceRoute attached to it
+                  newPacket->AddHeader (newDsrRoutingHeader); // Add the routing header with rerr and sourceRoute attached to it
                   Ptr<NetDevice> dev = m_ip->GetNetDevice (m_ip->GetInterfaceForAddress (m_mainAddress));
                   m_ipv4Route->SetOutputDevice (dev);
 
@@ -1068,10 +1180,12 @@ void DsrRouting::CheckSendBuffer ()
             }
           else
             {
-              dsrRoutingHeader.SetNextHeader (protocol);
-              dsrRoutingHeader.SetMessageType (2);
-              dsrRoutingHeader.SetSourceId (GetIDfromIP (m_mainAddress));
-              dsrRoutingHeader.SetDestId (GetIDfromIP (destination));
+              DsrRoutingHeader newDsrRoutingHeader;
+              newDsrRoutingHeader.SetWideIds (m_wideNodeIds);
+              newDsrRoutingHeader.SetNextHeader (protocol);
+              newDsrRoutingHeader.SetMessageType (2);
+              newDsrRoutingHeader.SetSourceId (GetIDfromIP (m_mainAddress));
+              newDsrRoutingHeader.SetDestId (GetIDfromIP (destination));
 
               DsrOptionSRHeader sourceRoute;
               std::vector<Ipv4Address> nodeList = toDst.GetVector (); // Get the route from the route entry we found
@@ -1084,7 +1198,7 @@ void DsrRouting::CheckSendBuffer ()
               uint8_t salvage = 0;
               dsrcount++;
               sourceRoute.SetTime(Simulator::Now().GetMilliSeconds());
-              sourceRoute.SetAckFlag(3);
+              sourceRoute.SetAckFlag (SelectAckFlag (nodeList));
               sourceRoute.SetSendCout(dsrcount);
               sourceRoute.SetNodesAddress (nodeList); // Save the whole route in the source route header of the packet
               sourceRoute.SetSegmentsLeft ((nodeList.size () - 2)); // The segmentsLeft field will indicate the hops to go
@@ -1095,9 +1209,9 @@ void DsrRouting::CheckSendBuffer ()
                   m_routeCache->UseExtends (nodeList);
                 }
               uint8_t length = sourceRoute.GetLength ();
-              dsrRoutingHeader.SetPayloadLength (uint16_t (length) + 2);
-              dsrRoutingHeader.AddDsrOption (sourceRoute);
-              cleanP->AddHeader (dsrRoutingHeader);
+              newDsrRoutingHeader.SetPayloadLength (uint16_t (length) + 2);
+              newDsrRoutingHeader.AddDsrOption (sourceRoute);
+              cleanP->AddHeader (newDsrRoutingHeader);
               Ptr<const Packet> mtP = cleanP->Copy ();
               // Put the data packet in the maintenance queue for data packet retransmission
               DsrMaintainBuffEntry newEntry (/*Packet=*/ mtP, /*Ipv4Address=*/ m_mainAddress, /*nextHop=*/ nextHop,
@@ -1106,6 +1220,7 @@ void DsrRouting::CheckSendBuffer ()
               bool result = m_maintainBuffer.Enqueue (newEntry); // Enqueue the packet the the maintenance buffer
               if (result)
                 {
+                  ExpectAcks (mtP, sourceRoute.GetAckFlag (), nodeList);
                   NetworkKey networkKey;
                   networkKey.m_ackId = newEntry.GetAckId ();
                   networkKey.m_ourAdd = newEntry.GetOurAdd ();
@@ -1125,9 +1240,9 @@ void DsrRouting::CheckSendBuffer ()
                   linkKey.m_ourAdd = newEntry.GetOurAdd ();
                   linkKey.m_nextHop = newEntry.GetNextHop ();
 
-                  m_addressForwardCnt[networkKey] = 0;
-                  m_passiveCnt[passiveKey] = 0;
-                  m_linkCnt[linkKey] = 0;
+                  m_addressForwardTimer.SetRetries (networkKey, 0);
+                  m_passiveAckTimer.SetRetries (passiveKey, 0);
+                  m_linkAckTimer.SetRetries (linkKey, 0);
 
                   if (m_linkAck)
                     {
@@ -1157,10 +1272,6 @@ void DsrRouting::CheckSendBuffer ()
               return;
             }
         }
-      else
-        {
-          ++i;
-        }
     }
   //after going through the entire send buffer and send all packets found route,
   //we need to resume the timer if it has been suspended
@@ -1242,11 +1353,7 @@ bool DsrRouting::PromiscReceive (Ptr<NetDevice> device, Ptr<const Packet> packet
       /*
        * Peek data to get the option type as well as length and segmentsLeft field
        */
-      uint32_t size = pktMinusIpHdr->GetSize ();
-      uint8_t *data = new uint8_t[size];
-      pktMinusIpHdr->CopyData (data, size);
-      uint8_t optionType = 0;
-      optionType = *(data);
+      uint8_t optionType = PeekOptionType (pktMinusIpHdr);
 
       Ptr<dsr::DsrOptions> dsrOption;
 
@@ -1311,6 +1418,7 @@ DsrRouting::PacketNewRoute (Ptr<Packet> packet,
     {
       Ptr<Packet> cleanP = packet->Copy ();
       DsrRoutingHeader dsrRoutingHeader;
+      dsrRoutingHeader.SetWideIds (m_wideNodeIds);
       dsrRoutingHeader.SetNextHeader (protocol);
       dsrRoutingHeader.SetMessageType (2);
       dsrRoutingHeader.SetSourceId (GetIDfromIP (source));
@@ -1334,7 +1442,7 @@ DsrRouting::PacketNewRoute (Ptr<Packet> packet,
       sourceRoute.SetSegmentsLeft ((nodeList.size () - 2));     // The segmentsLeft field will indicate the hops to go
 
       sourceRoute.SetSalvage (salvage);
-      sourceRoute.SetAckFlag(3);
+      sourceRoute.SetAckFlag (SelectAckFlag (nodeList));
       sourceRoute.SetTime(Simulator::Now().GetMilliSeconds());
       uint8_t length = sourceRoute.GetLength ();
       dsrRoutingHeader.SetPayloadLength (uint16_t (length) + 2);
@@ -1350,6 +1458,7 @@ DsrRouting::PacketNewRoute (Ptr<Packet> packet,
 
       if (result)
         {
+          ExpectAcks (mtP, sourceRoute.GetAckFlag (), nodeList);
           NetworkKey networkKey;
           networkKey.m_ackId = newEntry.GetAckId ();
           networkKey.m_ourAdd = newEntry.GetOurAdd ();
@@ -1369,9 +1478,9 @@ DsrRouting::PacketNewRoute (Ptr<Packet> packet,
           linkKey.m_ourAdd = newEntry.GetOurAdd ();
           linkKey.m_nextHop = newEntry.GetNextHop ();
 
-          m_addressForwardCnt[networkKey] = 0;
-          m_passiveCnt[passiveKey] = 0;
-          m_linkCnt[linkKey] = 0;
+          m_addressForwardTimer.SetRetries (networkKey, 0);
+          m_passiveAckTimer.SetRetries (passiveKey, 0);
+          m_linkAckTimer.SetRetries (linkKey, 0);
 
           if (m_linkAck)
             {
@@ -1399,6 +1508,7 @@ DsrRouting::SendUnreachError (Ipv4Address unreachNode, Ipv4Address destination,
 {
   NS_LOG_FUNCTION (this << unreachNode << destination << originalDst << (uint32_t)salvage << (uint32_t)protocol);
   DsrRoutingHeader dsrRoutingHeader;
+  dsrRoutingHeader.SetWideIds (m_wideNodeIds);
   dsrRoutingHeader.SetNextHeader (protocol);
   dsrRoutingHeader.SetMessageType (1);
   dsrRoutingHeader.SetSourceId (GetIDfromIP (m_mainAddress));
@@ -1520,6 +1630,7 @@ DsrRouting::ForwardErrPacket (DsrOptionRerrUnreachHeader &rerr,
   NS_ASSERT_MSG (!m_downTarget.IsNull (), "Error, DsrRouting cannot send downward");
   sourceRoute.SetTime(Simulator::Now().GetMilliSeconds());
   DsrRoutingHeader dsrRoutingHeader;
+  dsrRoutingHeader.SetWideIds (m_wideNodeIds);
   dsrRoutingHeader.SetNextHeader (protocol);
   dsrRoutingHeader.SetMessageType (1);
   dsrRoutingHeader.SetSourceId (GetIDfromIP (rerr.GetErrorSrc ()));
@@ -1611,6 +1722,7 @@ DsrRouting::Send (Ptr<Packet> packet,
         {
           Ptr<Packet> cleanP = packet->Copy ();
           DsrRoutingHeader dsrRoutingHeader;
+          dsrRoutingHeader.SetWideIds (m_wideNodeIds);
           dsrRoutingHeader.SetNextHeader (protocol);
           dsrRoutingHeader.SetMessageType (2);
           dsrRoutingHeader.SetSourceId (GetIDfromIP (source));
@@ -1618,7 +1730,6 @@ DsrRouting::Send (Ptr<Packet> packet,
 
           ++dsrcount; //(20170901 sx) dsrcount represents as the data packet sending count when the function:send() is called by sender the dsrcount increases to 1
           DsrOptionSRHeader sourceRoute;
-          sourceRoute.SetAckFlag(3);
           sourceRoute.SetSendCout(dsrcount);
           uint64_t sun = Simulator::Now().GetMilliSeconds();
           sourceRoute.SetTime(sun);
@@ -1630,11 +1741,8 @@ DsrRouting::Send (Ptr<Packet> packet,
               return;
             }
           bool results = true;
-          if(blackattack == true){
-          if(!m_blackList.empty()){ //if the vector m_ackPair(used to check the ack from destination)
-             	   results = checkBlackList(m_blackList,nodeList);
-
-                }
+          if(m_blackholeDefense){
+             	   results = checkBlackList(nodeList);
           }
           if(results == false){
           blackfindcount++;
@@ -1642,6 +1750,7 @@ DsrRouting::Send (Ptr<Packet> packet,
           }
           uint8_t salvage = 0;
           sourceRoute.SetNodesAddress (nodeList);       // Save the whole route in the source route header of the packet
+          sourceRoute.SetAckFlag (SelectAckFlag (nodeList));
           /// When found a route and use it, UseExtends to the link cache
           if (m_routeCache->IsLinkCache ())
             {
@@ -1667,6 +1776,7 @@ DsrRouting::Send (Ptr<Packet> packet,
           bool result = m_maintainBuffer.Enqueue (newEntry);       // Enqueue the packet the the maintenance buffer
           if (result)
             {
+              ExpectAcks (mtP, sourceRoute.GetAckFlag (), nodeList);
               NetworkKey networkKey;
               networkKey.m_ackId = newEntry.GetAckId ();
               networkKey.m_ourAdd = newEntry.GetOurAdd ();
@@ -1686,9 +1796,9 @@ DsrRouting::Send (Ptr<Packet> packet,
               linkKey.m_ourAdd = newEntry.GetOurAdd ();
               linkKey.m_nextHop = newEntry.GetNextHop ();
 
-              m_addressForwardCnt[networkKey] = 0;
-              m_passiveCnt[passiveKey] = 0;
-              m_linkCnt[linkKey] = 0;
+              m_addressForwardTimer.SetRetries (networkKey, 0);
+              m_passiveAckTimer.SetRetries (passiveKey, 0);
+              m_linkAckTimer.SetRetries (linkKey, 0);
 
               if (m_linkAck)
                 {
@@ -1749,6 +1859,7 @@ DsrRouting::AddAckReqHeader (Ptr<Packet>& packet, Ipv4Address nextHop)
   ackReq.SetAckId (m_ackId);
   uint8_t length = (sourceRoute.GetLength () + ackReq.GetLength ());
   DsrRoutingHeader newDsrRoutingHeader;
+  newDsrRoutingHeader.SetWideIds (m_wideNodeIds);
   newDsrRoutingHeader.SetNextHeader (protocol);
   newDsrRoutingHeader.SetMessageType (2);
   newDsrRoutingHeader.SetSourceId (sourceId);
@@ -1880,18 +1991,17 @@ DsrRouting::IncreaseRetransTimer ()
   std::map<uint32_t, Ptr<dsr::DsrNetworkQueue> >::iterator i = m_priorityQueue.find (priority);
   Ptr<dsr::DsrNetworkQueue> dsrNetworkQueue = i->second;
 
+  // Each queued packet delays the network timers towards its next hop by one increment
+  std::map<Ipv4Address, uint32_t> queued;
   std::vector<DsrNetworkQueueEntry> newNetworkQueue = dsrNetworkQueue->GetQueue ();
   for (std::vector<DsrNetworkQueueEntry>::iterator i = newNetworkQueue.begin (); i != newNetworkQueue.end (); i++)
     {
-      Ipv4Address nextHop = i->GetNextHopAddress ();
-      for (std::map<NetworkKey, Timer>::iterator j = m_addressForwardTimer.begin (); j != m_addressForwardTimer.end (); j++)
-        {
-          if (nextHop == j->first.m_nextHop)
-            {
-              NS_LOG_DEBUG ("The network delay left is " << j->second.GetDelayLeft ());
-              j->second.SetDelay (j->second.GetDelayLeft () + m_retransIncr);
-            }
-        }
+      ++queued[i->GetNextHopAddress ()];
+    }
+  for (std::map<Ipv4Address, uint32_t>::const_iterator j = queued.begin (); j != queued.end (); ++j)
+    {
+      NS_LOG_DEBUG ("Delay the network timers for " << j->first << " by " << j->second << " increments");
+      m_addressForwardTimer.Shift (j->first, Time (j->second * m_retransIncr));
     }
 }
 
@@ -1916,8 +2026,8 @@ DsrRouting::SendPacketFromBuffer (DsrOptionSRHeader  &sourceRoute, Ipv4Address n
 
   // Reconstruct the route and Retransmit the data packet
   sourceRoute.SetSendCout(0);
-  sourceRoute.SetAckFlag(3);
   std::vector<Ipv4Address> nodeList = sourceRoute.GetNodesAddress ();
+  sourceRoute.SetAckFlag (SelectAckFlag (nodeList));
   Ipv4Address destination = nodeList.back ();
   Ipv4Address source = nodeList.front ();       // Get the source address
   NS_LOG_INFO ("The nexthop address " << nextHop << " the source " << source << " the destination " << destination);
@@ -1943,6 +2053,7 @@ DsrRouting::SendPacketFromBuffer (DsrOptionSRHeader  &sourceRoute, Ipv4Address n
         	  sourceRoute.SetTime(It->second);
           // Set the source route option
           DsrRoutingHeader dsrRoutingHeader;
+          dsrRoutingHeader.SetWideIds (m_wideNodeIds);
           dsrRoutingHeader.SetNextHeader (protocol);
           dsrRoutingHeader.SetMessageType (2);
           dsrRoutingHeader.SetSourceId (GetIDfromIP (source));
@@ -1964,6 +2075,7 @@ DsrRouting::SendPacketFromBuffer (DsrOptionSRHeader  &sourceRoute, Ipv4Address n
 
           if (result)
             {
+              ExpectAcks (mtP, sourceRoute.GetAckFlag (), nodeList);
               NetworkKey networkKey;
               networkKey.m_ackId = newEntry.GetAckId ();
               networkKey.m_ourAdd = newEntry.GetOurAdd ();
@@ -1983,9 +2095,9 @@ DsrRouting::SendPacketFromBuffer (DsrOptionSRHeader  &sourceRoute, Ipv4Address n
               linkKey.m_ourAdd = newEntry.GetOurAdd ();
               linkKey.m_nextHop = newEntry.GetNextHop ();
 
-              m_addressForwardCnt[networkKey] = 0;
-              m_passiveCnt[passiveKey] = 0;
-              m_linkCnt[linkKey] = 0;
+              m_addressForwardTimer.SetRetries (networkKey, 0);
+              m_passiveAckTimer.SetRetries (passiveKey, 0);
+              m_linkAckTimer.SetRetries (linkKey, 0);
 
               if (m_linkAck)
                 {
@@ -2039,12 +2151,7 @@ DsrRouting::SendPacketFromBuffer (DsrOptionSRHeader  &sourceRoute, Ipv4Address n
           /*
            * Peek data to get the option type as well as length and segmentsLeft field
            */
-          uint32_t size = copyP->GetSize ();
-          uint8_t *data = new uint8_t[size];
-          copyP->CopyData (data, size);
-
-          uint8_t optionType = 0;
-          optionType = *(data);
+          uint8_t optionType = PeekOptionType (copyP);
           NS_LOG_DEBUG ("The option type value in send packet " << (uint32_t)optionType);
           if (optionType == 3)
             {
@@ -2052,7 +2159,7 @@ DsrRouting::SendPacketFromBuffer (DsrOptionSRHeader  &sourceRoute, Ipv4Address n
               Ptr<dsr::DsrOptions> dsrOption;
               DsrOptionHeader dsrOptionHeader;
 
-              uint8_t errorType = *(data + 2);
+              uint8_t errorType = m_optionPeek[2];
               NS_LOG_DEBUG ("The error type");
               if (errorType == 1)
                 {
@@ -2072,6 +2179,7 @@ DsrRouting::SendPacketFromBuffer (DsrOptionSRHeader  &sourceRoute, Ipv4Address n
 
                   std::vector<Ipv4Address> nodeList = sourceRoute.GetNodesAddress ();
                   DsrRoutingHeader newRoutingHeader;
+                  newRoutingHeader.SetWideIds (m_wideNodeIds);
                   newRoutingHeader.SetNextHeader (protocol);
                   newRoutingHeader.SetMessageType (1);
                   newRoutingHeader.SetSourceId (GetIDfromIP (rerr.GetErrorSrc ()));
@@ -2213,6 +2321,15 @@ DsrRouting::CallCancelPacketTimer (uint16_t ackId, Ipv4Header const& ipv4Header,
   CancelNetworkPacketTimer (newEntry);  // Only need to cancel network packet timer
 }
 
+void
+DsrRouting::CallCancelPacketTimer (std::vector<uint16_t> const& ackIds, Ipv4Header const& ipv4Header, Ipv4Address realSrc, Ipv4Address realDst)
+{
+  for (std::vector<uint16_t>::const_iterator id = ackIds.begin (); id != ackIds.end (); ++id)
+    {
+      CallCancelPacketTimer (*id, ipv4Header, realSrc, realDst);
+    }
+}
+
 void 
 DsrRouting::CancelPacketAllTimer (DsrMaintainBuffEntry & mb)
 {
@@ -2231,37 +2348,18 @@ DsrRouting::CancelLinkPacketTimer (DsrMaintainBuffEntry & mb)
   linkKey.m_nextHop = mb.GetNextHop ();
   linkKey.m_source = mb.GetSrc ();
   linkKey.m_destination = mb.GetDst ();
-  /*
-   * Here we have found the entry for send retries, so we get the value and increase it by one
-   */
-  /// TODO need to think about this part
-  m_linkCnt[linkKey] = 0;
-  m_linkCnt.erase (linkKey);
-
-  // TODO if find the linkkey, we need to remove it
-
-  // Find the network acknowledgment timer
-  std::map<LinkKey, Timer>::const_iterator i =
-    m_linkAckTimer.find (linkKey);
-  if (i == m_linkAckTimer.end ())
+  if (m_linkAckTimer.IsRunning (linkKey))
     {
-      NS_LOG_INFO ("did not find the link timer");
+      NS_LOG_INFO ("did find the link timer");
     }
   else
     {
-      NS_LOG_INFO ("did find the link timer");
-      /*
-       * Schedule the packet retry
-       * Push back the nextHop, source, destination address
-       */
-      m_linkAckTimer[linkKey].Cancel ();
-      m_linkAckTimer[linkKey].Remove ();
-      if (m_linkAckTimer[linkKey].IsRunning ())
-        {
-          NS_LOG_INFO ("Timer not canceled");
-        }
-      m_linkAckTimer.erase (linkKey);
+      NS_LOG_INFO ("did not find the link timer");
     }
+  /*
+   * Stop the link acknowledgment timer and forget the send retries
+   */
+  m_linkAckTimer.Cancel (linkKey);
 
   // Erase the maintenance entry
   // yet this does not check the segments left value here
@@ -2282,38 +2380,22 @@ DsrRouting::CancelNetworkPacketTimer (DsrMaintainBuffEntry & mb)
   networkKey.m_nextHop = mb.GetNextHop ();
   networkKey.m_source = mb.GetSrc ();
   networkKey.m_destination = mb.GetDst ();
-  /*
-   * Here we have found the entry for send retries, so we get the value and increase it by one
-   */
-  m_addressForwardCnt[networkKey] = 0;
-  m_addressForwardCnt.erase (networkKey);
-
   NS_LOG_INFO ("ackId " << mb.GetAckId () << " ourAdd " << mb.GetOurAdd () << " nextHop " << mb.GetNextHop ()
                         << " source " << mb.GetSrc () << " destination " << mb.GetDst ()
                         << " segsLeft " << (uint32_t)mb.GetSegsLeft ()
                );
-  // Find the network acknowledgment timer
-  std::map<NetworkKey, Timer>::const_iterator i =
-    m_addressForwardTimer.find (networkKey);
-  if (i == m_addressForwardTimer.end ())
+  if (m_addressForwardTimer.IsRunning (networkKey))
     {
-      NS_LOG_INFO ("did not find the packet timer");
+      NS_LOG_INFO ("did find the packet timer");
     }
   else
     {
-      NS_LOG_INFO ("did find the packet timer");
-      /*
-       * Schedule the packet retry
-       * Push back the nextHop, source, destination address
-       */
-      m_addressForwardTimer[networkKey].Cancel ();
-      m_addressForwardTimer[networkKey].Remove ();
-      if (m_addressForwardTimer[networkKey].IsRunning ())
-        {
-          NS_LOG_INFO ("Timer not canceled");
-        }
-      m_addressForwardTimer.erase (networkKey);
+      NS_LOG_INFO ("did not find the packet timer");
     }
+  /*
+   * Stop the network acknowledgment timer and forget the send retries
+   */
+  m_addressForwardTimer.Cancel (networkKey);
   // Erase the maintenance entry
   // yet this does not check the segments left value here
   if (m_maintainBuffer.NetworkEqual (mb))
@@ -2332,30 +2414,18 @@ DsrRouting::CancelPassivePacketTimer (DsrMaintainBuffEntry & mb)
   passiveKey.m_destination = mb.GetDst ();
   passiveKey.m_segsLeft = mb.GetSegsLeft ();
 
-  m_passiveCnt[passiveKey] = 0;
-  m_passiveCnt.erase (passiveKey);
-
-  // Find the passive acknowledgment timer
-  std::map<PassiveKey, Timer>::const_iterator j =
-    m_passiveAckTimer.find (passiveKey);
-  if (j == m_passiveAckTimer.end ())
+  if (m_passiveAckTimer.IsRunning (passiveKey))
     {
-      NS_LOG_INFO ("did not find the passive timer");
+      NS_LOG_INFO ("find the passive timer");
     }
   else
     {
-      NS_LOG_INFO ("find the passive timer");
-      /*
-       * Cancel passive acknowledgment timer
-       */
-      m_passiveAckTimer[passiveKey].Cancel ();
-      m_passiveAckTimer[passiveKey].Remove ();
-      if (m_passiveAckTimer[passiveKey].IsRunning ())
-        {
-          NS_LOG_INFO ("Timer not canceled");
-        }
-      m_passiveAckTimer.erase (passiveKey);
+      NS_LOG_INFO ("did not find the passive timer");
     }
+  /*
+   * Cancel passive acknowledgment timer and forget the passive retries
+   */
+  m_passiveAckTimer.Cancel (passiveKey);
 }
 
 void
@@ -2465,6 +2535,7 @@ DsrRouting::SalvagePacket (Ptr<const Packet> packet, Ipv4Address source, Ipv4Add
     {
       NS_LOG_DEBUG ("We have found a route for the packet");
       DsrRoutingHeader newDsrRoutingHeader;
+      newDsrRoutingHeader.SetWideIds (m_wideNodeIds);
       newDsrRoutingHeader.SetNextHeader (protocol);
       newDsrRoutingHeader.SetMessageType (2);
       newDsrRoutingHeader.SetSourceId (GetIDfromIP (source));
@@ -2537,56 +2608,14 @@ DsrRouting::ScheduleLinkPacketRetry (DsrMaintainBuffEntry & mb,
                                      uint8_t protocol)
 {
   NS_LOG_FUNCTION (this << (uint32_t) protocol);
-  Ptr<Packet> p = mb.GetPacket ()->Copy ();
   Ipv4Address source = mb.GetSrc ();
   Ipv4Address nextHop = mb.GetNextHop ();
-  Ptr<Packet> ackp = mb.GetPacket()->Copy();
-  		Ptr<Packet> packet = ackp->Copy ();            // Save a copy of the received packet
-  		  /*
-  		   * When forwarding or local deliver packets, this one should be used always!!
-  		   */
-  		/*from 2494 to 2530 in order to change the ackflag in sourceroute header, we need to
-  		 * get the SR header from the buffer first, then change the ackflag to 2, at last encapsulate the
-  		 * sourceroute header in packet and save in buffer
-  		 * */
-  		  DsrRoutingHeader dsrRoutingHeader1;
-  		  packet->RemoveHeader (dsrRoutingHeader1);          // Remove the DSR header in whole
-  		  Ptr<Packet> copy = packet->Copy ();
-  		  uint32_t offset = dsrRoutingHeader1.GetDsrOptionsOffset ();        // Get the offset for option header, 8 bytes in this case
-
-  		   // This packet is used to peek option type
-  		   ackp->RemoveAtStart (offset);
-  		   uint8_t buf[2];
-  		     ackp->CopyData (buf, sizeof(buf));
-  		     uint8_t numberAddress = (buf[1] - 2) / 4;
-  		     DsrOptionSRHeader sourceRoute;
-  		     sourceRoute.SetNumberAddress (numberAddress);
-  		     ackp->RemoveHeader (sourceRoute);
-  		     // The route size saved in the source route
-  		     std::vector<Ipv4Address> nodeList = sourceRoute.GetNodesAddress ();
-  		     uint8_t segsLeft = sourceRoute.GetSegmentsLeft ();
-  		     uint8_t salvage = sourceRoute.GetSalvage ();
-  		    // uint16_t ackFlag = sourceRoute.GetAckFlag();
-  	         DsrOptionSRHeader newSourceRoute;
-  	         newSourceRoute.SetSegmentsLeft (segsLeft);
-  	         newSourceRoute.SetSalvage (salvage);
-  	         newSourceRoute.SetNodesAddress (nodeList);
-  	         newSourceRoute.SetAckFlag(2);
-  	         newSourceRoute.SetTime(sourceRoute.GetTime());
-  	         Ipv4Address src = mb.GetSrc ();
-  	         Ipv4Address dst = mb.GetDst();
-  	         DsrRoutingHeader dsrRoutingHeader;
-  	         dsrRoutingHeader.SetNextHeader (protocol);
-  	         dsrRoutingHeader.SetMessageType (2);
-  	         dsrRoutingHeader.SetSourceId (GetIDfromIP (src));
-  	         dsrRoutingHeader.SetDestId (GetIDfromIP (dst));
-
-  	           // We get the salvage value in sourceRoute header and set it to route error header if triggered error
-  	           Ptr<Packet> sendp = packet->Copy ();
-  	           uint8_t length = sourceRoute.GetLength ();
-  	           dsrRoutingHeader.SetPayloadLength (uint16_t (length) + 2);
-  	           dsrRoutingHeader.AddDsrOption (newSourceRoute);
-  	           sendp->AddHeader (dsrRoutingHeader);
+  // Switch the copy to two hop acks in place, the route is not decoded
+  Ptr<Packet> sendp = mb.GetPacket ()->Copy ();
+  DsrSRHeaderPatch sourceRoute;
+  sendp->RemoveHeader (sourceRoute);
+  sourceRoute.SetAckFlag (2);
+  sendp->AddHeader (sourceRoute);
 
   // Send the data packet out before schedule the next packet transmission
   SendPacket (sendp, source, nextHop, protocol);
@@ -2597,15 +2626,7 @@ DsrRouting::ScheduleLinkPacketRetry (DsrMaintainBuffEntry & mb,
   linkKey.m_ourAdd = mb.GetOurAdd ();
   linkKey.m_nextHop = mb.GetNextHop ();
 
-  if (m_linkAckTimer.find (linkKey) == m_linkAckTimer.end ())
-    {
-      Timer timer (Timer::CANCEL_ON_DESTROY);
-      m_linkAckTimer[linkKey] = timer;
-    }
-  m_linkAckTimer[linkKey].SetFunction (&DsrRouting::LinkScheduleTimerExpire, this);
-  m_linkAckTimer[linkKey].Remove ();
-  m_linkAckTimer[linkKey].SetArguments (mb, protocol);
-  m_linkAckTimer[linkKey].Schedule (m_linkAckTimeout);
+  m_linkAckTimer.Schedule (linkKey, m_linkAckTimeout, mb, protocol);
 }
 
 void
@@ -2627,16 +2648,8 @@ DsrRouting::SchedulePassivePacketRetry (DsrMaintainBuffEntry & mb,
   passiveKey.m_destination = mb.GetDst ();
   passiveKey.m_segsLeft = mb.GetSegsLeft ();
 
-  if (m_passiveAckTimer.find (passiveKey) == m_passiveAckTimer.end ())
-    {
-      Timer timer (Timer::CANCEL_ON_DESTROY);
-      m_passiveAckTimer[passiveKey] = timer;
-    }
   NS_LOG_DEBUG ("The passive acknowledgment option for data packet");
-  m_passiveAckTimer[passiveKey].SetFunction (&DsrRouting::PassiveScheduleTimerExpire, this);
-  m_passiveAckTimer[passiveKey].Remove ();
-  m_passiveAckTimer[passiveKey].SetArguments (mb, protocol);
-  m_passiveAckTimer[passiveKey].Schedule (m_passiveAckTimeout);
+  m_passiveAckTimer.Schedule (passiveKey, m_passiveAckTimeout, mb, protocol);
 }
 
 void
@@ -2644,8 +2657,8 @@ DsrRouting::ScheduleNetworkPacketRetry (DsrMaintainBuffEntry & mb,
                                         bool isFirst,
                                         uint8_t protocol)
 {
-  Ptr<Packet> p = Create<Packet> ();
-  Ptr<Packet> dsrP = Create<Packet> ();
+  Ptr<Packet> p;
+  Ptr<Packet> dsrP;
   // The new entry will be used for retransmission
   NetworkKey networkKey;
  // Ipv4Address nextHop = mb.GetNextHop ();
@@ -2678,78 +2691,37 @@ DsrRouting::ScheduleNetworkPacketRetry (DsrMaintainBuffEntry & mb,
       networkKey.m_source = newEntry.GetSrc ();
       networkKey.m_destination = newEntry.GetDst ();
 
-      m_addressForwardCnt[networkKey] = 0;
+      m_addressForwardTimer.SetRetries (networkKey, 0);
       if (! m_maintainBuffer.Enqueue (newEntry))
         {
           NS_LOG_ERROR ("Failed to enqueue packet retry");
         }
 
-      if (m_addressForwardTimer.find (networkKey) == m_addressForwardTimer.end ())
-        {
-          Timer timer (Timer::CANCEL_ON_DESTROY);
-          m_addressForwardTimer[networkKey] = timer;
-        }
-
       // After m_tryPassiveAcks, schedule the packet retransmission using network acknowledgment option
-      m_addressForwardTimer[networkKey].SetFunction (&DsrRouting::NetworkScheduleTimerExpire, this);
-      m_addressForwardTimer[networkKey].Remove ();
-      m_addressForwardTimer[networkKey].SetArguments (newEntry, protocol);
       NS_LOG_DEBUG ("The packet retries time for " << newEntry.GetAckId () << " is " << m_sendRetries
                                                    << " and the delay time is " << Time (2 * m_nodeTraversalTime).GetSeconds ());
       // Back-off mechanism
-      m_addressForwardTimer[networkKey].Schedule (Time (2 * m_nodeTraversalTime));
+      m_addressForwardTimer.Schedule (networkKey, Time (2 * m_nodeTraversalTime), newEntry, protocol);
     }
   else
     {
 
-		Ptr<Packet> ackp = mb.GetPacket()->Copy();
-		Ptr<Packet> packet = ackp->Copy ();            // Save a copy of the received packet
-		  /*
-		   * When forwarding or local deliver packets, this one should be used always!!
-		   */
-		/*from 2494 to 2530 in order to change the ackflag in sourceroute header, we need to
-		 * get the SR header from the buffer first, then change the ackflag to 2, at last encapsulate the
-		 * sourceroute header in packet and save in buffer
-		 * */
-		  DsrRoutingHeader dsrRoutingHeader1;
-		  packet->RemoveHeader (dsrRoutingHeader1);          // Remove the DSR header in whole
-		  Ptr<Packet> copy = packet->Copy ();
-		  uint32_t offset = dsrRoutingHeader1.GetDsrOptionsOffset ();        // Get the offset for option header, 8 bytes in this case
-
-		   // This packet is used to peek option type
-		   ackp->RemoveAtStart (offset);
-		   uint8_t buf[2];
-		     ackp->CopyData (buf, sizeof(buf));
-		     uint8_t numberAddress = (buf[1] - 2) / 4;
-		     DsrOptionSRHeader sourceRoute;
-		     sourceRoute.SetNumberAddress (numberAddress);
-		     ackp->RemoveHeader (sourceRoute);
-		     // The route size saved in the source route
-		     std::vector<Ipv4Address> nodeList = sourceRoute.GetNodesAddress ();
-		     uint8_t segsLeft = sourceRoute.GetSegmentsLeft ();
-		     uint8_t salvage = sourceRoute.GetSalvage ();
-		    // uint16_t ackFlag = sourceRoute.GetAckFlag();
-	         DsrOptionSRHeader newSourceRoute;
-	         newSourceRoute.SetSegmentsLeft (segsLeft);
-	         newSourceRoute.SetSalvage (salvage);
-	         newSourceRoute.SetNodesAddress (nodeList);
-	         newSourceRoute.SetAckFlag(2);
-	         newSourceRoute.SetTime(sourceRoute.GetTime());
-	         newSourceRoute.SetSendCout(dsrcount);
-	         Ipv4Address src = mb.GetSrc ();
-	         Ipv4Address dst = mb.GetDst();
-	         DsrRoutingHeader dsrRoutingHeader;
-	         dsrRoutingHeader.SetNextHeader (protocol);
-	         dsrRoutingHeader.SetMessageType (2);
-	         dsrRoutingHeader.SetSourceId (GetIDfromIP (src));
-	         dsrRoutingHeader.SetDestId (GetIDfromIP (dst));
-
-	           // We get the salvage value in sourceRoute header and set it to route error header if triggered error
-	           Ptr<Packet> sendp = packet->Copy ();
-	           uint8_t length = sourceRoute.GetLength ();
-	           dsrRoutingHeader.SetPayloadLength (uint16_t (length) + 2);
-	           dsrRoutingHeader.AddDsrOption (newSourceRoute);
-	           sendp->AddHeader (dsrRoutingHeader);
+      // Switch the copy to two hop acks in place, the route is not decoded
+      Ptr<Packet> sendp = mb.GetPacket ()->Copy ();
+      DsrSRHeaderPatch sourceRoute;
+      sendp->RemoveHeader (sourceRoute);
+      sourceRoute.SetAckFlag (2);
+      sourceRoute.SetSendCount (dsrcount);
+      Ipv4Address src = mb.GetSrc ();
+      uint32_t ackId = static_cast<uint32_t> (mb.GetPacket ()->GetUid ());
+      if (src == m_mainAddress && !m_ackCorrelation.Refresh (src, ackId))
+        {
+          // The packet went unacknowledged, counted once however often it is retried
+          m_ackPolicy->NotifyLost (mb.GetDst ());
+          // Only the first two hop retry of a packet reads its route, to wait for the acks of every node down it
+          m_ackCorrelation.Expect (src, ackId, PeekRoute (sendp, sourceRoute.GetNumberAddress ()));
+        }
+      sendp->AddHeader (sourceRoute);
 
 
 
@@ -2763,18 +2735,16 @@ DsrRouting::ScheduleNetworkPacketRetry (DsrMaintainBuffEntry & mb,
       /*
        * Here we have found the entry for send retries, so we get the value and increase it by one
        */
-      m_sendRetries = m_addressForwardCnt[networkKey];
+      m_sendRetries = m_addressForwardTimer.GetRetries (networkKey);
       NS_LOG_DEBUG ("The packet retry we have done " << m_sendRetries);
 
-      p = mb.GetPacket ()->Copy ();
-      dsrP = mb.GetPacket ()->Copy ();
       Ipv4Address source = mb.GetSrc ();
       Ipv4Address nextHop = mb.GetNextHop ();
 
       // Send the data packet out before schedule the next packet transmission
       SendPacket (sendp, source, nextHop, protocol);
 
-      NS_LOG_DEBUG ("The packet with dsr header " << dsrP->GetSize ());
+      NS_LOG_DEBUG ("The packet with dsr header " << sendp->GetSize ());
       networkKey.m_ackId = mb.GetAckId ();
       networkKey.m_ourAdd = mb.GetOurAdd ();
       networkKey.m_nextHop = mb.GetNextHop ();
@@ -2793,13 +2763,10 @@ DsrRouting::ScheduleNetworkPacketRetry (DsrMaintainBuffEntry & mb,
        */
 
       // After m_tryPassiveAcks, schedule the packet retransmission using network acknowledgment option
-      m_addressForwardTimer[networkKey].SetFunction (&DsrRouting::NetworkScheduleTimerExpire, this);
-      m_addressForwardTimer[networkKey].Remove ();
-      m_addressForwardTimer[networkKey].SetArguments (mb, protocol);
       NS_LOG_DEBUG ("The packet retries time for " << mb.GetAckId () << " is " << m_sendRetries
                                                    << " and the delay time is " << Time (2 * m_sendRetries *  m_nodeTraversalTime).GetSeconds ());
       // Back-off mechanism
-      m_addressForwardTimer[networkKey].Schedule (Time (2 * m_sendRetries * m_nodeTraversalTime));
+      m_addressForwardTimer.Schedule (networkKey, Time (2 * m_sendRetries * m_nodeTraversalTime), mb, protocol);
     }
 }
 
@@ -2819,20 +2786,11 @@ DsrRouting::LinkScheduleTimerExpire  (DsrMaintainBuffEntry & mb,
   lk.m_ourAdd = mb.GetOurAdd ();
   lk.m_nextHop = mb.GetNextHop ();
 
-  // Cancel passive ack timer
-  m_linkAckTimer[lk].Cancel ();
-  m_linkAckTimer[lk].Remove ();
-  if (m_linkAckTimer[lk].IsRunning ())
-    {
-      NS_LOG_DEBUG ("Timer not canceled");
-    }
-  m_linkAckTimer.erase (lk);
-
   // Increase the send retry times
-  m_linkRetries = m_linkCnt[lk];
+  m_linkRetries = m_linkAckTimer.GetRetries (lk);
   if (m_linkRetries < m_tryLinkAcks)
     {
-      m_linkCnt[lk] = ++m_linkRetries;
+      m_linkAckTimer.SetRetries (lk, ++m_linkRetries);
       ScheduleLinkPacketRetry (mb, protocol);
     }
   else
@@ -2867,20 +2825,11 @@ DsrRouting::PassiveScheduleTimerExpire  (DsrMaintainBuffEntry & mb,
   pk.m_destination = mb.GetDst ();
   pk.m_segsLeft = mb.GetSegsLeft ();
 
-  // Cancel passive ack timer
-  m_passiveAckTimer[pk].Cancel ();
-  m_passiveAckTimer[pk].Remove ();
-  if (m_passiveAckTimer[pk].IsRunning ())
-    {
-      NS_LOG_DEBUG ("Timer not canceled");
-    }
-  m_passiveAckTimer.erase (pk);
-
   // Increase the send retry times
-  m_passiveRetries = m_passiveCnt[pk];
+  m_passiveRetries = m_passiveAckTimer.GetRetries (pk);
   if (m_passiveRetries < m_tryPassiveAcks)
     {
-      m_passiveCnt[pk] = ++m_passiveRetries;
+      m_passiveAckTimer.SetRetries (pk, ++m_passiveRetries);
       SchedulePassivePacketRetry (mb, protocol);
     }
   else
@@ -2897,7 +2846,12 @@ DsrRouting::AssignStreams (int64_t stream)
 {
   NS_LOG_FUNCTION (this << stream);
   m_uniformRandomVariable->SetStream (stream);
-  return 1;
+  if (m_adversary == 0)
+    {
+      m_adversary = CreateObject<DsrAdversary> ();
+    }
+  // A shared adversary takes the stream of the first node only
+  return 1 + m_adversary->AssignStreams (stream + 1);
 }
 
 void
@@ -2917,7 +2871,7 @@ DsrRouting::NetworkScheduleTimerExpire  (DsrMaintainBuffEntry & mb,
   networkKey.m_destination = dst;
 
   // Increase the send retry times
-  m_sendRetries = m_addressForwardCnt[networkKey];
+  m_sendRetries = m_addressForwardTimer.GetRetries (networkKey);
 
   if (m_sendRetries >= m_maxMaintRexmt)
     {
@@ -2931,7 +2885,7 @@ DsrRouting::NetworkScheduleTimerExpire  (DsrMaintainBuffEntry & mb,
     }
   else
     {
-      m_addressForwardCnt[networkKey] = ++m_sendRetries;
+      m_addressForwardTimer.SetRetries (networkKey, ++m_sendRetries);
       ScheduleNetworkPacketRetry (mb, false, protocol);
     }
 }
@@ -2950,6 +2904,7 @@ DsrRouting::ForwardPacket (Ptr<const Packet> packet,
   NS_ASSERT_MSG (!m_downTarget.IsNull (), "Error, DsrRouting cannot send downward");
 
   DsrRoutingHeader dsrRoutingHeader;
+  dsrRoutingHeader.SetWideIds (m_wideNodeIds);
   dsrRoutingHeader.SetNextHeader (protocol);
   dsrRoutingHeader.SetMessageType (2);
   dsrRoutingHeader.SetSourceId (GetIDfromIP (source));
@@ -2990,9 +2945,9 @@ DsrRouting::ForwardPacket (Ptr<const Packet> packet,
       linkKey.m_ourAdd = newEntry.GetOurAdd ();
       linkKey.m_nextHop = newEntry.GetNextHop ();
 
-      m_addressForwardCnt[networkKey] = 0;
-      m_passiveCnt[passiveKey] = 0;
-      m_linkCnt[linkKey] = 0;
+      m_addressForwardTimer.SetRetries (networkKey, 0);
+      m_passiveAckTimer.SetRetries (passiveKey, 0);
+      m_linkAckTimer.SetRetries (linkKey, 0);
 
       if (m_linkAck)
         {
@@ -3030,10 +2985,11 @@ DsrRouting::SendInitialRequest (Ipv4Address source,
    * Construct the route request option header
    */
   DsrRoutingHeader dsrRoutingHeader;
+  dsrRoutingHeader.SetWideIds (m_wideNodeIds);
   dsrRoutingHeader.SetNextHeader (protocol);
   dsrRoutingHeader.SetMessageType (1);
   dsrRoutingHeader.SetSourceId (GetIDfromIP (source));
-  dsrRoutingHeader.SetDestId (255);
+  dsrRoutingHeader.SetDestId (DsrFsHeader::NO_ID);
 
   DsrOptionRreqHeader rreqHeader;                                  // has an alignment of 4n+0
   rreqHeader.AddNodeAddress (m_mainAddress);                       // Add our own address in the header
@@ -3047,6 +3003,7 @@ DsrRouting::SendInitialRequest (Ipv4Address source,
   packet->AddHeader (dsrRoutingHeader);
   dsrRreq++; //sx when this function is called dsrRreq increase one
    	rreqPacketSize.push_back(packet->GetSize());
+  m_controlTxTrace (packet, DsrOptionRreq::OPT_NUMBER);
   // Schedule the route requests retry with non-propagation set true
   bool nonProp = true;
   std::vector<Ipv4Address> address;
@@ -3124,10 +3081,11 @@ DsrRouting::SendErrorRequest (DsrOptionRerrUnreachHeader &rerr, uint8_t protocol
        * Construct the route request option header
        */
       DsrRoutingHeader dsrRoutingHeader;
+      dsrRoutingHeader.SetWideIds (m_wideNodeIds);
       dsrRoutingHeader.SetNextHeader (protocol);
       dsrRoutingHeader.SetMessageType (1);
       dsrRoutingHeader.SetSourceId (GetIDfromIP (m_mainAddress));
-      dsrRoutingHeader.SetDestId (255);
+      dsrRoutingHeader.SetDestId (DsrFsHeader::NO_ID);
 
       Ptr<Packet> dstP = Create<Packet> ();
       DsrOptionRreqHeader rreqHeader;                                // has an alignment of 4n+0
@@ -3155,6 +3113,7 @@ DsrRouting::SendErrorRequest (DsrOptionRerrUnreachHeader &rerr, uint8_t protocol
       propPacket->AddPacketTag (tag);
       dsrRerr++; //sx when this method is called then dsrRerr increases one
      rerrPacketSize.push_back(  propPacket->GetSize());//sx get the packet size of rerr packet
+      m_controlTxTrace (propPacket, DsrOptionRerr::OPT_NUMBER);
       if ((m_addressReqTimer.find (originalDst) == m_addressReqTimer.end ()) && (m_nonPropReqTimer.find (originalDst) == m_nonPropReqTimer.end ()))
         {
           NS_LOG_INFO ("Only when there is no existing route request time when the initial route request is scheduled");
@@ -3367,6 +3326,7 @@ DsrRouting::RouteRequestTimerExpire (Ptr<Packet> packet, std::vector<Ipv4Address
       m_rreqTable->FindAndUpdate (dst);
       dsrRreq++;//sx when this function is called dsrRreq increase one
       	rreqPacketSize.push_back(propPacket->GetSize());
+      m_controlTxTrace (propPacket, DsrOptionRreq::OPT_NUMBER);
       SendRequest (propPacket, source);
       NS_LOG_DEBUG ("Check the route request entry " << source << " " << dst);
       ScheduleRreqRetry (packet, address, false, requestId, protocol);
@@ -3410,6 +3370,7 @@ DsrRouting::ScheduleInterRequest (Ptr<Packet> packet)
 {
 	dsrRreq++; //sx when this function is called dsrRreq increase one
 		rreqPacketSize.push_back(packet->GetSize());
+  m_controlTxTrace (packet, DsrOptionRreq::OPT_NUMBER);
   NS_LOG_FUNCTION (this << packet);
   /*
    * This is a forwarding case when sending route requests, a random delay time [0, m_broadcastJitter]
@@ -3459,6 +3420,7 @@ DsrRouting::SendGratuitousReply (Ipv4Address source, Ipv4Address srcAddress, std
        * This part adds DSR header to the packet and send reply
        */
       DsrRoutingHeader dsrRoutingHeader;
+      dsrRoutingHeader.SetWideIds (m_wideNodeIds);
       dsrRoutingHeader.SetNextHeader (protocol);
       dsrRoutingHeader.SetMessageType (1);
       dsrRoutingHeader.SetSourceId (GetIDfromIP (replySrc));
@@ -3489,6 +3451,7 @@ DsrRouting::SendReply (Ptr<Packet> packet,
 {
 	dsrRrep++;
 	rrepPacketSize.push_back(packet->GetSize());
+  m_controlTxTrace (packet, DsrOptionRrep::OPT_NUMBER);
   NS_LOG_FUNCTION (this << packet << source << nextHop);
   NS_ASSERT_MSG (!m_downTarget.IsNull (), "Error, DsrRouting cannot send downward");
 
@@ -3549,13 +3512,54 @@ DsrRouting::SendAck   (uint16_t ackId,
 					   Ipv4Address targetDst,
 					   Ipv4Address realSender)
 {
+  SendAck (std::vector<uint16_t> (1, ackId), destination, realSrc, realDst, protocol, route,
+           ipv4Address, flag, targetDst, realSender);
+}
 
+void
+DsrRouting::SendAck   (std::vector<uint16_t> const& ackIds,
+                       Ipv4Address destination,
+                       Ipv4Address realSrc,
+                       Ipv4Address realDst,
+                       uint8_t protocol,
+                       Ptr<Ipv4Route> route,
+                       std::vector<Ipv4Address> ipv4Address,
+                       uint16_t flag,
+                       Ipv4Address targetDst,
+                       Ipv4Address realSender)
+{
+  NS_LOG_FUNCTION (this << ackIds.size () << destination << realSrc << realDst << (uint32_t)protocol << route);
+  DsrAckBatchKey key;
+  key.m_realSrc = realSrc;
+  key.m_realDst = realDst;
+  key.m_nextHop = destination;
+  key.m_targetDst = targetDst;
+  key.m_realSender = realSender;
+  key.m_flag = flag;
+  if (m_ackHoldoff.IsStrictlyPositive ())
+    {
+      m_ackBatcher.Add (key, ackIds, protocol, route, ipv4Address);
+    }
+  else
+    {
+      SendAckNow (ackIds, key, protocol, route, ipv4Address);
+    }
+}
 
-  NS_LOG_FUNCTION (this << ackId << destination << realSrc << realDst << (uint32_t)protocol << route);
+void
+DsrRouting::SendAckNow (std::vector<uint16_t> const& ackIds,
+                        DsrAckBatchKey const& key,
+                        uint8_t protocol,
+                        Ptr<Ipv4Route> route,
+                        std::vector<Ipv4Address> const& ipv4Address)
+{
+  NS_LOG_FUNCTION (this << ackIds.size () << key.m_nextHop << key.m_realSrc << key.m_realDst << (uint32_t)protocol << route);
   NS_ASSERT_MSG (!m_downTarget.IsNull (), "Error, DsrRouting cannot send downward");
+  Ipv4Address destination = key.m_nextHop;
 
   // This is a route reply option header
   DsrRoutingHeader dsrRoutingHeader;
+  dsrRoutingHeader.SetWideIds (m_wideNodeIds);
   dsrRoutingHeader.SetNextHeader (protocol);
   dsrRoutingHeader.SetMessageType (1);
   dsrRoutingHeader.SetSourceId (GetIDfromIP (m_mainAddress));
@@ -3564,13 +3568,14 @@ DsrRouting::SendAck   (uint16_t ackId,
   /*
    * Set the ack Id and set the ack source address and destination address
    */
-  ack.SetAckFlag(flag);  // set ack flag in ack option header. (20170826 sx)
-  ack.SetAckId (ackId);  // add the ack id (20170824 sx)
-  ack.SetRealSrc (realSrc);
-  ack.SetRealDst (realDst);
-  ack.SetOriginalSender(realSender);
-  ack.SetTargetDst(targetDst); // set the real target destination of the ack packet.(20170826 sx)
+  ack.SetAckFlag(key.m_flag);  // set ack flag in ack option header. (20170826 sx)
+  ack.SetAckIds (ackIds);  // add the ack ids (20170824 sx)
+  ack.SetRealSrc (key.m_realSrc);
+  ack.SetRealDst (key.m_realDst);
+  ack.SetOriginalSender(key.m_realSender);
+  ack.SetTargetDst(key.m_targetDst); // set the real target destination of the ack packet.(20170826 sx)
   ack.SetNodesAddress(ipv4Address); // add the ipv4Address vector into the ack header (20170825 sx)
+  ack.SetCompact (m_compactAck);
   uint8_t length = ack.GetLength ();
   dsrRoutingHeader.SetPayloadLength (uint16_t (length) + 2);
   dsrRoutingHeader.AddDsrOption (ack);
@@ -3578,6 +3583,7 @@ DsrRouting::SendAck   (uint16_t ackId,
   packet->AddHeader (dsrRoutingHeader);
   dsrAck++;
   ackPacketSize.push_back(packet->GetSize());
+  m_controlTxTrace (packet, DsrOptionAck::OPT_NUMBER);
   //std::cout<<"The real source is "<<ack.GetRealSrc()<<".\nThe real dest is "<<ack.GetRealDst()<<".\n\n"; // unused debug info (20170826 sx)
   Ptr<NetDevice> dev = m_ip->GetNetDevice (m_ip->GetInterfaceForAddress (m_mainAddress));
   route->SetOutputDevice (dev);
@@ -3602,6 +3608,16 @@ DsrRouting::SendAck   (uint16_t ackId,
    }
 }
 
+uint8_t
+DsrRouting::PeekOptionType (Ptr<const Packet> packet)
+{
+  if (packet->CopyData (m_optionPeek, OPTION_PEEK_SIZE) == 0)
+    {
+      return 0;
+    }
+  return m_optionPeek[0];
+}
+
 enum IpL4Protocol::RxStatus
 DsrRouting::Receive (Ptr<Packet> p,
                      Ipv4Header const &ip,
@@ -3614,10 +3630,11 @@ DsrRouting::Receive (Ptr<Packet> p,
   Ptr<Packet> packet = p->Copy ();            // Save a copy of the received packet
   /*
    * When forwarding or local deliver packets, this one should be used always!!
+   * The option processing only reads it or copies it before changing it, so
+   * it is also the packet delivered to the upper layer.
    */
   DsrRoutingHeader dsrRoutingHeader;
   packet->RemoveHeader (dsrRoutingHeader);          // Remove the DSR header in whole
-  Ptr<Packet> copy = packet->Copy ();
 
   uint8_t protocol = dsrRoutingHeader.GetNextHeader ();
   uint32_t sourceId = dsrRoutingHeader.GetSourceId ();
@@ -3639,16 +3656,10 @@ DsrRouting::Receive (Ptr<Packet> p,
   /*
    * Peek data to get the option type as well as length and segmentsLeft field
    */
-  uint32_t size = p->GetSize ();
-  uint8_t *data = new uint8_t[size];
-  p->CopyData (data, size);
-
-  uint8_t optionType = 0;
+  uint8_t optionType = PeekOptionType (p);
   uint8_t optionLength = 0;
   uint8_t segmentsLeft = 0;
 
-
-  optionType = *(data);
   NS_LOG_LOGIC ("The option type value " << (uint32_t)optionType << " with packet id " << p->GetUid());
   dsrOption = GetOption (optionType);       // Get the relative dsr option and demux to the process function
   Ipv4Address promiscSource;      /// this is just here for the sake of passing in the promisc source
@@ -3672,66 +3683,42 @@ DsrRouting::Receive (Ptr<Packet> p,
     }
   else if (optionType == 2)
     {
+      // Read the reply once, the loops of a route for us are cut and checked for suspects as it is read
+      DsrRrepVerifier rrep;
+      bool verified = rrep.Verify (p, m_mainAddress, m_blackholeDefense ? &m_blackList : 0) != 0;
+      bool suspect = false;
+      if (verified && rrep.IsForUs ())
+        {
+          if (rrep.GetBlackFlag () == 1)
+            {
+              realreceivefake++;
+            }
+          if (rrep.IsBlackListed () && control == true && p->GetUid () != rrepid)
+            {
+              suspect = true;
+              rrepid = p->GetUid ();
+            }
+        }
 
-	    // Get the number of routers' address field
-	  Ptr<Packet> pp = p->Copy ();
-	    uint8_t buf[2];
-	    pp->CopyData (buf, sizeof(buf));
-	    uint8_t numberAddress = (buf[1] - 2) / 4;
-
-	    DsrOptionRrepHeader rrep;
-	    rrep.SetNumberAddress (numberAddress);  // Set the number of ip address in the header to reserver space for deserialize header
-	    pp->RemoveHeader (rrep);
-	    bool results = true;
-	    std::vector<Ipv4Address> nodeList = rrep.GetNodesAddress ();
-	    /**
-	     * Get the destination address, which is the last element in the nodeList
-	     */
-	    Ipv4Address targetAddress = nodeList.front ();
-	    // If the RREP option has rached to the destination
-	    if (targetAddress == m_mainAddress){
-	    	RemoveDuplicates (nodeList); // This is for the route reply from intermediate node since we didn't remove
-	    	                                   // duplicate there
-	    	      if (nodeList.size () == 0)
-	    	        {
-	    	          NS_LOG_DEBUG ("The route we have contains 0 entries");
-	    	          optionLength = 0;
-	    	        }else{
-	    	        	if(rrep.GetAck() == 1)
-	    	        	    realreceivefake++;
-
-
-	        if(blackattack == true){
-	              if(!m_blackList.empty()){ //if the vector m_ackPair(used to check the ack from destination)
-	                 	   results = checkBlackList(m_blackList,nodeList);
-
-	                    }
-	        }
-	              if(results == false){
-	            	  if ( control == true){
-	            		  if(pp->GetUid() != rrepid){
-	                         optionLength = 1;
-	                         rrepid = pp->GetUid();
-	            		  }
-	            	  }
-	              }
-	    	        }
-	    }
-
-	     if(optionLength != 1){
-      dsrOption = GetOption (optionType);
-      optionLength = ProcessRrep (p, packet, m_mainAddress, source, ip, protocol, isPromisc, promiscSource);
-	     }
-	     if(optionLength == 1){
-	    	 fakerrep++;
-	    	 NS_LOG_INFO ("Discard this packet");
-	    	           m_dropTrace (p);
-	     }
-      if (optionLength == 0)
+      if (suspect)
         {
+          fakerrep++;
           NS_LOG_INFO ("Discard this packet");
           m_dropTrace (p);
         }
+      else
+        {
+          if (verified)
+            {
+              dsrOption = GetOption (optionType);
+              optionLength = ProcessRrep (p, packet, rrep, m_mainAddress, source, ip, protocol, isPromisc, promiscSource);
+            }
+          if (optionLength == 0)
+            {
+              NS_LOG_INFO ("Discard this packet");
+              m_dropTrace (p);
+            }
+        }
     }
 
   else if (optionType == 32)       // This is the ACK option
@@ -3764,8 +3751,8 @@ DsrRouting::Receive (Ptr<Packet> p,
   else if (optionType == 96)       // This is the source route option
     {
       dsrOption = GetOption (optionType);
+      segmentsLeft = m_optionPeek[DsrOptionSRHeader::SEGMENTS_LEFT_OFFSET];
       optionLength = processSr (p, packet, m_mainAddress, source, ip, protocol, isPromisc, promiscSource);
-      segmentsLeft = *(data + 3);
       if (optionLength == 0)
         {
           NS_LOG_INFO ("Discard this packet");
@@ -3782,11 +3769,10 @@ DsrRouting::Receive (Ptr<Packet> p,
               Ptr<IpL4Protocol> nextProto = l3proto->GetProtocol (nextHeader);
               if (nextProto != 0)
                 {
-                  // we need to make a copy in the unlikely event we hit the
-                  // RX_ENDPOINT_UNREACH code path
+                  // No copy is needed, the RX_ENDPOINT_UNREACH code path does not reuse it
                   // Here we can use the packet that has been get off whole DSR header
                   enum IpL4Protocol::RxStatus status =
-                    nextProto->Receive (copy, ip, incomingInterface);
+                    nextProto->Receive (packet, ip, incomingInterface);
                   NS_LOG_DEBUG ("The receive status " << status);
                   switch (status)
                     {
@@ -3899,14 +3885,8 @@ uint8_t DsrRouting::processAck(Ptr<Packet> packet, Ptr<Packet> dsrP, Ipv4Address
 	   * Remove the ACK header
 	   */
 	  Ptr<Packet> p = packet->Copy ();
-	  // get the size of node list in ack header. (20170825 sx)
-	  uint8_t buf[2];
-	  p->CopyData (buf, sizeof(buf));
-	  uint8_t numberAddress = (buf[1] - 6) / 4;
-
+	  // the ack header sizes its node list from the option length
 	  DsrOptionAckHeader ack;
-	  ack.SetNumberAddress(numberAddress);
-
 	  p->RemoveHeader (ack);
 
 	  NS_LOG_DEBUG ("The next header value " << (uint32_t)protocol);
@@ -3919,7 +3899,7 @@ uint8_t DsrRouting::processAck(Ptr<Packet> packet, Ptr<Packet> dsrP, Ipv4Address
 	  Ipv4Address realDst = ack.GetRealDst ();
 	  Ipv4Address originalSender = ack.GetOriginalSender();//(20170831 sx)
 	  Ipv4Address targetDst = ack.GetTargetDst(); //(20170826 sx)
-	  uint16_t ackId = ack.GetAckId ();           //(20170826 sx)
+	  std::vector<uint16_t> ackIds = ack.GetAckIds (); // one ack may cover several packets
 	  uint16_t ackFlag = ack.GetAckFlag();        //(20170826 sx)
 	  /*
 	   * Get the node with ip address and get the dsr extension and route cache objects
@@ -3927,44 +3907,29 @@ uint8_t DsrRouting::processAck(Ptr<Packet> packet, Ptr<Packet> dsrP, Ipv4Address
 	  Ptr<Node> node = GetNodeWithAddress (ipv4Address);
 	  if(ackFlag == 1){
 		  UpdateRouteEntry (realDst);
-		  CallCancelPacketTimer (ackId, ipv4Header, realSrc, realDst);
+		  CallCancelPacketTimer (ackIds, ipv4Header, realSrc, realDst);
 	  }
 	  if(ackFlag == 2){
 
 		  if(targetDst == ipv4Address){//(20170831 sx)
 			  if(realSrc == ipv4Address){
-				  blacktries++;
-				  uint16_t count = nodeList.size()-2;
-				  std::vector<Ipv4Address>::iterator iter = std::find(m_ackPair.begin(),m_ackPair.end(),originalSender);
-				  	   			if(iter == m_ackPair.end())
-				  	   			    m_ackPair.push_back(originalSender);
-				  	   		 if(count == 0)
-				  	   			m_ackPair.clear();
-				  	   	 if(originalSender == nodeList.back())
-				  	   	m_ackPair.clear();
-
-
-				  	   if(blacktries == count){
-				  		   if(originalSender != nodeList.back()){
-				  			   handleBlackList(m_ackPair,nodeList);
-				  			 blacktries = 0;
-				  		   }
-				  		   else
-				  		   {
-				  			 m_ackPair.clear();
-				  			 blacktries = 0;
-				  			 UpdateRouteEntry (realDst);
-				  			 CallCancelPacketTimer (ackId, ipv4Header, realSrc, realDst);
-				  		   }
-				  	   }
-	               /*std::cout<<"test the ack list\n";
-				  for (it = m_ackPair.begin(); it != m_ackPair.end(); ++it) {
-				      std::vector<Ipv4Address>::iterator it_inner;
-				      for (it_inner = it->second.begin(); it_inner != it->second.end(); ++it_inner) {
-				              std::cout<<"the id is "<<it->first<<"and the address is"<<*it_inner<<"\n";
-				          }
-				  }*/
-
+				  // every id on the ack is one two hop ack of its packet
+				  for (std::vector<uint16_t>::const_iterator id = ackIds.begin (); id != ackIds.end (); ++id)
+				    {
+				      // The ack shows the relay before its sender forwarded the packet
+				      Ipv4Address relay = ReverseSearchNextHop (originalSender, nodeList);
+				      if (relay != realSrc && relay != "0.0.0.0")
+				        {
+				          m_routeCache->UpdateTrust (relay, true);
+				        }
+				      m_ackCorrelation.Acknowledge (realSrc, m_ackCorrelation.Extend (realSrc, *id), originalSender);
+				      if (originalSender == nodeList.back ())
+				        {
+				          // The destination has the packet, the other acks only tell about the relays
+				          UpdateRouteEntry (realDst);
+				          CallCancelPacketTimer (*id, ipv4Header, realSrc, realDst);
+				        }
+				    }
 
 				  return ack.GetSerializedSize ();
 			  }
@@ -3976,16 +3941,16 @@ uint8_t DsrRouting::processAck(Ptr<Packet> packet, Ptr<Packet> dsrP, Ipv4Address
 			      newTargetDst = ReverseSearchNextTwoHop(ipv4Address, nodeList);
 			  if(nexthop == "0.0.0.0"){
 				  UpdateRouteEntry (realDst);
-				  CallCancelPacketTimer (ackId, ipv4Header, realSrc, realDst);
+				  CallCancelPacketTimer (ackIds, ipv4Header, realSrc, realDst);
 			  }else{
 				  if(newTargetDst != "0.0.0.0"){
 
 					  m_ipv4Route = SetRoute (nexthop, ipv4Address);
-					  SendAck (ackId, nexthop, realSrc, realDst, protocol, m_ipv4Route,nodeList, ackFlag,newTargetDst,originalSender);
+					  SendAck (ackIds, nexthop, realSrc, realDst, protocol, m_ipv4Route,nodeList, ackFlag,newTargetDst,originalSender);
 				  }else{
 
 					  m_ipv4Route = SetRoute (nexthop, ipv4Address);
-					  SendAck (ackId, nexthop, realSrc, realDst, protocol, m_ipv4Route,nodeList, ackFlag,nexthop,originalSender);
+					  SendAck (ackIds, nexthop, realSrc, realDst, protocol, m_ipv4Route,nodeList, ackFlag,nexthop,originalSender);
 				  }
 			  }
 	  	  }
@@ -3996,14 +3961,21 @@ uint8_t DsrRouting::processAck(Ptr<Packet> packet, Ptr<Packet> dsrP, Ipv4Address
 
 	  		  m_ipv4Route = SetRoute (nexthop, ipv4Address);
 
-	  		  SendAck (ackId, nexthop, realSrc, realDst, protocol, m_ipv4Route,nodeList, ackFlag,targetDst,originalSender);
+	  		  SendAck (ackIds, nexthop, realSrc, realDst, protocol, m_ipv4Route,nodeList, ackFlag,targetDst,originalSender);
 	  	  }
 	  }
 	  if(ackFlag == 3){
 	  	  if(targetDst == ipv4Address){
 
 	  		  UpdateRouteEntry (realDst);
-	   		  CallCancelPacketTimer (ackId, ipv4Header, realSrc, realDst);
+	   		  CallCancelPacketTimer (ackIds, ipv4Header, realSrc, realDst);
+	   		  if(realSrc == ipv4Address){
+	   			  // one delivery for every packet the ack covers
+	   			  for (uint32_t i = 0; i < ackIds.size (); ++i)
+	   			    {
+	   			      m_ackPolicy->NotifyDelivered (realDst);
+	   			    }
+	   		  }
 	   		  /*if(ipv4Address == realSrc){
 	   			std::vector<Ipv4Address>::iterator iter = std::find(m_test.begin(),m_test.end(),originalSender);
 	   			if(iter == m_test.end())
@@ -4022,7 +3994,7 @@ uint8_t DsrRouting::processAck(Ptr<Packet> packet, Ptr<Packet> dsrP, Ipv4Address
 
 	  	  		  m_ipv4Route = SetRoute (nexthop, ipv4Address);
 
-	  	  		  SendAck (ackId, nexthop, realSrc, realDst, protocol, m_ipv4Route,nodeList, ackFlag,targetDst,originalSender);
+	  	  		  SendAck (ackIds, nexthop, realSrc, realDst, protocol, m_ipv4Route,nodeList, ackFlag,targetDst,originalSender);
 	   	  }
 
 	  }
@@ -4072,17 +4044,6 @@ Ipv4Address DsrRouting::ReverseSearchNextTwoHop  (Ipv4Address ipv4Address, std::
   Ipv4Address none = "0.0.0.0";
   return none;
 }
-bool DsrRouting::checkRrepDst(Ipv4Address ipv4Address, std::vector<Ipv4Address>&vec){
-	for (std::vector<Ipv4Address>::reverse_iterator ri = vec.rbegin (); ri != vec.rend (); ++ri)
-	    {
-	      if (ipv4Address == (*ri))
-	        {
-
-	          return true;
-	        }
-	    }
-	  return false;
-}
 uint8_t DsrRouting::processSr(Ptr<Packet> packet, Ptr<Packet> dsrP, Ipv4Address ipv4Address, Ipv4Address source, Ipv4Header const& ipv4Header, uint8_t protocol, bool& isPromisc, Ipv4Address promiscSource)
 {
 	NS_LOG_FUNCTION (this << packet << dsrP << ipv4Address << source << ipv4Address << ipv4Header << (uint32_t)protocol << isPromisc);
@@ -4178,7 +4139,7 @@ uint8_t DsrRouting::processSr(Ptr<Packet> packet, Ptr<Packet> dsrP, Ipv4Address
 		  	    Ipv4Address ackTargetAddress;
 		  	      Ptr<Packet> ackp = packet->Copy ();
 		  	      m_ipv4Route = SetRoute (ackAddress, ipv4Address);
-		  	    if(blackHole == true){ //sx when blackhole receives the datapacket->discard it!
+		  	    if(m_adversary->DropsData (m_node->GetId (), GetIDfromIP (realSrc), GetIDfromIP (realDestination))){ //sx when blackhole receives the datapacket->discard it!
 		  	    	  	  					      if(ApacketId != p->GetUid()){
 		  	    	  	  						  ++attackCount;
 		  	    	  	  					      ApacketId = p->GetUid();
@@ -4242,11 +4203,7 @@ uint8_t DsrRouting::processSr(Ptr<Packet> packet, Ptr<Packet> dsrP, Ipv4Address
 	      Ipv4Address nextAddress;
 
 	      // Get the option type value
-	      uint32_t size = p->GetSize ();
-	      uint8_t *data = new uint8_t[size];
-	      p->CopyData (data, size);
-	      uint8_t optionType = 0;
-	      optionType = *(data);
+	      uint8_t optionType = PeekOptionType (p);
 	      /// When the option type is 160, means there is ACK request header after the source route, we need
 	      /// to send back acknowledgment
 	      if (optionType == 160)
@@ -4391,31 +4348,74 @@ bool DsrRouting::ContainAddressAfter (Ipv4Address ipv4Address, Ipv4Address destA
     }
   return false;
 }
-void DsrRouting::handleBlackList(std::vector<Ipv4Address>& ackPair, std::vector<Ipv4Address>& nodeList){
+void DsrRouting::handleBlackList(uint32_t ackId, std::vector<Ipv4Address> const& nodeList, std::vector<Ipv4Address> const& missing){
 
-	 	 Ipv4Address dst = nodeList.back();
-	 	 bool result = checkRrepDst(dst,ackPair);
-	 	 if(result == false)
+	 	 // Acks lost on the way back make no relay suspect as long as the destination acked
+	 	 if(std::find(missing.begin(),missing.end(),nodeList.back()) == missing.end())
 	 	 {
-	 		 std::vector<Ipv4Address>::iterator iter = std::find(m_blackList.begin(),m_blackList.end(),ackPair.front());
-	 						  	   			if(iter == m_blackList.end())
-	 						  	   			m_blackList.push_back(ackPair.front());
+	 		 NS_LOG_DEBUG ("Packet " << ackId << " delivered, " << missing.size () << " acks lost");
+	 		 m_ackPolicy->NotifyDelivered(nodeList.back());
+	 		 return;
 	 	 }
+	 	 // The packet stopped at the node right before the first one that did not ack
+	 	 std::vector<Ipv4Address>::const_iterator first = std::find(nodeList.begin(),nodeList.end(),missing.front());
+	 	 Ipv4Address suspect = *(first - 1);
+	 	 NS_LOG_DEBUG ("Packet " << ackId << " lost after " << suspect);
+	 	 m_blackList.Add(suspect);
+	 	 m_routeCache->UpdateTrust(suspect, false);
+	 	 m_ackPolicy->NotifySuspect(nodeList.back(), suspect);
+}
+
+void
+DsrRouting::AckSetComplete (uint32_t ackId, std::vector<Ipv4Address> const& nodeList, std::vector<Ipv4Address> const& missing)
+{
+  NS_LOG_FUNCTION (this << ackId);
+  UpdateRouteEntry (nodeList.back ());
+  m_ackPolicy->NotifyDelivered (nodeList.back ());
+}
+
+void
+DsrRouting::NotifyBlackList (Ipv4Address address, bool added)
+{
+  NS_LOG_FUNCTION (this << address << added);
+  m_blackListTrace (address, added);
+}
+
+std::vector<Ipv4Address>
+DsrRouting::PeekRoute (Ptr<const Packet> packet, uint8_t numberAddress) const
+{
+  std::vector<Ipv4Address> route;
+  std::vector<uint8_t> raw (4 * numberAddress);
+  if (raw.empty () || packet->CopyData (&raw[0], raw.size ()) != raw.size ())
+    {
+      return route;
+    }
+  route.reserve (numberAddress);
+  for (uint32_t i = 0; i < raw.size (); i += 4)
+    {
+      route.push_back (Ipv4Address::Deserialize (&raw[i]));
+    }
+  return route;
+}
+
+uint8_t
+DsrRouting::SelectAckFlag (std::vector<Ipv4Address> const& nodeList)
+{
+  return m_ackPolicy->SelectAckFlag (nodeList.back (), nodeList, m_routeCache->GetRoutePenalty (nodeList));
+}
 
-	 	 m_ackPair.clear();
+void
+DsrRouting::ExpectAcks (Ptr<const Packet> packet, uint8_t ackFlag, std::vector<Ipv4Address> const& nodeList)
+{
+  if (ackFlag == DsrAckPolicy::TWO_HOP)
+    {
+      m_ackCorrelation.Expect (m_mainAddress, static_cast<uint32_t> (packet->GetUid ()), nodeList);
+    }
 }
 
-bool DsrRouting::checkBlackList(std::vector<Ipv4Address>& blacklist, std::vector<Ipv4Address>& nodeList){
+bool DsrRouting::checkBlackList(std::vector<Ipv4Address> const& nodeList){
 
-	Ipv4Address address;
-	for (std::vector<Ipv4Address>::const_iterator i = nodeList.begin (); i != nodeList.end (); ++i)
-				 {
-				  	   address = (*i);
-				  	   std::vector<Ipv4Address>::iterator iter = std::find(m_blackList.begin(),m_blackList.end(),address);
-				       if(iter != m_blackList.end())
-				    	   return false;
-				 }
-	return true;
+	return !m_blackList.ContainsAny(nodeList);
 
 }
 uint8_t DsrRouting::processRreq(Ptr<Packet> packet, Ptr<Packet> dsrP, Ipv4Address ipv4Address, Ipv4Address source, Ipv4Header const& ipv4Header, uint8_t protocol, bool& isPromisc, Ipv4Address promiscSource)
@@ -4487,10 +4487,11 @@ uint8_t DsrRouting::processRreq(Ptr<Packet> packet, Ptr<Packet> dsrP, Ipv4Addres
    * Construct the dsr routing header for later use
    */
   DsrRoutingHeader dsrRoutingHeader;
+  dsrRoutingHeader.SetWideIds (m_wideNodeIds);
   dsrRoutingHeader.SetNextHeader (protocol);
   dsrRoutingHeader.SetMessageType (1);
   dsrRoutingHeader.SetSourceId (GetIDfromIP (source));
-  dsrRoutingHeader.SetDestId (255);
+  dsrRoutingHeader.SetDestId (DsrFsHeader::NO_ID);
 
   // check whether we have received this request or not, if not, it will save the request in the table for
   // later use, if not found, return false, and push the newly received source request entry in the cache
@@ -4542,47 +4543,47 @@ uint8_t DsrRouting::processRreq(Ptr<Packet> packet, Ptr<Packet> dsrP, Ipv4Addres
                                               saveRoute);
 
 
-      if(blackHole == true){  // blackhole test let 32 and 25 be blackhole attack
-          	  Ipv4Address nextHop; // Declare the next hop address to use
-          	               std::vector<Ipv4Address> changeRoute (nodeList);
-
-          	                  // push back our own address
-          	               m_finalRoute.clear ();              // get a clear route vector
-          	               for (std::vector<Ipv4Address>::iterator i = changeRoute.begin (); i != changeRoute.end (); ++i)
-          	                 {
-          	                   m_finalRoute.push_back (*i);  // Get the full route from source to destination
-          	                 }
-          	               m_finalRoute.push_back(m_mainAddress);
-          	               m_finalRoute.push_back(targetAddress);
-          	               PrintVector (m_finalRoute);
-          	               nextHop = ReverseSearchNextHop (ipv4Address, m_finalRoute); // get the next hop
-
-          	           DsrOptionRrepHeader rrep;
-          	                     rrep.SetNodesAddress (m_finalRoute);     // Set the node addresses in the route reply header
-          	                     rrep.SetAck(1);
-          	                     NS_LOG_DEBUG ("The nextHop address " << nextHop);
-          	                     Ipv4Address replyDst = m_finalRoute.front ();
-
-          	                     DsrRoutingHeader dsrRoutingHeader;
-          	                     dsrRoutingHeader.SetNextHeader (protocol);
-          	                     dsrRoutingHeader.SetMessageType (1);
-          	                     dsrRoutingHeader.SetSourceId (GetIDfromIP (targetAddress));
-          	                     dsrRoutingHeader.SetDestId (GetIDfromIP (replyDst));
-          	                     // Set the route for route reply
-          	                     SetRoute (nextHop, ipv4Address);
-
-          	                     uint8_t length = rrep.GetLength ();  // Get the length of the rrep header excluding the type header
-          	                     dsrRoutingHeader.SetPayloadLength (length + 2);
-          	                     dsrRoutingHeader.AddDsrOption (rrep);
-          	                     Ptr<Packet> newPacket = Create<Packet> ();
-          	                     newPacket->AddHeader (dsrRoutingHeader);
-          	                     fakeRrepCount++;
-
-          	                     ScheduleInitialReply (newPacket, ipv4Address, nextHop, m_ipv4Route);
-          	                     return 0;
+      if (m_adversary->ForgesReplies (m_node->GetId ()))  // blackhole / grayhole answer with a forged reply
+        {
+          Ipv4Address nextHop; // Declare the next hop address to use
+          std::vector<Ipv4Address> changeRoute (nodeList);
 
+          // push back our own address
+          m_finalRoute.clear ();              // get a clear route vector
+          for (std::vector<Ipv4Address>::iterator i = changeRoute.begin (); i != changeRoute.end (); ++i)
+            {
+              m_finalRoute.push_back (*i);  // Get the full route from source to destination
             }
+          m_finalRoute.push_back (m_mainAddress);
+          m_finalRoute.push_back (targetAddress);
+          PrintVector (m_finalRoute);
+          nextHop = ReverseSearchNextHop (ipv4Address, m_finalRoute); // get the next hop
 
+          DsrOptionRrepHeader rrep;
+          rrep.SetNodesAddress (m_finalRoute);     // Set the node addresses in the route reply header
+          rrep.SetAck (1);
+          NS_LOG_DEBUG ("The nextHop address " << nextHop);
+          Ipv4Address replyDst = m_finalRoute.front ();
+
+          DsrRoutingHeader dsrRoutingHeader;
+          dsrRoutingHeader.SetWideIds (m_wideNodeIds);
+          dsrRoutingHeader.SetNextHeader (protocol);
+          dsrRoutingHeader.SetMessageType (1);
+          dsrRoutingHeader.SetSourceId (GetIDfromIP (targetAddress));
+          dsrRoutingHeader.SetDestId (GetIDfromIP (replyDst));
+          // Set the route for route reply
+          SetRoute (nextHop, ipv4Address);
+
+          uint8_t length = rrep.GetLength ();  // Get the length of the rrep header excluding the type header
+          dsrRoutingHeader.SetPayloadLength (length + 2);
+          dsrRoutingHeader.AddDsrOption (rrep);
+          Ptr<Packet> newPacket = Create<Packet> ();
+          newPacket->AddHeader (dsrRoutingHeader);
+          fakeRrepCount++;
+
+          ScheduleInitialReply (newPacket, ipv4Address, nextHop, m_ipv4Route);
+          return 0;
+        }
 
       NS_LOG_DEBUG ("The target address over here " << targetAddress << " and the ip address " << ipv4Address << " and the source address " << mainVector[0]);
       if (targetAddress == ipv4Address)
@@ -4617,6 +4618,7 @@ uint8_t DsrRouting::processRreq(Ptr<Packet> packet, Ptr<Packet> dsrP, Ipv4Addres
            * This part add dsr header to the packet and send route reply packet
            */
           DsrRoutingHeader dsrRoutingHeader;
+          dsrRoutingHeader.SetWideIds (m_wideNodeIds);
           dsrRoutingHeader.SetNextHeader (protocol);
           dsrRoutingHeader.SetMessageType (1);
           dsrRoutingHeader.SetSourceId (GetIDfromIP (ipv4Address));
@@ -4829,10 +4831,11 @@ uint8_t DsrRouting::processRreq(Ptr<Packet> packet, Ptr<Packet> dsrP, Ipv4Addres
                * This part add dsr header to the packet and send route reply packet
                */
               DsrRoutingHeader dsrRoutingHeader;
+              dsrRoutingHeader.SetWideIds (m_wideNodeIds);
               dsrRoutingHeader.SetNextHeader (protocol);
               dsrRoutingHeader.SetMessageType (1);
               dsrRoutingHeader.SetSourceId (GetIDfromIP (realSource));
-              dsrRoutingHeader.SetDestId (255);
+              dsrRoutingHeader.SetDestId (DsrFsHeader::NO_ID);
 
               uint8_t length = rrep.GetLength ();  // Get the length of the rrep header excluding the type header
               dsrRoutingHeader.SetPayloadLength (length + 2);
@@ -4976,80 +4979,29 @@ void DsrRouting::RemoveDuplicates (std::vector<Ipv4Address>& vec)
 {
   NS_LOG_FUNCTION (this);
   //Remove duplicate ip address from the route if any, should not happen with normal behavior nodes
-  std::vector<Ipv4Address> vec2 (vec); // declare vec2 as a copy of the vec
-  PrintVector (vec2); // Print all the ip address in the route
-  vec.clear (); // clear vec
-  for (std::vector<Ipv4Address>::const_iterator i = vec2.begin (); i != vec2.end (); ++i)
-    {
-      if (vec.empty ())
-        {
-          vec.push_back (*i);
-          continue;
-        }
-      else
-        {
-          for (std::vector<Ipv4Address>::iterator j = vec.begin (); j != vec.end (); ++j)
-            {
-              if ((*i) == (*j))
-                {
-                  if ((j + 1) != vec.end ())
-                    {
-                      vec.erase (j + 1, vec.end ());   // Automatic shorten the route
-                      break;
-                    }
-                  else
-                    {
-                      break;
-                    }
-                }
-              else if (j == (vec.end () - 1))
-                {
-                  vec.push_back (*i);
-                  break;
-                }
-              else
-                {
-                  continue;
-                }
-            }
-        }
-    }
+  PrintVector (vec); // Print all the ip address in the route
+  DsrRrepVerifier::RemoveDuplicates (vec);
 }
-uint8_t DsrRouting::ProcessRrep (Ptr<Packet> packet, Ptr<Packet> dsrP, Ipv4Address ipv4Address, Ipv4Address source, Ipv4Header const& ipv4Header, uint8_t protocol, bool& isPromisc, Ipv4Address promiscSource)
+
+uint8_t DsrRouting::ProcessRrep (Ptr<Packet> packet, Ptr<Packet> dsrP, DsrRrepVerifier const& rrep, Ipv4Address ipv4Address, Ipv4Address source, Ipv4Header const& ipv4Header, uint8_t protocol, bool& isPromisc, Ipv4Address promiscSource)
 {
   NS_LOG_FUNCTION (this << packet << dsrP << ipv4Address << source << ipv4Header << (uint32_t)protocol << isPromisc);
 
-  Ptr<Packet> p = packet->Copy ();
-
-  // Get the number of routers' address field
-  uint8_t buf[2];
-  p->CopyData (buf, sizeof(buf));
-  uint8_t numberAddress = (buf[1] - 2) / 4;
-
-  DsrOptionRrepHeader rrep;
-  rrep.SetNumberAddress (numberAddress);  // Set the number of ip address in the header to reserver space for deserialize header
-  p->RemoveHeader (rrep);
-
   Ptr<Node> node = GetNodeWithAddress (ipv4Address);
 
   NS_LOG_DEBUG ("The next header value " << (uint32_t)protocol);
 
-  std::vector<Ipv4Address> nodeList = rrep.GetNodesAddress ();
+  // The loops of a route for us were cut by the verifier, this is for the route reply from
+  // intermediate node since we didn't remove duplicate there
+  std::vector<Ipv4Address> nodeList = rrep.GetRoute ();
 
   /**
    * Get the destination address, which is the last element in the nodeList
    */
   Ipv4Address targetAddress = nodeList.front ();
   // If the RREP option has reached to the destination
-  if (targetAddress == ipv4Address)
+  if (rrep.IsForUs ())
     {
-      RemoveDuplicates (nodeList); // This is for the route reply from intermediate node since we didn't remove
-                                   // duplicate there
-      if (nodeList.size () == 0)
-        {
-          NS_LOG_DEBUG ("The route we have contains 0 entries");
-          return 0;
-        }
       /**
        * Get the destination address for the data packet, which is the last element in the nodeList
        */
@@ -5109,7 +5061,8 @@ uint8_t DsrRouting::ProcessRrep (Ptr<Packet> packet, Ptr<Packet> dsrP, Ipv4Addre
     }
   else
     {
-      uint8_t length = rrep.GetLength () - 2; // The get length - 2 is to get aligned for the malformed header check
+      DsrOptionRrepHeader rrepHeader = rrep.GetHeader ();
+      uint8_t length = rrepHeader.GetLength () - 2; // The get length - 2 is to get aligned for the malformed header check
       NS_LOG_DEBUG ("The length of rrep option " << (uint32_t)length);
 
       if (length % 2 != 0)
@@ -5168,15 +5121,16 @@ uint8_t DsrRouting::ProcessRrep (Ptr<Packet> packet, Ptr<Packet> dsrP, Ipv4Addre
        * This part add dsr routing header to the packet and send reply
        */
       DsrRoutingHeader dsrRoutingHeader;
+      dsrRoutingHeader.SetWideIds (m_wideNodeIds);
       dsrRoutingHeader.SetNextHeader (protocol);
 
-      length = rrep.GetLength ();    // Get the length of the rrep header excluding the type header
+      length = rrepHeader.GetLength ();    // Get the length of the rrep header excluding the type header
       NS_LOG_DEBUG ("The reply header length " << (uint32_t)length);
       dsrRoutingHeader.SetPayloadLength (length + 2);
       dsrRoutingHeader.SetMessageType (1);
       dsrRoutingHeader.SetSourceId (GetIDfromIP (source));
       dsrRoutingHeader.SetDestId (GetIDfromIP (targetAddress));
-      dsrRoutingHeader.AddDsrOption (rrep);
+      dsrRoutingHeader.AddDsrOption (rrepHeader);
       Ptr<Packet> newPacket = Create<Packet> ();
       newPacket->AddHeader (dsrRoutingHeader);
       SendReply (newPacket, ipv4Address, nextHop, m_ipv4Route);
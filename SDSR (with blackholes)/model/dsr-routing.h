@@ -67,12 +67,20 @@
 #include "dsr-rcache.h"
 #include "dsr-rreq-table.h"
 #include "dsr-maintain-buff.h"
+#include "dsr-retrans-timer.h"
+#include "dsr-ack-batcher.h"
+#include "dsr-blacklist.h"
+#include "dsr-ack-correlation.h"
+#include "dsr-ack-policy.h"
+#include "dsr-rrep-verifier.h"
 #include "dsr-passive-buff.h"
 #include "dsr-option-header.h"
 #include "dsr-fs-header.h"
 #include "dsr-rsendbuff.h"
+#include "dsr-adversary.h"
 #include "dsr-errorbuff.h"
 #include "dsr-gratuitous-reply-table.h"
+#include "dsr-node-directory.h"
 #include <fstream>
 #include "ns3/core-module.h"
 #include "ns3/network-module.h"
@@ -110,6 +118,13 @@ public:
     * \brief Define the dsr protocol number.
     */
   static const uint8_t PROT_NUMBER;
+  /**
+   * Callback signature for the route discovery and maintenance packets this node sends.
+   *
+   * \param [in] packet the DSR packet, without the ip header
+   * \param [in] optionType the option number of the rreq, rrep, rerr or ack it carries
+   */
+  typedef void (* ControlTxCallback)(Ptr<const Packet> packet, uint8_t optionType);
   /**
    * \brief Constructor.
    */
@@ -158,6 +173,26 @@ public:
     * \return the passive buffer
     */
   Ptr<dsr::DsrPassiveBuffer> GetPassiveBuffer () const;
+  /**
+   * \brief Set the adversary model
+   * \param adversary the attacker set and behaviour, may be shared by all the nodes
+   */
+  void SetAdversary (Ptr<dsr::DsrAdversary> adversary);
+  /**
+   * \brief Get the adversary model
+   * \return the attacker set and behaviour
+   */
+  Ptr<dsr::DsrAdversary> GetAdversary () const;
+  /**
+   * \brief Set the ack policy
+   * \param ackPolicy picks the ack mode of the data packets of this node
+   */
+  void SetAckPolicy (Ptr<dsr::DsrAckPolicy> ackPolicy);
+  /**
+   * \brief Get the ack policy
+   * \return the ack policy
+   */
+  Ptr<dsr::DsrAckPolicy> GetAckPolicy () const;
 
   /// functions used to direct to route cache
   //\{
@@ -186,15 +221,20 @@ public:
   /**
     * \brief Get the node id from ip address.
     * \param address IPv4 address
-    * \return the node id
+    * \return the node id, DsrFsHeader::NO_ID if unknown
     */
-  uint16_t GetIDfromIP (Ipv4Address address);
+  uint32_t GetIDfromIP (Ipv4Address address);
   /**
     * \brief Get the ip address from id.
     * \param id unique ID
     * \return the ip address for the id
     */
-  Ipv4Address GetIPfromID (uint16_t id);
+  Ipv4Address GetIPfromID (uint32_t id);
+  /**
+    * \brief Whether the fixed size headers we build carry 32 bit node ids.
+    * \return the WideNodeIds attribute
+    */
+  bool IsWideNodeIds () const;
   /**
     * \brief Get the Ip address from mac address.
     * \param address Mac48Address
@@ -317,6 +357,10 @@ public:
    * \brief Call the cancel packet retransmission timer function
    */
   void CallCancelPacketTimer (uint16_t ackId, Ipv4Header const& ipv4Header, Ipv4Address realSrc, Ipv4Address realDst);
+  /**
+   * \brief Call the cancel packet retransmission timer function for every id of an ack
+   */
+  void CallCancelPacketTimer (std::vector<uint16_t> const& ackIds, Ipv4Header const& ipv4Header, Ipv4Address realSrc, Ipv4Address realDst);
   /**
    * \brief Cancel the network packet retransmission timer for a specific maintenance entry
    */
@@ -480,6 +524,45 @@ public:
 				  Ipv4Address targetDst,
 				  Ipv4Address realSender
 				  );
+  /**
+   * Send one acknowledgment covering several data packets, held back for
+   * AckHoldoff first so that acks of later packets of the flow can join it
+   *
+   * \param ackIds the ids of the acked packets
+   * \param destination IPv4 address of the immediate ACK receiver
+   * \param realSrc IPv4 address of the real source
+   * \param realDst IPv4 address of the real destination
+   * \param protocol the protocol number
+   * \param route Route
+   * \param ipv4Address the route of the acked packets
+   * \param flag one hop, two hop or end to end ack
+   * \param targetDst the node the ack is meant for
+   * \param realSender the node that generated the ack
+   */
+  void SendAck (std::vector<uint16_t> const& ackIds,
+                Ipv4Address destination,
+                Ipv4Address realSrc,
+                Ipv4Address realDst,
+                uint8_t protocol,
+                Ptr<Ipv4Route> route,
+                std::vector<Ipv4Address> ipv4Address,
+                uint16_t flag,
+                Ipv4Address targetDst,
+                Ipv4Address realSender);
+  /**
+   * Put an acknowledgment in the network queue
+   *
+   * \param ackIds the ids of the acked packets
+   * \param key the addresses and flag of the ack
+   * \param protocol the protocol number
+   * \param route Route
+   * \param ipv4Address the route of the acked packets
+   */
+  void SendAckNow (std::vector<uint16_t> const& ackIds,
+                   DsrAckBatchKey const& key,
+                   uint8_t protocol,
+                   Ptr<Ipv4Route> route,
+                   std::vector<Ipv4Address> const& ipv4Address);
   /**
    * \param p packet to forward up
    * \param header IPv4 Header information
@@ -584,6 +667,10 @@ protected:
    */
   TracedCallback<Ptr<const Packet> > m_dropTrace;
   TracedCallback <const DsrOptionSRHeader &> m_txPacketTrace;
+  /// The trace for nodes entering or leaving the blacklist
+  TracedCallback<Ipv4Address, bool> m_blackListTrace;
+  /// The trace for the control packets counted in dsrRreq, dsrRrep, dsrRerr and dsrAck
+  TracedCallback<Ptr<const Packet>, uint8_t> m_controlTxTrace;
 
 private:
 
@@ -607,7 +694,20 @@ private:
 
   virtual uint8_t processAck (Ptr<Packet> packet, Ptr<Packet> dsrP, Ipv4Address ipv4Address, Ipv4Address source, Ipv4Header const& ipv4Header, uint8_t protocol, bool& isPromisc, Ipv4Address promiscSource);
   //(sx 2017917) this processack function used to handle the ack in routing.cc file.
-  virtual uint8_t ProcessRrep (Ptr<Packet> packet, Ptr<Packet> dsrP, Ipv4Address ipv4Address, Ipv4Address source, Ipv4Header const& ipv4Header, uint8_t protocol, bool& isPromisc, Ipv4Address promiscSource);
+  /**
+   * \brief Process a route reply read by a DsrRrepVerifier
+   * \param packet the packet, starting with the route reply option
+   * \param dsrP the packet with the dsr header
+   * \param rrep the route reply as read by Receive
+   * \param ipv4Address the address of this node
+   * \param source the source of the packet
+   * \param ipv4Header the ip header of the packet
+   * \param protocol the protocol number
+   * \param isPromisc set to false once the reply is sent on
+   * \param promiscSource the source of a promiscuously received packet
+   * \return the size of the option, 0 to drop the packet
+   */
+  virtual uint8_t ProcessRrep (Ptr<Packet> packet, Ptr<Packet> dsrP, DsrRrepVerifier const& rrep, Ipv4Address ipv4Address, Ipv4Address source, Ipv4Header const& ipv4Header, uint8_t protocol, bool& isPromisc, Ipv4Address promiscSource);
 
   std::vector<Ipv4Address> CutRoute (Ipv4Address ipv4Address, std::vector<Ipv4Address> &nodeList);
   /**
@@ -627,13 +727,60 @@ private:
    */
   Ipv4Address ReverseSearchNextTwoHop  (Ipv4Address ipv4Address, std::vector<Ipv4Address>& vec);
 
-  bool checkRrepDst(Ipv4Address ipv4Address, std::vector<Ipv4Address>&vec);
+  /**
+   * \brief Peek at the leading bytes of an option header.
+   *
+   * Copies at most OPTION_PEEK_SIZE bytes into m_optionPeek instead of the
+   * whole remaining payload; the bytes stay valid until the next call.
+   * \param packet the packet starting with the option to peek
+   * \return the option type, or 0 if the packet is empty
+   */
+  uint8_t PeekOptionType (Ptr<const Packet> packet);
+
   virtual uint8_t processSr (Ptr<Packet> packet, Ptr<Packet> dsrP, Ipv4Address ipv4Address, Ipv4Address source, Ipv4Header const& ipv4Header, uint8_t protocol, bool& isPromisc, Ipv4Address promiscSource);
   bool ContainAddressAfter (Ipv4Address ipv4Address, Ipv4Address destAddress, std::vector<Ipv4Address> &nodeList);
 
-  void handleBlackList(std::vector<Ipv4Address>& ackPair, std::vector<Ipv4Address>& nodeList);
-  bool checkBlackList(std::vector<Ipv4Address>& blacklist, std::vector<Ipv4Address>& nodeList);
-  std::vector<Ipv4Address> m_blackList;
+  /**
+   * \brief Blacklist the node a packet stopped at, called for two hop ack sets still missing acks
+   * \param ackId the id of the packet
+   * \param nodeList the route of the packet
+   * \param missing the nodes that did not ack, in route order
+   */
+  void handleBlackList(uint32_t ackId, std::vector<Ipv4Address> const& nodeList, std::vector<Ipv4Address> const& missing);
+  /**
+   * \brief Refresh the route of a packet every node down the route acked
+   * \param ackId the id of the packet
+   * \param nodeList the route of the packet
+   * \param missing empty
+   */
+  void AckSetComplete (uint32_t ackId, std::vector<Ipv4Address> const& nodeList, std::vector<Ipv4Address> const& missing);
+  bool checkBlackList(std::vector<Ipv4Address> const& nodeList);
+  /**
+   * \brief Fire the blacklist trace
+   * \param address the node entering or leaving the blacklist
+   * \param added true if the node entered the blacklist
+   */
+  void NotifyBlackList (Ipv4Address address, bool added);
+  /**
+   * \brief Read the route of a data packet whose source route fixed fields were removed
+   * \param packet the packet, starting with the route
+   * \param numberAddress the number of addresses of the route
+   * \return the route, empty if the packet is too short
+   */
+  std::vector<Ipv4Address> PeekRoute (Ptr<const Packet> packet, uint8_t numberAddress) const;
+  /**
+   * \brief Ask the ack policy for the ack mode of a data packet this node originates
+   * \param nodeList the route of the packet
+   * \return the ack flag
+   */
+  uint8_t SelectAckFlag (std::vector<Ipv4Address> const& nodeList);
+  /**
+   * \brief Wait for the two hop acks of a data packet this node sent with two hop acks
+   * \param packet the packet
+   * \param ackFlag the ack flag of its source route
+   * \param nodeList the route of the packet
+   */
+  void ExpectAcks (Ptr<const Packet> packet, uint8_t ackFlag, std::vector<Ipv4Address> const& nodeList);
   virtual uint8_t processRreq(Ptr<Packet> packet, Ptr<Packet> dsrP, Ipv4Address ipv4Address, Ipv4Address source, Ipv4Header const& ipv4Header, uint8_t protocol, bool& isPromisc, Ipv4Address promiscSource);
   bool IfDuplicates (std::vector<Ipv4Address>& vec, std::vector<Ipv4Address>& vec2);
   bool ReverseRoutes  (std::vector<Ipv4Address>& vec);
@@ -654,7 +801,6 @@ private:
 
   Ptr<Ipv4> m_ip;
   ///< The ip ptr
-  std::vector<Ipv4Address> m_ackPair;
   uint64_t ApacketId = 0;
   uint16_t realreceivefake = 0;
   uint16_t blackfindcount = 0;
@@ -671,15 +817,13 @@ private:
   uint16_t attackCount = 0;
   uint16_t rreqS = 0;
   uint16_t rreqid = 0;
-  bool blackHole = false;
   std::vector<uint16_t> rerrPacketSize;
-  uint16_t m_id = 0;
+  uint32_t m_id = 0;
   std::vector<uint16_t> rreqPacketSize;
   std::vector<uint16_t> rrepPacketSize;
   std::vector<uint16_t> ackPacketSize;
 
   Ptr<Node> m_node;                                     ///< The node ptr
-  uint16_t  blacktries = 0;
   uint64_t packetId = 0;
   uint16_t buffercount = 0;
   Ipv4Address m_mainAddress;                            ///< Our own Ip address
@@ -784,6 +928,10 @@ private:
 
   Time m_useExtends;                                    ///< The use extension of the life time for link cache
 
+  double m_trustDecay;                                  ///< The weight kept by the former trust evidence
+
+  uint32_t m_trustPenalty;                              ///< The extra hops a relay of no trust counts for
+
   bool m_subRoute;                                      ///< Whether to save sub route or not
 
   Time m_retransIncr;                                   ///< the increase time for retransmission timer when face network congestion
@@ -794,17 +942,11 @@ private:
 
   std::map<Ipv4Address, Timer> m_nonPropReqTimer;       ///< Map IP address + RREQ timer.
 
-  std::map<NetworkKey, Timer>  m_addressForwardTimer;   ///< Map network key + forward timer.
+  DsrRetransTimer<NetworkKey, NetworkKeyHash> m_addressForwardTimer;   ///< Network key + forward timer and counts.
 
-  std::map<NetworkKey, uint32_t> m_addressForwardCnt;   ///< Map network key + forward counts.
+  DsrRetransTimer<PassiveKey, PassiveKeyHash> m_passiveAckTimer;        ///< The timer and counts for passive acknowledgment
 
-  std::map<PassiveKey, uint32_t> m_passiveCnt;          ///< Map packet key + passive forward counts.
-
-  std::map<PassiveKey, Timer> m_passiveAckTimer;        ///< The timer for passive acknowledgment
-
-  std::map<LinkKey, uint32_t> m_linkCnt;                ///< Map packet key + link forward counts.
-
-  std::map<LinkKey, Timer> m_linkAckTimer;              ///< The timer for link acknowledgment
+  DsrRetransTimer<LinkKey, LinkKeyHash> m_linkAckTimer;                 ///< The timer and counts for link acknowledgment
 
   Ptr<dsr::DsrRouteCache> m_routeCache;                 ///< A "drop-front" queue used by the routing layer to cache routes found.
 
@@ -812,10 +954,46 @@ private:
 
   Ptr<dsr::DsrPassiveBuffer> m_passiveBuffer;           ///< A "drop-front" queue used by the routing layer to cache route request sent.
 
+  Ptr<dsr::DsrAdversary> m_adversary;                   ///< The attacker set and behaviour
+
+  Ptr<dsr::DsrAckPolicy> m_ackPolicy;                   ///< Picks the ack mode of the data packets this node originates
+
+  TypeId m_ackPolicyTypeId;                             ///< The type of the ack policy built when none is set
+
+  Ptr<dsr::DsrNodeDirectory> m_directory;               ///< The simulation-wide ip address, node id and mac address directory
+
+  static const uint32_t OPTION_PEEK_SIZE = 12;          ///< The option bytes needed to demux, up to the source route segments left
+
+  uint8_t m_optionPeek[OPTION_PEEK_SIZE];               ///< Scratch buffer reused to peek at received option headers
+
   uint32_t m_numPriorityQueues;                         ///< The number of priority queues used
 
   bool m_linkAck;                                       ///< define if we use link acknowledgement or not
 
+  bool m_wideNodeIds;                                   ///< define if the fixed size header carries 32 bit node ids
+
+  bool m_compactAck;                                    ///< define if the ack option uses the compact encoding
+
+  Time m_ackHoldoff;                                    ///< how long acks wait to be coalesced
+
+  uint32_t m_maxAckBatch;                               ///< max number of ids per ack
+
+  DsrAckBatcher m_ackBatcher;                           ///< acks held back for coalescing
+
+  bool m_blackholeDefense;                              ///< define if blacklisted nodes are avoided and replies checked
+
+  Time m_blackListTimeout;                              ///< how long a suspect stays blacklisted after its first strike
+
+  Time m_maxBlackListTimeout;                           ///< the longest a repeat suspect stays blacklisted
+
+  DsrBlackList m_blackList;                             ///< nodes suspected of dropping data
+
+  Time m_ackCorrelationTimeout;                         ///< how long the source waits for two hop acks
+
+  uint32_t m_maxAckCorrelations;                        ///< max number of packets waiting for two hop acks
+
+  DsrAckCorrelation m_ackCorrelation;                   ///< two hop acks expected by this source
+
   std::map<uint32_t, Ptr<dsr::DsrNetworkQueue> > m_priorityQueue;   ///< priority queues
 
   DsrGraReply m_graReply;                               ///< The gratuitous route reply.
@@ -826,7 +1004,6 @@ private:
   std::vector<Ipv4Address> m_clearList;                 ///< The node that is clear to send packet to
   uint64_t rrepid = 0;
   uint16_t realcount = 0;
-  bool blackattack = false;
   std::vector<Ipv4Address> m_addresses;                 ///< The bind ipv4 addresses with next hop, src, destination address in sequence
   std::map <uint64_t, uint64_t> m_current_time;
   std::map <std::string, uint32_t> m_macToNodeIdMap;    ///< The map of mac address to node id
@@ -0,0 +1,185 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2026 The SDSR contributors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: The SDSR contributors, see the git history
+ */
+
+#include "dsr-rrep-verifier.h"
+#include <algorithm>
+#include <limits>
+#include "ns3/log.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("DsrRrepVerifier");
+
+namespace dsr {
+
+DsrRrepVerifier::DsrRrepVerifier ()
+  : m_size (0),
+    m_blackFlag (0),
+    m_forUs (false),
+    m_blackListed (false)
+{
+}
+
+bool
+DsrRrepVerifier::Append (std::vector<Ipv4Address> & route, std::bitset<256> & seen, Ipv4Address address)
+{
+  uint8_t low = address.Get () & 0xff;
+  if (seen.test (low))
+    {
+      std::vector<Ipv4Address>::iterator first = std::find (route.begin (), route.end (), address);
+      if (first != route.end ())
+        {
+          // Automatic shorten the route
+          route.erase (first + 1, route.end ());
+          seen.reset ();
+          for (std::vector<Ipv4Address>::const_iterator i = route.begin (); i != route.end (); ++i)
+            {
+              seen.set (i->Get () & 0xff);
+            }
+          return true;
+        }
+    }
+  seen.set (low);
+  route.push_back (address);
+  return false;
+}
+
+void
+DsrRrepVerifier::RemoveDuplicates (std::vector<Ipv4Address> & route)
+{
+  std::vector<Ipv4Address> received;
+  received.swap (route);
+  route.reserve (received.size ());
+  std::bitset<256> seen;
+  for (std::vector<Ipv4Address>::const_iterator i = received.begin (); i != received.end (); ++i)
+    {
+      Append (route, seen, *i);
+    }
+}
+
+uint32_t
+DsrRrepVerifier::Verify (Ptr<const Packet> packet, Ipv4Address ipv4Address, DsrBlackList * blackList)
+{
+  NS_LOG_FUNCTION (this << packet << ipv4Address);
+  m_route.clear ();
+  m_size = 0;
+  m_blackFlag = 0;
+  m_forUs = false;
+  m_blackListed = false;
+
+  // Option type, length, flag and the reserved byte
+  uint8_t fixed[4];
+  if (packet->CopyData (fixed, sizeof (fixed)) != sizeof (fixed) || fixed[0] != 2)
+    {
+      NS_LOG_LOGIC ("Not a route reply");
+      return 0;
+    }
+  uint32_t numberAddress = fixed[1] < 2 ? 0 : (fixed[1] - 2) / 4;
+  uint32_t size = 4 + 4 * numberAddress;
+  if (numberAddress < 2)
+    {
+      NS_LOG_LOGIC ("Malformed route reply with " << numberAddress << " addresses");
+      return 0;
+    }
+  m_raw.resize (size);
+  if (packet->CopyData (&m_raw[0], size) != size)
+    {
+      NS_LOG_LOGIC ("Truncated route reply");
+      return 0;
+    }
+  m_blackFlag = m_raw[2];
+  m_route.reserve (numberAddress);
+  m_forUs = Ipv4Address::Deserialize (&m_raw[4]) == ipv4Address;
+  if (!m_forUs)
+    {
+      for (uint32_t i = 4; i < size; i += 4)
+        {
+          m_route.push_back (Ipv4Address::Deserialize (&m_raw[i]));
+        }
+      m_size = size;
+      return m_size;
+    }
+
+  // The reply reached its source, cut the loops and look for suspects on the way
+  const uint32_t none = std::numeric_limits<uint32_t>::max ();
+  uint32_t firstBlack = none;
+  std::bitset<256> seen;
+  for (uint32_t i = 4; i < size; i += 4)
+    {
+      Ipv4Address address = Ipv4Address::Deserialize (&m_raw[i]);
+      if (Append (m_route, seen, address))
+        {
+          if (firstBlack != none && firstBlack >= m_route.size ())
+            {
+              // The suspect was on the loop that was cut
+              firstBlack = none;
+            }
+        }
+      else if (blackList != 0 && firstBlack == none && blackList->Contains (address))
+        {
+          firstBlack = m_route.size () - 1;
+        }
+    }
+  m_blackListed = firstBlack != none;
+  m_size = size;
+  return m_size;
+}
+
+bool
+DsrRrepVerifier::IsForUs () const
+{
+  return m_forUs;
+}
+
+std::vector<Ipv4Address> const &
+DsrRrepVerifier::GetRoute () const
+{
+  return m_route;
+}
+
+bool
+DsrRrepVerifier::IsBlackListed () const
+{
+  return m_blackListed;
+}
+
+uint8_t
+DsrRrepVerifier::GetBlackFlag () const
+{
+  return m_blackFlag;
+}
+
+DsrOptionRrepHeader
+DsrRrepVerifier::GetHeader () const
+{
+  DsrOptionRrepHeader rrep;
+  rrep.SetNodesAddress (m_route);
+  rrep.SetAck (m_blackFlag);
+  return rrep;
+}
+
+uint32_t
+DsrRrepVerifier::GetSerializedSize () const
+{
+  return m_size;
+}
+
+} // namespace dsr
+} // namespace ns3
@@ -0,0 +1,115 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2026 The SDSR contributors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: The SDSR contributors, see the git history
+ */
+
+#ifndef DSR_RREP_VERIFIER_H
+#define DSR_RREP_VERIFIER_H
+
+#include <vector>
+#include <bitset>
+#include "ns3/ptr.h"
+#include "ns3/packet.h"
+#include "ns3/ipv4-address.h"
+#include "dsr-option-header.h"
+#include "dsr-blacklist.h"
+
+namespace ns3 {
+namespace dsr {
+/**
+ * \ingroup dsr
+ * \brief Reads a route reply option once and checks its route in the same pass
+ *
+ * DsrRouting::Receive used to peek the whole DsrOptionRrepHeader to look at the route,
+ * and ProcessRrep removed it from the packet again. The verifier copies the option out
+ * of the packet once and decodes the addresses from the raw bytes. If the reply has
+ * reached the node it is meant for, the route loops are cut while the addresses are
+ * decoded, the same way DsrRouting::RemoveDuplicates does, and every address kept is
+ * looked up in the blacklist. A 256 bit set of the low address bytes seen so far tells
+ * when an address can be a repeat, only then the route is searched.
+ */
+class DsrRrepVerifier
+{
+public:
+  DsrRrepVerifier ();
+  /**
+   * \brief Read the route reply option at the start of a packet
+   * \param packet the packet, starting with the option
+   * \param ipv4Address the address of this node
+   * \param blackList the suspects to look for in a reply for this node, 0 not to look
+   * \return the size of the option, 0 if it is malformed
+   */
+  uint32_t Verify (Ptr<const Packet> packet, Ipv4Address ipv4Address, DsrBlackList * blackList);
+  /**
+   * \brief Check if the reply has reached the node it is meant for
+   * \return true if the first address of the route is this node
+   */
+  bool IsForUs () const;
+  /**
+   * \brief Get the route of the reply
+   * \return the route with the loops cut if the reply is for this node, as received otherwise
+   */
+  std::vector<Ipv4Address> const & GetRoute () const;
+  /**
+   * \brief Check if a node of the route is blacklisted
+   * \return true if a node of the route, loops cut, is in the blacklist given to Verify
+   */
+  bool IsBlackListed () const;
+  /**
+   * \brief Get the flag forged replies carry
+   * \return the flag
+   */
+  uint8_t GetBlackFlag () const;
+  /**
+   * \brief Build the header of the reply, to send it on
+   * \return the header with the route as received
+   */
+  DsrOptionRrepHeader GetHeader () const;
+  /**
+   * \brief Get the size of the option as received
+   * \return the size, 0 if it was malformed
+   */
+  uint32_t GetSerializedSize () const;
+  /**
+   * \brief Cut the loops of a route, keeping the first visit of every node
+   * \param route the route
+   */
+  static void RemoveDuplicates (std::vector<Ipv4Address> & route);
+
+private:
+  /**
+   * \brief Append an address to a route, or cut the route back to it if it is a repeat
+   * \param route the route
+   * \param seen the low bytes of the addresses of the route
+   * \param address the address
+   * \return true if the address was a repeat and the route was cut
+   */
+  static bool Append (std::vector<Ipv4Address> & route, std::bitset<256> & seen, Ipv4Address address);
+
+  std::vector<uint8_t> m_raw;                      ///< the option bytes, kept to save allocations
+  std::vector<Ipv4Address> m_route;                ///< the route
+  uint32_t m_size;                                 ///< the size of the option
+  uint8_t m_blackFlag;                             ///< the flag of forged replies
+  bool m_forUs;                                    ///< the reply is for this node
+  bool m_blackListed;                              ///< a node of the route is blacklisted
+};
+
+} // namespace dsr
+} // namespace ns3
+
+#endif /* DSR_RREP_VERIFIER_H */
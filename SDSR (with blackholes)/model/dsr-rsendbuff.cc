@@ -31,7 +31,6 @@
 
 #include "dsr-rsendbuff.h"
 #include <algorithm>
-#include <functional>
 #include "ns3/ipv4-route.h"
 #include "ns3/socket.h"
 #include "ns3/log.h"
@@ -46,37 +45,57 @@ uint32_t
 DsrSendBuffer::GetSize ()
 {
   Purge ();
-  return m_sendBuffer.size ();
+  return m_size;
+}
+
+void
+DsrSendBuffer::GetDestinations (std::vector<Ipv4Address> & destinations)
+{
+  Purge ();
+  for (std::map<Ipv4Address, Bucket>::const_iterator i = m_buckets.begin (); i != m_buckets.end (); ++i)
+    {
+      destinations.push_back (i->first);
+    }
 }
 
 bool
 DsrSendBuffer::Enqueue (DsrSendBuffEntry & entry)
 {
   Purge ();
-  for (std::vector<DsrSendBuffEntry>::const_iterator i = m_sendBuffer.begin (); i
-       != m_sendBuffer.end (); ++i)
+  std::map<Ipv4Address, Bucket>::iterator bucket = m_buckets.find (entry.GetDestination ());
+  if (bucket != m_buckets.end ())
     {
-//      NS_LOG_DEBUG ("packet id " << i->GetPacket ()->GetUid () << " " << entry.GetPacket ()->GetUid ()
-//                                << " dst " << i->GetDestination () << " " << entry.GetDestination ());
-
-      if ((i->GetPacket ()->GetUid () == entry.GetPacket ()->GetUid ())
-          && (i->GetDestination () == entry.GetDestination ()))
+      for (Bucket::const_iterator i = bucket->second.begin (); i != bucket->second.end (); ++i)
         {
-          return false;
+          if (i->GetPacket ()->GetUid () == entry.GetPacket ()->GetUid ())
+            {
+              return false;
+            }
         }
     }
 
   entry.SetExpireTime (m_sendBufferTimeout);     // Initialize the send buffer timeout
+  entry.SetSequence (m_expiry.Insert (Simulator::Now () + m_sendBufferTimeout));
   /*
-   * Drop the most aged packet when buffer reaches to max
+   * Drop the most aged packet when buffer reaches to max, it is at the front of one of the buckets
    */
-  if (m_sendBuffer.size () >= m_maxLen)
+  if (m_size >= m_maxLen && m_size > 0)
     {
-      Drop (m_sendBuffer.front (), "Drop the most aged packet");         // Drop the most aged packet
-      m_sendBuffer.erase (m_sendBuffer.begin ());
+      std::map<Ipv4Address, Bucket>::iterator oldest = m_buckets.begin ();
+      for (std::map<Ipv4Address, Bucket>::iterator i = m_buckets.begin (); i != m_buckets.end (); ++i)
+        {
+          if (i->second.front ().GetSequence () < oldest->second.front ().GetSequence ())
+            {
+              oldest = i;
+            }
+        }
+      Drop (oldest->second.front (), "Drop the most aged packet");         // Drop the most aged packet
+      PopFront (oldest);
     }
   // enqueue the entry
-  m_sendBuffer.push_back (entry);
+  m_buckets[entry.GetDestination ()].push_back (entry);
+  m_bucketOf[entry.GetSequence ()] = entry.GetDestination ();
+  ++m_size;
   return true;
 }
 
@@ -84,20 +103,15 @@ void
 DsrSendBuffer::DropPacketWithDst (Ipv4Address dst)
 {
   NS_LOG_FUNCTION (this << dst);
-  Purge ();
   /*
    * Drop the packet with destination address dst
    */
-  for (std::vector<DsrSendBuffEntry>::iterator i = m_sendBuffer.begin (); i
-       != m_sendBuffer.end (); ++i)
+  std::vector<DsrSendBuffEntry> entries;
+  Drain (dst, entries);
+  for (std::vector<DsrSendBuffEntry>::iterator i = entries.begin (); i != entries.end (); ++i)
     {
-      if (IsEqual (*i, dst))
-        {
-          Drop (*i, "DropPacketWithDst");
-        }
+      Drop (*i, "DropPacketWithDst");
     }
-  m_sendBuffer.erase (std::remove_if (m_sendBuffer.begin (), m_sendBuffer.end (),
-                                      std::bind2nd (std::ptr_fun (DsrSendBuffer::IsEqual), dst)), m_sendBuffer.end ());
 }
 
 bool
@@ -107,17 +121,36 @@ DsrSendBuffer::Dequeue (Ipv4Address dst, DsrSendBuffEntry & entry)
   /*
    * Dequeue the entry with destination address dst
    */
-  for (std::vector<DsrSendBuffEntry>::iterator i = m_sendBuffer.begin (); i != m_sendBuffer.end (); ++i)
+  std::map<Ipv4Address, Bucket>::iterator bucket = m_buckets.find (dst);
+  if (bucket == m_buckets.end ())
     {
-      if (i->GetDestination () == dst)
-        {
-          entry = *i;
-          i = m_sendBuffer.erase (i);
-          NS_LOG_DEBUG ("Packet size while dequeuing " << entry.GetPacket ()->GetSize ());
-          return true;
-        }
+      return false;
     }
-  return false;
+  entry = bucket->second.front ();
+  PopFront (bucket);
+  NS_LOG_DEBUG ("Packet size while dequeuing " << entry.GetPacket ()->GetSize ());
+  return true;
+}
+
+uint32_t
+DsrSendBuffer::Drain (Ipv4Address dst, std::vector<DsrSendBuffEntry> & entries)
+{
+  Purge ();
+  std::map<Ipv4Address, Bucket>::iterator bucket = m_buckets.find (dst);
+  if (bucket == m_buckets.end ())
+    {
+      return 0;
+    }
+  uint32_t count = bucket->second.size ();
+  for (Bucket::const_iterator i = bucket->second.begin (); i != bucket->second.end (); ++i)
+    {
+      m_bucketOf.erase (i->GetSequence ());
+      entries.push_back (*i);
+    }
+  m_size -= count;
+  m_buckets.erase (bucket);
+  NS_LOG_DEBUG ("Drained " << count << " packets for " << dst);
+  return count;
 }
 
 bool
@@ -126,18 +159,26 @@ DsrSendBuffer::Find (Ipv4Address dst)
   /*
    * Make sure if the send buffer contains entry with certain dst
    */
-  for (std::vector<DsrSendBuffEntry>::const_iterator i = m_sendBuffer.begin (); i
-       != m_sendBuffer.end (); ++i)
+  if (m_buckets.find (dst) != m_buckets.end ())
     {
-      if (i->GetDestination () == dst)
-        {
-          NS_LOG_DEBUG ("Found the packet");
-          return true;
-        }
+      NS_LOG_DEBUG ("Found the packet");
+      return true;
     }
   return false;
 }
 
+void
+DsrSendBuffer::PopFront (std::map<Ipv4Address, Bucket>::iterator bucket)
+{
+  m_bucketOf.erase (bucket->second.front ().GetSequence ());
+  bucket->second.pop_front ();
+  --m_size;
+  if (bucket->second.empty ())
+    {
+      m_buckets.erase (bucket);
+    }
+}
+
 struct IsExpired
 {
   bool
@@ -148,25 +189,52 @@ struct IsExpired
   }
 };
 
+struct SequenceLess
+{
+  bool
+  operator() (DsrSendBuffEntry const & e, uint64_t sequence) const
+  {
+    return (e.GetSequence () < sequence);
+  }
+};
+
 void
 DsrSendBuffer::Purge ()
 {
   /*
-   * Purge the buffer to eliminate expired entries
+   * Purge the buffer to eliminate expired entries, nothing is scanned until one of them expires
    */
-  NS_LOG_INFO ("The send buffer size " << m_sendBuffer.size ());
+  if (!m_expiry.IsDue ())
+    {
+      return;
+    }
+  NS_LOG_INFO ("The send buffer size " << m_size);
   IsExpired pred;
-  for (std::vector<DsrSendBuffEntry>::iterator i = m_sendBuffer.begin (); i
-       != m_sendBuffer.end (); ++i)
+  uint64_t sequence;
+  while (m_expiry.PopDue (sequence))
     {
-      if (pred (*i))
+      std::unordered_map<uint64_t, Ipv4Address>::iterator owner = m_bucketOf.find (sequence);
+      if (owner == m_bucketOf.end ())
+        {
+          continue;               // The entry has already left the buffer
+        }
+      std::map<Ipv4Address, Bucket>::iterator bucket = m_buckets.find (owner->second);
+      Bucket::iterator i = std::lower_bound (bucket->second.begin (), bucket->second.end (), sequence, SequenceLess ());
+      if (!pred (*i))
+        {
+          m_expiry.Reinsert (Simulator::Now () + i->GetExpireTime (), sequence);
+          continue;
+        }
+      NS_LOG_DEBUG ("Dropping Queue Packets");
+      Drop (*i, "Drop out-dated packet ");
+      m_bucketOf.erase (owner);
+      bucket->second.erase (i);
+      --m_size;
+      if (bucket->second.empty ())
         {
-          NS_LOG_DEBUG ("Dropping Queue Packets");
-          Drop (*i, "Drop out-dated packet ");
+          m_buckets.erase (bucket);
         }
     }
-  m_sendBuffer.erase (std::remove_if (m_sendBuffer.begin (), m_sendBuffer.end (), pred),
-                      m_sendBuffer.end ());
 }
 
 void
@@ -33,8 +33,12 @@
 #define DSR_SENDBUFF_H
 
 #include <vector>
+#include <deque>
+#include <map>
+#include <unordered_map>
 #include "ns3/ipv4-routing-protocol.h"
 #include "ns3/simulator.h"
+#include "dsr-expiry-index.h"
 
 namespace ns3 {
 namespace dsr {
@@ -58,7 +62,8 @@ public:
     : m_packet (pa),
       m_dst (d),
       m_expire (exp + Simulator::Now ()),
-      m_protocol (p)
+      m_protocol (p),
+      m_sequence (0)
   {
   }
   /**
@@ -96,6 +101,14 @@ public:
   {
     return m_expire - Simulator::Now ();
   }
+  void SetSequence (uint64_t sequence)
+  {
+    m_sequence = sequence;
+  }
+  uint64_t GetSequence () const
+  {
+    return m_sequence;
+  }
   void SetProtocol (uint8_t p)
   {
     m_protocol = p;
@@ -114,11 +127,16 @@ private:
   Time m_expire;
   /// The protocol number
   uint8_t m_protocol;
+  /// The sequence number given by the expiry index of the buffer
+  uint64_t m_sequence;
 };
 
 /**
  * \ingroup dsr
  * \brief DSR send buffer
+ *
+ * Packets are kept in one FIFO per destination, the length and age bounds
+ * apply to the buffer as a whole.
  */
 /************************************************************************************************************************/
 class DsrSendBuffer
@@ -128,6 +146,7 @@ public:
    * Default constructor
    */
   DsrSendBuffer ()
+    : m_size (0)
   {
   }
   /**
@@ -149,6 +168,15 @@ public:
    *         false otherwise
    */
   bool Dequeue (Ipv4Address dst, DsrSendBuffEntry & entry);
+  /**
+   * Remove all the entries for the given destination,
+   * the earliest first.
+   *
+   * \param dst IPv4 address of the destination
+   * \param entries vector the entries are appended to
+   * \return the number of entries removed
+   */
+  uint32_t Drain (Ipv4Address dst, std::vector<DsrSendBuffEntry> & entries);
   /**
    * Remove all packets with destination IP address dst
    *
@@ -168,6 +196,12 @@ public:
    * \return the number of entries in the queue
    */
   uint32_t GetSize ();
+  /**
+   * Get the destinations that have packets in the queue
+   *
+   * \param destinations vector the destinations are appended to
+   */
+  void GetDestinations (std::vector<Ipv4Address> & destinations);
   /**
    * Return the maximum queue length
    *
@@ -206,35 +240,24 @@ public:
   }
   // \}
 
-  /**
-   * Return a pointer to the internal queue
-   *
-   * \return a pointer to the internal queue
-   */
-  std::vector<DsrSendBuffEntry> & GetBuffer ()
-  {
-    return m_sendBuffer;
-  }
-
 private:
+  /// The packets waiting for one destination, the earliest first
+  typedef std::deque<DsrSendBuffEntry> Bucket;
 
-  std::vector<DsrSendBuffEntry> m_sendBuffer;                   ///< The send buffer to cache unsent packet
+  std::map<Ipv4Address, Bucket> m_buckets;                      ///< The send buffer to cache unsent packet, by destination
+  std::unordered_map<uint64_t, Ipv4Address> m_bucketOf;         ///< The destination of every entry, by sequence number
+  uint32_t m_size;                                              ///< The number of entries in all the buckets
+  DsrExpiryIndex m_expiry;                                      ///< The expire times of the entries
   void Purge ();                                                ///< Remove all expired entries
   void Drop (DsrSendBuffEntry en, std::string reason);          ///< Notify that packet is dropped from queue by timeout
-  uint32_t m_maxLen;                                            ///< The maximum number of packets that we allow a routing protocol to buffer.
-  Time m_sendBufferTimeout;                                     ///< The maximum period of time that a routing protocol is allowed to buffer a packet for, seconds.
   /**
-   * Check if the send buffer entry is the same or not
+   * Remove the first entry of a bucket, the bucket is erased once empty
    *
-   * \param en SendBufferEntry
-   * \param dst IPv4 address to check
-   * \return true if the SendBufferEntry destination is the same,
-   *         false otherwise
+   * \param bucket the bucket to take the entry from
    */
-  static bool IsEqual (DsrSendBuffEntry en, const Ipv4Address dst)
-  {
-    return (en.GetDestination () == dst);
-  }
+  void PopFront (std::map<Ipv4Address, Bucket>::iterator bucket);
+  uint32_t m_maxLen;                                            ///< The maximum number of packets that we allow a routing protocol to buffer.
+  Time m_sendBufferTimeout;                                     ///< The maximum period of time that a routing protocol is allowed to buffer a packet for, seconds.
 };
 /*******************************************************************************************************************************/
 } // namespace dsr
@@ -30,6 +30,8 @@
  */
 
 #include <vector>
+#include <cmath>
+#include <sstream>
 #include "ns3/ptr.h"
 #include "ns3/boolean.h"
 #include "ns3/test.h"
@@ -39,15 +41,30 @@
 #include "ns3/double.h"
 #include "ns3/uinteger.h"
 #include "ns3/string.h"
+#include "ns3/enum.h"
 #include "ns3/ipv4-address-helper.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/simple-net-device-helper.h"
 
 #include "ns3/dsr-fs-header.h"
 #include "ns3/dsr-option-header.h"
 #include "ns3/dsr-rreq-table.h"
 #include "ns3/dsr-rcache.h"
 #include "ns3/dsr-rsendbuff.h"
+#include "ns3/dsr-maintain-buff.h"
+#include "ns3/dsr-expiry-index.h"
+#include "ns3/dsr-retrans-timer.h"
+#include "ns3/dsr-ack-batcher.h"
+#include "ns3/dsr-node-directory.h"
+#include "ns3/dsr-adversary.h"
+#include "ns3/dsr-blacklist.h"
+#include "ns3/dsr-ack-correlation.h"
+#include "ns3/dsr-ack-policy.h"
+#include "ns3/dsr-rrep-verifier.h"
 #include "ns3/dsr-main-helper.h"
 #include "ns3/dsr-helper.h"
+#include "ns3/dsr-detection-stats.h"
+#include "ns3/dsr-options.h"
 
 using namespace ns3;
 using namespace dsr;
@@ -85,6 +102,66 @@ DsrFsHeaderTest::DoRun ()
   NS_TEST_EXPECT_MSG_EQ (*(data + 8), rreqHeader.GetType (), "expect the rreqHeader after fixed size header");
 }
 // -----------------------------------------------------------------------------
+// / Unit test for node ids past 256 in the fixed size header
+class DsrFsHeaderNodeIdTest : public TestCase
+{
+public:
+  DsrFsHeaderNodeIdTest ();
+  ~DsrFsHeaderNodeIdTest ();
+  virtual void
+  DoRun (void);
+};
+DsrFsHeaderNodeIdTest::DsrFsHeaderNodeIdTest ()
+  : TestCase ("DSR Fixed size Header node ids")
+{
+}
+DsrFsHeaderNodeIdTest::~DsrFsHeaderNodeIdTest ()
+{
+}
+void
+DsrFsHeaderNodeIdTest::DoRun ()
+{
+  dsr::DsrOptionRreqHeader rreqHeader;
+
+  dsr::DsrRoutingHeader compact;
+  compact.SetMessageType (1);
+  compact.SetSourceId (1000);
+  compact.SetDestId (dsr::DsrFsHeader::NO_ID);
+  compact.AddDsrOption (rreqHeader);
+  Ptr<Packet> p = Create<Packet> ();
+  p->AddHeader (compact);
+  dsr::DsrRoutingHeader compact2;
+  p->RemoveHeader (compact2);
+  NS_TEST_EXPECT_MSG_EQ (compact2.IsWideIds (), false, "trivial");
+  NS_TEST_EXPECT_MSG_EQ (compact2.GetMessageType (), 1, "trivial");
+  NS_TEST_EXPECT_MSG_EQ (compact2.GetSourceId (), 1000, "Compact ids go past 256");
+  NS_TEST_EXPECT_MSG_EQ (compact2.GetDestId (), dsr::DsrFsHeader::NO_ID, "trivial");
+  NS_TEST_EXPECT_MSG_EQ (compact2.GetDsrOptionsOffset (), 8, "trivial");
+
+  dsr::DsrRoutingHeader wide;
+  wide.SetWideIds (true);
+  wide.SetMessageType (2);
+  wide.SetSourceId (70000);
+  wide.SetDestId (123456);
+  wide.AddDsrOption (rreqHeader);
+  NS_TEST_EXPECT_MSG_EQ (wide.GetSerializedSize () % 4, 0, "length of routing header is not a multiple of 4");
+  Buffer buf;
+  buf.AddAtStart (wide.GetSerializedSize ());
+  wide.Serialize (buf.Begin ());
+  const uint8_t* data = buf.PeekData ();
+  NS_TEST_EXPECT_MSG_EQ (*(data + 12), rreqHeader.GetType (), "expect the rreqHeader after wide fixed size header");
+
+  p = Create<Packet> ();
+  p->AddHeader (wide);
+  dsr::DsrRoutingHeader wide2;
+  p->RemoveHeader (wide2);
+  NS_TEST_EXPECT_MSG_EQ (wide2.IsWideIds (), true, "trivial");
+  NS_TEST_EXPECT_MSG_EQ (wide2.GetMessageType (), 2, "The wide flag must not leak into the message type");
+  NS_TEST_EXPECT_MSG_EQ (wide2.GetSourceId (), 70000, "trivial");
+  NS_TEST_EXPECT_MSG_EQ (wide2.GetDestId (), 123456, "trivial");
+  NS_TEST_EXPECT_MSG_EQ (wide2.GetDsrOptionsOffset (), 12, "trivial");
+}
+// -----------------------------------------------------------------------------
 // / Unit test for RREQ
 class DsrRreqHeaderTest : public TestCase
 {
@@ -328,7 +405,193 @@ DsrAckHeaderTest::DoRun ()
   dsr::DsrOptionAckHeader h2;
   p->RemoveAtStart (8);
   uint32_t bytes = p->RemoveHeader (h2);
-  NS_TEST_EXPECT_MSG_EQ (bytes, 12, "Total RREP is 12 bytes long");
+  NS_TEST_EXPECT_MSG_EQ (bytes, 22, "Total ACK is 22 bytes long");
+  NS_TEST_EXPECT_MSG_EQ (h2.GetLength (), 20, "Option length is the serialized size - 2");
+}
+// -----------------------------------------------------------------------------
+// / Unit test for the compact ACK encoding
+class DsrAckCompactHeaderTest : public TestCase
+{
+public:
+  DsrAckCompactHeaderTest ();
+  ~DsrAckCompactHeaderTest ();
+  virtual void
+  DoRun (void);
+};
+DsrAckCompactHeaderTest::DsrAckCompactHeaderTest ()
+  : TestCase ("DSR compact ACK")
+{
+}
+DsrAckCompactHeaderTest::~DsrAckCompactHeaderTest ()
+{
+}
+void
+DsrAckCompactHeaderTest::DoRun ()
+{
+  std::vector<Ipv4Address> nodeList;
+  nodeList.push_back (Ipv4Address ("1.1.1.0"));
+  nodeList.push_back (Ipv4Address ("1.1.1.1"));
+  nodeList.push_back (Ipv4Address ("1.1.1.2"));
+  nodeList.push_back (Ipv4Address ("1.1.1.3"));
+
+  dsr::DsrOptionAckHeader h;
+  h.SetAckId (7);
+  h.SetAckFlag (2);
+  h.SetRealSrc (nodeList.front ());
+  h.SetRealDst (nodeList.back ());
+  h.SetTargetDst (nodeList[1]);
+  h.SetOriginalSender (nodeList[2]);
+  h.SetNodesAddress (nodeList);
+  NS_TEST_EXPECT_MSG_EQ (h.GetSerializedSize (), 38, "Full encoding is 22 + 4n bytes");
+  NS_TEST_EXPECT_MSG_EQ (h.GetLength (), 36, "Option length follows the full encoding");
+  h.SetCompact (true);
+  NS_TEST_EXPECT_MSG_EQ (h.GetSerializedSize (), 24, "Compact encoding is 8 + 4n bytes");
+  NS_TEST_EXPECT_MSG_EQ (h.GetLength (), 22, "Option length follows the compact encoding");
+
+  Ptr<Packet> p = Create<Packet> ();
+  p->AddHeader (h);
+  dsr::DsrOptionAckHeader h2;
+  uint32_t bytes = p->RemoveHeader (h2);
+  NS_TEST_EXPECT_MSG_EQ (bytes, 24, "Deserialize reads the compact size");
+  NS_TEST_EXPECT_MSG_EQ (p->GetSize (), 0, "Nothing left behind");
+  NS_TEST_EXPECT_MSG_EQ (h2.IsCompact (), true, "Compact bit is carried");
+  NS_TEST_EXPECT_MSG_EQ (h2.GetAckId (), 7, "ack id");
+  NS_TEST_EXPECT_MSG_EQ (h2.GetAckFlag (), 2, "flag without the compact bit");
+  NS_TEST_EXPECT_MSG_EQ (h2.GetRealSrc (), nodeList.front (), "real source from the list");
+  NS_TEST_EXPECT_MSG_EQ (h2.GetRealDst (), nodeList.back (), "real destination from the list");
+  NS_TEST_EXPECT_MSG_EQ (h2.GetTargetDst (), nodeList[1], "target from its hop index");
+  NS_TEST_EXPECT_MSG_EQ (h2.GetOriginalSender (), nodeList[2], "sender from its hop index");
+  NS_TEST_EXPECT_MSG_EQ (h2.GetNodesAddresses ().size (), 4, "node list size from the length");
+  NS_TEST_EXPECT_MSG_EQ (h2.GetNodesAddresses ()[3], nodeList[3], "node list content");
+
+  // a target off the route falls back to the full encoding
+  h.SetTargetDst (Ipv4Address ("2.2.2.2"));
+  NS_TEST_EXPECT_MSG_EQ (h.GetSerializedSize (), 38, "Fallback to the full encoding");
+  p = Create<Packet> ();
+  p->AddHeader (h);
+  dsr::DsrOptionAckHeader h3;
+  bytes = p->RemoveHeader (h3);
+  NS_TEST_EXPECT_MSG_EQ (bytes, 38, "Deserialize reads the full size");
+  NS_TEST_EXPECT_MSG_EQ (h3.IsCompact (), false, "No compact bit");
+  NS_TEST_EXPECT_MSG_EQ (h3.GetTargetDst (), Ipv4Address ("2.2.2.2"), "target address");
+  NS_TEST_EXPECT_MSG_EQ (h3.GetOriginalSender (), nodeList[2], "sender address");
+  NS_TEST_EXPECT_MSG_EQ (h3.GetNodesAddresses ().size (), 4, "node list size from the length");
+}
+// -----------------------------------------------------------------------------
+// / Unit test for ACKs covering several packets
+class DsrAckBatchTest : public TestCase
+{
+public:
+  DsrAckBatchTest ();
+  ~DsrAckBatchTest ();
+  virtual void
+  DoRun (void);
+  void Flush (std::vector<uint16_t> const & ackIds, dsr::DsrAckBatchKey const & key, uint8_t protocol,
+              Ptr<Ipv4Route> route, std::vector<Ipv4Address> const & nodeList);
+
+  std::vector<std::vector<uint16_t> > flushed;
+  std::vector<Time> flushTimes;
+};
+DsrAckBatchTest::DsrAckBatchTest ()
+  : TestCase ("DSR ACK batch")
+{
+}
+DsrAckBatchTest::~DsrAckBatchTest ()
+{
+}
+void
+DsrAckBatchTest::Flush (std::vector<uint16_t> const & ackIds, dsr::DsrAckBatchKey const & key, uint8_t protocol,
+                        Ptr<Ipv4Route> route, std::vector<Ipv4Address> const & nodeList)
+{
+  NS_TEST_EXPECT_MSG_EQ ((uint32_t)protocol, 17, "trivial");
+  flushed.push_back (ackIds);
+  flushTimes.push_back (Simulator::Now ());
+}
+void
+DsrAckBatchTest::DoRun ()
+{
+  std::vector<Ipv4Address> nodeList;
+  nodeList.push_back (Ipv4Address ("1.1.1.0"));
+  nodeList.push_back (Ipv4Address ("1.1.1.1"));
+  nodeList.push_back (Ipv4Address ("1.1.1.2"));
+
+  // ids close to the first one go as a bitmap
+  std::vector<uint16_t> ids;
+  ids.push_back (65530);
+  ids.push_back (65533);
+  ids.push_back (2);
+  ids.push_back (25);
+  dsr::DsrOptionAckHeader h;
+  h.SetAckFlag (1);
+  h.SetRealSrc (nodeList.front ());
+  h.SetRealDst (nodeList.back ());
+  h.SetTargetDst (nodeList[1]);
+  h.SetOriginalSender (nodeList[2]);
+  h.SetNodesAddress (nodeList);
+  h.SetCompact (true);
+  h.SetAckIds (ids);
+  NS_TEST_EXPECT_MSG_EQ (h.GetSerializedSize (), 8 + 6 + 12, "Bitmap batch section is 6 bytes");
+  Ptr<Packet> p = Create<Packet> ();
+  p->AddHeader (h);
+  dsr::DsrOptionAckHeader h2;
+  NS_TEST_EXPECT_MSG_EQ (p->RemoveHeader (h2), 26, "trivial");
+  NS_TEST_EXPECT_MSG_EQ (h2.GetAckFlag (), 1, "Flag without the batch bit");
+  NS_TEST_EXPECT_MSG_EQ (h2.GetAckIds ().size (), 4, "trivial");
+  NS_TEST_EXPECT_MSG_EQ (h2.GetAckIds ()[0], 65530, "trivial");
+  NS_TEST_EXPECT_MSG_EQ (h2.GetAckIds ()[2], 2, "Bitmap wraps around the 16 bit ids");
+  NS_TEST_EXPECT_MSG_EQ (h2.GetAckIds ()[3], 25, "trivial");
+  NS_TEST_EXPECT_MSG_EQ (h2.GetNodesAddresses ().size (), 3, "Node list after the batch section");
+
+  // far apart ids go as a list
+  ids.push_back (4000);
+  h.SetAckIds (ids);
+  NS_TEST_EXPECT_MSG_EQ (h.GetSerializedSize (), 8 + 2 + 8 + 12, "List batch section is 2 + 2n bytes");
+  p = Create<Packet> ();
+  p->AddHeader (h);
+  dsr::DsrOptionAckHeader h3;
+  NS_TEST_EXPECT_MSG_EQ (p->RemoveHeader (h3), 30, "trivial");
+  NS_TEST_EXPECT_MSG_EQ (h3.GetAckIds ().size (), 5, "trivial");
+  NS_TEST_EXPECT_MSG_EQ (h3.GetAckIds ()[4], 4000, "trivial");
+  NS_TEST_EXPECT_MSG_EQ (h3.GetRealDst (), nodeList.back (), "trivial");
+
+  dsr::DsrAckBatcher batcher;
+  batcher.SetFlushCallback (MakeCallback (&DsrAckBatchTest::Flush, this));
+  batcher.SetHoldoff (MilliSeconds (10));
+  batcher.SetMaxIds (3);
+  dsr::DsrAckBatchKey key;
+  key.m_realSrc = nodeList.front ();
+  key.m_realDst = nodeList.back ();
+  key.m_nextHop = nodeList[1];
+  key.m_targetDst = nodeList[1];
+  key.m_realSender = nodeList[2];
+  key.m_flag = 1;
+  dsr::DsrAckBatchKey twoHop = key;
+  twoHop.m_flag = 2;
+  twoHop.m_targetDst = nodeList[0];
+
+  batcher.Add (key, std::vector<uint16_t> (1, 1), 17, 0, nodeList);
+  batcher.Add (twoHop, std::vector<uint16_t> (1, 1), 17, 0, nodeList);
+  batcher.Add (key, std::vector<uint16_t> (1, 2), 17, 0, nodeList);
+  batcher.Add (key, std::vector<uint16_t> (1, 2), 17, 0, nodeList);
+  NS_TEST_EXPECT_MSG_EQ (batcher.GetSize (), 2, "One batch per key");
+  batcher.Add (key, std::vector<uint16_t> (1, 3), 17, 0, nodeList);
+  NS_TEST_EXPECT_MSG_EQ (flushed.size (), 1, "A full batch goes out at once");
+  NS_TEST_EXPECT_MSG_EQ (flushed[0].size (), 3, "Duplicates are not counted twice");
+  batcher.Add (key, std::vector<uint16_t> (1, 4), 17, 0, nodeList);
+  std::vector<Ipv4Address> newRoute = nodeList;
+  newRoute.insert (newRoute.begin () + 1, Ipv4Address ("1.1.1.9"));
+  batcher.Add (key, std::vector<uint16_t> (1, 5), 17, 0, newRoute);
+  NS_TEST_EXPECT_MSG_EQ (flushed.size (), 2, "A new route flushes the pending ack");
+  NS_TEST_EXPECT_MSG_EQ (flushed[1][0], 4, "trivial");
+
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  NS_TEST_EXPECT_MSG_EQ (flushed.size (), 4, "The rest goes out after the holdoff");
+  NS_TEST_EXPECT_MSG_EQ (flushTimes[2], MilliSeconds (10), "trivial");
+  NS_TEST_EXPECT_MSG_EQ (flushTimes[3], MilliSeconds (10), "trivial");
+  NS_TEST_EXPECT_MSG_EQ (batcher.GetSize (), 0, "trivial");
+  NS_TEST_EXPECT_MSG_EQ (batcher.GetCoalesced (), 2, "Ids 2 and 3 rode on the ack of 1");
 }
 // -----------------------------------------------------------------------------
 // / Unit test for DSR route cache entry
@@ -384,6 +647,143 @@ DsrCacheEntryTest::DoRun ()
   NS_TEST_EXPECT_MSG_EQ (rcache->DeleteRoute (Ipv4Address ("1.1.1.1")), false, "trivial");
 }
 // -----------------------------------------------------------------------------
+// / Unit test for the DSR link cache shortest path tree
+class DsrLinkCacheTest : public TestCase
+{
+public:
+  DsrLinkCacheTest ();
+  ~DsrLinkCacheTest ();
+  virtual void
+  DoRun (void);
+};
+DsrLinkCacheTest::DsrLinkCacheTest ()
+  : TestCase ("DSR LinkCache")
+{
+}
+DsrLinkCacheTest::~DsrLinkCacheTest ()
+{
+}
+void
+DsrLinkCacheTest::DoRun ()
+{
+  Ptr<dsr::DsrRouteCache> rcache = CreateObject<dsr::DsrRouteCache> ();
+  rcache->SetCacheType ("LinkCache");
+  rcache->SetInitStability (Seconds (25));
+  rcache->SetMinLifeTime (Seconds (1));
+  rcache->SetUseExtends (Seconds (1));
+  rcache->SetCacheTimeout (Seconds (300));
+
+  Ipv4Address a ("10.1.1.1");
+  Ipv4Address b ("10.1.1.2");
+  Ipv4Address c ("10.1.1.3");
+  Ipv4Address d ("10.1.1.4");
+  Ipv4Address e ("10.1.1.5");
+  std::vector<Ipv4Address> longRoute;
+  longRoute.push_back (a);
+  longRoute.push_back (b);
+  longRoute.push_back (c);
+  longRoute.push_back (d);
+  rcache->AddRoute_Link (longRoute, a);
+
+  dsr::DsrRouteCacheEntry entry;
+  NS_TEST_EXPECT_MSG_EQ (rcache->LookupRoute (d, entry), true, "trivial");
+  NS_TEST_EXPECT_MSG_EQ (entry.GetVector ().size (), 4, "trivial");
+  NS_TEST_EXPECT_MSG_EQ (rcache->LookupRoute (c, entry), true, "trivial");
+  NS_TEST_EXPECT_MSG_EQ (entry.GetVector ().size (), 3, "trivial");
+  NS_TEST_EXPECT_MSG_EQ (rcache->LookupRoute (e, entry), false, "trivial");
+
+  // A shortcut to d is picked up by the incremental update
+  std::vector<Ipv4Address> shortRoute;
+  shortRoute.push_back (a);
+  shortRoute.push_back (e);
+  shortRoute.push_back (d);
+  rcache->AddRoute_Link (shortRoute, a);
+  NS_TEST_EXPECT_MSG_EQ (rcache->LookupRoute (d, entry), true, "trivial");
+  NS_TEST_EXPECT_MSG_EQ (entry.GetVector ().size (), 3, "Shortcut not used");
+  NS_TEST_EXPECT_MSG_EQ (entry.GetVector ()[1], e, "Shortcut not used");
+
+  // Breaking the shortcut falls back to the longer route
+  rcache->DeleteAllRoutesIncludeLink (e, d, a);
+  NS_TEST_EXPECT_MSG_EQ (rcache->LookupRoute (d, entry), true, "trivial");
+  NS_TEST_EXPECT_MSG_EQ (entry.GetVector ().size (), 4, "Broken link still used");
+  NS_TEST_EXPECT_MSG_EQ (rcache->LookupRoute (e, entry), true, "trivial");
+  NS_TEST_EXPECT_MSG_EQ (entry.GetVector ().size (), 2, "trivial");
+
+  // Breaking the only route leaves d unreachable
+  rcache->DeleteAllRoutesIncludeLink (b, c, a);
+  NS_TEST_EXPECT_MSG_EQ (rcache->LookupRoute (d, entry), false, "trivial");
+  NS_TEST_EXPECT_MSG_EQ (rcache->LookupRoute (b, entry), true, "trivial");
+}
+// -----------------------------------------------------------------------------
+// / Unit test for sub routes through intermediate hops of the path cache
+class DsrPathCacheTest : public TestCase
+{
+public:
+  DsrPathCacheTest ();
+  ~DsrPathCacheTest ();
+  virtual void
+  DoRun (void);
+  void CheckExpired (Ptr<dsr::DsrRouteCache> rcache, Ipv4Address hop);
+};
+DsrPathCacheTest::DsrPathCacheTest ()
+  : TestCase ("DSR PathCache")
+{
+}
+DsrPathCacheTest::~DsrPathCacheTest ()
+{
+}
+void
+DsrPathCacheTest::DoRun ()
+{
+  Ptr<dsr::DsrRouteCache> rcache = CreateObject<dsr::DsrRouteCache> ();
+  rcache->SetCacheType ("PathCache");
+  rcache->SetMaxEntriesEachDst (3);
+
+  Ipv4Address a ("10.1.1.1");
+  Ipv4Address b ("10.1.1.2");
+  Ipv4Address c ("10.1.1.3");
+  Ipv4Address d ("10.1.1.4");
+  std::vector<Ipv4Address> ip;
+  ip.push_back (a);
+  ip.push_back (b);
+  ip.push_back (c);
+  ip.push_back (d);
+  dsr::DsrRouteCacheEntry entry (ip, d, Seconds (10));
+  NS_TEST_EXPECT_MSG_EQ (rcache->AddRoute (entry), true, "trivial");
+
+  dsr::DsrRouteCacheEntry const * view = rcache->LookupRouteEntry (d);
+  NS_TEST_EXPECT_MSG_EQ ((view != 0), true, "trivial");
+  NS_TEST_EXPECT_MSG_EQ (view->PeekVector ().size (), 4, "trivial");
+
+  // c is only reachable through the route to d
+  view = rcache->LookupRouteEntry (c);
+  NS_TEST_EXPECT_MSG_EQ ((view != 0), true, "Sub route not found");
+  NS_TEST_EXPECT_MSG_EQ (view->PeekVector ().size (), 3, "trivial");
+  NS_TEST_EXPECT_MSG_EQ (view->PeekVector ().back (), c, "trivial");
+  NS_TEST_EXPECT_MSG_EQ (view->GetDestination (), c, "trivial");
+
+  // Neither the source nor an unknown address give a sub route
+  NS_TEST_EXPECT_MSG_EQ ((rcache->LookupRouteEntry (a) == 0), true, "trivial");
+  NS_TEST_EXPECT_MSG_EQ ((rcache->LookupRouteEntry (Ipv4Address ("10.1.1.9")) == 0), true, "trivial");
+
+  // Once the routes through b are gone it is no longer found
+  NS_TEST_EXPECT_MSG_EQ (rcache->DeleteRoute (d), true, "trivial");
+  NS_TEST_EXPECT_MSG_EQ (rcache->DeleteRoute (c), true, "trivial");
+  NS_TEST_EXPECT_MSG_EQ ((rcache->LookupRouteEntry (b) == 0), true, "Deleted route still indexed");
+
+  // Expired routes are not used for sub routes
+  dsr::DsrRouteCacheEntry shortLived (ip, d, Seconds (1));
+  NS_TEST_EXPECT_MSG_EQ (rcache->AddRoute (shortLived), true, "trivial");
+  Simulator::Schedule (Seconds (2), &DsrPathCacheTest::CheckExpired, this, rcache, b);
+  Simulator::Run ();
+  Simulator::Destroy ();
+}
+void
+DsrPathCacheTest::CheckExpired (Ptr<dsr::DsrRouteCache> rcache, Ipv4Address hop)
+{
+  NS_TEST_EXPECT_MSG_EQ ((rcache->LookupRouteEntry (hop) == 0), true, "Expired route used for a sub route");
+}
+// -----------------------------------------------------------------------------
 // / Unit test for Send Buffer
 class DsrSendBuffTest : public TestCase
 {
@@ -446,6 +846,24 @@ DsrSendBuffTest::DoRun ()
   q.DropPacketWithDst (Ipv4Address ("0.0.0.4"));
   NS_TEST_EXPECT_MSG_EQ (q.GetSize (), 2, "trivial");
 
+  Ipv4Address dst5 = Ipv4Address ("0.0.0.5");
+  Ptr<Packet> packet5 = Create<Packet> ();
+  Ptr<Packet> packet6 = Create<Packet> ();
+  dsr::DsrSendBuffEntry e5 (packet5, dst5, Seconds (1));
+  dsr::DsrSendBuffEntry e6 (packet6, dst5, Seconds (1));
+  q.Enqueue (e5);
+  q.Enqueue (e6);
+  std::vector<Ipv4Address> destinations;
+  q.GetDestinations (destinations);
+  NS_TEST_EXPECT_MSG_EQ (destinations.size (), 3, "one bucket per destination");
+  std::vector<dsr::DsrSendBuffEntry> drained;
+  NS_TEST_EXPECT_MSG_EQ (q.Drain (dst5, drained), 2, "all packets for the destination");
+  NS_TEST_EXPECT_MSG_EQ (drained.front ().GetPacket ()->GetUid (), packet5->GetUid (), "earliest first");
+  NS_TEST_EXPECT_MSG_EQ (drained.back ().GetPacket ()->GetUid (), packet6->GetUid (), "earliest first");
+  NS_TEST_EXPECT_MSG_EQ (q.Find (dst5), false, "trivial");
+  NS_TEST_EXPECT_MSG_EQ (q.Drain (dst5, drained), 0, "trivial");
+  NS_TEST_EXPECT_MSG_EQ (q.GetSize (), 2, "trivial");
+
   CheckSizeLimit ();
 
   Simulator::Schedule (q.GetSendBufferTimeout () + Seconds (1), &DsrSendBuffTest::CheckTimeout, this);
@@ -478,6 +896,221 @@ DsrSendBuffTest::CheckTimeout ()
   NS_TEST_EXPECT_MSG_EQ (q.GetSize (), 0, "Must be empty now");
 }
 // -----------------------------------------------------------------------------
+// / Stress test for the maintain buffer of a relay with thousands of packets in flight
+class DsrMaintainBuffStressTest : public TestCase
+{
+public:
+  DsrMaintainBuffStressTest ();
+  ~DsrMaintainBuffStressTest ();
+  virtual void
+  DoRun (void);
+  /// Build the entry of the n-th packet sent
+  dsr::DsrMaintainBuffEntry MakeEntry (uint32_t n) const;
+
+  static const uint32_t HOPS = 8;
+  static const uint32_t FLOWS = 50;
+  static const uint32_t PACKETS = 4000;
+};
+const uint32_t DsrMaintainBuffStressTest::HOPS;
+const uint32_t DsrMaintainBuffStressTest::FLOWS;
+const uint32_t DsrMaintainBuffStressTest::PACKETS;
+DsrMaintainBuffStressTest::DsrMaintainBuffStressTest ()
+  : TestCase ("DSR MaintainBuffStress")
+{
+}
+DsrMaintainBuffStressTest::~DsrMaintainBuffStressTest ()
+{
+}
+dsr::DsrMaintainBuffEntry
+DsrMaintainBuffStressTest::MakeEntry (uint32_t n) const
+{
+  uint32_t flow = n % FLOWS;
+  return dsr::DsrMaintainBuffEntry (Create<Packet> (), Ipv4Address ("10.1.1.1"), Ipv4Address (0x0a010200 + flow % HOPS),
+                                    Ipv4Address (0x0a010300 + flow), Ipv4Address (0x0a010400 + flow), n / FLOWS, 2);
+}
+void
+DsrMaintainBuffStressTest::DoRun ()
+{
+  dsr::DsrMaintainBuffer buffer;
+  buffer.SetMaxQueueLen (PACKETS);
+  buffer.SetMaintainBufferTimeout (Seconds (30));
+
+  uint32_t enqueued = 0;
+  for (uint32_t n = 0; n < PACKETS; ++n)
+    {
+      dsr::DsrMaintainBuffEntry entry = MakeEntry (n);
+      enqueued += buffer.Enqueue (entry);
+    }
+  NS_TEST_EXPECT_MSG_EQ (enqueued, PACKETS, "trivial");
+  dsr::DsrMaintainBuffEntry duplicate = MakeEntry (PACKETS / 2);
+  NS_TEST_EXPECT_MSG_EQ (buffer.Enqueue (duplicate), false, "Duplicate entry enqueued");
+  NS_TEST_EXPECT_MSG_EQ (buffer.GetSize (), PACKETS, "trivial");
+
+  // Network acks for half of the packets, promiscuous acks for a quarter
+  uint32_t acked = 0;
+  for (uint32_t n = 0; n < PACKETS; n += 2)
+    {
+      dsr::DsrMaintainBuffEntry entry = MakeEntry (n);
+      acked += buffer.NetworkEqual (entry);
+    }
+  for (uint32_t n = 1; n < PACKETS; n += 4)
+    {
+      dsr::DsrMaintainBuffEntry entry = MakeEntry (n);
+      acked += buffer.PromiscEqual (entry);
+    }
+  NS_TEST_EXPECT_MSG_EQ (acked, PACKETS / 2 + PACKETS / 4, "Ack not matched");
+  NS_TEST_EXPECT_MSG_EQ (buffer.GetSize (), PACKETS / 4, "trivial");
+  dsr::DsrMaintainBuffEntry gone = MakeEntry (0);
+  NS_TEST_EXPECT_MSG_EQ (buffer.NetworkEqual (gone), false, "Acked entry still held");
+
+  // Packet 3 is the oldest one left for its next hop, a link ack takes the next one of its flow
+  dsr::DsrMaintainBuffEntry oldest;
+  dsr::DsrMaintainBuffEntry probe = MakeEntry (3);
+  NS_TEST_EXPECT_MSG_EQ (buffer.Dequeue (probe.GetNextHop (), oldest), true, "trivial");
+  NS_TEST_EXPECT_MSG_EQ (oldest.GetSrc (), probe.GetSrc (), "Not the oldest entry");
+  NS_TEST_EXPECT_MSG_EQ (oldest.GetAckId (), 0, "Not the oldest entry");
+  NS_TEST_EXPECT_MSG_EQ (buffer.LinkEqual (probe), true, "trivial");
+  NS_TEST_EXPECT_MSG_EQ (buffer.GetSize (), PACKETS / 4 - 2, "trivial");
+
+  uint32_t left = 0;
+  for (uint32_t n = 3; n < PACKETS; n += 4)
+    {
+      left += MakeEntry (n).GetNextHop () == probe.GetNextHop ();
+    }
+  buffer.DropPacketWithNextHop (probe.GetNextHop ());
+  NS_TEST_EXPECT_MSG_EQ (buffer.Find (probe.GetNextHop ()), false, "trivial");
+  NS_TEST_EXPECT_MSG_EQ (buffer.GetSize (), PACKETS / 4 - left, "trivial");
+}
+// -----------------------------------------------------------------------------
+// / Unit test for the expiry index of the DSR buffers
+class DsrExpiryIndexTest : public TestCase
+{
+public:
+  DsrExpiryIndexTest ();
+  ~DsrExpiryIndexTest ();
+  virtual void
+  DoRun (void);
+  void CheckDue ();
+  dsr::DsrExpiryIndex index;
+};
+DsrExpiryIndexTest::DsrExpiryIndexTest ()
+  : TestCase ("DSR ExpiryIndex")
+{
+}
+DsrExpiryIndexTest::~DsrExpiryIndexTest ()
+{
+}
+void
+DsrExpiryIndexTest::DoRun ()
+{
+  NS_TEST_EXPECT_MSG_EQ (index.Insert (Seconds (3)), 0, "trivial");
+  NS_TEST_EXPECT_MSG_EQ (index.Insert (Seconds (1)), 1, "trivial");
+  NS_TEST_EXPECT_MSG_EQ (index.Insert (Seconds (2)), 2, "trivial");
+  NS_TEST_EXPECT_MSG_EQ (index.IsDue (), false, "trivial");
+
+  Simulator::Schedule (Seconds (2.5), &DsrExpiryIndexTest::CheckDue, this);
+  Simulator::Run ();
+  Simulator::Destroy ();
+}
+void
+DsrExpiryIndexTest::CheckDue ()
+{
+  uint64_t sequence;
+  NS_TEST_EXPECT_MSG_EQ (index.IsDue (), true, "trivial");
+  NS_TEST_EXPECT_MSG_EQ (index.PopDue (sequence), true, "trivial");
+  NS_TEST_EXPECT_MSG_EQ (sequence, 1, "Earliest entry not first");
+  NS_TEST_EXPECT_MSG_EQ (index.PopDue (sequence), true, "trivial");
+  NS_TEST_EXPECT_MSG_EQ (sequence, 2, "trivial");
+  NS_TEST_EXPECT_MSG_EQ (index.PopDue (sequence), false, "Entry due before its time");
+  NS_TEST_EXPECT_MSG_EQ (index.GetSize (), 1, "trivial");
+}
+// -----------------------------------------------------------------------------
+// / Unit test for the shared retransmission timers
+class DsrRetransTimerTest : public TestCase
+{
+public:
+  DsrRetransTimerTest ();
+  ~DsrRetransTimerTest ();
+  virtual void
+  DoRun (void);
+  void Expire (dsr::DsrMaintainBuffEntry & mb, uint8_t protocol);
+  static dsr::LinkKey MakeKey (uint32_t dst, uint32_t nextHop);
+  static dsr::DsrMaintainBuffEntry MakeEntry (dsr::LinkKey const & key);
+
+  dsr::DsrRetransTimer<dsr::LinkKey, dsr::LinkKeyHash> timer;
+  std::vector<Ipv4Address> expired;
+  std::vector<Time> expireTimes;
+};
+DsrRetransTimerTest::DsrRetransTimerTest ()
+  : TestCase ("DSR RetransTimer")
+{
+}
+DsrRetransTimerTest::~DsrRetransTimerTest ()
+{
+}
+dsr::LinkKey
+DsrRetransTimerTest::MakeKey (uint32_t dst, uint32_t nextHop)
+{
+  dsr::LinkKey key;
+  key.m_source = Ipv4Address ("10.0.0.1");
+  key.m_destination = Ipv4Address (0x0a000000 + dst);
+  key.m_ourAdd = Ipv4Address ("10.0.0.1");
+  key.m_nextHop = Ipv4Address (0x0a000000 + nextHop);
+  return key;
+}
+dsr::DsrMaintainBuffEntry
+DsrRetransTimerTest::MakeEntry (dsr::LinkKey const & key)
+{
+  return dsr::DsrMaintainBuffEntry (Create<Packet> (), key.m_ourAdd, key.m_nextHop, key.m_source,
+                                    key.m_destination, 0, 1, Seconds (10));
+}
+void
+DsrRetransTimerTest::Expire (dsr::DsrMaintainBuffEntry & mb, uint8_t protocol)
+{
+  NS_TEST_EXPECT_MSG_EQ ((uint32_t)protocol, 17, "trivial");
+  expired.push_back (mb.GetDst ());
+  expireTimes.push_back (Simulator::Now ());
+}
+void
+DsrRetransTimerTest::DoRun ()
+{
+  timer.SetFunction (MakeCallback (&DsrRetransTimerTest::Expire, this));
+  dsr::LinkKey k1 = MakeKey (1, 100);
+  dsr::LinkKey k2 = MakeKey (2, 100);
+  dsr::LinkKey k3 = MakeKey (3, 200);
+
+  timer.SetRetries (k1, 2);
+  timer.Schedule (k1, Seconds (1), MakeEntry (k1), 17);
+  timer.Schedule (k2, Seconds (2), MakeEntry (k2), 17);
+  timer.Schedule (k3, Seconds (1.5), MakeEntry (k3), 17);
+  NS_TEST_EXPECT_MSG_EQ (timer.GetSize (), 3, "trivial");
+  NS_TEST_EXPECT_MSG_EQ (timer.GetRetries (k1), 2, "Arming a timer keeps the retries");
+
+  timer.SetRetries (k3, 1);
+  timer.Cancel (k3);
+  NS_TEST_EXPECT_MSG_EQ (timer.IsRunning (k3), false, "trivial");
+  NS_TEST_EXPECT_MSG_EQ (timer.GetRetries (k3), 0, "Cancel forgets the retries");
+
+  timer.Shift (k1.m_nextHop, Seconds (1));
+  NS_TEST_EXPECT_MSG_EQ (timer.GetDelayLeft (k1), Seconds (2), "Shift the timers of the next hop");
+  NS_TEST_EXPECT_MSG_EQ (timer.GetDelayLeft (k2), Seconds (3), "Shift the timers of the next hop");
+  timer.Schedule (k3, Seconds (2.5), MakeEntry (k3), 17);
+  timer.Schedule (k2, Seconds (2.8), MakeEntry (k2), 17);
+
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  NS_TEST_EXPECT_MSG_EQ (expired.size (), 3, "Every timer fires once");
+  NS_TEST_EXPECT_MSG_EQ (expired[0], k1.m_destination, "trivial");
+  NS_TEST_EXPECT_MSG_EQ (expireTimes[0], Seconds (2), "trivial");
+  NS_TEST_EXPECT_MSG_EQ (expired[1], k3.m_destination, "trivial");
+  NS_TEST_EXPECT_MSG_EQ (expireTimes[1], Seconds (2.5), "trivial");
+  NS_TEST_EXPECT_MSG_EQ (expired[2], k2.m_destination, "Rescheduling replaces the timer");
+  NS_TEST_EXPECT_MSG_EQ (expireTimes[2], Seconds (2.8), "trivial");
+  NS_TEST_EXPECT_MSG_EQ (timer.GetSize (), 0, "trivial");
+  NS_TEST_EXPECT_MSG_EQ (timer.GetRetries (k1), 2, "The retries outlive the timer");
+}
+// -----------------------------------------------------------------------------
 // / Unit test for DSR routing table entry
 class DsrRreqTableTest : public TestCase
 {
@@ -503,19 +1136,707 @@ DsrRreqTableTest::DoRun ()
   NS_TEST_EXPECT_MSG_EQ (rt.m_reqNo, 2, "trivial");
 }
 // -----------------------------------------------------------------------------
+// / Unit test for the node directory
+class DsrNodeDirectoryTest : public TestCase
+{
+public:
+  DsrNodeDirectoryTest ();
+  ~DsrNodeDirectoryTest ();
+  virtual void
+  DoRun (void);
+};
+DsrNodeDirectoryTest::DsrNodeDirectoryTest ()
+  : TestCase ("DSR NodeDirectory")
+{
+}
+DsrNodeDirectoryTest::~DsrNodeDirectoryTest ()
+{
+}
+void
+DsrNodeDirectoryTest::DoRun ()
+{
+  NodeContainer nodes;
+  nodes.Create (3);
+  InternetStackHelper internet;
+  internet.Install (nodes);
+  SimpleNetDeviceHelper simple;
+  NetDeviceContainer devices = simple.Install (nodes);
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("10.1.1.0", "255.255.255.0");
+  Ipv4InterfaceContainer interfaces = ipv4.Assign (devices);
+
+  Ptr<dsr::DsrNodeDirectory> directory = dsr::DsrNodeDirectory::Get ();
+  uint32_t id2 = nodes.Get (2)->GetId ();
+  NS_TEST_EXPECT_MSG_EQ (directory->GetIdFromIp (interfaces.GetAddress (1)), nodes.Get (1)->GetId (), "trivial");
+  NS_TEST_EXPECT_MSG_EQ (directory->GetIpFromId (id2), interfaces.GetAddress (2), "trivial");
+  NS_TEST_EXPECT_MSG_EQ (directory->GetIpFromMac (Mac48Address::ConvertFrom (devices.Get (0)->GetAddress ())),
+                         interfaces.GetAddress (0), "trivial");
+  NS_TEST_EXPECT_MSG_EQ (directory->GetNodeWithAddress (interfaces.GetAddress (2)), nodes.Get (2), "trivial");
+  NS_TEST_EXPECT_MSG_EQ (directory->GetIdFromIp (Ipv4Address ("10.1.2.1")), dsr::DsrNodeDirectory::NOT_FOUND, "trivial");
+
+  uint32_t rebuilds = directory->GetRebuildCount ();
+  for (uint32_t i = 0; i < 100; ++i)
+    {
+      directory->GetIdFromIp (interfaces.GetAddress (i % 3));
+    }
+  NS_TEST_EXPECT_MSG_EQ (directory->GetRebuildCount (), rebuilds, "Hits must not rescan the NodeList");
+
+  // Renumber node 2, the stale entry has to be noticed
+  Ptr<Ipv4> ip = nodes.Get (2)->GetObject<Ipv4> ();
+  int32_t ifIndex = ip->GetInterfaceForDevice (devices.Get (2));
+  ip->RemoveAddress (ifIndex, 0);
+  ip->AddAddress (ifIndex, Ipv4InterfaceAddress (Ipv4Address ("10.1.1.100"), Ipv4Mask ("255.255.255.0")));
+  NS_TEST_EXPECT_MSG_EQ (directory->GetIpFromId (id2), Ipv4Address ("10.1.1.100"), "Address change not noticed");
+  NS_TEST_EXPECT_MSG_EQ (directory->GetIdFromIp (Ipv4Address ("10.1.1.100")), id2, "trivial");
+  NS_TEST_EXPECT_MSG_EQ (directory->GetIdFromIp (interfaces.GetAddress (2)), dsr::DsrNodeDirectory::NOT_FOUND, "trivial");
+  NS_TEST_EXPECT_MSG_EQ (directory->GetNodeWithAddress (interfaces.GetAddress (2)), Ptr<Node> (), "trivial");
+
+  Simulator::Destroy ();
+}
+// -----------------------------------------------------------------------------
+// / Unit test for the adversary model
+class DsrAdversaryTest : public TestCase
+{
+public:
+  DsrAdversaryTest ();
+  ~DsrAdversaryTest ();
+  virtual void
+  DoRun (void);
+  void CheckWindow (bool active);
+
+  Ptr<dsr::DsrAdversary> adversary;
+};
+DsrAdversaryTest::DsrAdversaryTest ()
+  : TestCase ("DSR Adversary")
+{
+}
+DsrAdversaryTest::~DsrAdversaryTest ()
+{
+}
+void
+DsrAdversaryTest::CheckWindow (bool active)
+{
+  NS_TEST_EXPECT_MSG_EQ (adversary->IsActive (12), active, "Attack window at " << Simulator::Now ().GetSeconds ());
+  NS_TEST_EXPECT_MSG_EQ (adversary->ForgesReplies (12), active, "trivial");
+  NS_TEST_EXPECT_MSG_EQ (adversary->DropsData (12, 1, 2), active, "trivial");
+}
+void
+DsrAdversaryTest::DoRun ()
+{
+  adversary = CreateObject<dsr::DsrAdversary> ();
+  NS_TEST_EXPECT_MSG_EQ (adversary->GetAttackerNodes (), "12,18", "The old SDSR blackholes by default");
+  adversary->SetAttribute ("AttackerNodes", StringValue (""));
+  NS_TEST_EXPECT_MSG_EQ (adversary->IsConfigured (), false, "No attackers");
+  NS_TEST_EXPECT_MSG_EQ (adversary->DropsData (12, 1, 2), false, "trivial");
+  NS_TEST_EXPECT_MSG_EQ (adversary->AssignStreams (7), 1, "The first node sharing the adversary assigns its stream");
+  NS_TEST_EXPECT_MSG_EQ (adversary->AssignStreams (9), 0, "The others do not");
+
+  adversary->SetAttribute ("AttackerNodes", StringValue ("18, 12,30-32"));
+  NS_TEST_EXPECT_MSG_EQ (adversary->GetAttackerNodes (), "12,18,30,31,32", "Ids and ranges");
+  NS_TEST_EXPECT_MSG_EQ (adversary->IsConfigured (), true, "trivial");
+  NS_TEST_EXPECT_MSG_EQ (adversary->IsAttacker (31), true, "trivial");
+  NS_TEST_EXPECT_MSG_EQ (adversary->IsAttacker (13), false, "trivial");
+
+  adversary->SetAttribute ("AttackType", EnumValue (dsr::DsrAdversary::GRAYHOLE));
+  adversary->SetAttribute ("DropProbability", DoubleValue (0.0));
+  NS_TEST_EXPECT_MSG_EQ (adversary->ForgesReplies (12), true, "A grayhole forges replies");
+  NS_TEST_EXPECT_MSG_EQ (adversary->DropsData (12, 1, 2), false, "trivial");
+  adversary->SetAttribute ("DropProbability", DoubleValue (1.0));
+  NS_TEST_EXPECT_MSG_EQ (adversary->DropsData (12, 1, 2), true, "trivial");
+  NS_TEST_EXPECT_MSG_EQ (adversary->DropsData (13, 1, 2), false, "Only attackers drop");
+
+  adversary->SetAttribute ("AttackType", EnumValue (dsr::DsrAdversary::SELECTIVE_FORWARDING));
+  adversary->SetAttribute ("SelectiveTargets", StringValue ("2"));
+  NS_TEST_EXPECT_MSG_EQ (adversary->ForgesReplies (12), false, "A selective forwarder routes honestly");
+  NS_TEST_EXPECT_MSG_EQ (adversary->DropsData (12, 1, 2), true, "Flows to a target are dropped");
+  NS_TEST_EXPECT_MSG_EQ (adversary->DropsData (12, 2, 3), true, "Flows from a target are dropped");
+  NS_TEST_EXPECT_MSG_EQ (adversary->DropsData (12, 1, 3), false, "Other flows are forwarded");
+
+  adversary->SetAttribute ("AttackType", EnumValue (dsr::DsrAdversary::BLACKHOLE));
+  adversary->SetAttribute ("StartTime", TimeValue (Seconds (10)));
+  adversary->SetAttribute ("StopTime", TimeValue (Seconds (20)));
+  Simulator::Schedule (Seconds (5), &DsrAdversaryTest::CheckWindow, this, false);
+  Simulator::Schedule (Seconds (10), &DsrAdversaryTest::CheckWindow, this, true);
+  Simulator::Schedule (Seconds (19), &DsrAdversaryTest::CheckWindow, this, true);
+  Simulator::Schedule (Seconds (20), &DsrAdversaryTest::CheckWindow, this, false);
+  Simulator::Run ();
+  Simulator::Destroy ();
+}
+// -----------------------------------------------------------------------------
+// / Unit test for the blacklist
+class DsrBlackListTest : public TestCase
+{
+public:
+  DsrBlackListTest ();
+  ~DsrBlackListTest ();
+  virtual void
+  DoRun (void);
+  void Changed (Ipv4Address address, bool isAdded);
+  void CheckListed (Ipv4Address address, bool listed);
+
+  dsr::DsrBlackList blackList;
+  std::vector<Ipv4Address> changes;
+  std::vector<bool> added;
+};
+DsrBlackListTest::DsrBlackListTest ()
+  : TestCase ("DSR BlackList")
+{
+}
+DsrBlackListTest::~DsrBlackListTest ()
+{
+}
+void
+DsrBlackListTest::Changed (Ipv4Address address, bool isAdded)
+{
+  changes.push_back (address);
+  added.push_back (isAdded);
+}
+void
+DsrBlackListTest::CheckListed (Ipv4Address address, bool listed)
+{
+  NS_TEST_EXPECT_MSG_EQ (blackList.Contains (address), listed, address << " at " << Simulator::Now ().GetSeconds ());
+}
+void
+DsrBlackListTest::DoRun ()
+{
+  Ipv4Address a ("1.1.1.1");
+  Ipv4Address b ("1.1.1.2");
+  blackList.SetChangeCallback (MakeCallback (&DsrBlackListTest::Changed, this));
+  blackList.SetTimeout (Seconds (10));
+  blackList.SetMaxTimeout (Seconds (30));
+
+  blackList.Add (a);
+  // Three strikes would be 40 seconds, capped at 30
+  blackList.Add (b);
+  blackList.Add (b);
+  blackList.Add (b);
+  NS_TEST_EXPECT_MSG_EQ (blackList.GetSize (), 2, "trivial");
+  NS_TEST_EXPECT_MSG_EQ (blackList.GetStrikes (b), 3, "trivial");
+  NS_TEST_EXPECT_MSG_EQ (changes.size (), 2, "Only new nodes are reported");
+
+  std::vector<Ipv4Address> route;
+  route.push_back (Ipv4Address ("1.1.1.0"));
+  route.push_back (Ipv4Address ("1.1.1.3"));
+  NS_TEST_EXPECT_MSG_EQ (blackList.ContainsAny (route), false, "trivial");
+  route.push_back (a);
+  NS_TEST_EXPECT_MSG_EQ (blackList.ContainsAny (route), true, "trivial");
+
+  // A second strike at 5 seconds keeps a listed until 25 seconds
+  Simulator::Schedule (Seconds (5), &dsr::DsrBlackList::Add, &blackList, a);
+  Simulator::Schedule (Seconds (24), &DsrBlackListTest::CheckListed, this, a, true);
+  Simulator::Schedule (Seconds (25), &DsrBlackListTest::CheckListed, this, a, false);
+  Simulator::Schedule (Seconds (29), &DsrBlackListTest::CheckListed, this, b, true);
+  Simulator::Schedule (Seconds (30), &DsrBlackListTest::CheckListed, this, b, false);
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  NS_TEST_EXPECT_MSG_EQ (blackList.GetSize (), 0, "Expired nodes are dropped");
+  NS_TEST_EXPECT_MSG_EQ (changes.size (), 4, "trivial");
+  NS_TEST_EXPECT_MSG_EQ (changes[2], a, "trivial");
+  NS_TEST_EXPECT_MSG_EQ (added[2], false, "trivial");
+  NS_TEST_EXPECT_MSG_EQ (changes[3], b, "trivial");
+
+  blackList.SetTimeout (Seconds (0));
+  blackList.Add (a);
+  NS_TEST_EXPECT_MSG_EQ (blackList.Remove (a), true, "trivial");
+  NS_TEST_EXPECT_MSG_EQ (blackList.Contains (a), false, "trivial");
+}
+// -----------------------------------------------------------------------------
+// / Unit test for the trust weighted route selection
+class DsrRouteTrustTest : public TestCase
+{
+public:
+  DsrRouteTrustTest ();
+  ~DsrRouteTrustTest ();
+  virtual void
+  DoRun (void);
+};
+DsrRouteTrustTest::DsrRouteTrustTest ()
+  : TestCase ("DSR RouteTrust")
+{
+}
+DsrRouteTrustTest::~DsrRouteTrustTest ()
+{
+}
+void
+DsrRouteTrustTest::DoRun ()
+{
+  dsr::DsrNodeTrust trust;
+  NS_TEST_EXPECT_MSG_EQ (trust.GetTrust (), 1, "A node starts trusted");
+  trust.Update (true, 0.9);
+  NS_TEST_EXPECT_MSG_EQ (trust.GetTrust (), 1, "Deliveries alone keep the trust");
+  trust.Update (false, 0.5);
+  NS_TEST_EXPECT_MSG_EQ_TOL (trust.GetTrust (), 0.6, 1e-9, "(0.5 + 1) / (0.5 + 1 + 1)");
+
+  Ipv4Address a ("10.1.1.1");
+  Ipv4Address b ("10.1.1.2");
+  Ipv4Address c ("10.1.1.3");
+  Ipv4Address d ("10.1.1.4");
+  Ipv4Address e ("10.1.1.5");
+  std::vector<Ipv4Address> shortRoute;
+  shortRoute.push_back (a);
+  shortRoute.push_back (b);
+  shortRoute.push_back (d);
+  std::vector<Ipv4Address> longRoute;
+  longRoute.push_back (a);
+  longRoute.push_back (c);
+  longRoute.push_back (e);
+  longRoute.push_back (d);
+
+  // The link cache avoids a distrusted relay even for a longer route
+  Ptr<dsr::DsrRouteCache> rcache = CreateObject<dsr::DsrRouteCache> ();
+  rcache->SetCacheType ("LinkCache");
+  rcache->SetInitStability (Seconds (25));
+  rcache->SetMinLifeTime (Seconds (1));
+  rcache->SetUseExtends (Seconds (1));
+  rcache->SetCacheTimeout (Seconds (300));
+  rcache->SetTrustDecay (0.9);
+  rcache->SetTrustPenalty (4);
+  rcache->AddRoute_Link (shortRoute, a);
+  rcache->AddRoute_Link (longRoute, a);
+
+  dsr::DsrRouteCacheEntry entry;
+  NS_TEST_EXPECT_MSG_EQ (rcache->LookupRoute (d, entry), true, "trivial");
+  NS_TEST_EXPECT_MSG_EQ (entry.GetVector ()[1], b, "The shortest route first");
+  rcache->UpdateTrust (b, false);
+  NS_TEST_EXPECT_MSG_EQ (rcache->GetTrust (b), 0.5, "trivial");
+  NS_TEST_EXPECT_MSG_EQ (rcache->GetRoutePenalty (shortRoute), 2, "trivial");
+  NS_TEST_EXPECT_MSG_EQ (rcache->LookupRoute (d, entry), true, "trivial");
+  NS_TEST_EXPECT_MSG_EQ (entry.GetVector ()[1], c, "Distrusted relay still used");
+  // The relay earns its trust back with deliveries
+  for (uint32_t i = 0; i < 5; ++i)
+    {
+      rcache->UpdateTrust (b, true);
+    }
+  NS_TEST_EXPECT_MSG_EQ (rcache->LookupRoute (d, entry), true, "trivial");
+  NS_TEST_EXPECT_MSG_EQ (entry.GetVector ()[1], b, "Trust not restored");
+
+  // The path cache puts the routes through a distrusted relay last
+  Ptr<dsr::DsrRouteCache> pcache = CreateObject<dsr::DsrRouteCache> ();
+  pcache->SetCacheType ("PathCache");
+  pcache->SetMaxEntriesEachDst (3);
+  pcache->SetTrustPenalty (4);
+  dsr::DsrRouteCacheEntry shortEntry (shortRoute, d, Seconds (20));
+  dsr::DsrRouteCacheEntry longEntry (longRoute, d, Seconds (10));
+  NS_TEST_EXPECT_MSG_EQ (pcache->AddRoute (shortEntry), true, "trivial");
+  NS_TEST_EXPECT_MSG_EQ (pcache->AddRoute (longEntry), true, "trivial");
+  NS_TEST_EXPECT_MSG_EQ (pcache->LookupRoute (d, entry), true, "trivial");
+  NS_TEST_EXPECT_MSG_EQ (entry.GetVector ()[1], b, "The longest living route first");
+  pcache->UpdateTrust (b, false);
+  NS_TEST_EXPECT_MSG_EQ (pcache->LookupRoute (d, entry), true, "trivial");
+  NS_TEST_EXPECT_MSG_EQ (entry.GetVector ()[1], c, "Distrusted relay still used");
+  Simulator::Destroy ();
+}
+// -----------------------------------------------------------------------------
+// / Unit test for the two hop ack correlation
+class DsrAckCorrelationTest : public TestCase
+{
+public:
+  DsrAckCorrelationTest ();
+  ~DsrAckCorrelationTest ();
+  virtual void
+  DoRun (void);
+  void Complete (uint32_t ackId, std::vector<Ipv4Address> const & route, std::vector<Ipv4Address> const & missing);
+  void Incomplete (uint32_t ackId, std::vector<Ipv4Address> const & route, std::vector<Ipv4Address> const & missing);
+
+  std::vector<uint32_t> completed;
+  std::vector<uint32_t> incompleted;
+  std::vector<Ipv4Address> lastMissing;
+  Time incompleteTime;
+};
+DsrAckCorrelationTest::DsrAckCorrelationTest ()
+  : TestCase ("DSR ACK correlation")
+{
+}
+DsrAckCorrelationTest::~DsrAckCorrelationTest ()
+{
+}
+void
+DsrAckCorrelationTest::Complete (uint32_t ackId, std::vector<Ipv4Address> const & route, std::vector<Ipv4Address> const & missing)
+{
+  NS_TEST_EXPECT_MSG_EQ (route.size (), 5, "trivial");
+  NS_TEST_EXPECT_MSG_EQ (missing.size (), 0, "trivial");
+  completed.push_back (ackId);
+}
+void
+DsrAckCorrelationTest::Incomplete (uint32_t ackId, std::vector<Ipv4Address> const & route, std::vector<Ipv4Address> const & missing)
+{
+  incompleted.push_back (ackId);
+  lastMissing = missing;
+  incompleteTime = Simulator::Now ();
+}
+void
+DsrAckCorrelationTest::DoRun ()
+{
+  std::vector<Ipv4Address> route;
+  route.push_back (Ipv4Address ("1.1.1.0"));
+  route.push_back (Ipv4Address ("1.1.1.1"));
+  route.push_back (Ipv4Address ("1.1.1.2"));
+  route.push_back (Ipv4Address ("1.1.1.3"));
+  route.push_back (Ipv4Address ("1.1.1.4"));
+  Ipv4Address source = route.front ();
+
+  dsr::DsrAckCorrelation table;
+  table.SetCompleteCallback (MakeCallback (&DsrAckCorrelationTest::Complete, this));
+  table.SetIncompleteCallback (MakeCallback (&DsrAckCorrelationTest::Incomplete, this));
+  table.SetTimeout (Seconds (2));
+  NS_TEST_EXPECT_MSG_EQ (table.Expect (source, 1, std::vector<Ipv4Address> (route.begin (), route.begin () + 2)),
+                         false, "Neighbours send no two hop acks");
+
+  // Every node two or more hops down the route acks
+  NS_TEST_EXPECT_MSG_EQ (table.Expect (source, 0x1fffe, route), true, "trivial");
+  NS_TEST_EXPECT_MSG_EQ (table.Extend (source, 0xfffe), 0x1fffe, "trivial");
+  NS_TEST_EXPECT_MSG_EQ (table.Extend (source, 0x0001), 0x20001, "The id wraps forward");
+  NS_TEST_EXPECT_MSG_EQ (table.Acknowledge (source, 0x1fffe, route[2]), true, "trivial");
+  NS_TEST_EXPECT_MSG_EQ (table.Acknowledge (source, 0x1fffe, route[4]), true, "trivial");
+  NS_TEST_EXPECT_MSG_EQ (completed.size (), 0, "A node did not ack yet");
+  NS_TEST_EXPECT_MSG_EQ (table.Acknowledge (source, 0x1fffe, route[3]), true, "trivial");
+  NS_TEST_EXPECT_MSG_EQ (completed.size (), 1, "trivial");
+  NS_TEST_EXPECT_MSG_EQ (completed[0], 0x1fffe, "trivial");
+  NS_TEST_EXPECT_MSG_EQ (table.GetSize (), 0, "trivial");
+  NS_TEST_EXPECT_MSG_EQ (table.Acknowledge (source, 0x1fffe, route[3]), false, "Late ack of a finished set");
+
+  // Past the wrap the old id is still told apart
+  NS_TEST_EXPECT_MSG_EQ (table.Expect (source, 0x20001, route), true, "trivial");
+  NS_TEST_EXPECT_MSG_EQ (table.Extend (source, 0xfffe), 0x1fffe, "The id wraps backward");
+  NS_TEST_EXPECT_MSG_EQ (table.Acknowledge (source, table.Extend (source, 0x0001), route[2]), true, "trivial");
+  Simulator::Run ();
+  NS_TEST_EXPECT_MSG_EQ (incompleted.size (), 1, "trivial");
+  NS_TEST_EXPECT_MSG_EQ (incompleted[0], 0x20001, "trivial");
+  NS_TEST_EXPECT_MSG_EQ (incompleteTime, Seconds (2), "trivial");
+  NS_TEST_EXPECT_MSG_EQ (lastMissing.size (), 2, "trivial");
+  NS_TEST_EXPECT_MSG_EQ (lastMissing[0], route[3], "Missing nodes in route order");
+
+  // The table drops the oldest packets when it is full
+  table.SetMaxEntries (2);
+  table.Expect (source, 10, route);
+  table.Expect (source, 11, route);
+  table.Expect (source, 12, route);
+  NS_TEST_EXPECT_MSG_EQ (table.GetSize (), 2, "trivial");
+  NS_TEST_EXPECT_MSG_EQ (table.GetEvicted (), 1, "trivial");
+  NS_TEST_EXPECT_MSG_EQ (table.Acknowledge (source, 10, route[2]), false, "Evicted packet still waited for");
+  table.Clear ();
+  Simulator::Destroy ();
+}
+// -----------------------------------------------------------------------------
+// / Unit test for patching the source route of a data packet in place
+class DsrSRHeaderPatchTest : public TestCase
+{
+public:
+  DsrSRHeaderPatchTest ();
+  ~DsrSRHeaderPatchTest ();
+  virtual void
+  DoRun (void);
+};
+DsrSRHeaderPatchTest::DsrSRHeaderPatchTest ()
+  : TestCase ("DSR SR header patch")
+{
+}
+DsrSRHeaderPatchTest::~DsrSRHeaderPatchTest ()
+{
+}
+void
+DsrSRHeaderPatchTest::DoRun ()
+{
+  std::vector<Ipv4Address> nodeList;
+  nodeList.push_back (Ipv4Address ("1.1.1.0"));
+  nodeList.push_back (Ipv4Address ("1.1.1.1"));
+  nodeList.push_back (Ipv4Address ("1.1.1.2"));
+
+  for (uint32_t wide = 0; wide < 2; ++wide)
+    {
+      dsr::DsrOptionSRHeader sr;
+      sr.SetNodesAddress (nodeList);
+      sr.SetSalvage (1);
+      sr.SetSegmentsLeft (1);
+      sr.SetAckFlag (3);
+      sr.SetSendCout (5);
+      sr.SetTime (1234);
+      dsr::DsrRoutingHeader header;
+      header.SetWideIds (wide == 1);
+      header.SetNextHeader (17);
+      header.SetMessageType (2);
+      header.SetSourceId (1);
+      header.SetDestId (2);
+      header.SetPayloadLength (sr.GetLength () + 2);
+      header.AddDsrOption (sr);
+      Ptr<Packet> p = Create<Packet> (100);
+      p->AddHeader (header);
+      uint32_t size = p->GetSize ();
+
+      dsr::DsrSRHeaderPatch patch;
+      NS_TEST_EXPECT_MSG_EQ (p->RemoveHeader (patch), (wide ? 12 : 8) + 15, "Only the fixed fields are taken");
+      NS_TEST_EXPECT_MSG_EQ (patch.GetAckFlag (), 3, "trivial");
+      NS_TEST_EXPECT_MSG_EQ (patch.GetSendCount (), 5, "trivial");
+      NS_TEST_EXPECT_MSG_EQ (patch.GetNumberAddress (), 3, "trivial");
+      patch.SetAckFlag (2);
+      patch.SetSendCount (0x1234);
+      patch.SetSegmentsLeft (0);
+      patch.SetSalvage (2);
+      p->AddHeader (patch);
+      NS_TEST_EXPECT_MSG_EQ (p->GetSize (), size, "trivial");
+
+      // A full decode sees the patched fields and the route untouched
+      dsr::DsrRoutingHeader header2;
+      p->PeekHeader (header2);
+      NS_TEST_EXPECT_MSG_EQ (header2.GetSourceId (), 1, "trivial");
+      NS_TEST_EXPECT_MSG_EQ (header2.GetDestId (), 2, "trivial");
+      p->RemoveAtStart (header2.GetDsrOptionsOffset ());
+      dsr::DsrOptionSRHeader sr2;
+      sr2.SetNumberAddress (3);
+      p->RemoveHeader (sr2);
+      NS_TEST_EXPECT_MSG_EQ ((uint32_t)sr2.GetAckFlag (), 2, "trivial");
+      NS_TEST_EXPECT_MSG_EQ (sr2.GetSendCout (), 0x1234, "trivial");
+      NS_TEST_EXPECT_MSG_EQ ((uint32_t)sr2.GetSegmentsLeft (), 0, "trivial");
+      NS_TEST_EXPECT_MSG_EQ ((uint32_t)sr2.GetSalvage (), 2, "trivial");
+      NS_TEST_EXPECT_MSG_EQ (sr2.GetTime (), 1234, "trivial");
+      NS_TEST_EXPECT_MSG_EQ (sr2.GetNodeAddress (2), nodeList[2], "trivial");
+    }
+}
+// -----------------------------------------------------------------------------
+// / Unit test for the adaptive ack policy
+class DsrAckPolicyTest : public TestCase
+{
+public:
+  DsrAckPolicyTest ();
+  ~DsrAckPolicyTest ();
+  virtual void
+  DoRun (void);
+  void CheckAckFlag (uint8_t ackFlag);
+
+  Ptr<dsr::DsrAdaptiveAckPolicy> policy;
+  std::vector<Ipv4Address> route;
+};
+DsrAckPolicyTest::DsrAckPolicyTest ()
+  : TestCase ("DSR AckPolicy")
+{
+}
+DsrAckPolicyTest::~DsrAckPolicyTest ()
+{
+}
+void
+DsrAckPolicyTest::CheckAckFlag (uint8_t ackFlag)
+{
+  NS_TEST_EXPECT_MSG_EQ ((uint32_t)policy->SelectAckFlag (route.back (), route, 0), (uint32_t)ackFlag,
+                         "at " << Simulator::Now ().GetSeconds ());
+}
+void
+DsrAckPolicyTest::DoRun ()
+{
+  policy = CreateObject<dsr::DsrAdaptiveAckPolicy> ();
+  Ipv4Address dst ("1.1.1.3");
+  route.push_back (Ipv4Address ("1.1.1.0"));
+  route.push_back (dst);
+  // A single hop has nothing to escalate to
+  NS_TEST_EXPECT_MSG_EQ ((uint32_t)policy->SelectAckFlag (dst, route, 8), 3, "trivial");
+  route.insert (route.begin () + 1, Ipv4Address ("1.1.1.1"));
+  route.insert (route.begin () + 2, Ipv4Address ("1.1.1.2"));
+
+  NS_TEST_EXPECT_MSG_EQ ((uint32_t)policy->SelectAckFlag (dst, route, 0), 3, "A clean path uses end to end acks");
+  NS_TEST_EXPECT_MSG_EQ ((uint32_t)policy->SelectAckFlag (dst, route, 2), 2, "A relay lost trust");
+  NS_TEST_EXPECT_MSG_EQ ((uint32_t)policy->SelectAckFlag (dst, route, 0), 3, "Trust came back");
+
+  // One loss lifts the average to 0.25, above EscalateLoss
+  policy->NotifyLost (dst);
+  NS_TEST_EXPECT_MSG_EQ_TOL (policy->GetLoss (dst), 0.25, 1e-9, "trivial");
+  NS_TEST_EXPECT_MSG_EQ ((uint32_t)policy->SelectAckFlag (dst, route, 0), 2, "A lossy path uses two hop acks");
+  // It takes six deliveries to get below RelaxLoss
+  for (uint32_t i = 0; i < 5; ++i)
+    {
+      policy->NotifyDelivered (dst);
+    }
+  NS_TEST_EXPECT_MSG_EQ ((uint32_t)policy->SelectAckFlag (dst, route, 0), 2, "Between the thresholds the mode stays");
+  policy->NotifyDelivered (dst);
+  NS_TEST_EXPECT_MSG_EQ ((uint32_t)policy->SelectAckFlag (dst, route, 0), 3, "trivial");
+  NS_TEST_EXPECT_MSG_EQ ((uint32_t)policy->GetAckFlag (Ipv4Address ("1.1.1.9")), 3, "trivial");
+
+  // A blamed relay keeps two hop acks on for the SuspicionHold of 10 seconds
+  Simulator::Schedule (Seconds (1), &dsr::DsrAckPolicy::NotifySuspect, policy, dst, Ipv4Address ("1.1.1.2"));
+  Simulator::Schedule (Seconds (10), &DsrAckPolicyTest::CheckAckFlag, this, 2);
+  Simulator::Schedule (Seconds (11), &DsrAckPolicyTest::CheckAckFlag, this, 3);
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  Ptr<dsr::DsrFixedAckPolicy> fixed = CreateObject<dsr::DsrFixedAckPolicy> ();
+  fixed->NotifyLost (dst);
+  NS_TEST_EXPECT_MSG_EQ ((uint32_t)fixed->SelectAckFlag (dst, route, 8), 3, "trivial");
+}
+// -----------------------------------------------------------------------------
+// / Unit test for the route reply verifier
+class DsrRrepVerifierTest : public TestCase
+{
+public:
+  DsrRrepVerifierTest ();
+  ~DsrRrepVerifierTest ();
+  virtual void
+  DoRun (void);
+};
+DsrRrepVerifierTest::DsrRrepVerifierTest ()
+  : TestCase ("DSR RrepVerifier")
+{
+}
+DsrRrepVerifierTest::~DsrRrepVerifierTest ()
+{
+}
+void
+DsrRrepVerifierTest::DoRun ()
+{
+  Ipv4Address s ("10.1.1.1");
+  Ipv4Address a ("10.1.1.2");
+  Ipv4Address b ("10.1.1.3");
+  Ipv4Address c ("10.1.2.2");   // same low byte as a
+  Ipv4Address d ("10.1.1.9");
+  std::vector<Ipv4Address> route;
+  route.push_back (s);
+  route.push_back (a);
+  route.push_back (b);
+  route.push_back (a);
+  route.push_back (c);
+  route.push_back (d);
+  dsr::DsrOptionRrepHeader h;
+  h.SetNodesAddress (route);
+  h.SetAck (1);
+  Ptr<Packet> p = Create<Packet> (8);
+  p->AddHeader (h);
+
+  dsr::DsrBlackList blackList;
+  blackList.Add (b);
+  dsr::DsrRrepVerifier rrep;
+  NS_TEST_EXPECT_MSG_EQ (rrep.Verify (p, s, &blackList), h.GetSerializedSize (), "trivial");
+  NS_TEST_EXPECT_MSG_EQ (rrep.IsForUs (), true, "trivial");
+  NS_TEST_EXPECT_MSG_EQ ((uint32_t)rrep.GetBlackFlag (), 1, "trivial");
+  // The loop through b is cut, c only shares the low byte of a
+  std::vector<Ipv4Address> cut = rrep.GetRoute ();
+  NS_TEST_EXPECT_MSG_EQ (cut.size (), 4, "trivial");
+  NS_TEST_EXPECT_MSG_EQ (cut[1], a, "trivial");
+  NS_TEST_EXPECT_MSG_EQ (cut[2], c, "trivial");
+  NS_TEST_EXPECT_MSG_EQ (rrep.IsBlackListed (), false, "A suspect on a cut loop is not on the route");
+  std::vector<Ipv4Address> removed = route;
+  dsr::DsrRrepVerifier::RemoveDuplicates (removed);
+  NS_TEST_EXPECT_MSG_EQ ((removed == cut), true, "trivial");
+
+  blackList.Add (d);
+  rrep.Verify (p, s, &blackList);
+  NS_TEST_EXPECT_MSG_EQ (rrep.IsBlackListed (), true, "trivial");
+  NS_TEST_EXPECT_MSG_EQ (rrep.Verify (p, s, 0), h.GetSerializedSize (), "trivial");
+  NS_TEST_EXPECT_MSG_EQ (rrep.IsBlackListed (), false, "No blacklist, no suspects");
+
+  // An intermediate node sends the reply on as it came
+  NS_TEST_EXPECT_MSG_EQ (rrep.Verify (p, b, &blackList), h.GetSerializedSize (), "trivial");
+  NS_TEST_EXPECT_MSG_EQ (rrep.IsForUs (), false, "trivial");
+  NS_TEST_EXPECT_MSG_EQ (rrep.IsBlackListed (), false, "trivial");
+  NS_TEST_EXPECT_MSG_EQ ((rrep.GetRoute () == route), true, "trivial");
+  dsr::DsrOptionRrepHeader forward = rrep.GetHeader ();
+  NS_TEST_EXPECT_MSG_EQ (forward.GetSerializedSize (), h.GetSerializedSize (), "trivial");
+  NS_TEST_EXPECT_MSG_EQ ((uint32_t)forward.GetAck (), 1, "trivial");
+
+  Ptr<Packet> shortPacket = Create<Packet> ();
+  route.resize (1);
+  h.SetNodesAddress (route);
+  shortPacket->AddHeader (h);
+  NS_TEST_EXPECT_MSG_EQ (rrep.Verify (shortPacket, s, &blackList), 0, "A reply needs two addresses");
+}
+// -----------------------------------------------------------------------------
+// / Unit test for the detection statistics
+class DsrDetectionStatsTest : public TestCase
+{
+public:
+  DsrDetectionStatsTest ();
+  ~DsrDetectionStatsTest ();
+  virtual void
+  DoRun (void);
+};
+DsrDetectionStatsTest::DsrDetectionStatsTest ()
+  : TestCase ("DSR DetectionStats")
+{
+}
+DsrDetectionStatsTest::~DsrDetectionStatsTest ()
+{
+}
+void
+DsrDetectionStatsTest::DoRun ()
+{
+  DsrDetectionStats stats;
+  NS_TEST_EXPECT_MSG_EQ (std::isnan (stats.GetPrecision ()), true, "Nothing detected");
+  NS_TEST_EXPECT_MSG_EQ (std::isnan (stats.GetRecall ()), true, "No attackers");
+
+  stats.SetAttackStart (Seconds (10));
+  stats.AddAttacker (3);
+  stats.AddAttacker (5);
+  stats.AddAttacker (7);
+  stats.AddAttacker (9);
+  stats.NotifyBlackListed (1, 3, Seconds (14));
+  // Only the first detection of a node counts
+  stats.NotifyBlackListed (2, 3, Seconds (30));
+  stats.NotifyBlackListed (2, 5, Seconds (20));
+  stats.NotifyBlackListed (4, 6, Seconds (25));
+  NS_TEST_EXPECT_MSG_EQ (stats.GetBlackListEvents (), 4, "trivial");
+  NS_TEST_EXPECT_MSG_EQ (stats.GetDetectedCount (), 3, "trivial");
+  NS_TEST_EXPECT_MSG_EQ (stats.GetTruePositives (), 2, "trivial");
+  NS_TEST_EXPECT_MSG_EQ (stats.GetFalsePositives (), 1, "trivial");
+  NS_TEST_EXPECT_MSG_EQ_TOL (stats.GetPrecision (), 2.0 / 3, 1e-9, "trivial");
+  NS_TEST_EXPECT_MSG_EQ_TOL (stats.GetRecall (), 0.5, 1e-9, "trivial");
+  NS_TEST_EXPECT_MSG_EQ (stats.GetMeanTimeToDetect (), Seconds (7), "(4 + 10) / 2");
+  NS_TEST_EXPECT_MSG_EQ (stats.GetMaxTimeToDetect (), Seconds (10), "trivial");
+
+  stats.NotifyControlTx (DsrOptionRreq::OPT_NUMBER, 40);
+  stats.NotifyControlTx (DsrOptionRreq::OPT_NUMBER, 44);
+  stats.NotifyControlTx (DsrOptionAck::OPT_NUMBER, 16);
+  NS_TEST_EXPECT_MSG_EQ (stats.GetControlPackets (), 3, "trivial");
+  NS_TEST_EXPECT_MSG_EQ (stats.GetControlBytes (), 100, "trivial");
+  NS_TEST_EXPECT_MSG_EQ (stats.GetControlBytes (DsrOptionRreq::OPT_NUMBER), 84, "trivial");
+  NS_TEST_EXPECT_MSG_EQ (stats.GetControlBytes (DsrOptionRrep::OPT_NUMBER), 0, "trivial");
+
+  std::ostringstream csv;
+  DsrDetectionStats::WriteCsvHeaderFields (csv);
+  csv << "\n";
+  stats.WriteCsvFields (csv);
+  NS_TEST_EXPECT_MSG_EQ (csv.str ().substr (csv.str ().find ('\n') + 1, 14), "4,3,2,1,0.6666", "trivial");
+
+  stats.Reset ();
+  NS_TEST_EXPECT_MSG_EQ (stats.GetControlBytes (), 0, "trivial");
+  std::ostringstream json;
+  stats.WriteJsonFields (json);
+  NS_TEST_EXPECT_MSG_EQ (json.str ().find ("\"precision\": null") != std::string::npos, true, "NaN is null");
+
+  // A suspicion raised before the attack starts counts as immediate
+  stats.SetAttackStart (Seconds (10));
+  stats.AddAttacker (3);
+  stats.NotifyBlackListed (1, 3, Seconds (4));
+  NS_TEST_EXPECT_MSG_EQ (stats.GetMeanTimeToDetect (), Seconds (0), "trivial");
+  NS_TEST_EXPECT_MSG_EQ (stats.GetMaxTimeToDetect (), Seconds (0), "trivial");
+}
+// -----------------------------------------------------------------------------
 class DsrTestSuite : public TestSuite
 {
 public:
   DsrTestSuite () : TestSuite ("routing-dsr", UNIT)
   {
     AddTestCase (new DsrFsHeaderTest, TestCase::QUICK);
+    AddTestCase (new DsrFsHeaderNodeIdTest, TestCase::QUICK);
     AddTestCase (new DsrRreqHeaderTest, TestCase::QUICK);
     AddTestCase (new DsrRrepHeaderTest, TestCase::QUICK);
     AddTestCase (new DsrSRHeaderTest, TestCase::QUICK);
     AddTestCase (new DsrRerrHeaderTest, TestCase::QUICK);
     AddTestCase (new DsrAckReqHeaderTest, TestCase::QUICK);
     AddTestCase (new DsrAckHeaderTest, TestCase::QUICK);
+    AddTestCase (new DsrAckCompactHeaderTest, TestCase::QUICK);
+    AddTestCase (new DsrAckBatchTest, TestCase::QUICK);
     AddTestCase (new DsrCacheEntryTest, TestCase::QUICK);
+    AddTestCase (new DsrLinkCacheTest, TestCase::QUICK);
+    AddTestCase (new DsrPathCacheTest, TestCase::QUICK);
     AddTestCase (new DsrSendBuffTest, TestCase::QUICK);
+    AddTestCase (new DsrExpiryIndexTest, TestCase::QUICK);
+    AddTestCase (new DsrMaintainBuffStressTest, TestCase::QUICK);
+    AddTestCase (new DsrRetransTimerTest, TestCase::QUICK);
+    AddTestCase (new DsrNodeDirectoryTest, TestCase::QUICK);
+    AddTestCase (new DsrAdversaryTest, TestCase::QUICK);
+    AddTestCase (new DsrBlackListTest, TestCase::QUICK);
+    AddTestCase (new DsrRouteTrustTest, TestCase::QUICK);
+    AddTestCase (new DsrAckCorrelationTest, TestCase::QUICK);
+    AddTestCase (new DsrSRHeaderPatchTest, TestCase::QUICK);
+    AddTestCase (new DsrAckPolicyTest, TestCase::QUICK);
+    AddTestCase (new DsrRrepVerifierTest, TestCase::QUICK);
+    AddTestCase (new DsrDetectionStatsTest, TestCase::QUICK);
   }
 } g_dsrTestSuite;
@@ -4,6 +4,8 @@
 #include <sstream>
 #include <vector>
 #include <dirent.h>//DIR*
+#include <ctime>
+#include <cstdlib>
 
 #include "simisso.h"
 
@@ -21,6 +23,13 @@ VanetSim::VanetSim()
 	txp = 20;  // dBm
 	
 	mod = 0;
+	ackHoldoff = 0;
+#ifdef SIMISSO_DETECTION_STATS
+	detectionStats = "";
+#endif
+	traceCache = true;
+	traceModel = true;
+	waypointWindow = 64;
 	duration = 0;
 	nodeNum = 0;//cars
 	m_sinks=10;
@@ -79,6 +88,15 @@ void VanetSim::ParseArguments(int argc, char *argv[])
 	cmd.AddValue ("folder", "Working Directory", folder);
 	cmd.AddValue ("txp", "TX power", txp);
 	cmd.AddValue ("mod", "0=aodv 1=olsr 2=dsdv 3=dsr", mod);
+	cmd.AddValue ("ackHoldoff", "DSR ack coalescing window in ms, 0=one ack per packet", ackHoldoff);
+	cmd.AddValue ("attackers", "DSR attacker node ids, e.g. 5,7 or 10-14, default 5,7 for DSR and 12,18 for SDSR", MakeCallback (&VanetSim::SetAttackers, this));
+	cmd.AddValue ("attackType", "0=none 1=blackhole 2=grayhole 3=selective forwarding, default 1", MakeCallback (&VanetSim::SetAttackType, this));
+	cmd.AddValue ("traceCache", "Map the sumo inputs from input.trace.bin, rebuilt when the xml files change", traceCache);
+	cmd.AddValue ("traceModel", "Move the cars with SumoTraceMobilityModel, 0=WaypointMobilityModel", traceModel);
+	cmd.AddValue ("waypointWindow", "Waypoints queued per car with --traceModel=0, refilled as it moves on, 0=the whole trace at start", waypointWindow);
+#ifdef SIMISSO_DETECTION_STATS
+	cmd.AddValue ("detectionStats", "DSR detection statistics file, one JSON line per run is appended", detectionStats);
+#endif
 
 	//cmd.AddValue ("ds", "DataSet", m_ds);
 	cmd.Parse (argc,argv);
@@ -89,6 +107,18 @@ void VanetSim::ParseArguments(int argc, char *argv[])
 
 }
 
+bool VanetSim::SetAttackers(std::string nodes)
+{
+	Config::SetDefault ("ns3::dsr::DsrAdversary::AttackerNodes", StringValue (nodes));
+	return true;
+}
+
+bool VanetSim::SetAttackType(std::string type)
+{
+	Config::SetDefault ("ns3::dsr::DsrAdversary::AttackType", EnumValue (atoi (type.c_str ())));
+	return true;
+}
+
 void VanetSim::LoadTraffic()
 {
 	switch (mod)
@@ -136,6 +166,11 @@ void VanetSim::LoadTraffic()
 
 	os.open(output.data(),std::ios::out);
 
+	if (traceCache)
+		Config::SetDefault ("ns3::vanetmobility::sumomobility::SumoMobility::TraceCache", StringValue (temp + "/input.trace.bin"));
+	Config::SetDefault ("ns3::vanetmobility::sumomobility::SumoMobility::TraceModel", BooleanValue (traceModel));
+	Config::SetDefault ("ns3::vanetmobility::sumomobility::SumoMobility::WaypointWindow", UintegerValue (waypointWindow));
+
 	ns3::vanetmobility::VANETmobilityHelper mobilityHelper;
 	VMo=mobilityHelper.GetSumoMObility(sumo_net,sumo_route,sumo_fcd);
 
@@ -245,8 +280,13 @@ void VanetSim::ConfigApp()
         break;
 
       case 3:
+        // only the SDSR module knows the attribute
+        Config::SetDefaultFailSafe ("ns3::dsr::DsrRouting::AckHoldoff", TimeValue (MilliSeconds (ackHoldoff)));
         internet.Install (m_nodes);
         dsrMain.Install (dsr, m_nodes);
+#ifdef SIMISSO_DETECTION_STATS
+        m_detectionStats.Install (m_nodes);
+#endif
         std::cout<<"DSR"<<std::endl;
         os<<"DSR"<<std::endl;
         break;
@@ -409,7 +449,29 @@ void VanetSim::Run()
 	std::cout << "Starting simulation for " << duration << " s ..."<< std::endl;
 	os << "Starting simulation for " << duration << " s ..."<< std::endl;
 	Simulator::Stop(Seconds(duration));
+	std::clock_t start = std::clock();
 	Simulator::Run();
+	double cpu = double(std::clock() - start) / CLOCKS_PER_SEC;
+	std::cout << "CPU time: " << cpu << " s (" << cpu / duration << " s per simulated second)" << std::endl;
+	os << "CPU time: " << cpu << " s (" << cpu / duration << " s per simulated second)" << std::endl;
+#ifdef SIMISSO_DETECTION_STATS
+	if (mod == 3 && !detectionStats.empty ())
+	{
+		// one line per run, so runs over several attacker sets can share the file
+		m_detectionStats.Finish ();
+		// the attack the nodes ran with, given on the command line or the tree's default
+		Ptr<dsr::DsrAdversary> adversary = CreateObject<dsr::DsrAdversary> ();
+		EnumValue attackType;
+		adversary->GetAttribute ("AttackType", attackType);
+		std::ofstream stats (detectionStats.c_str (), std::ios::app);
+		stats << "{\"scenario\": \"simisso\", \"nodes\": " << nodeNum
+		      << ", \"attacker_nodes\": \"" << adversary->GetAttackerNodes () << "\", \"attack_type\": " << attackType.Get ()
+		      << ", \"sent\": " << Tx1_Data_Pkts << ", \"received\": " << Rx1_Data_Pkts
+		      << ", \"cpu_s\": " << cpu << ", \"cpu_per_simulated_s\": " << cpu / duration << ", ";
+		m_detectionStats.WriteJsonFields (stats);
+		stats << "}" << std::endl;
+	}
+#endif
 	Simulator::Destroy();
 
 }
@@ -19,6 +19,11 @@
 #include "ns3/dsdv-module.h"
 #include "ns3/dsr-module.h"
 
+// Defined by the SDSR wscript, the DSR tree has no detection statistics helper
+#ifdef NS3_DSR_DETECTION_STATS
+#define SIMISSO_DETECTION_STATS
+#endif
+
 
 #include "ns3/vanetmobility-helper.h"
 
@@ -50,6 +55,8 @@ protected:
 	void ProcessOutputs();
 	bool CheckActive(Node node);
 	void Look_at_clock();
+	bool SetAttackers(std::string nodes);//--attackers, the tree's DsrAdversary default otherwise
+	bool SetAttackType(std::string type);//--attackType, likewise
 	
 private:
 	Ptr<Socket> source;
@@ -72,6 +79,14 @@ private:
 	
 	
 	int mod;//0=aodv 1=olsr 2=dsdv 3=dsr
+	double ackHoldoff;//ms dsr acks wait to be coalesced, 0=one ack per packet
+	bool traceCache;//keep a binary cache of the sumo inputs in the input folder
+	bool traceModel;//SumoTraceMobilityModel for the cars, WaypointMobilityModel otherwise
+	uint32_t waypointWindow;//waypoints queued per car with WaypointMobilityModel, 0=the whole trace at start
+#ifdef SIMISSO_DETECTION_STATS
+	std::string detectionStats;//file the dsr detection statistics are appended to, empty for none
+	DsrDetectionStats m_detectionStats;
+#endif
 
 	uint32_t nodeNum;
 	double duration;
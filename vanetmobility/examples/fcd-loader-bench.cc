@@ -0,0 +1,191 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+/*
+ * Throughput and peak memory of the SUMO FCD loader. Writes a synthetic
+ * route file and fcd file of the given size, unless --generate=0, then loads
+ * them either with VehicleLoader, which streams the fcd file, or with a
+ * tinyxml document as the loader did before, and reports MB/s, peak RSS and
+ * the bytes a sample takes once loaded: TraceStore columns for stream, one
+ * Trace per sample for dom. Run each mode in its own process, the peak RSS
+ * only grows.
+ *
+ * ./waf --run "fcd-loader-bench --vehicles=2000 --steps=3600 --mode=stream"
+ * ./waf --run "fcd-loader-bench --vehicles=2000 --steps=3600 --mode=dom --generate=0"
+ */
+
+#include "ns3/core-module.h"
+#include "ns3/RouteElement.h"
+
+#include <sys/resource.h>
+#include <sys/time.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+using namespace ns3;
+using namespace ns3::vanetmobility::sumomobility;
+
+static double
+WallSeconds (void)
+{
+  struct timeval tv;
+  gettimeofday (&tv, 0);
+  return tv.tv_sec + tv.tv_usec * 1e-6;
+}
+
+/// Peak resident set size of the process in MB
+static double
+PeakRssMb (void)
+{
+  struct rusage usage;
+  getrusage (RUSAGE_SELF, &usage);
+  return usage.ru_maxrss / 1024.0; // kB on Linux
+}
+
+static void
+Generate (std::string routeFile, std::string fcdFile, uint32_t vehicles, uint32_t steps)
+{
+  FILE *route = fopen (routeFile.c_str (), "w");
+  fprintf (route, "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<routes>\n");
+  for (uint32_t v = 0; v < vehicles; ++v)
+    {
+      fprintf (route, "    <vehicle id=\"%u\" depart=\"0.00\">\n        <route edges=\"e%u e%u\"/>\n    </vehicle>\n",
+               v, v, v + 1);
+    }
+  fprintf (route, "</routes>\n");
+  fclose (route);
+
+  FILE *fcd = fopen (fcdFile.c_str (), "w");
+  fprintf (fcd, "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<fcd-export>\n");
+  for (uint32_t t = 0; t < steps; ++t)
+    {
+      fprintf (fcd, "    <timestep time=\"%u.00\">\n", t);
+      for (uint32_t v = 0; v < vehicles; ++v)
+        {
+          fprintf (fcd, "        <vehicle id=\"%u\" x=\"%.2f\" y=\"%.2f\" angle=\"%.2f\" type=\"DEFAULT_VEHTYPE\""
+                   " speed=\"%.2f\" pos=\"%.2f\" lane=\"e%u_0\" slope=\"0.00\"/>\n",
+                   v, 100.0 + v + t * 13.89, 2000.0 - v * 0.5, 90.0, 13.89, t * 13.89, v);
+        }
+      fprintf (fcd, "    </timestep>\n");
+    }
+  fprintf (fcd, "</fcd-export>\n");
+  fclose (fcd);
+}
+
+/// The loader before the streaming reader: the whole document, then a recursive walk
+static uint64_t
+WalkDocument (TiXmlNode *node, std::vector<std::vector<Trace> > &traces, Trace &trace)
+{
+  uint64_t samples = 0;
+  TiXmlElement *element = node->ToElement ();
+  if (element && (0 == strcmp (element->Value (), "timestep") || 0 == strcmp (element->Value (), "vehicle")))
+    {
+      int vid = -1;
+      for (TiXmlAttribute *a = element->FirstAttribute (); a; a = a->Next ())
+        {
+          switch (getAttribuutID (a->Name ()))
+            {
+            case ATTR_ID: vid = atoi (a->Value ()); break;
+            case ATTR_TIME: trace.time = atof (a->Value ()); break;
+            case ATTR_X: trace.x = atof (a->Value ()); break;
+            case ATTR_Y: trace.y = atof (a->Value ()); break;
+            case ATTR_ANGLE: trace.angle = atof (a->Value ()); break;
+            case ATTR_SPEED: trace.speed = atof (a->Value ()); break;
+            case ATTR_POS: trace.pos = atof (a->Value ()); break;
+            case ATTR_SLOPE: trace.slope = atof (a->Value ()); break;
+            case ATTR_LANE: trace.lane = a->Value (); break;
+            case ATTR_TYPE: trace.type = a->Value (); break;
+            default: break;
+            }
+        }
+      if (0 == strcmp (element->Value (), "vehicle") && vid >= 0 && vid < (int)traces.size ())
+        {
+          traces[vid].push_back (trace);
+          ++samples;
+        }
+    }
+  for (TiXmlNode *child = node->FirstChild (); child; child = child->NextSibling ())
+    {
+      samples += WalkDocument (child, traces, trace);
+    }
+  return samples;
+}
+
+int
+main (int argc, char *argv[])
+{
+  uint32_t vehicles = 1000;
+  uint32_t steps = 1000;
+  std::string routeFile = "fcd-bench.rou.xml";
+  std::string fcdFile = "fcd-bench.fcd.xml";
+  std::string mode = "stream";
+  bool generate = true;
+
+  CommandLine cmd;
+  cmd.AddValue ("vehicles", "Vehicles in the synthetic trace", vehicles);
+  cmd.AddValue ("steps", "One second timesteps in the synthetic trace", steps);
+  cmd.AddValue ("route", "Route file", routeFile);
+  cmd.AddValue ("fcd", "FCD file", fcdFile);
+  cmd.AddValue ("generate", "Write the synthetic files first", generate);
+  cmd.AddValue ("mode", "stream: VehicleLoader, dom: tinyxml document", mode);
+  cmd.Parse (argc, argv);
+
+  if (generate)
+    {
+      Generate (routeFile, fcdFile, vehicles, steps);
+    }
+
+  VehicleLoader vl;
+  vl.LoadRouteXML (routeFile.c_str ());
+  double baseRss = PeakRssMb ();
+
+  uint64_t samples = 0;
+  uint64_t bytes = 0;
+  uint64_t storeBytes = 0;
+  double start = WallSeconds ();
+  if (mode == "dom")
+    {
+      TiXmlDocument doc (fcdFile.c_str ());
+      if (!doc.LoadFile ())
+        {
+          std::cerr << "Failed to load " << fcdFile << std::endl;
+          return 1;
+        }
+      std::vector<std::vector<Trace> > traces (vl.getTraces ().GetVehicleCount ());
+      Trace trace;
+      samples = WalkDocument (&doc, traces, trace);
+      for (std::vector<std::vector<Trace> >::const_iterator v = traces.begin (); v != traces.end (); ++v)
+        {
+          storeBytes += v->capacity () * sizeof (Trace);
+          for (std::vector<Trace>::const_iterator t = v->begin (); t != v->end (); ++t)
+            {
+              // what the strings hold beyond their small buffer
+              storeBytes += (t->lane.capacity () > 15 ? t->lane.capacity () + 1 : 0)
+                + (t->type.capacity () > 15 ? t->type.capacity () + 1 : 0);
+            }
+        }
+    }
+  else
+    {
+      vl.LoadFCDOutputXML (fcdFile.c_str ());
+      samples = vl.getTraces ().GetSampleCount ();
+      storeBytes = vl.getTraces ().GetMemoryUsage ();
+    }
+  double seconds = WallSeconds () - start;
+  FILE *fcd = fopen (fcdFile.c_str (), "rb");
+  if (fcd)
+    {
+      fseek (fcd, 0, SEEK_END);
+      bytes = ftell (fcd);
+      fclose (fcd);
+    }
+
+  double mb = bytes / (1024.0 * 1024.0);
+  std::cout << "mode\tfile MB\tsamples\tseconds\tMB/s\tpeak RSS MB\tpeak RSS over routes MB\tbytes/sample" << std::endl;
+  std::cout << mode << "\t" << mb << "\t" << samples << "\t" << seconds << "\t" << mb / seconds << "\t"
+            << PeakRssMb () << "\t" << PeakRssMb () - baseRss << "\t" << (samples ? storeBytes / (double)samples : 0)
+            << std::endl;
+  return 0;
+}
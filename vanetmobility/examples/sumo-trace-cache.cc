@@ -0,0 +1,94 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+/*
+ * Compile the SUMO inputs of a scenario into a binary trace cache, the file
+ * SumoMobility maps instead of parsing the xml when its TraceCache attribute
+ * names it. Reports how long the xml parse and the cache load take.
+ *
+ * ./waf --run "sumo-trace-cache --folder=SimMap --cache=SimMap/input.trace.bin"
+ */
+
+#include "ns3/core-module.h"
+#include "ns3/RouteElement.h"
+#include "ns3/TraceCache.h"
+
+#include <sys/time.h>
+#include <iostream>
+#include <vector>
+
+using namespace ns3;
+using namespace ns3::vanetmobility::sumomobility;
+
+static double
+WallSeconds (void)
+{
+  struct timeval tv;
+  gettimeofday (&tv, 0);
+  return tv.tv_sec + tv.tv_usec * 1e-6;
+}
+
+int
+main (int argc, char *argv[])
+{
+  std::string folder = "SimMap";
+  std::string cacheFile = "";
+
+  CommandLine cmd;
+  cmd.AddValue ("folder", "Folder holding input.net.xml, input.rou.xml and input.fcd.xml", folder);
+  cmd.AddValue ("cache", "Cache file, default <folder>/input.trace.bin", cacheFile);
+  cmd.Parse (argc, argv);
+
+  std::vector<std::string> sources;
+  sources.push_back (folder + "/input.net.xml");
+  sources.push_back (folder + "/input.rou.xml");
+  sources.push_back (folder + "/input.fcd.xml");
+  if (cacheFile.empty ())
+    {
+      cacheFile = folder + "/input.trace.bin";
+    }
+
+  double start = WallSeconds ();
+  uint64_t hash = TraceCache::HashSources (sources);
+  double hashTime = WallSeconds () - start;
+  if (!hash)
+    {
+      std::cerr << "Cannot read the xml files in " << folder << std::endl;
+      return 1;
+    }
+
+  start = WallSeconds ();
+  RoadMap roadmap;
+  VehicleLoader vl;
+  roadmap.LoadNetXMLFile (sources[0].c_str ());
+  vl.LoadRouteXML (sources[1].c_str ());
+  vl.LoadFCDOutputXML (sources[2].c_str ());
+  double parseTime = WallSeconds () - start;
+
+  if (!TraceCache::Write (cacheFile.c_str (), hash, roadmap, vl))
+    {
+      std::cerr << "Cannot write " << cacheFile << std::endl;
+      return 1;
+    }
+
+  start = WallSeconds ();
+  TraceCache *cache = new TraceCache ();
+  RoadMap cachedRoadmap;
+  VehicleLoader cachedVl;
+  if (cache->Open (cacheFile.c_str (), hash))
+    {
+      cachedRoadmap.LoadTraceCache (*cache);
+    }
+  if (!cachedVl.LoadTraceCache (cache))
+    {
+      std::cerr << "Cannot map " << cacheFile << std::endl;
+      return 1;
+    }
+  double loadTime = WallSeconds () - start;
+
+  const TraceStore &traces = cachedVl.getTraces ();
+  std::cout << cacheFile << ": " << traces.GetVehicleCount () << " vehicles, " << traces.GetSampleCount ()
+            << " samples, " << cachedRoadmap.getEdges ().size () << " lanes, " << traces.GetStringCount () << " strings" << std::endl;
+  std::cout << "hash of the xml files " << hashTime << " s, xml parse " << parseTime
+            << " s, cache load " << loadTime << " s" << std::endl;
+  return 0;
+}
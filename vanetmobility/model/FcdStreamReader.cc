@@ -0,0 +1,269 @@
+#include "ns3/FcdStreamReader.h"
+
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+
+namespace ns3
+{
+namespace vanetmobility
+{
+namespace sumomobility
+{
+
+using namespace std;
+
+FcdStreamReader::FcdStreamReader(uint32_t bufferSize):
+		m_file(NULL),m_buffer(bufferSize+1,'\0'),m_begin(0),m_end(0),m_name(0),m_attributes(0),
+		m_bytesRead(0),m_samples(0),m_vid(-1)
+{
+}
+
+FcdStreamReader::~FcdStreamReader()
+{
+	Close();
+}
+
+bool FcdStreamReader::Open(const char* pFilename)
+{
+	Close();
+	m_file = fopen(pFilename,"rb");
+	m_begin = m_end = 0;
+	m_buffer[0] = '\0';
+	m_bytesRead = m_samples = 0;
+	m_vid = -1;
+	m_trace = Trace();
+	return m_file != NULL;
+}
+
+void FcdStreamReader::Close()
+{
+	if (m_file)
+		fclose(m_file);
+	m_file = NULL;
+}
+
+bool FcdStreamReader::Next()
+{
+	while (NextStartTag())
+	{
+		const char* element = &m_buffer[m_name];
+		if (0==strcmp(element,"vehicle"))
+		{
+			m_vid = -1;
+			ReadAttributes();
+			m_samples++;
+			return true;
+		}
+		if (0==strcmp(element,"timestep"))
+			ReadAttributes();
+	}
+	return false;
+}
+
+bool FcdStreamReader::Fill()
+{
+	if (!m_file)
+		return false;
+	if (m_begin > 0)
+	{
+		memmove(&m_buffer[0],&m_buffer[m_begin],m_end-m_begin);
+		m_end -= m_begin;
+		m_begin = 0;
+	}
+	//a single tag longer than the buffer
+	if (m_end == m_buffer.size()-1)
+		m_buffer.resize(2*m_end+1);
+	size_t n = fread(&m_buffer[m_end],1,m_buffer.size()-1-m_end,m_file);
+	m_end += n;
+	m_buffer[m_end] = '\0';
+	m_bytesRead += n;
+	return n > 0;
+}
+
+bool FcdStreamReader::FindTagEnd(size_t& end)
+{
+	const char* base = &m_buffer[0];
+	size_t p = m_begin+1;
+	if (m_end-m_begin >= 4 && 0==strncmp(base+m_begin,"<!--",4))
+	{
+		//comments may hold '>' and quotes
+		for (p = m_begin+4; p+2 < m_end; p++)
+		{
+			if (base[p]=='-' && base[p+1]=='-' && base[p+2]=='>')
+			{
+				end = p+2;
+				return true;
+			}
+		}
+		return false;
+	}
+	if (m_end-m_begin < 4 && m_end-m_begin >= 2 && base[m_begin+1]=='!')
+		return false;//not sure yet whether it is a comment
+	char quote = 0;
+	for (; p < m_end; p++)
+	{
+		char c = base[p];
+		if (quote)
+		{
+			if (c==quote)
+				quote = 0;
+		}
+		else if (c=='"' || c=='\'')
+			quote = c;
+		else if (c=='>')
+		{
+			end = p;
+			return true;
+		}
+	}
+	return false;
+}
+
+bool FcdStreamReader::NextStartTag()
+{
+	for (;;)
+	{
+		char* base = &m_buffer[0];
+		const char* lt = (const char*)memchr(base+m_begin,'<',m_end-m_begin);
+		if (!lt)
+		{
+			m_begin = m_end;
+			if (!Fill())
+				return false;
+			continue;
+		}
+		m_begin = lt-base;
+		size_t end;
+		if (!FindTagEnd(end))
+		{
+			if (!Fill())
+				return false;
+			continue;
+		}
+		char kind = base[m_begin+1];
+		if (kind=='/' || kind=='?' || kind=='!')
+		{
+			//end tag, declaration, comment
+			m_begin = end+1;
+			continue;
+		}
+		size_t p = m_begin+1;
+		while (p < end && !isspace((unsigned char)base[p]) && base[p]!='/')
+			p++;
+		m_name = m_begin+1;
+		m_attributes = (p < end && isspace((unsigned char)base[p])) ? p+1 : m_name;
+		base[p] = '\0';
+		base[end] = '\0';
+		m_begin = end+1;
+		return true;
+	}
+}
+
+void FcdStreamReader::ReadAttributes()
+{
+	if (m_attributes == m_name)
+		return;
+	char* p = &m_buffer[m_attributes];
+	for (;;)
+	{
+		while (isspace((unsigned char)*p))
+			p++;
+		if (*p=='\0' || *p=='/')
+			return;
+		char* name = p;
+		while (*p && *p!='=' && !isspace((unsigned char)*p))
+			p++;
+		char* nameEnd = p;
+		while (isspace((unsigned char)*p))
+			p++;
+		if (*p!='=')
+			return;
+		p++;
+		while (isspace((unsigned char)*p))
+			p++;
+		char quote = *p;
+		if (quote!='"' && quote!='\'')
+			return;
+		char* value = ++p;
+		while (*p && *p!=quote)
+			p++;
+		if (!*p)
+			return;
+		*nameEnd = '\0';
+		*p++ = '\0';
+
+		switch(getAttribuutID(name))
+		{
+		case ATTR_ID    :m_vid         =atoi(value);break;
+		case ATTR_TIME  :m_trace.time  =atof(value);break;
+		case ATTR_X     :m_trace.x     =atof(value);break;
+		case ATTR_Y     :m_trace.y     =atof(value);break;
+		case ATTR_ANGLE :m_trace.angle =atof(value);break;
+		case ATTR_SPEED :m_trace.speed =atof(value);break;
+		case ATTR_POS   :m_trace.pos   =atof(value);break;
+		case ATTR_SLOPE :m_trace.slope =atof(value);break;
+		case ATTR_LANE  :
+			{
+				m_trace.lane = value;
+				if (strchr(value,'&'))
+					Unescape(m_trace.lane);
+				if (m_trace.lane.size() >= 2)
+					m_trace.lane.erase(m_trace.lane.end()-2,m_trace.lane.end());
+				StringReplace(m_trace.lane,originLanCharactor,changeLaneCharactor);
+				break;
+			}
+		case ATTR_TYPE  :
+			{
+				m_trace.type = value;
+				if (strchr(value,'&'))
+					Unescape(m_trace.type);
+				break;
+			}
+		default:break;
+		}
+	}
+}
+
+void FcdStreamReader::Unescape(std::string& value)
+{
+	static const char* entities[][2] = {{"&amp;","&"},{"&lt;","<"},{"&gt;",">"},{"&quot;","\""},{"&apos;","'"}};
+	string result;
+	result.reserve(value.size());
+	for (string::size_type i = 0; i < value.size(); )
+	{
+		bool replaced = false;
+		if (value[i]=='&')
+		{
+			for (int e = 0; e < 5 && !replaced; e++)
+			{
+				string::size_type len = strlen(entities[e][0]);
+				if (0==value.compare(i,len,entities[e][0]))
+				{
+					result += entities[e][1];
+					i += len;
+					replaced = true;
+				}
+			}
+			string::size_type semicolon = value.find(';',i);
+			if (!replaced && value.compare(i,2,"&#")==0 && semicolon!=string::npos)
+			{
+				bool hex = i+2 < value.size() && value[i+2]=='x';
+				long code = strtol(value.c_str()+i+(hex ? 3 : 2),NULL,hex ? 16 : 10);
+				if (code > 0 && code < 128)
+				{
+					result += char(code);
+					i = semicolon+1;
+					replaced = true;
+				}
+			}
+		}
+		if (!replaced)
+			result += value[i++];
+	}
+	value.swap(result);
+}
+
+} /* namespace sumomobility */
+} /* namespace vanetmobility */
+} /* namespace ns3 */
@@ -0,0 +1,82 @@
+#ifndef FCDSTREAMREADER_H_
+#define FCDSTREAMREADER_H_
+
+#include "ns3/RouteElement.h"
+
+#include <cstdio>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace ns3
+{
+namespace vanetmobility
+{
+namespace sumomobility
+{
+
+/*
+ * Streaming reader of SUMO fcd-export files.
+ *
+ * The file is read in chunks and scanned tag by tag, no document tree is ever built,
+ * so the memory use is the chunk buffer and the current sample whatever the file size.
+ * Each Next() moves to the following <vehicle> sample; its time is the one of the
+ * enclosing <timestep>. As with the tinyxml loader, an attribute missing from a sample
+ * keeps the value of the previous sample, lanes lose their "_<index>" suffix and
+ * have '/' replaced by '-'.
+ */
+class FcdStreamReader
+{
+public:
+	FcdStreamReader(uint32_t bufferSize = 1 << 20);
+	virtual ~FcdStreamReader();
+
+	bool Open(const char* pFilename);
+	void Close();
+	bool Next();//false at the end of the file
+
+	int GetVehicleId() const
+	{
+		return m_vid;
+	}
+
+	const Trace& GetTrace() const
+	{
+		return m_trace;
+	}
+
+	uint64_t GetBytesRead() const
+	{
+		return m_bytesRead;
+	}
+
+	uint64_t GetSampleCount() const
+	{
+		return m_samples;
+	}
+
+private:
+	bool Fill();//keep the unparsed tail, read the next chunk behind it
+	bool NextStartTag();//leave the name and the attributes of the next start tag in the buffer
+	bool FindTagEnd(size_t& end);
+	void ReadAttributes();//of the start tag found by NextStartTag, into m_vid and m_trace
+	static void Unescape(std::string& value);
+
+	FILE* m_file;
+	std::vector<char> m_buffer;//chunk, 0 terminated at m_end
+	size_t m_begin;//first byte not parsed yet
+	size_t m_end;
+	size_t m_name;//the name of the start tag found by NextStartTag
+	size_t m_attributes;//its attributes, 0 terminated, m_attributes==m_name if it has none
+	uint64_t m_bytesRead;
+	uint64_t m_samples;
+
+	int m_vid;
+	Trace m_trace;
+};
+
+} /* namespace sumomobility */
+} /* namespace vanetmobility */
+} /* namespace ns3 */
+
+#endif /* FCDSTREAMREADER_H_ */
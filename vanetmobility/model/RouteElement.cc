@@ -1,5 +1,9 @@
 
 #include "ns3/RouteElement.h"
+#include "ns3/FcdStreamReader.h"
+#include "ns3/TraceCache.h"
+
+#include <algorithm>
 
 namespace ns3
 {
@@ -76,6 +80,25 @@ void RoadMap::LoadNetXMLFile(const char* pFilename)
 	}
 }
 
+void RoadMap::LoadTraceCache(const TraceCache& cache)
+{
+	const TraceCacheEdge* e = cache.GetEdges();
+	for (uint64_t i = 0; i < cache.GetEdgeCount(); i++)
+	{
+		Edge edge;
+		edge.id = cache.GetString(e[i].id);
+		edge.from = cache.GetString(e[i].from);
+		edge.to = cache.GetString(e[i].to);
+		edge.priority = e[i].priority;
+		edge.lane.id = cache.GetString(e[i].laneId);
+		edge.lane.index = e[i].laneIndex;
+		edge.lane.speed = e[i].laneSpeed;
+		edge.lane.length = e[i].laneLength;
+		edge.lane.shape = cache.GetString(e[i].laneShape);
+		edges.insert(map<string,Edge>::value_type(edge.lane.id,edge));
+	}
+}
+
 void RoadMap::printedges()
 {
 	map<string,Edge>::iterator edge;
@@ -286,7 +309,246 @@ void Route::printroute()
 		cout<<endl;
 }
 
-VehicleLoader::VehicleLoader()
+TraceStore::TraceStore():m_first(1,0),m_sampleCount(0),m_cache(NULL)
+{
+	UpdateColumns();
+}
+
+TraceStore::TraceStore(const TraceStore& s):m_cache(NULL)
+{
+	*this = s;
+}
+
+TraceStore& TraceStore::operator=(const TraceStore& s)
+{
+	if (this == &s)
+		return *this;
+	Clear();
+	m_strings = s.m_strings;
+	m_stringIds = s.m_stringIds;
+	m_vehicles = s.m_vehicles;
+	m_first = s.m_first;
+	m_owner = s.m_owner;
+	m_sampleCount = s.m_sampleCount;
+	for (int c = 0; c < DOUBLE_COLUMNS; c++)
+		m_doubleData[c].assign(s.m_double[c],s.m_double[c]+m_sampleCount);
+	for (int c = 0; c < FLOAT_COLUMNS; c++)
+		m_floatData[c].assign(s.m_float[c],s.m_float[c]+m_sampleCount);
+	for (int c = 0; c < ID_COLUMNS; c++)
+		m_idData[c].assign(s.m_id[c],s.m_id[c]+m_sampleCount);
+	UpdateColumns();
+	return *this;
+}
+
+TraceStore::~TraceStore()
+{
+	delete m_cache;
+}
+
+void TraceStore::Clear()
+{
+	delete m_cache;
+	m_cache = NULL;
+	m_strings.clear();
+	m_stringIds.clear();
+	m_vehicles.clear();
+	m_first.assign(1,0);
+	vector<uint32_t>().swap(m_owner);
+	m_sampleCount = 0;
+	for (int c = 0; c < DOUBLE_COLUMNS; c++)
+		vector<double>().swap(m_doubleData[c]);
+	for (int c = 0; c < FLOAT_COLUMNS; c++)
+		vector<float>().swap(m_floatData[c]);
+	for (int c = 0; c < ID_COLUMNS; c++)
+		vector<uint32_t>().swap(m_idData[c]);
+	UpdateColumns();
+}
+
+uint32_t TraceStore::Intern(const string& s)
+{
+	unordered_map<string,uint32_t>::const_iterator it = m_stringIds.find(s);
+	if (it != m_stringIds.end())
+		return it->second;
+	uint32_t id = m_strings.size();
+	m_stringIds[s] = id;
+	m_strings.push_back(s);
+	return id;
+}
+
+const string& TraceStore::GetString(uint32_t id) const
+{
+	static const string empty;
+	return id < m_strings.size() ? m_strings[id] : empty;
+}
+
+void TraceStore::AddVehicle(const Vehicle& vehicle)
+{
+	m_vehicles.push_back(vehicle);
+	m_first.push_back(m_first.back());
+}
+
+void TraceStore::Append(uint32_t v,const Trace& trace)
+{
+	MakeOwned();
+	if (m_owner.empty() && m_sampleCount > 0)
+	{
+		//appending to finalized samples, recover whose they are
+		m_owner.resize(m_sampleCount);
+		for (uint32_t i = 0; i < m_vehicles.size(); i++)
+			fill(m_owner.begin()+m_first[i],m_owner.begin()+m_first[i+1],i);
+	}
+	m_owner.push_back(v);
+	m_doubleData[TIME].push_back(trace.time);
+	m_doubleData[X].push_back(trace.x);
+	m_doubleData[Y].push_back(trace.y);
+	m_floatData[ANGLE].push_back(trace.angle);
+	m_floatData[SPEED].push_back(trace.speed);
+	m_floatData[POS].push_back(trace.pos);
+	m_floatData[SLOPE].push_back(trace.slope);
+	m_idData[LANE].push_back(Intern(trace.lane));
+	m_idData[TYPE].push_back(Intern(trace.type));
+	m_sampleCount++;
+	UpdateColumns();
+}
+
+namespace
+{
+//Move c[i] to c[dest[i]], the new column has no spare capacity
+template <typename T>
+void Permute(vector<T>& c,const vector<uint64_t>& dest)
+{
+	vector<T> out(c.size());
+	for (uint64_t i = 0; i < c.size(); i++)
+		out[dest[i]] = c[i];
+	c.swap(out);
+}
+}
+
+void TraceStore::Finalize()
+{
+	if (m_owner.empty())
+		return;
+	//counting sort by vehicle, stable so every vehicle keeps its samples in time order
+	vector<uint64_t> next(m_vehicles.size()+1,0);
+	for (uint64_t i = 0; i < m_sampleCount; i++)
+		next[m_owner[i]+1]++;
+	for (uint32_t v = 0; v < m_vehicles.size(); v++)
+		next[v+1] += next[v];
+	m_first = next;
+	vector<uint64_t> dest(m_sampleCount);
+	for (uint64_t i = 0; i < m_sampleCount; i++)
+		dest[i] = next[m_owner[i]]++;
+	vector<uint32_t>().swap(m_owner);
+	for (int c = 0; c < DOUBLE_COLUMNS; c++)
+		Permute(m_doubleData[c],dest);
+	for (int c = 0; c < FLOAT_COLUMNS; c++)
+		Permute(m_floatData[c],dest);
+	for (int c = 0; c < ID_COLUMNS; c++)
+		Permute(m_idData[c],dest);
+	UpdateColumns();
+}
+
+bool TraceStore::Map(TraceCache* cache)
+{
+	Clear();
+	m_cache = cache;
+	if (!cache->IsOpen())
+	{
+		Clear();
+		return false;
+	}
+	for (uint32_t i = 0; i < cache->GetStringCount(); i++)
+	{
+		if (Intern(cache->GetString(i)) != i)
+		{
+			Clear();//the ids of the columns would not match
+			return false;
+		}
+	}
+	const TraceCacheVehicle* v = cache->GetVehicles();
+	const uint32_t* routeEdges = cache->GetRouteEdges();
+	m_vehicles.resize(cache->GetVehicleCount());
+	m_first.resize(m_vehicles.size()+1);
+	for (uint64_t i = 0; i < m_vehicles.size(); i++)
+	{
+		if (v[i].firstSample != m_first[i])
+		{
+			Clear();//the samples of a vehicle must follow the ones of the previous
+			return false;
+		}
+		m_first[i+1] = v[i].firstSample+v[i].sampleCount;
+		Vehicle& vehicle = m_vehicles[i];
+		vehicle.id = v[i].id;
+		vehicle.depart = v[i].depart;
+		for (uint64_t e = v[i].firstEdge; e < v[i].firstEdge+v[i].edgeCount; e++)
+			vehicle.route.edgesID.push_back(GetString(routeEdges[e]));
+	}
+	m_sampleCount = m_first.back();
+	UpdateColumns();
+	return true;
+}
+
+Trace TraceStore::GetTrace(uint64_t s) const
+{
+	Trace trace;
+	trace.time = m_double[TIME][s];
+	trace.x = m_double[X][s];
+	trace.y = m_double[Y][s];
+	trace.angle = m_float[ANGLE][s];
+	trace.speed = m_float[SPEED][s];
+	trace.pos = m_float[POS][s];
+	trace.slope = m_float[SLOPE][s];
+	trace.lane = GetString(m_id[LANE][s]);
+	trace.type = GetString(m_id[TYPE][s]);
+	return trace;
+}
+
+uint64_t TraceStore::GetMemoryUsage() const
+{
+	uint64_t bytes = m_first.capacity()*sizeof(uint64_t)+m_owner.capacity()*sizeof(uint32_t);
+	for (int c = 0; c < DOUBLE_COLUMNS; c++)
+		bytes += m_doubleData[c].capacity()*sizeof(double);
+	for (int c = 0; c < FLOAT_COLUMNS; c++)
+		bytes += m_floatData[c].capacity()*sizeof(float);
+	for (int c = 0; c < ID_COLUMNS; c++)
+		bytes += m_idData[c].capacity()*sizeof(uint32_t);
+	for (vector<string>::const_iterator s = m_strings.begin(); s != m_strings.end(); ++s)
+		bytes += 2*(sizeof(string)+s->capacity())+sizeof(uint32_t);//the table and the index
+	for (vector<Vehicle>::const_iterator v = m_vehicles.begin(); v != m_vehicles.end(); ++v)
+	{
+		bytes += sizeof(Vehicle);
+		for (vector<string>::const_iterator e = v->route.edgesID.begin(); e != v->route.edgesID.end(); ++e)
+			bytes += sizeof(string)+e->capacity();
+	}
+	return bytes;
+}
+
+void TraceStore::MakeOwned()
+{
+	if (!m_cache)
+		return;
+	for (int c = 0; c < DOUBLE_COLUMNS; c++)
+		m_doubleData[c].assign(m_double[c],m_double[c]+m_sampleCount);
+	for (int c = 0; c < FLOAT_COLUMNS; c++)
+		m_floatData[c].assign(m_float[c],m_float[c]+m_sampleCount);
+	for (int c = 0; c < ID_COLUMNS; c++)
+		m_idData[c].assign(m_id[c],m_id[c]+m_sampleCount);
+	delete m_cache;
+	m_cache = NULL;
+	UpdateColumns();
+}
+
+void TraceStore::UpdateColumns()
+{
+	for (int c = 0; c < DOUBLE_COLUMNS; c++)
+		m_double[c] = m_cache ? m_cache->GetColumn((DoubleColumn)c) : m_doubleData[c].data();
+	for (int c = 0; c < FLOAT_COLUMNS; c++)
+		m_float[c] = m_cache ? m_cache->GetColumn((FloatColumn)c) : m_floatData[c].data();
+	for (int c = 0; c < ID_COLUMNS; c++)
+		m_id[c] = m_cache ? m_cache->GetColumn((IdColumn)c) : m_idData[c].data();
+}
+
+VehicleLoader::VehicleLoader():m_temp_vehicle(NULL)
 {
 	// TODO Auto-generated constructor stub
 
@@ -294,10 +556,18 @@ VehicleLoader::VehicleLoader()
 
 VehicleLoader::~VehicleLoader()
 {
-	// TODO Auto-generated destructor stub
+	delete m_temp_vehicle;
 }
 
-VehicleLoader::VehicleLoader(const VehicleLoader& v){vehicles=v.vehicles;m_temp_vehicle=NULL;}
+VehicleLoader::VehicleLoader(const VehicleLoader& v):traces(v.traces),m_temp_vehicle(NULL){}
+
+namespace
+{
+bool VehicleIdLess(const Vehicle& a,const Vehicle& b)
+{
+	return a.id < b.id;
+}
+}
 
 void VehicleLoader::LoadRouteXML(const char *  pXMLFilename)
 {
@@ -307,7 +577,15 @@ void VehicleLoader::LoadRouteXML(const char *  pXMLFilename)
 	{
 	//	printf("\n%s:\n", pXMLFilename);
 		initialize_vehicles( &doc ); // defined later in the tutorial
-		ReadMapIntoVector();
+		//ordered by id, the last definition of an id wins
+		stable_sort(m_parsed.begin(),m_parsed.end(),VehicleIdLess);
+		for (size_t i = 0; i < m_parsed.size(); i++)
+		{
+			if (i+1 < m_parsed.size() && m_parsed[i+1].id == m_parsed[i].id)
+				continue;
+			traces.AddVehicle(m_parsed[i]);
+		}
+		vector<Vehicle>().swap(m_parsed);
 	}
 	else
 	{
@@ -317,38 +595,45 @@ void VehicleLoader::LoadRouteXML(const char *  pXMLFilename)
 
 void VehicleLoader::LoadFCDOutputXML(const char *  pXMLFilename)
 {
-	TiXmlDocument doc(pXMLFilename);
-	bool loadOkay = doc.LoadFile();
-	if (loadOkay)
+	FcdStreamReader reader;
+	if (!reader.Open(pXMLFilename))
 	{
-//		printf("\n%s:\n", pXMLFilename);
-		initialize_trace(&doc);
+		printf("Failed to load file \"%s\"\n", pXMLFilename);
+		return;
 	}
-	else
+	while (reader.Next())
 	{
-		printf("Failed to load file \"%s\"\n", pXMLFilename);
+		int vid = reader.GetVehicleId();
+		if (vid < 0 || vid >= (int)traces.GetVehicleCount())
+			continue;//not in the route file
+		traces.Append(vid,reader.GetTrace());
 	}
+	traces.Finalize();
+}
+
+bool VehicleLoader::LoadTraceCache(TraceCache* cache)
+{
+	return traces.Map(cache);
 }
 
 void VehicleLoader::print_vehicle()
 {
-	vector<Vehicle>::iterator v;
-	for (v=vehicles.begin();v!=vehicles.end();v++)
+	for (uint32_t v = 0; v < traces.GetVehicleCount(); v++)
 	{
-		cout<<(*v).id<<"  "<<(*v).depart<<endl;
-		//(*v).route.printroute();
-		vector<Trace>::iterator t;
-		for (t=(*v).trace.begin();t!=(*v).trace.end();t++)
+		cout<<traces.GetVehicle(v).id<<"  "<<traces.GetVehicle(v).depart<<endl;
+		//traces.GetVehicle(v).route.printroute();
+		for (uint64_t s = traces.GetBegin(v); s < traces.GetEnd(v); s++)
 		{
-			cout<<"trace:  "<<(*t).time<<"  "<<(*t).x<<"  "<<(*t).y<<"  "<<(*t).angle<<(*t).type
-				<<(*t).speed<<(*t).pos<<"  "<<(*t).lane<<"  "<<"  "<<(*t).slope<<"  "<<"  "<<endl;
+			Trace t = traces.GetTrace(s);
+			cout<<"trace:  "<<t.time<<"  "<<t.x<<"  "<<t.y<<"  "<<t.angle<<t.type
+				<<t.speed<<t.pos<<"  "<<t.lane<<"  "<<"  "<<t.slope<<"  "<<"  "<<endl;
 		}
 	}
 }
 
-const vector<Vehicle>& VehicleLoader::getVehicles()const
+const TraceStore& VehicleLoader::getTraces()const
 {
-	return vehicles;
+	return traces;
 }
 
 
@@ -370,16 +655,19 @@ void VehicleLoader::initialize_vehicles( TiXmlNode* pParent)
 			{
 			case 1:
 				{
+					delete m_temp_vehicle;
 					m_temp_vehicle = new Vehicle();
 					read_vehicle(pParent->ToElement());
 					break;
 				}//vehicle
 			case 2:
 				{
+					if (!m_temp_vehicle)
+						break;//a route outside of a vehicle
 					read_vehicle(pParent->ToElement());
-				//	vehicles.push_back(*m_temp_vehicle);
-					mapvehicles[m_temp_vehicle->id]=*m_temp_vehicle;
+					m_parsed.push_back(*m_temp_vehicle);
 					delete m_temp_vehicle;
+					m_temp_vehicle = NULL;
 					break;
 				}//route
 			default:break;
@@ -416,92 +704,9 @@ int VehicleLoader::read_vehicle(TiXmlElement* pElement)
 	return i;
 }
 
-void VehicleLoader::initialize_trace( TiXmlNode* pParent)
-{
-	if ( !pParent ) return;
-	TiXmlNode* pChild;
-	int t = pParent->Type();
-	int vid;
-	switch ( t )
-	{
-	case TiXmlNode::TINYXML_ELEMENT:
-		{
-			const char *element = pParent->Value();
-			int elementID=0;
-			if (0==strcmp(element,"timestep"))elementID=1;
-			if (0==strcmp(element,"vehicle"))elementID=2;
-			switch(elementID)
-			{
-			case 1:
-				{
-					read_trace(pParent->ToElement());
-					break;
-				}//timestep
-			case 2:
-				{
-					vid=read_trace(pParent->ToElement());
-					vehicles[vid].trace.push_back(m_temp_trace);
-					break;
-				}//vehicle
-			default:break;
-			}
-			break;
-		}
-	default:break;
-	}
-
-	for ( pChild = pParent->FirstChild(); pChild != 0; pChild = pChild->NextSibling())
-		initialize_trace(pChild);
-}
-
-int VehicleLoader::read_trace(TiXmlElement* pElement)//Return vehicle ID value
-{
-	if ( !pElement ) return 0;
-	TiXmlAttribute* pAttrib=pElement->FirstAttribute();
-	int i=0;
-	int attributeID;
-	int vid=-1;
-	while (pAttrib)
-	{
-		attributeID=getAttribuutID(pAttrib->Name());
-		switch(attributeID)
-		{
-		case ATTR_ID    :vid               =atoi(pAttrib->Value());break;
-		case ATTR_TIME  :m_temp_trace.time =atof(pAttrib->Value());break;
-		case ATTR_X     :m_temp_trace.x    =atof(pAttrib->Value());break;
-		case ATTR_Y     :m_temp_trace.y    =atof(pAttrib->Value());break;
-		case ATTR_ANGLE :m_temp_trace.angle=atof(pAttrib->Value());break;
-		case ATTR_SPEED :m_temp_trace.speed=atof(pAttrib->Value());break;
-		case ATTR_POS   :m_temp_trace.pos  =atof(pAttrib->Value());break;
-		case ATTR_SLOPE :m_temp_trace.slope=atof(pAttrib->Value());break;
-		case ATTR_LANE  :
-			{
-				m_temp_trace.lane =     pAttrib->Value();
-				m_temp_trace.lane.erase(m_temp_trace.lane.end()-2,m_temp_trace.lane.end());
-                StringReplace(m_temp_trace.lane,originLanCharactor,changeLaneCharactor);
-				//cout<<m_temp_trace.lane<<endl;
-				break;
-			}
-		case ATTR_TYPE  :m_temp_trace.type =     pAttrib->Value();break;
-		default:break;
-		}
-		i++;
-		pAttrib=pAttrib->Next();
-	}
-	return vid;
-}
-
 void VehicleLoader::Clear()
 {
-	vehicles.clear();
-	mapvehicles.clear();
-}
-
-void VehicleLoader::ReadMapIntoVector()
-{
-	map<int,Vehicle>::iterator it;
-	for(it = mapvehicles.begin();it!= mapvehicles.end();it++)
-		vehicles.push_back(it->second);
+	traces.Clear();
 }
 
 } /* namespace sumomobility */
@@ -5,9 +5,11 @@
 #include "ns3/tinyxml.h"
 #include "ns3/vector.h"
 
+#include <stdint.h>
 #include <string>
 #include <map>
 #include <iostream>
+#include <unordered_map>
 #include <vector>
 
 namespace ns3
@@ -43,6 +45,8 @@ void StringReplace(std::string&,const std::string&,const std::string&);
 
 int getAttribuutID(const char* attribute);
 
+class TraceCache;
+
 struct Lane
 {
 	std::string id;
@@ -69,6 +73,7 @@ public:
 	virtual ~RoadMap();
 	void Clear(){edges.clear();};
 	void LoadNetXMLFile(const char* pFilename);
+	void LoadTraceCache(const TraceCache& cache);
 	void printedges();
 	const std::map<std::string,Edge>& getEdges()const;  //warning: the key is lane's id, not edges
 
@@ -128,7 +133,136 @@ struct Vehicle
 	int id;
 	double depart;
 	Route route;
-	std::vector<Trace> trace;
+};
+
+/*
+ * The samples of all the vehicles, one contiguous column per Trace field.
+ *
+ * A Trace costs two std::string per sample; here a sample is 48 bytes, lanes and
+ * vehicle types being ids into one table of interned strings. The samples of vehicle v
+ * are [GetBegin(v),GetEnd(v)) in time order. Append() takes the samples in any order,
+ * Finalize() groups them by vehicle. The columns are either owned, or point into a
+ * mapped TraceCache that the store then owns; a copy always owns its columns.
+ */
+class TraceStore
+{
+public:
+	enum DoubleColumn
+	{
+		TIME,
+		X,
+		Y,
+		DOUBLE_COLUMNS
+	};
+	enum FloatColumn
+	{
+		ANGLE,
+		SPEED,
+		POS,
+		SLOPE,
+		FLOAT_COLUMNS
+	};
+	enum IdColumn
+	{
+		LANE,
+		TYPE,
+		ID_COLUMNS
+	};
+	static const uint32_t SAMPLE_BYTES = DOUBLE_COLUMNS*sizeof(double)+FLOAT_COLUMNS*sizeof(float)+ID_COLUMNS*sizeof(uint32_t);
+
+	TraceStore();
+	TraceStore(const TraceStore& s);
+	TraceStore& operator=(const TraceStore& s);
+	virtual ~TraceStore();
+	void Clear();
+
+	uint32_t Intern(const std::string& s);
+	const std::string& GetString(uint32_t id) const;//empty if unknown
+	uint32_t GetStringCount() const
+	{
+		return m_strings.size();
+	}
+
+	void AddVehicle(const Vehicle& vehicle);//the vehicle index is the order of the calls
+	uint32_t GetVehicleCount() const
+	{
+		return m_vehicles.size();
+	}
+	const Vehicle& GetVehicle(uint32_t v) const
+	{
+		return m_vehicles[v];
+	}
+
+	void Append(uint32_t v,const Trace& trace);
+	void Finalize();
+	bool Map(TraceCache* cache);//replaces the content, owns the cache from then on, even on failure
+
+	uint64_t GetSampleCount() const
+	{
+		return m_sampleCount;
+	}
+	uint64_t GetBegin(uint32_t v) const
+	{
+		return m_first[v];
+	}
+	uint64_t GetEnd(uint32_t v) const
+	{
+		return m_first[v+1];
+	}
+	const double* GetColumn(DoubleColumn column) const
+	{
+		return m_double[column];
+	}
+	const float* GetColumn(FloatColumn column) const
+	{
+		return m_float[column];
+	}
+	const uint32_t* GetColumn(IdColumn column) const
+	{
+		return m_id[column];
+	}
+	double GetTime(uint64_t s) const
+	{
+		return m_double[TIME][s];
+	}
+	double GetX(uint64_t s) const
+	{
+		return m_double[X][s];
+	}
+	double GetY(uint64_t s) const
+	{
+		return m_double[Y][s];
+	}
+	double GetPos(uint64_t s) const
+	{
+		return m_float[POS][s];
+	}
+	const std::string& GetLane(uint64_t s) const
+	{
+		return GetString(m_id[LANE][s]);
+	}
+	Trace GetTrace(uint64_t s) const;//the sample as a Trace, for the callers that want one
+
+	uint64_t GetMemoryUsage() const;//heap bytes of the store, a mapped cache not included
+
+private:
+	void MakeOwned();//copy the mapped columns, release the cache
+	void UpdateColumns();//point the columns at the owned vectors
+
+	std::vector<std::string> m_strings;
+	std::unordered_map<std::string,uint32_t> m_stringIds;
+	std::vector<Vehicle> m_vehicles;
+	std::vector<uint64_t> m_first;//GetVehicleCount()+1 entries, over the finalized samples
+	std::vector<uint32_t> m_owner;//vehicle of each sample while not finalized, empty otherwise
+
+	uint64_t m_sampleCount;
+	std::vector<double> m_doubleData[DOUBLE_COLUMNS];
+	std::vector<float> m_floatData[FLOAT_COLUMNS];
+	std::vector<uint32_t> m_idData[ID_COLUMNS];
+	const double* m_double[DOUBLE_COLUMNS];
+	const float* m_float[FLOAT_COLUMNS];
+	const uint32_t* m_id[ID_COLUMNS];
+	TraceCache* m_cache;
 };
 
 class VehicleLoader
@@ -139,20 +273,17 @@ public:
 	VehicleLoader(const VehicleLoader& v);
 	void LoadRouteXML(const char *  pXMLFilename);
 	void LoadFCDOutputXML(const char *  pXMLFilename);
+	bool LoadTraceCache(TraceCache* cache);//instead of both xml files, see TraceStore::Map
 	void print_vehicle();
-	const std::vector<Vehicle>& getVehicles() const;
+	const TraceStore& getTraces() const;
 	void Clear();
 
 private:
-	std::vector<Vehicle> vehicles;
-	std::map<int,Vehicle> mapvehicles;
+	TraceStore traces;
+	std::vector<Vehicle> m_parsed;//of the route file being read
 	Vehicle *m_temp_vehicle;
-	Trace   m_temp_trace;
 	void initialize_vehicles( TiXmlNode* pParent);
 	int read_vehicle(TiXmlElement* pElement);
-	void initialize_trace( TiXmlNode* pParent);
-	int read_trace(TiXmlElement* pElement);//Return vehicle ID value
-	void ReadMapIntoVector();
 };
 
 } /* namespace sumomobility */
@@ -7,6 +7,10 @@
 #include "ns3/internet-module.h"
 #include "ns3/application.h"
 #include "ns3/SumoMobility.h"
+#include "ns3/SumoTraceMobilityModel.h"
+#include "ns3/TraceCache.h"
+
+#include <algorithm>
 
 namespace ns3
 {
@@ -20,11 +24,9 @@ using namespace std;
 
 
 SumoMobility::SumoMobility(std::string netxmlpath,std::string routexmlpath,std::string fcdxmlpath):
-		netxmlpath(netxmlpath),routexmlpath(routexmlpath),fcdxmlpath(fcdxmlpath),readTotalTime(0)
+		netxmlpath(netxmlpath),routexmlpath(routexmlpath),fcdxmlpath(fcdxmlpath),traceModel(true),waypointWindow(0),readTotalTime(0)
 {
-	// TODO Auto-generated constructor stub
-	LoadTraffic();
-	InitializeCoordinateToLane();
+	// The traffic is loaded in NotifyConstructionCompleted, once the attributes are set
 }
 
 SumoMobility::~SumoMobility()
@@ -36,26 +38,79 @@ TypeId SumoMobility::GetTypeId()
 {
 	  static TypeId tid = TypeId ("ns3::vanetmobility::sumomobility::SumoMobility")
 	    .SetParent<Object> ()
+	    .AddAttribute ("TraceCache",
+	                   "Binary cache of the net, route and fcd files, rebuilt when they change. "
+	                   "Empty to parse the xml files every time.",
+	                   StringValue (""),
+	                   MakeStringAccessor (&SumoMobility::traceCachePath),
+	                   MakeStringChecker ())
+	    .AddAttribute ("TraceModel",
+	                   "Drive the vehicles with SumoTraceMobilityModel, reading the samples in place. "
+	                   "False for WaypointMobilityModel and off-map waypoints before and after each trace.",
+	                   BooleanValue (true),
+	                   MakeBooleanAccessor (&SumoMobility::traceModel),
+	                   MakeBooleanChecker ())
+	    .AddAttribute ("WaypointWindow",
+	                   "Waypoints queued in the model of a vehicle, refilled as it moves on. "
+	                   "0 to queue the whole trace at Install. Without TraceModel only.",
+	                   UintegerValue (0),
+	                   MakeUintegerAccessor (&SumoMobility::waypointWindow),
+	                   MakeUintegerChecker<uint32_t> ())
 	  ;
 	  return tid;
 }
 
+void SumoMobility::NotifyConstructionCompleted()
+{
+	VANETmobility::NotifyConstructionCompleted();
+	LoadTraffic();
+}
+
 void SumoMobility::LoadTraffic()
 {
+	if (traceCachePath.empty())
+	{
+		roadmap.LoadNetXMLFile(netxmlpath.data());
+		vl.LoadRouteXML(routexmlpath.data());
+		vl.LoadFCDOutputXML(fcdxmlpath.data());
+		return;
+	}
+
+	vector<string> sources;
+	sources.push_back(netxmlpath);
+	sources.push_back(routexmlpath);
+	sources.push_back(fcdxmlpath);
+	uint64_t hash = TraceCache::HashSources(sources);
+	TraceCache* cache = new TraceCache();
+	if (hash && cache->Open(traceCachePath.data(),hash))
+	{
+		roadmap.LoadTraceCache(*cache);
+		if (vl.LoadTraceCache(cache))//the samples stay in the mapping
+		{
+			cout<<"Trace cache "<<traceCachePath<<" is up to date"<<endl;
+			return;
+		}
+		roadmap.Clear();
+	}
+	else
+		delete cache;
 	roadmap.LoadNetXMLFile(netxmlpath.data());
 	vl.LoadRouteXML(routexmlpath.data());
 	vl.LoadFCDOutputXML(fcdxmlpath.data());
+	if (hash && TraceCache::Write(traceCachePath.data(),hash,roadmap,vl))
+		cout<<"Trace cache "<<traceCachePath<<" written"<<endl;
+	else
+		cout<<"Cannot write the trace cache "<<traceCachePath<<endl;
 }
 
 double SumoMobility::GetStartTime(uint32_t id)
 {
-	return vl.getVehicles()[id].trace.front().time;
-
+	return vl.getTraces().GetTime(vl.getTraces().GetBegin(id));
 }
 
 double SumoMobility::GetStopTime(uint32_t id)
 {
-	return vl.getVehicles()[id].trace.back().time;
+	return vl.getTraces().GetTime(vl.getTraces().GetEnd(id)-1);
 }
 
 void SumoMobility::Install()
@@ -65,42 +120,81 @@ void SumoMobility::Install()
 
 	bool lazyNotify = true;
 	bool initialPositionIsWaypoint = false;
-	mobility.SetMobilityModel ("ns3::WaypointMobilityModel","LazyNotify",BooleanValue (lazyNotify),
-	                           "InitialPositionIsWaypoint",BooleanValue (initialPositionIsWaypoint));
+	if (traceModel)
+		mobility.SetMobilityModel ("ns3::vanetmobility::sumomobility::SumoTraceMobilityModel");
+	else
+		mobility.SetMobilityModel ("ns3::WaypointMobilityModel","LazyNotify",BooleanValue (lazyNotify),
+		                           "InitialPositionIsWaypoint",BooleanValue (initialPositionIsWaypoint));
 	mobility.Install (NodeContainer::GetGlobal());
   std::cout<<"mobility.Install"<<std::endl;
 	double maxTime = 0;
-	uint32_t CarNumber = 0;
+	const TraceStore& traces = vl.getTraces();
+	m_nextSample.resize(traces.GetVehicleCount());
 	// Populate the vector of mobility models, each model for a vehicle
-	for (vector<Vehicle>::const_iterator vehicle =vl.getVehicles().begin();vehicle!=vl.getVehicles().end();vehicle++)
+	for (uint32_t CarNumber = 0; CarNumber < traces.GetVehicleCount(); CarNumber++)
 	{
-		double end_time=0.0;
+		uint64_t begin = traces.GetBegin(CarNumber);
+		uint64_t end = traces.GetEnd(CarNumber);
+		if (traceModel)
+		{
+			if (begin < end && traces.GetTime(end-1) > maxTime)
+			  maxTime = traces.GetTime(end-1);
+			Ptr<SumoTraceMobilityModel> tracemodel = NodeList::GetNode (CarNumber)->GetObject<SumoTraceMobilityModel> ();
+			//Off the map, each vehicle on its own spot so that absent vehicles cannot hear each other
+			tracemodel->SetPosition(Vector(10000.0 + CarNumber * 10000.0,10000.0,10000.0));
+			tracemodel->SetTrace(&traces,CarNumber);
+			continue;
+		}
 		// Add this mobility model to the stack.
 		Ptr<WaypointMobilityModel> waypointmodel =
 		    NodeList::GetNode (CarNumber)->GetObject<MobilityModel> ()->GetObject<WaypointMobilityModel> ();
 		//Add a initial position(10000,10000,10000)
-		if ((*((*vehicle).trace).begin()).time >= 1.0)
-		  waypointmodel->AddWaypoint(Waypoint(Seconds((*((*vehicle).trace).begin()).time-1.0),Vector(10000.0 + CarNumber * 10000.0,10000.0,10000.0)));
-		// Add the trace into the way point model
-		for(vector<Trace>::const_iterator t=(*vehicle).trace.begin();t!=(*vehicle).trace.end();t++)
-		{
-			// Add waypoints
-			end_time = (*t).time;
-			if (end_time>maxTime)
-			  maxTime=end_time;
-			Waypoint wp(Seconds(end_time),Vector((*t).x,(*t).y,0.0));
-			waypointmodel->AddWaypoint(wp);
-		}
-		//Add a final position(-10000,-10000,-10000)
-		waypointmodel->AddWaypoint(Waypoint(Seconds(end_time+0.1),Vector(-10000.0 - CarNumber * 10000.0,-10000.0,-10000.0)));
-		std::cout<<CarNumber<<","<<std::flush;
-		CarNumber++;
+		if (begin < end && traces.GetTime(begin) >= 1.0)
+		  waypointmodel->AddWaypoint(Waypoint(Seconds(traces.GetTime(begin)-1.0),Vector(10000.0 + CarNumber * 10000.0,10000.0,10000.0)));
+		if (begin < end && traces.GetTime(end-1) > maxTime)
+		  maxTime = traces.GetTime(end-1);
+		// Add the trace into the way point model, or its first window
+		m_nextSample[CarNumber] = begin;
+		Feed(CarNumber,0);
 	}
-	std::cout<<std::endl;
 	cout<<"Max time in fcdoutput.xml is "<<maxTime<<endl;
 	readTotalTime = maxTime+1;
 }
 
+void SumoMobility::Feed(uint32_t CarNumber,uint32_t queued)
+{
+	const TraceStore& traces = vl.getTraces();
+	Ptr<WaypointMobilityModel> waypointmodel =
+	    NodeList::GetNode (CarNumber)->GetObject<MobilityModel> ()->GetObject<WaypointMobilityModel> ();
+	uint64_t& next = m_nextSample[CarNumber];
+	uint64_t end = traces.GetEnd(CarNumber);
+	uint64_t last = end;
+	// The model must never run out of waypoints before the trace ends, it would stop
+	// the vehicle; so at least two are queued and the refill comes while one is left.
+	uint32_t window = std::max(waypointWindow,2u);
+	if (waypointWindow > 0)
+		last = std::min<uint64_t>(end,next+(queued < window ? window-queued : 1));
+	for (; next < last; next++)
+		waypointmodel->AddWaypoint(Waypoint(Seconds(traces.GetTime(next)),Vector(traces.GetX(next),traces.GetY(next),0.0)));
+	if (next < end)
+	{
+		// Once half of the window is behind the vehicle
+		double refill = traces.GetTime(next-1-window/2);
+		Simulator::Schedule(Seconds(std::max(0.0,refill-Simulator::Now().GetSeconds())),&SumoMobility::Refill,this,CarNumber);
+		return;
+	}
+	//Add a final position(-10000,-10000,-10000)
+	double end_time = end > traces.GetBegin(CarNumber) ? traces.GetTime(end-1) : 0.0;
+	waypointmodel->AddWaypoint(Waypoint(Seconds(end_time+0.1),Vector(-10000.0 - CarNumber * 10000.0,-10000.0,-10000.0)));
+}
+
+void SumoMobility::Refill(uint32_t CarNumber)
+{
+	Ptr<WaypointMobilityModel> waypointmodel =
+	    NodeList::GetNode (CarNumber)->GetObject<MobilityModel> ()->GetObject<WaypointMobilityModel> ();
+	Feed(CarNumber,waypointmodel->WaypointsLeft());
+}
+
 void SumoMobility::ForceUpdates(std::vector<Ptr<MobilityModel> > mobilityStack)
 {
 
@@ -119,32 +213,30 @@ void SumoMobility::ForceUpdates(std::vector<Ptr<MobilityModel> > mobilityStack)
 
 }
 
-const sumomobility::Trace& SumoMobility::GetTrace(uint32_t& Vehicle_ID,Vector& pos) const
+bool SumoMobility::GetTrace(uint32_t Vehicle_ID,const Vector& pos,sumomobility::Trace& trace) const
 {
-	vector<Trace>::const_iterator result;
-	for (vector<Trace>::const_iterator trace = vl.getVehicles()[Vehicle_ID].trace.begin();
-			trace != vl.getVehicles()[Vehicle_ID].trace.end(); trace++)
+	const TraceStore& traces = vl.getTraces();
+	if (Vehicle_ID >= traces.GetVehicleCount())
+		return false;
+	//the last sample at that position, as before
+	for (uint64_t s = traces.GetEnd(Vehicle_ID); s > traces.GetBegin(Vehicle_ID); s--)
 	{
-		if ((*trace) == pos)
-			result=trace;
+		if (traces.GetX(s-1) == pos.x && traces.GetY(s-1) == pos.y)
+		{
+			trace = traces.GetTrace(s-1);
+			return true;
+		}
 	}
-	if(result==vl.getVehicles()[Vehicle_ID].trace.end())
-		return *(Trace*)NULL;
-	return *result;
+	return false;
 }
 
-void SumoMobility::InitializeCoordinateToLane()
+void SumoMobility::InitializeCoordinateToLane() const
 {
-	const vector<Vehicle>& vehicles=vl.getVehicles();
-	vector<Vehicle>::const_iterator vit;
-	vector<Trace>::const_iterator trace;
-	for(vit=vehicles.begin();vit!=vehicles.end();++vit)
+	const TraceStore& traces = vl.getTraces();
+	for (uint64_t s = 0; s < traces.GetSampleCount(); s++)
 	{
-		for (trace =vit->trace.begin();	trace != vit->trace.end(); ++trace)
-		{
-			Vector2D v(trace->x,trace->y);
-			m_CoordinateToLane[v]=std::pair<std::string,double>(trace->lane,trace->pos);
-		}
+		Vector2D v(traces.GetX(s),traces.GetY(s));
+		m_CoordinateToLane[v]=std::pair<std::string,double>(traces.GetLane(s),traces.GetPos(s));
 	}
 }
 
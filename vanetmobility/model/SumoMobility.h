@@ -61,7 +61,7 @@ public:
 
 	const uint32_t GetNodeSize() const
 	{
-		return vl.getVehicles().size();
+		return vl.getTraces().GetVehicleCount();
 	}
 
 	void Install();
@@ -71,32 +71,44 @@ public:
 		return readTotalTime;
 	}
 
-	const sumomobility::Trace& GetTrace(uint32_t& Vehicle_ID,Vector& pos) const;
+	bool GetTrace(uint32_t Vehicle_ID,const Vector& pos,sumomobility::Trace& trace) const;
 
 	const CoordinateToLaneType& getCoordinateToLane() const
 	{
+		if (m_CoordinateToLane.empty())
+			InitializeCoordinateToLane();
 		return m_CoordinateToLane;
 	}
 
+protected:
+	virtual void NotifyConstructionCompleted();
+
 private:
 	void LoadTraffic();
 	void ForceUpdates (std::vector<Ptr<MobilityModel> > mobilityStack);
 
-	void InitializeCoordinateToLane();
+	void InitializeCoordinateToLane() const;
+
+	void Feed(uint32_t CarNumber,uint32_t queued);//queue the next waypoints of a vehicle
+	void Refill(uint32_t CarNumber);
 
 	std::string netxmlpath;
 	std::string routexmlpath;
 	std::string fcdxmlpath;
+	std::string traceCachePath;
+	bool traceModel;//SumoTraceMobilityModel rather than WaypointMobilityModel
+	uint32_t waypointWindow;//waypoints queued per vehicle, 0 for all of them
 
 	///\name traffic information
 	//\{
 	RoadMap roadmap;
 	VehicleLoader vl;
 	double readTotalTime;
+	std::vector<uint64_t> m_nextSample;//first sample of each vehicle not queued yet
 	//\}
 
-	//convert the coordinate (x,y) to the lane and offset pair
-	CoordinateToLaneType m_CoordinateToLane;
+	//convert the coordinate (x,y) to the lane and offset pair, built on first use
+	mutable CoordinateToLaneType m_CoordinateToLane;
 
 };
 
@@ -0,0 +1,148 @@
+#include "ns3/SumoTraceMobilityModel.h"
+#include "ns3/simulator.h"
+
+#include <algorithm>
+
+namespace ns3
+{
+namespace vanetmobility
+{
+namespace sumomobility
+{
+NS_OBJECT_ENSURE_REGISTERED (SumoTraceMobilityModel);
+
+TypeId SumoTraceMobilityModel::GetTypeId()
+{
+	  static TypeId tid = TypeId ("ns3::vanetmobility::sumomobility::SumoTraceMobilityModel")
+	    .SetParent<MobilityModel> ()
+	    .AddConstructor<SumoTraceMobilityModel> ()
+	    .AddTraceSource ("Presence",
+	                     "The vehicle entered (true) or left (false) the map.",
+	                     MakeTraceSourceAccessor (&SumoTraceMobilityModel::m_presenceTrace),
+	                     "ns3::vanetmobility::sumomobility::SumoTraceMobilityModel::PresenceCallback")
+	  ;
+	  return tid;
+}
+
+SumoTraceMobilityModel::SumoTraceMobilityModel():
+		m_traces(NULL),m_begin(0),m_end(0),m_cursor(0),m_absentPosition(10000.0,10000.0,10000.0)
+{
+}
+
+SumoTraceMobilityModel::~SumoTraceMobilityModel()
+{
+}
+
+void SumoTraceMobilityModel::DoDispose()
+{
+	m_arrival.Cancel();
+	m_departure.Cancel();
+	m_traces = NULL;
+	m_begin = m_end = m_cursor = 0;
+	MobilityModel::DoDispose();
+}
+
+void SumoTraceMobilityModel::SetTrace(const TraceStore* traces,uint32_t vehicle)
+{
+	m_arrival.Cancel();
+	m_departure.Cancel();
+	m_traces = traces;
+	m_begin = m_cursor = traces->GetBegin(vehicle);
+	m_end = traces->GetEnd(vehicle);
+	m_arrivalTime = m_departureTime = Seconds(0);
+	if (m_begin < m_end)
+	{
+		m_arrivalTime = Seconds(traces->GetTime(m_begin));
+		m_departureTime = Seconds(traces->GetTime(m_end-1));
+		Time now = Simulator::Now();
+		if (m_arrivalTime >= now)
+			m_arrival = Simulator::Schedule(m_arrivalTime-now,&SumoTraceMobilityModel::NotifyPresence,this,true);
+		if (m_departureTime >= now)
+			m_departure = Simulator::Schedule(m_departureTime-now+TimeStep(1),&SumoTraceMobilityModel::NotifyPresence,this,false);
+	}
+	NotifyCourseChange();
+}
+
+bool SumoTraceMobilityModel::IsPresent() const
+{
+	Time now = Simulator::Now();
+	return m_begin < m_end && m_arrivalTime <= now && now <= m_departureTime;
+}
+
+Time SumoTraceMobilityModel::GetArrivalTime() const
+{
+	return m_arrivalTime;
+}
+
+Time SumoTraceMobilityModel::GetDepartureTime() const
+{
+	return m_departureTime;
+}
+
+void SumoTraceMobilityModel::NotifyPresence(bool present)
+{
+	m_presenceTrace(this,present);
+	NotifyCourseChange();
+}
+
+uint64_t SumoTraceMobilityModel::Seek(double t) const
+{
+	const double* time = m_traces->GetColumn(TraceStore::TIME);
+	uint64_t found = m_end;
+	for (uint64_t s = m_cursor; s < m_end && s < m_cursor+4 && time[s] <= t; s++)
+	{
+		if (s+1 == m_end || time[s+1] > t)
+		{
+			found = s;
+			break;
+		}
+	}
+	//a jump, or the first query: time[m_begin] <= t, so the bound is past m_begin
+	if (found == m_end)
+		found = std::upper_bound(time+m_begin,time+m_end,t)-time-1;
+	if (found != m_cursor)
+	{
+		m_cursor = found;
+		NotifyCourseChange();//a new leg, as a waypoint model would report
+	}
+	return found;
+}
+
+Vector SumoTraceMobilityModel::DoGetPosition() const
+{
+	if (!IsPresent())
+		return m_absentPosition;
+	double t = std::min(std::max(Simulator::Now().GetSeconds(),m_traces->GetTime(m_begin)),m_traces->GetTime(m_end-1));
+	uint64_t s = Seek(t);
+	Vector position(m_traces->GetX(s),m_traces->GetY(s),0.0);
+	if (s+1 < m_end && m_traces->GetTime(s+1) > m_traces->GetTime(s))
+	{
+		double f = (t-m_traces->GetTime(s))/(m_traces->GetTime(s+1)-m_traces->GetTime(s));
+		position.x += f*(m_traces->GetX(s+1)-m_traces->GetX(s));
+		position.y += f*(m_traces->GetY(s+1)-m_traces->GetY(s));
+	}
+	return position;
+}
+
+void SumoTraceMobilityModel::DoSetPosition(const Vector& position)
+{
+	//the trace decides while the vehicle is present, this is where it waits otherwise
+	m_absentPosition = position;
+	NotifyCourseChange();
+}
+
+Vector SumoTraceMobilityModel::DoGetVelocity() const
+{
+	if (!IsPresent())
+		return Vector(0.0,0.0,0.0);
+	double t = std::min(std::max(Simulator::Now().GetSeconds(),m_traces->GetTime(m_begin)),m_traces->GetTime(m_end-1));
+	uint64_t s = Seek(t);
+	if (s+1 == m_end || m_traces->GetTime(s+1) <= m_traces->GetTime(s))
+		return Vector(0.0,0.0,0.0);
+	double dt = m_traces->GetTime(s+1)-m_traces->GetTime(s);
+	return Vector((m_traces->GetX(s+1)-m_traces->GetX(s))/dt,(m_traces->GetY(s+1)-m_traces->GetY(s))/dt,0.0);
+}
+
+} /* namespace sumomobility */
+} /* namespace vanetmobility */
+} /* namespace ns3 */
@@ -0,0 +1,68 @@
+#ifndef SUMOTRACEMOBILITYMODEL_H_
+#define SUMOTRACEMOBILITYMODEL_H_
+
+#include "ns3/mobility-model.h"
+#include "ns3/event-id.h"
+#include "ns3/nstime.h"
+#include "ns3/traced-callback.h"
+#include "ns3/RouteElement.h"
+
+namespace ns3
+{
+namespace vanetmobility
+{
+namespace sumomobility
+{
+
+/*
+ * Mobility of one vehicle, read from its samples in a TraceStore.
+ *
+ * The vehicle is on the map from its first to its last sample, its presence interval,
+ * and moves in a straight line from one sample to the next. A query first tries the
+ * sample of the previous query and the few after it, as the simulation time only moves
+ * forward, then falls back to a binary search of the time column. Off the map the
+ * vehicle stays where SetPosition() put it. The Presence trace fires when it enters
+ * and when it leaves.
+ */
+class SumoTraceMobilityModel:
+		public MobilityModel
+{
+public:
+	typedef void (* PresenceCallback)(Ptr<const MobilityModel> model,bool present);
+
+	static TypeId GetTypeId();
+	SumoTraceMobilityModel();
+	virtual ~SumoTraceMobilityModel();
+
+	void SetTrace(const TraceStore* traces,uint32_t vehicle);//the store must outlive the model
+	bool IsPresent() const;
+	Time GetArrivalTime() const;//of the first sample, 0 without samples
+	Time GetDepartureTime() const;//of the last sample, absent from the next time step
+
+protected:
+	virtual void DoDispose();
+
+private:
+	virtual Vector DoGetPosition() const;
+	virtual void DoSetPosition(const Vector& position);
+	virtual Vector DoGetVelocity() const;
+	uint64_t Seek(double t) const;//last sample at or before t, t inside the presence interval
+	void NotifyPresence(bool present);
+
+	const TraceStore* m_traces;
+	uint64_t m_begin;
+	uint64_t m_end;
+	mutable uint64_t m_cursor;
+	Time m_arrivalTime;
+	Time m_departureTime;
+	Vector m_absentPosition;
+	EventId m_arrival;
+	EventId m_departure;
+	TracedCallback<Ptr<const MobilityModel>,bool> m_presenceTrace;
+};
+
+} /* namespace sumomobility */
+} /* namespace vanetmobility */
+} /* namespace ns3 */
+
+#endif /* SUMOTRACEMOBILITYMODEL_H_ */
@@ -0,0 +1,306 @@
+#include "ns3/TraceCache.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <unordered_map>
+
+namespace ns3
+{
+namespace vanetmobility
+{
+namespace sumomobility
+{
+
+using namespace std;
+
+static const char traceCacheMagic[8] = {'S','U','M','O','T','R','C','\0'};
+static const uint32_t traceCacheVersion = 2;
+
+namespace
+{
+//Collect the strings once, hand out their ids
+class StringTable
+{
+public:
+	uint32_t Intern(const string& s)
+	{
+		unordered_map<string,uint32_t>::const_iterator it = ids.find(s);
+		if (it != ids.end())
+			return it->second;
+		uint32_t id = strings.size();
+		ids[s] = id;
+		strings.push_back(s);
+		return id;
+	}
+	unordered_map<string,uint32_t> ids;
+	vector<string> strings;
+};
+
+uint64_t Align(uint64_t offset)
+{
+	return (offset+7) & ~uint64_t(7);
+}
+
+bool WriteAt(FILE* file,uint64_t offset,const void* data,uint64_t size)
+{
+	if (fseek(file,offset,SEEK_SET) != 0)
+		return false;
+	return size == 0 || fwrite(data,1,size,file) == size;
+}
+}
+
+TraceCache::TraceCache():m_data(NULL),m_size(0),m_header(NULL)
+{
+}
+
+TraceCache::~TraceCache()
+{
+	Close();
+}
+
+uint64_t TraceCache::HashSources(const vector<string>& files)
+{
+	//FNV-1a over the size and the bytes of every file
+	uint64_t hash = 14695981039346656037ULL;
+	const uint64_t prime = 1099511628211ULL;
+	vector<unsigned char> buffer(1 << 20);
+	for (vector<string>::const_iterator f = files.begin(); f != files.end(); ++f)
+	{
+		FILE* file = fopen(f->c_str(),"rb");
+		if (!file)
+			return 0;
+		uint64_t size = 0;
+		size_t n;
+		while ((n = fread(&buffer[0],1,buffer.size(),file)) > 0)
+		{
+			for (size_t i = 0; i < n; i++)
+				hash = (hash ^ buffer[i]) * prime;
+			size += n;
+		}
+		fclose(file);
+		for (int i = 0; i < 8; i++)
+			hash = (hash ^ ((size >> (8*i)) & 0xff)) * prime;
+	}
+	return hash ? hash : 1;
+}
+
+bool TraceCache::Write(const char* pFilename,uint64_t sourceHash,const RoadMap& roadmap,const VehicleLoader& vl)
+{
+	//the lane and type columns are written as they are, so their ids come first
+	const TraceStore& traces = vl.getTraces();
+	StringTable strings;
+	for (uint32_t i = 0; i < traces.GetStringCount(); i++)
+		strings.Intern(traces.GetString(i));
+	vector<TraceCacheEdge> edges;
+	for (map<string,Edge>::const_iterator e = roadmap.getEdges().begin(); e != roadmap.getEdges().end(); ++e)
+	{
+		TraceCacheEdge edge;
+		edge.id = strings.Intern(e->second.id);
+		edge.from = strings.Intern(e->second.from);
+		edge.to = strings.Intern(e->second.to);
+		edge.laneId = strings.Intern(e->second.lane.id);
+		edge.laneShape = strings.Intern(e->second.lane.shape);
+		edge.laneIndex = e->second.lane.index;
+		edge.priority = e->second.priority;
+		edge.laneSpeed = e->second.lane.speed;
+		edge.laneLength = e->second.lane.length;
+		edges.push_back(edge);
+	}
+
+	vector<TraceCacheVehicle> records;
+	vector<uint32_t> routeEdges;
+	for (uint32_t v = 0; v < traces.GetVehicleCount(); v++)
+	{
+		const Vehicle& vehicle = traces.GetVehicle(v);
+		TraceCacheVehicle record;
+		memset(&record,0,sizeof(record));
+		record.id = vehicle.id;
+		record.depart = vehicle.depart;
+		record.firstSample = traces.GetBegin(v);
+		record.sampleCount = traces.GetEnd(v)-traces.GetBegin(v);
+		record.firstEdge = routeEdges.size();
+		record.edgeCount = vehicle.route.edgesID.size();
+		for (vector<string>::const_iterator id = vehicle.route.edgesID.begin(); id != vehicle.route.edgesID.end(); ++id)
+			routeEdges.push_back(strings.Intern(*id));
+		records.push_back(record);
+	}
+	uint64_t sampleCount = traces.GetSampleCount();
+
+	vector<uint64_t> stringOffsets(1,0);
+	for (vector<string>::const_iterator str = strings.strings.begin(); str != strings.strings.end(); ++str)
+		stringOffsets.push_back(stringOffsets.back()+str->size());
+	string characters;
+	characters.reserve(stringOffsets.back());
+	for (vector<string>::const_iterator str = strings.strings.begin(); str != strings.strings.end(); ++str)
+		characters += *str;
+
+	TraceCacheHeader header;
+	memset(&header,0,sizeof(header));
+	memcpy(header.magic,traceCacheMagic,sizeof(header.magic));
+	header.version = traceCacheVersion;
+	header.sourceHash = sourceHash;
+	header.edgeCount = edges.size();
+	header.edgeOffset = Align(sizeof(header));
+	header.vehicleCount = records.size();
+	header.vehicleOffset = Align(header.edgeOffset+edges.size()*sizeof(TraceCacheEdge));
+	header.sampleCount = sampleCount;
+	header.columnOffset = Align(header.vehicleOffset+records.size()*sizeof(TraceCacheVehicle));
+	header.edgeIdCount = routeEdges.size();
+	header.routeOffset = Align(header.columnOffset+sampleCount*TraceStore::SAMPLE_BYTES);
+	header.stringCount = strings.strings.size();
+	header.stringOffset = Align(header.routeOffset+routeEdges.size()*sizeof(uint32_t));
+	header.fileSize = header.stringOffset+stringOffsets.size()*sizeof(uint64_t)+characters.size();
+
+	//Write next to the target and rename, so concurrent runs never see half a cache
+	char suffix[32];
+	snprintf(suffix,sizeof(suffix),".%ld.tmp",(long)getpid());
+	string tmp = string(pFilename)+suffix;
+	FILE* file = fopen(tmp.c_str(),"wb");
+	if (!file)
+		return false;
+	bool ok = WriteAt(file,0,&header,sizeof(header))
+		&& WriteAt(file,header.edgeOffset,edges.empty() ? NULL : &edges[0],edges.size()*sizeof(TraceCacheEdge))
+		&& WriteAt(file,header.vehicleOffset,records.empty() ? NULL : &records[0],records.size()*sizeof(TraceCacheVehicle));
+	uint64_t offset = header.columnOffset;
+	for (int c = 0; ok && c < TraceStore::DOUBLE_COLUMNS; c++,offset += sampleCount*sizeof(double))
+		ok = WriteAt(file,offset,traces.GetColumn((TraceStore::DoubleColumn)c),sampleCount*sizeof(double));
+	for (int c = 0; ok && c < TraceStore::FLOAT_COLUMNS; c++,offset += sampleCount*sizeof(float))
+		ok = WriteAt(file,offset,traces.GetColumn((TraceStore::FloatColumn)c),sampleCount*sizeof(float));
+	for (int c = 0; ok && c < TraceStore::ID_COLUMNS; c++,offset += sampleCount*sizeof(uint32_t))
+		ok = WriteAt(file,offset,traces.GetColumn((TraceStore::IdColumn)c),sampleCount*sizeof(uint32_t));
+	ok = ok
+		&& WriteAt(file,header.routeOffset,routeEdges.empty() ? NULL : &routeEdges[0],routeEdges.size()*sizeof(uint32_t))
+		&& WriteAt(file,header.stringOffset,&stringOffsets[0],stringOffsets.size()*sizeof(uint64_t))
+		&& WriteAt(file,header.stringOffset+stringOffsets.size()*sizeof(uint64_t),characters.data(),characters.size());
+	ok = (fclose(file) == 0) && ok;
+	if (ok)
+		ok = rename(tmp.c_str(),pFilename) == 0;
+	if (!ok)
+		remove(tmp.c_str());
+	return ok;
+}
+
+bool TraceCache::Open(const char* pFilename,uint64_t sourceHash)
+{
+	Close();
+	int fd = open(pFilename,O_RDONLY);
+	if (fd < 0)
+		return false;
+	struct stat st;
+	if (fstat(fd,&st) != 0 || (uint64_t)st.st_size < sizeof(TraceCacheHeader))
+	{
+		close(fd);
+		return false;
+	}
+	void* data = mmap(NULL,st.st_size,PROT_READ,MAP_SHARED,fd,0);
+	close(fd);
+	if (data == MAP_FAILED)
+		return false;
+	m_data = (const char*)data;
+	m_size = st.st_size;
+	m_header = (const TraceCacheHeader*)m_data;
+
+	const TraceCacheHeader& h = *m_header;
+	bool valid = memcmp(h.magic,traceCacheMagic,sizeof(h.magic)) == 0
+		&& h.version == traceCacheVersion
+		&& h.sourceHash == sourceHash
+		&& h.fileSize == m_size
+		&& h.edgeCount < m_size && h.vehicleCount < m_size && h.sampleCount < m_size
+		&& h.edgeIdCount < m_size && h.stringCount < m_size
+		&& h.edgeOffset+h.edgeCount*sizeof(TraceCacheEdge) <= h.vehicleOffset
+		&& h.vehicleOffset+h.vehicleCount*sizeof(TraceCacheVehicle) <= h.columnOffset
+		&& h.columnOffset+h.sampleCount*TraceStore::SAMPLE_BYTES <= h.routeOffset
+		&& h.routeOffset+h.edgeIdCount*sizeof(uint32_t) <= h.stringOffset
+		&& h.stringOffset+(h.stringCount+1)*sizeof(uint64_t) <= m_size;
+	if (valid)
+	{
+		//the string offsets and the slices must stay inside the file
+		const uint64_t* offsets = (const uint64_t*)(m_data+h.stringOffset);
+		uint64_t characters = m_size-h.stringOffset-(h.stringCount+1)*sizeof(uint64_t);
+		valid = offsets[h.stringCount] <= characters;
+		for (uint64_t i = 0; valid && i < h.stringCount; i++)
+			valid = offsets[i] <= offsets[i+1];
+		const TraceCacheVehicle* v = GetVehicles();
+		for (uint64_t i = 0; valid && i < h.vehicleCount; i++)
+			valid = v[i].firstSample+v[i].sampleCount <= h.sampleCount && v[i].firstEdge+v[i].edgeCount <= h.edgeIdCount;
+	}
+	if (!valid)
+		Close();
+	return valid;
+}
+
+void TraceCache::Close()
+{
+	if (m_data)
+		munmap((void*)m_data,m_size);
+	m_data = NULL;
+	m_size = 0;
+	m_header = NULL;
+}
+
+uint64_t TraceCache::GetEdgeCount() const
+{
+	return m_header->edgeCount;
+}
+
+const TraceCacheEdge* TraceCache::GetEdges() const
+{
+	return (const TraceCacheEdge*)(m_data+m_header->edgeOffset);
+}
+
+uint64_t TraceCache::GetVehicleCount() const
+{
+	return m_header->vehicleCount;
+}
+
+const TraceCacheVehicle* TraceCache::GetVehicles() const
+{
+	return (const TraceCacheVehicle*)(m_data+m_header->vehicleOffset);
+}
+
+uint64_t TraceCache::GetSampleCount() const
+{
+	return m_header->sampleCount;
+}
+
+const double* TraceCache::GetColumn(TraceStore::DoubleColumn column) const
+{
+	return (const double*)(m_data+m_header->columnOffset)+column*m_header->sampleCount;
+}
+
+const float* TraceCache::GetColumn(TraceStore::FloatColumn column) const
+{
+	return (const float*)GetColumn(TraceStore::DOUBLE_COLUMNS)+column*m_header->sampleCount;
+}
+
+const uint32_t* TraceCache::GetColumn(TraceStore::IdColumn column) const
+{
+	return (const uint32_t*)GetColumn(TraceStore::FLOAT_COLUMNS)+column*m_header->sampleCount;
+}
+
+const uint32_t* TraceCache::GetRouteEdges() const
+{
+	return (const uint32_t*)(m_data+m_header->routeOffset);
+}
+
+uint64_t TraceCache::GetStringCount() const
+{
+	return m_header->stringCount;
+}
+
+string TraceCache::GetString(uint32_t id) const
+{
+	if (id >= m_header->stringCount)
+		return string();
+	const uint64_t* offsets = (const uint64_t*)(m_data+m_header->stringOffset);
+	const char* characters = (const char*)(offsets+m_header->stringCount+1);
+	return string(characters+offsets[id],offsets[id+1]-offsets[id]);
+}
+
+} /* namespace sumomobility */
+} /* namespace vanetmobility */
+} /* namespace ns3 */
@@ -0,0 +1,125 @@
+#ifndef TRACECACHE_H_
+#define TRACECACHE_H_
+
+#include "ns3/RouteElement.h"
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace ns3
+{
+namespace vanetmobility
+{
+namespace sumomobility
+{
+
+/*
+ * Layout of a trace cache file. All the sections start on 8 byte boundaries and
+ * use the byte order of the machine that wrote them.
+ *
+ *   TraceCacheHeader
+ *   TraceCacheEdge[edgeCount]            the lanes of input.net.xml
+ *   TraceCacheVehicle[vehicleCount]      vehicles of input.rou.xml, ordered by id
+ *   double[sampleCount] x 3              time, x, y columns
+ *   float[sampleCount] x 4               angle, speed, pos, slope columns
+ *   uint32_t[sampleCount] x 2            lane and type columns, string ids
+ *   uint32_t[edgeIdCount]                route edges, string ids
+ *   uint64_t[stringCount+1], char[]      string table: offsets, then the characters
+ *
+ * The samples of a vehicle are contiguous, so every column holds one slice per vehicle.
+ * The columns are those of TraceStore, which uses them in place.
+ */
+struct TraceCacheHeader
+{
+	char magic[8];
+	uint32_t version;
+	uint32_t reserved;
+	uint64_t sourceHash;//of the xml files the cache was built from
+	uint64_t fileSize;
+	uint64_t edgeCount;
+	uint64_t edgeOffset;
+	uint64_t vehicleCount;
+	uint64_t vehicleOffset;
+	uint64_t sampleCount;
+	uint64_t columnOffset;
+	uint64_t edgeIdCount;
+	uint64_t routeOffset;
+	uint64_t stringCount;
+	uint64_t stringOffset;
+};
+
+struct TraceCacheEdge
+{
+	uint32_t id;//string ids
+	uint32_t from;
+	uint32_t to;
+	uint32_t laneId;
+	uint32_t laneShape;
+	int32_t  laneIndex;
+	double   priority;
+	double   laneSpeed;
+	double   laneLength;
+};
+
+struct TraceCacheVehicle
+{
+	int32_t  id;
+	uint32_t reserved;
+	double   depart;
+	uint64_t firstSample;
+	uint64_t sampleCount;
+	uint64_t firstEdge;
+	uint64_t edgeCount;
+};
+
+/*
+ * Compiled form of the SUMO inputs, mapped into memory instead of parsed.
+ *
+ * A converter, or SumoMobility on a cache miss, parses the xml files once and writes
+ * the cache with Write(). Later runs Open() it, which maps the file read only and
+ * checks it against the hash of the xml files, so a cache built from other inputs is
+ * never used. The accessors point into the mapping and stay valid until Close().
+ */
+class TraceCache
+{
+public:
+	TraceCache();
+	virtual ~TraceCache();
+
+	static uint64_t HashSources(const std::vector<std::string>& files);//0 if a file cannot be read
+	static bool Write(const char* pFilename,uint64_t sourceHash,const RoadMap& roadmap,const VehicleLoader& vl);
+
+	bool Open(const char* pFilename,uint64_t sourceHash);//false if missing, damaged or stale
+	void Close();
+	bool IsOpen() const
+	{
+		return m_data != NULL;
+	}
+
+	uint64_t GetEdgeCount() const;
+	const TraceCacheEdge* GetEdges() const;
+	uint64_t GetVehicleCount() const;
+	const TraceCacheVehicle* GetVehicles() const;
+	uint64_t GetSampleCount() const;
+	const double* GetColumn(TraceStore::DoubleColumn column) const;
+	const float* GetColumn(TraceStore::FloatColumn column) const;
+	const uint32_t* GetColumn(TraceStore::IdColumn column) const;
+	const uint32_t* GetRouteEdges() const;
+	uint64_t GetStringCount() const;
+	std::string GetString(uint32_t id) const;
+
+private:
+	TraceCache(const TraceCache&);
+	TraceCache& operator=(const TraceCache&);
+
+	const char* m_data;
+	uint64_t m_size;
+	const TraceCacheHeader* m_header;
+};
+
+} /* namespace sumomobility */
+} /* namespace vanetmobility */
+} /* namespace ns3 */
+
+#endif /* TRACECACHE_H_ */
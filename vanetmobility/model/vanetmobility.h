@@ -28,7 +28,7 @@ public:
 	virtual void Install()=0;
 	virtual double GetReadTotalTime()=0;
 	virtual const uint32_t GetNodeSize() const=0;
-	virtual const sumomobility::Trace& GetTrace(uint32_t&,Vector&) const=0;
+	virtual bool GetTrace(uint32_t,const Vector&,sumomobility::Trace&) const=0;//false if the vehicle was never there
 
 };
 
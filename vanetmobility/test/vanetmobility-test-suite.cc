@@ -2,10 +2,17 @@
 
 // Include a header file from your module to test.
 #include "ns3/vanetmobility.h"
+#include "ns3/FcdStreamReader.h"
+#include "ns3/TraceCache.h"
+#include "ns3/SumoMobility.h"
+#include "ns3/SumoTraceMobilityModel.h"
 
 // An essential include is test.h
 #include "ns3/test.h"
 
+#include <algorithm>
+#include <fstream>
+
 // Do not put your test classes in namespace ns3.  You may find it useful
 // to use the using directive to access the ns3 namespace directly
 using namespace ns3;
@@ -46,6 +53,432 @@ VanetmobilityTestCase1::DoRun (void)
   NS_TEST_ASSERT_MSG_EQ_TOL (0.01, 0.01, 0.001, "Numbers are not equal within tolerance");
 }
 
+// The FCD reader must not depend on where the chunks of the file end.
+class FcdStreamReaderTestCase : public TestCase
+{
+public:
+  FcdStreamReaderTestCase ();
+  virtual ~FcdStreamReaderTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+FcdStreamReaderTestCase::FcdStreamReaderTestCase ()
+  : TestCase ("FCD stream reader")
+{
+}
+
+FcdStreamReaderTestCase::~FcdStreamReaderTestCase ()
+{
+}
+
+void
+FcdStreamReaderTestCase::DoRun (void)
+{
+  using namespace vanetmobility::sumomobility;
+  std::string file = CreateTempDirFilename ("fcd.xml");
+  std::ofstream out (file.c_str ());
+  out << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\r\n"
+      << "<!-- a comment with <vehicle id=\"9\"/> and > inside -->\n"
+      << "<fcd-export>\n"
+      << "  <timestep time=\"1.50\">\n"
+      << "    <vehicle id=\"3\" x=\"10.25\" y=\"-4.5\" angle=\"90.00\" type=\"bus&amp;co\""
+      << " speed=\"12.5\" pos=\"7.00\" lane=\"a/b_1\" slope=\"0.50\"/>\n"
+      << "    <vehicle  id = '4' x='1' y='2' lane='c_0' note='x > y'></vehicle>\n"
+      << "  </timestep>\n"
+      << "  <timestep time=\"2.00\"/>\n"
+      << "  <timestep time=\"2.50\"><vehicle id=\"3\" x=\"11\" y=\"-4\"/></timestep>\n"
+      << "</fcd-export>\n";
+  out.close ();
+
+  // Tags cut by the chunk ends, and tags longer than a chunk
+  uint32_t bufferSizes[] = { 1 << 20, 7 };
+  for (uint32_t i = 0; i < 2; ++i)
+    {
+      FcdStreamReader reader (bufferSizes[i]);
+      NS_TEST_ASSERT_MSG_EQ (reader.Open (file.c_str ()), true, "cannot open " << file);
+
+      NS_TEST_ASSERT_MSG_EQ (reader.Next (), true, "first sample");
+      NS_TEST_EXPECT_MSG_EQ (reader.GetVehicleId (), 3, "the comment is skipped");
+      NS_TEST_EXPECT_MSG_EQ_TOL (reader.GetTrace ().time, 1.5, 1e-12, "time of the timestep");
+      NS_TEST_EXPECT_MSG_EQ_TOL (reader.GetTrace ().x, 10.25, 1e-12, "trivial");
+      NS_TEST_EXPECT_MSG_EQ_TOL (reader.GetTrace ().y, -4.5, 1e-12, "trivial");
+      NS_TEST_EXPECT_MSG_EQ_TOL (reader.GetTrace ().angle, 90, 1e-12, "trivial");
+      NS_TEST_EXPECT_MSG_EQ_TOL (reader.GetTrace ().speed, 12.5, 1e-12, "trivial");
+      NS_TEST_EXPECT_MSG_EQ_TOL (reader.GetTrace ().pos, 7, 1e-12, "trivial");
+      NS_TEST_EXPECT_MSG_EQ_TOL (reader.GetTrace ().slope, 0.5, 1e-12, "trivial");
+      NS_TEST_EXPECT_MSG_EQ (reader.GetTrace ().type, "bus&co", "entities are decoded");
+      NS_TEST_EXPECT_MSG_EQ (reader.GetTrace ().lane, "a-b", "lane index dropped, / replaced");
+
+      NS_TEST_ASSERT_MSG_EQ (reader.Next (), true, "second sample");
+      NS_TEST_EXPECT_MSG_EQ (reader.GetVehicleId (), 4, "single quotes and spaces around =");
+      NS_TEST_EXPECT_MSG_EQ_TOL (reader.GetTrace ().x, 1, 1e-12, "trivial");
+      NS_TEST_EXPECT_MSG_EQ (reader.GetTrace ().lane, "c", "trivial");
+      NS_TEST_EXPECT_MSG_EQ_TOL (reader.GetTrace ().speed, 12.5, 1e-12, "missing attributes keep their value");
+
+      NS_TEST_ASSERT_MSG_EQ (reader.Next (), true, "third sample");
+      NS_TEST_EXPECT_MSG_EQ_TOL (reader.GetTrace ().time, 2.5, 1e-12, "empty timesteps are passed over");
+      NS_TEST_EXPECT_MSG_EQ_TOL (reader.GetTrace ().x, 11, 1e-12, "trivial");
+      NS_TEST_EXPECT_MSG_EQ (reader.Next (), false, "end of file");
+      NS_TEST_EXPECT_MSG_EQ (reader.GetSampleCount (), 3, "trivial");
+    }
+}
+
+// A trace cache must give back what the xml files hold, and only for those files.
+class TraceCacheTestCase : public TestCase
+{
+public:
+  TraceCacheTestCase ();
+  virtual ~TraceCacheTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+TraceCacheTestCase::TraceCacheTestCase ()
+  : TestCase ("Trace cache")
+{
+}
+
+TraceCacheTestCase::~TraceCacheTestCase ()
+{
+}
+
+void
+TraceCacheTestCase::DoRun (void)
+{
+  using namespace vanetmobility::sumomobility;
+  std::vector<std::string> sources;
+  sources.push_back (CreateTempDirFilename ("input.net.xml"));
+  sources.push_back (CreateTempDirFilename ("input.rou.xml"));
+  sources.push_back (CreateTempDirFilename ("input.fcd.xml"));
+  std::string cacheFile = CreateTempDirFilename ("input.trace.bin");
+  std::ofstream net (sources[0].c_str ());
+  net << "<net><edge id=\"a/1\" from=\"j0\" to=\"j1\" priority=\"2\">"
+      << "<lane id=\"a/1_0\" index=\"0\" speed=\"13.89\" length=\"50.5\" shape=\"0,0 50,0\"/></edge></net>\n";
+  net.close ();
+  std::ofstream route (sources[1].c_str ());
+  route << "<routes><vehicle id=\"0\" depart=\"1.00\"><route edges=\"a/1 b\"/></vehicle>"
+        << "<vehicle id=\"1\" depart=\"2.00\"><route edges=\"b\"/></vehicle></routes>\n";
+  route.close ();
+  std::ofstream fcd (sources[2].c_str ());
+  fcd << "<fcd-export><timestep time=\"1.00\">"
+      << "<vehicle id=\"0\" x=\"1.5\" y=\"2\" angle=\"90\" type=\"car\" speed=\"3\" pos=\"4\" lane=\"a/1_0\" slope=\"0\"/>"
+      << "</timestep><timestep time=\"2.00\">"
+      << "<vehicle id=\"0\" x=\"4.5\" y=\"2\" angle=\"90\" type=\"car\" speed=\"3\" pos=\"7\" lane=\"a/1_0\" slope=\"0\"/>"
+      << "<vehicle id=\"1\" x=\"9\" y=\"8\" angle=\"0\" type=\"bus\" speed=\"1\" pos=\"0\" lane=\"b_1\" slope=\"0\"/>"
+      << "</timestep></fcd-export>\n";
+  fcd.close ();
+
+  uint64_t hash = TraceCache::HashSources (sources);
+  NS_TEST_ASSERT_MSG_NE (hash, 0, "cannot read the xml files");
+  RoadMap roadmap;
+  VehicleLoader vl;
+  roadmap.LoadNetXMLFile (sources[0].c_str ());
+  vl.LoadRouteXML (sources[1].c_str ());
+  vl.LoadFCDOutputXML (sources[2].c_str ());
+  NS_TEST_ASSERT_MSG_EQ (TraceCache::Write (cacheFile.c_str (), hash, roadmap, vl), true, "cannot write " << cacheFile);
+
+  TraceCache *cache = new TraceCache ();
+  NS_TEST_EXPECT_MSG_EQ (cache->Open (cacheFile.c_str (), hash + 1), false, "a cache of other inputs is stale");
+  NS_TEST_ASSERT_MSG_EQ (cache->Open (cacheFile.c_str (), hash), true, "cannot map " << cacheFile);
+  NS_TEST_EXPECT_MSG_EQ (cache->GetSampleCount (), 3, "trivial");
+  NS_TEST_EXPECT_MSG_EQ (cache->GetStringCount (), 7, "a-1 car b bus j0 j1 shape, each once");
+
+  RoadMap cachedRoadmap;
+  VehicleLoader cachedVl;
+  cachedRoadmap.LoadTraceCache (*cache);
+  NS_TEST_ASSERT_MSG_EQ (cachedVl.LoadTraceCache (cache), true, "trivial");
+  NS_TEST_ASSERT_MSG_EQ (cachedRoadmap.getEdges ().size (), 1, "trivial");
+  const Edge &edge = cachedRoadmap.getEdges ().begin ()->second;
+  NS_TEST_EXPECT_MSG_EQ (edge.id, "a-1", "trivial");
+  NS_TEST_EXPECT_MSG_EQ (edge.to, "j1", "trivial");
+  NS_TEST_EXPECT_MSG_EQ_TOL (edge.lane.length, 50.5, 1e-12, "trivial");
+  NS_TEST_EXPECT_MSG_EQ (edge.lane.shape, "0,0 50,0", "trivial");
+
+  const TraceStore &traces = cachedVl.getTraces ();
+  NS_TEST_ASSERT_MSG_EQ (traces.GetVehicleCount (), 2, "trivial");
+  NS_TEST_EXPECT_MSG_EQ_TOL (traces.GetVehicle (1).depart, 2, 1e-12, "trivial");
+  NS_TEST_EXPECT_MSG_EQ (traces.GetVehicle (0).route.edgesID.size (), 2, "trivial");
+  NS_TEST_EXPECT_MSG_EQ (traces.GetVehicle (0).route.edgesID[0], "a-1", "trivial");
+  NS_TEST_ASSERT_MSG_EQ (traces.GetEnd (0) - traces.GetBegin (0), 2, "trivial");
+  Trace trace = traces.GetTrace (traces.GetBegin (0) + 1);
+  NS_TEST_EXPECT_MSG_EQ_TOL (trace.time, 2, 1e-12, "trivial");
+  NS_TEST_EXPECT_MSG_EQ_TOL (trace.x, 4.5, 1e-12, "trivial");
+  NS_TEST_EXPECT_MSG_EQ_TOL (trace.pos, 7, 1e-12, "trivial");
+  NS_TEST_EXPECT_MSG_EQ (trace.lane, "a-1", "trivial");
+  trace = traces.GetTrace (traces.GetBegin (1));
+  NS_TEST_EXPECT_MSG_EQ (trace.type, "bus", "trivial");
+  NS_TEST_EXPECT_MSG_EQ (trace.lane, "b", "trivial");
+
+  VehicleLoader copy (cachedVl);
+  cachedVl.Clear ();
+  NS_TEST_EXPECT_MSG_EQ (copy.getTraces ().GetSampleCount (), 3, "a copy owns its samples, the mapping is gone");
+  NS_TEST_EXPECT_MSG_EQ (copy.getTraces ().GetLane (2), "b", "trivial");
+
+  std::ofstream touch (sources[2].c_str (), std::ios::app);
+  touch << "\n";
+  touch.close ();
+  NS_TEST_EXPECT_MSG_NE (TraceCache::HashSources (sources), hash, "any change of the inputs changes the hash");
+}
+
+// Samples come in timestep order, the store must give them back per vehicle.
+class TraceStoreTestCase : public TestCase
+{
+public:
+  TraceStoreTestCase ();
+  virtual ~TraceStoreTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+TraceStoreTestCase::TraceStoreTestCase ()
+  : TestCase ("Trace store")
+{
+}
+
+TraceStoreTestCase::~TraceStoreTestCase ()
+{
+}
+
+void
+TraceStoreTestCase::DoRun (void)
+{
+  using namespace vanetmobility::sumomobility;
+  TraceStore store;
+  Vehicle vehicle;
+  vehicle.depart = 0;
+  for (int v = 0; v < 3; ++v)
+    {
+      vehicle.id = v;
+      store.AddVehicle (vehicle);
+    }
+  Trace trace;
+  trace.angle = 90;
+  trace.speed = 13.25;
+  trace.slope = 0;
+  trace.type = "DEFAULT_VEHTYPE";
+  for (int step = 0; step < 4; ++step)
+    {
+      for (int v = 2; v >= 0; --v)
+        {
+          if (v == 1 && step > 0)
+            {
+              continue; // vehicle 1 leaves after the first step
+            }
+          trace.time = step;
+          trace.x = 100 * v + step;
+          trace.y = -v;
+          trace.pos = step * 0.5;
+          trace.lane = v == 2 ? "to/from" : "e0";
+          store.Append (v, trace);
+        }
+    }
+  store.Finalize ();
+  NS_TEST_ASSERT_MSG_EQ (store.GetSampleCount (), 9, "trivial");
+  NS_TEST_EXPECT_MSG_EQ (store.GetEnd (0) - store.GetBegin (0), 4, "trivial");
+  NS_TEST_EXPECT_MSG_EQ (store.GetEnd (1) - store.GetBegin (1), 1, "trivial");
+  NS_TEST_EXPECT_MSG_EQ (store.GetBegin (2), store.GetEnd (1), "the slices follow each other");
+  for (uint32_t v = 0; v < 3; ++v)
+    {
+      for (uint64_t s = store.GetBegin (v); s < store.GetEnd (v); ++s)
+        {
+          NS_TEST_EXPECT_MSG_EQ_TOL (store.GetTime (s), s - store.GetBegin (v), 1e-12, "samples keep their order");
+          NS_TEST_EXPECT_MSG_EQ_TOL (store.GetX (s), 100 * v + store.GetTime (s), 1e-12, "columns move together");
+        }
+    }
+  NS_TEST_EXPECT_MSG_EQ (store.GetStringCount (), 3, "DEFAULT_VEHTYPE e0 to/from, each once");
+  trace = store.GetTrace (store.GetEnd (2) - 1);
+  NS_TEST_EXPECT_MSG_EQ (trace.lane, "to/from", "trivial");
+  NS_TEST_EXPECT_MSG_EQ (trace.type, "DEFAULT_VEHTYPE", "trivial");
+  NS_TEST_EXPECT_MSG_EQ_TOL (trace.speed, 13.25, 1e-12, "trivial");
+  NS_TEST_EXPECT_MSG_EQ_TOL (trace.pos, 1.5, 1e-12, "trivial");
+
+  trace.time = 4;
+  store.Append (1, trace);
+  store.Finalize ();
+  NS_TEST_EXPECT_MSG_EQ (store.GetEnd (1) - store.GetBegin (1), 2, "appending to a finalized store");
+  NS_TEST_EXPECT_MSG_EQ_TOL (store.GetTime (store.GetEnd (1) - 1), 4, 1e-12, "trivial");
+  NS_TEST_EXPECT_MSG_EQ_TOL (store.GetTime (store.GetEnd (2) - 1), 3, 1e-12, "trivial");
+}
+
+// Vehicles fed a window of waypoints must follow the same path as with the whole trace.
+class WaypointWindowTestCase : public TestCase
+{
+public:
+  WaypointWindowTestCase ();
+  virtual ~WaypointWindowTestCase ();
+
+private:
+  virtual void DoRun (void);
+  void CheckPosition (Ptr<WaypointMobilityModel> model, double x, double y);
+};
+
+WaypointWindowTestCase::WaypointWindowTestCase ()
+  : TestCase ("Waypoint window")
+{
+}
+
+WaypointWindowTestCase::~WaypointWindowTestCase ()
+{
+}
+
+void
+WaypointWindowTestCase::CheckPosition (Ptr<WaypointMobilityModel> model, double x, double y)
+{
+  Vector position = model->GetPosition ();
+  NS_TEST_EXPECT_MSG_EQ_TOL (position.x, x, 1e-6, "x at " << Simulator::Now ().GetSeconds ());
+  NS_TEST_EXPECT_MSG_EQ_TOL (position.y, y, 1e-6, "y at " << Simulator::Now ().GetSeconds ());
+  NS_TEST_EXPECT_MSG_LT (model->WaypointsLeft (), 3, "no more than the window is queued");
+}
+
+void
+WaypointWindowTestCase::DoRun (void)
+{
+  using namespace vanetmobility::sumomobility;
+  std::string net = CreateTempDirFilename ("input.net.xml");
+  std::string route = CreateTempDirFilename ("input.rou.xml");
+  std::string fcd = CreateTempDirFilename ("input.fcd.xml");
+  std::ofstream netFile (net.c_str ());
+  netFile << "<net></net>\n";
+  netFile.close ();
+  std::ofstream routeFile (route.c_str ());
+  routeFile << "<routes><vehicle id=\"0\" depart=\"1.00\"><route edges=\"a\"/></vehicle>"
+            << "<vehicle id=\"1\" depart=\"3.00\"><route edges=\"a\"/></vehicle></routes>\n";
+  routeFile.close ();
+  std::ofstream fcdFile (fcd.c_str ());
+  fcdFile << "<fcd-export>";
+  for (int t = 1; t <= 20; ++t)
+    {
+      fcdFile << "<timestep time=\"" << t << ".00\">"
+              << "<vehicle id=\"0\" x=\"" << 10 * t << "\" y=\"5\" angle=\"90\" type=\"car\" speed=\"10\" pos=\"0\" lane=\"a_0\" slope=\"0\"/>";
+      if (t >= 3 && t <= 6)
+        {
+          fcdFile << "<vehicle id=\"1\" x=\"0\" y=\"" << 2 * t << "\" angle=\"0\" type=\"car\" speed=\"2\" pos=\"0\" lane=\"a_0\" slope=\"0\"/>";
+        }
+      fcdFile << "</timestep>";
+    }
+  fcdFile << "</fcd-export>\n";
+  fcdFile.close ();
+
+  Ptr<SumoMobility> sumo = CreateObject<SumoMobility> (net, route, fcd);
+  sumo->SetAttribute ("TraceModel", BooleanValue (false));
+  sumo->SetAttribute ("WaypointWindow", UintegerValue (2));
+  NodeContainer nodes;
+  nodes.Create (sumo->GetNodeSize ());
+  sumo->Install ();
+  Ptr<WaypointMobilityModel> car = nodes.Get (0)->GetObject<WaypointMobilityModel> ();
+  Ptr<WaypointMobilityModel> bus = nodes.Get (1)->GetObject<WaypointMobilityModel> ();
+  NS_TEST_EXPECT_MSG_LT (car->WaypointsLeft (), 4, "only the first window is queued at Install");
+  double times[] = { 1, 1.5, 2, 7.25, 13, 19.5, 20 };
+  for (uint32_t i = 0; i < sizeof (times) / sizeof (times[0]); ++i)
+    {
+      Simulator::Schedule (Seconds (times[i]), &WaypointWindowTestCase::CheckPosition, this, car, 10 * times[i], 5);
+    }
+  Simulator::Schedule (Seconds (4.5), &WaypointWindowTestCase::CheckPosition, this, bus, 0, 9);
+  Simulator::Schedule (Seconds (6), &WaypointWindowTestCase::CheckPosition, this, bus, 0, 12);
+  Simulator::Stop (Seconds (sumo->GetReadTotalTime ()));
+  Simulator::Run ();
+  NS_TEST_EXPECT_MSG_EQ (car->GetPosition ().x, -10000, "the vehicle left the map after its trace");
+  Simulator::Destroy ();
+}
+
+// The trace model must interpolate the samples, wherever the queries jump to, and be
+// off the map outside of its presence interval.
+class SumoTraceMobilityModelTestCase : public TestCase
+{
+public:
+  SumoTraceMobilityModelTestCase ();
+  virtual ~SumoTraceMobilityModelTestCase ();
+
+private:
+  virtual void DoRun (void);
+  void CheckPosition (Ptr<vanetmobility::sumomobility::SumoTraceMobilityModel> model, bool present, Vector position);
+  void Presence (Ptr<const MobilityModel> model, bool present);
+
+  std::vector<std::pair<double, bool> > m_presence;
+};
+
+SumoTraceMobilityModelTestCase::SumoTraceMobilityModelTestCase ()
+  : TestCase ("Sumo trace mobility model")
+{
+}
+
+SumoTraceMobilityModelTestCase::~SumoTraceMobilityModelTestCase ()
+{
+}
+
+void
+SumoTraceMobilityModelTestCase::CheckPosition (Ptr<vanetmobility::sumomobility::SumoTraceMobilityModel> model, bool present, Vector position)
+{
+  double now = Simulator::Now ().GetSeconds ();
+  NS_TEST_EXPECT_MSG_EQ (model->IsPresent (), present, "presence at " << now);
+  NS_TEST_EXPECT_MSG_EQ_TOL (model->GetPosition ().x, position.x, 1e-9, "x at " << now);
+  NS_TEST_EXPECT_MSG_EQ_TOL (model->GetPosition ().y, position.y, 1e-9, "y at " << now);
+  NS_TEST_EXPECT_MSG_EQ_TOL (model->GetPosition ().z, position.z, 1e-9, "z at " << now);
+}
+
+void
+SumoTraceMobilityModelTestCase::Presence (Ptr<const MobilityModel> model, bool present)
+{
+  m_presence.push_back (std::make_pair (Simulator::Now ().GetSeconds (), present));
+}
+
+void
+SumoTraceMobilityModelTestCase::DoRun (void)
+{
+  using namespace vanetmobility::sumomobility;
+  TraceStore store;
+  Vehicle vehicle;
+  vehicle.depart = 0;
+  vehicle.id = 0;
+  store.AddVehicle (vehicle);
+  vehicle.id = 1;
+  store.AddVehicle (vehicle);
+  Trace trace;
+  trace.angle = trace.speed = trace.pos = trace.slope = 0;
+  for (int t = 2; t <= 50; ++t)
+    {
+      trace.time = t;
+      trace.x = 3 * t;
+      trace.y = -t;
+      store.Append (0, trace);
+    }
+  store.Finalize ();
+
+  Ptr<SumoTraceMobilityModel> car = CreateObject<SumoTraceMobilityModel> ();
+  car->SetPosition (Vector (1, 2, 3));
+  car->SetTrace (&store, 0);
+  car->TraceConnectWithoutContext ("Presence", MakeCallback (&SumoTraceMobilityModelTestCase::Presence, this));
+  Ptr<SumoTraceMobilityModel> parked = CreateObject<SumoTraceMobilityModel> ();
+  parked->SetPosition (Vector (4, 5, 6));
+  parked->SetTrace (&store, 1);
+  NS_TEST_EXPECT_MSG_EQ (car->GetArrivalTime (), Seconds (2), "trivial");
+  NS_TEST_EXPECT_MSG_EQ (car->GetDepartureTime (), Seconds (50), "trivial");
+
+  double present[] = { 2, 2.5, 3.25, 3.5, 40.5, 41, 7.75, 49.9, 50 };
+  std::sort (present, present + sizeof (present) / sizeof (present[0]));
+  for (uint32_t i = 0; i < sizeof (present) / sizeof (present[0]); ++i)
+    {
+      double t = present[i];
+      Simulator::Schedule (Seconds (t), &SumoTraceMobilityModelTestCase::CheckPosition, this, car, true, Vector (3 * t, -t, 0));
+    }
+  Simulator::Schedule (Seconds (1), &SumoTraceMobilityModelTestCase::CheckPosition, this, car, false, Vector (1, 2, 3));
+  Simulator::Schedule (Seconds (50.5), &SumoTraceMobilityModelTestCase::CheckPosition, this, car, false, Vector (1, 2, 3));
+  Simulator::Schedule (Seconds (10), &SumoTraceMobilityModelTestCase::CheckPosition, this, parked, false, Vector (4, 5, 6));
+  Simulator::Stop (Seconds (60));
+  Simulator::Run ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_presence.size (), 2, "one arrival, one departure");
+  NS_TEST_EXPECT_MSG_EQ_TOL (m_presence[0].first, 2, 1e-9, "trivial");
+  NS_TEST_EXPECT_MSG_EQ (m_presence[0].second, true, "trivial");
+  NS_TEST_EXPECT_MSG_EQ_TOL (m_presence[1].first, 50, 1e-6, "right after the last sample");
+  NS_TEST_EXPECT_MSG_EQ (m_presence[1].second, false, "trivial");
+  Simulator::Destroy ();
+}
+
 // The TestSuite class names the TestSuite, identifies what type of TestSuite,
 // and enables the TestCases to be run.  Typically, only the constructor for
 // this class must be defined
@@ -61,6 +494,11 @@ VanetmobilityTestSuite::VanetmobilityTestSuite ()
 {
   // TestDuration for TestCase can be QUICK, EXTENSIVE or TAKES_FOREVER
   AddTestCase (new VanetmobilityTestCase1, TestCase::QUICK);
+  AddTestCase (new FcdStreamReaderTestCase, TestCase::QUICK);
+  AddTestCase (new TraceCacheTestCase, TestCase::QUICK);
+  AddTestCase (new TraceStoreTestCase, TestCase::QUICK);
+  AddTestCase (new WaypointWindowTestCase, TestCase::QUICK);
+  AddTestCase (new SumoTraceMobilityModelTestCase, TestCase::QUICK);
 }
 
 // Do not forget to allocate an instance of this TestSuite